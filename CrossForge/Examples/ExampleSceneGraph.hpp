@@ -195,6 +195,7 @@ namespace CForge {
 			Sc(1, 1) = Factor;
 			Sc(2, 2) = Factor;
 			for (uint32_t i = 0; i < pModel->vertexCount(); ++i) pModel->vertex(i) = Sc * pModel->vertex(i) - Offset;
+			pModel->geometryChanged();
 		}//scaleModel
 
 		SGNTransformation m_RootSGN;
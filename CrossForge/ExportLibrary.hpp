@@ -82,7 +82,9 @@ void exportLibrary(void) {
 	IncludeFiles.push_back("Core/SCForgeSimulation.h");
 	IncludeFiles.push_back("Core/SCrossForgeDevice.h");
 	IncludeFiles.push_back("Core/SGPIO.h");
+	IncludeFiles.push_back("Core/Parallel.hpp");
 	IncludeFiles.push_back("Core/SLogger.h");
+	IncludeFiles.push_back("Core/TSharedVector.hpp");
 
 	// AssetIO include files.
 	Directories.push_back("crossforge/include/crossforge/AssetIO/");
@@ -90,6 +92,7 @@ void exportLibrary(void) {
 	IncludeFiles.push_back("AssetIO/I2DImageIO.h");
 	IncludeFiles.push_back("AssetIO/I3DMeshIO.h");
 	IncludeFiles.push_back("AssetIO/SAssetIO.h");
+	IncludeFiles.push_back("AssetIO/SkeletalClipLibrary.h");
 	IncludeFiles.push_back("AssetIO/T2DImage.hpp");
 	IncludeFiles.push_back("AssetIO/T3DMesh.hpp");
 	IncludeFiles.push_back("AssetIO/VideoRecorder.h");
@@ -134,6 +137,7 @@ void exportLibrary(void) {
 	Directories.push_back("crossforge/include/crossforge/Graphics/Controller/");
 	IncludeFiles.push_back("Graphics/Controller/MorphTargetAnimationController.h");
 	IncludeFiles.push_back("Graphics/Controller/SkeletalAnimationController.h");
+	IncludeFiles.push_back("Graphics/Controller/SkeletalPoseController.h");
 
 	// Graphics/Font
 	Directories.push_back("crossforge/include/crossforge/Graphics/Font/");
@@ -3,6 +3,7 @@
 #include <crossforge/Graphics/RenderDevice.h>
 #include <crossforge/Core/SLogger.h>
 #include "../MeshProcessing/MeshDecimate.h"
+#include "../MeshProcessing/QEMDecimate.h"
 #include <crossforge/Graphics/Shader/SShaderManager.h>
 #include "LODHandler.h"
 #include <iostream>
@@ -72,32 +73,45 @@ namespace CForge {
 	
 	void LODActor::generateLODModells() {
 
-		// TODO parallelise generation
-		for (uint32_t i = 1; i < m_LODStages.size(); i++) {
-			T3DMesh<float>* pLODMesh = new T3DMesh<float>();
-			float amount = float(m_LODStages[i]) / m_LODStages[i-1];
-			if (amount > 1.0)
-				throw CForgeExcept("decimation stages are in wrong order");
-
-			bool succ = MeshDecimator::decimateMesh(m_LODMeshes[i-1], pLODMesh, amount);
-			bool faceless = false;
-			for (uint32_t j = 0; j < pLODMesh->submeshCount(); j++) {
-				if (pLODMesh->getSubmesh(j)->Faces.size() < 1)
-					faceless = true;
-			}
+		if (m_pSLOD->useProgressiveQEM) {
+			std::vector<T3DMesh<float>*> LODMeshes;
+			QEMDecimator::generateLODs(m_LODMeshes[0], &m_LODStages, &LODMeshes);
+			for (auto pLODMesh : LODMeshes) {
+				m_LODMeshes.push_back(pLODMesh);
+				pLODMesh->computePerVertexNormals();
+				initiateBuffers(m_LODMeshes.size() - 1);
 
-			if (!succ || pLODMesh->vertexCount() < 3 || faceless) { // decimation failed due to to few triangles to decimate
-				m_LODStages.erase(m_LODStages.begin()+i, m_LODStages.end());
-				delete pLODMesh;
-				//m_LODMeshes.push_back(nullptr);
-				break;
+				std::vector<Eigen::Matrix4f>* m_instLODMats = new std::vector<Eigen::Matrix4f>();
+				m_instancedMatRef.push_back(m_instLODMats);
 			}
-			m_LODMeshes.push_back(pLODMesh);
-			pLODMesh->computePerVertexNormals();
-			initiateBuffers(i);
+		}
+		else {
+			for (uint32_t i = 1; i < m_LODStages.size(); i++) {
+				T3DMesh<float>* pLODMesh = new T3DMesh<float>();
+				float amount = float(m_LODStages[i]) / m_LODStages[i-1];
+				if (amount > 1.0)
+					throw CForgeExcept("decimation stages are in wrong order");
+
+				bool succ = MeshDecimator::decimateMesh(m_LODMeshes[i-1], pLODMesh, amount);
+				bool faceless = false;
+				for (uint32_t j = 0; j < pLODMesh->submeshCount(); j++) {
+					if (pLODMesh->getSubmesh(j)->Faces.size() < 1)
+						faceless = true;
+				}
 
-			std::vector<Eigen::Matrix4f>* m_instLODMats = new std::vector<Eigen::Matrix4f>();
-			m_instancedMatRef.push_back(m_instLODMats);
+				if (!succ || pLODMesh->vertexCount() < 3 || faceless) { // decimation failed due to to few triangles to decimate
+					m_LODStages.erase(m_LODStages.begin()+i, m_LODStages.end());
+					delete pLODMesh;
+					//m_LODMeshes.push_back(nullptr);
+					break;
+				}
+				m_LODMeshes.push_back(pLODMesh);
+				pLODMesh->computePerVertexNormals();
+				initiateBuffers(i);
+
+				std::vector<Eigen::Matrix4f>* m_instLODMats = new std::vector<Eigen::Matrix4f>();
+				m_instancedMatRef.push_back(m_instLODMats);
+			}
 		}
 
 		calculateLODPercentages();
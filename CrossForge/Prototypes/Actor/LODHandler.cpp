@@ -3,6 +3,7 @@
 #include <tinyxml2.h>
 #include <crossforge/AssetIO/SAssetIO.h>
 #include "../MeshProcessing/MeshDecimate.h"
+#include "../MeshProcessing/QEMDecimate.h"
 //#include "Examples/SceneUtilities.hpp"
 
 //#include <filesystem>
@@ -124,7 +125,11 @@ namespace CForge {
 	}
 	
 	void LODHandler::generateLODMeshes(std::vector<T3DMesh<float>*>* LODmeshes, std::vector<float>* stages) {
-		// TODO parallelise generation
+		if (pSLOD->useProgressiveQEM) {
+			QEMDecimator::generateLODs((*LODmeshes)[0], stages, LODmeshes);
+			return;
+		}
+
 		for (uint32_t i = 1; i < stages->size(); i++) {
 			T3DMesh<float>* pLODMesh = new T3DMesh<float>();
 			float amount = float((*stages)[i]) / (*stages)[i-1];
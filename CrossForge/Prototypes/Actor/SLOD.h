@@ -30,6 +30,8 @@ namespace CForge {
 		bool skipMeshLoader = false;
 		bool forceLODregeneration = false;
 		bool useLibigl = false;
+		// generate all stages from one progressive quadric error collapse sequence instead of decimating stage by stage, opt in
+		bool useProgressiveQEM = false;
 		
 	protected:
 		SLOD(void);
@@ -27,13 +27,6 @@ namespace CForge {
 	void GLTFIO::loadIntern(const std::string Filepath, T3DMesh<float>* pMesh) {
 		this->m_pMesh = pMesh;
 
-		m_coord.clear();
-		m_normal.clear();
-		m_tangent.clear();
-		m_texCoord.clear();
-		m_color.clear();
-		m_joint.clear();
-		m_weight.clear();
 		m_primitiveIndexRanges.clear();
 
 		m_offsets.clear();
@@ -155,13 +148,9 @@ namespace CForge {
 		assert(!m_pCMesh);
 		m_pCMesh = new T3DMesh<float>(*pMesh);
 
-		m_coord.clear();
-		m_normal.clear();
-		m_tangent.clear();
-		m_texCoord.clear();
-		m_color.clear();
-		m_joint.clear();
-		m_weight.clear();
+		m_payloads.clear();
+		m_bufferSizes.clear();
+		m_minMaxJobs.clear();
 
 		m_offsets.clear();
 
@@ -169,10 +158,16 @@ namespace CForge {
 
 		m_filePath = Filepath;
 
+		size_t extIdx = Filepath.rfind('.');
+		bool isBinary = (extIdx != std::string::npos && Filepath.substr(extIdx) == ".glb");
+
 		//Using two buffers. One for vertex data and one for Textures.
+		//Binary files have a single buffer for everything.
 		Buffer buffer;
 		m_model.buffers.push_back(buffer);
-		m_model.buffers.push_back(buffer);
+		if (!isBinary) m_model.buffers.push_back(buffer);
+		m_textureBuffer = isBinary ? 0 : 1;
+		m_bufferSizes.assign(m_model.buffers.size(), 0);
 
 		//Every texture will use this basic sampler.
 		Sampler gltfSampler;
@@ -183,13 +178,29 @@ namespace CForge {
 
 		//Every mesh will hold a single primitive with the submesh data.
 
-		writeNodes();
-		writeSkinningData();
-		writeSkeletalAnimations();
+		try {
+			// layout first, buffer data is only encoded while the file is written
+			writeNodes();
+			writeSkinningData();
+			writeSkeletalAnimations();
+			finalizeAccessors();
+
+			if (isBinary) {
+				writeGLB(Filepath);
+			}
+			else {
+				encodePayloads();
 
-		TinyGLTF writer;
+				TinyGLTF writer;
 
-		writer.WriteGltfSceneToFile(&m_model, Filepath, false, false, true, false);
+				writer.WriteGltfSceneToFile(&m_model, Filepath, false, false, true, false);
+			}
+		}
+		catch (...) {
+			delete m_pCMesh;
+			m_pCMesh = nullptr;
+			throw;
+		}
 		delete m_pCMesh;
 		m_pCMesh = nullptr;
 	}//store
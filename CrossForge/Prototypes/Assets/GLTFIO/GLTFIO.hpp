@@ -20,7 +20,10 @@
 #include <crossforge/AssetIO/I3DMeshIO.h>
 #include <tiny_gltf.h>
 #include <algorithm>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <limits>
 
 #include "GLTFIOutil.hpp"
 
@@ -35,7 +38,8 @@ namespace CForge {
 class GLTFIO : public GLTFIOutil {
 public:
 	static GLTFIO& instance() {
-		static GLTFIO instance;
+		// one instance per thread, loads and stores keep their state in members
+		static thread_local GLTFIO instance;
 		return instance;
 	}
 	static void load(const std::string Filepath, T3DMesh<float>* pMesh) {
@@ -58,15 +62,11 @@ private:
 		m_model = tinygltf::Model();
 		m_pMesh = nullptr;
 		m_pCMesh = nullptr; //TODO(skade)
-		// Data for every primitive is stored in a separate vector.
 
-		m_coord.clear();
-		m_normal.clear();
-		m_tangent.clear();
-		m_texCoord.clear();
-		m_color.clear();
-		m_joint.clear();
-		m_weight.clear();
+		m_payloads.clear();
+		m_bufferSizes.clear();
+		m_minMaxJobs.clear();
+		m_textureBuffer = 1;
 
 		m_primitiveIndexRanges.clear();
 		m_offsets.clear(); //TODO(skade) type
@@ -81,15 +81,23 @@ private:
 	tinygltf::Model m_model;
 	T3DMesh<float>* m_pMesh = nullptr;
 	T3DMesh<float>* m_pCMesh = nullptr; //TODO(skade)
-	// Data for every primitive is stored in a separate vector.
 
-	std::vector<Eigen::Matrix<float, 3, 1>> m_coord;
-	std::vector<Eigen::Matrix<float, 3, 1>> m_normal;
-	std::vector<Eigen::Matrix<float, 3, 1>> m_tangent;
-	std::vector<Eigen::Matrix<float, 2, 1>> m_texCoord;
-	std::vector<Eigen::Matrix<float, 4, 1>> m_color;
-	std::vector<Eigen::Matrix<float, 4, 1>> m_joint;
-	std::vector<Eigen::Matrix<float, 4, 1>> m_weight;
+	/**
+	 * \brief Content of a buffer view that is only produced while the binary data is written. Encode writes Count
+	 *        elements starting at element First to pDst, so a payload can be encoded in pieces and in parallel.
+	*/
+	struct BinPayload {
+		int Buffer = 0;
+		size_t Offset = 0;
+		size_t ElementSize = 0;
+		size_t Count = 0;
+		std::function<void(unsigned char* pDst, size_t First, size_t Count)> Encode;
+	};
+	std::vector<BinPayload> m_payloads;
+	std::vector<size_t> m_bufferSizes; // bytes reserved per buffer
+	std::vector<std::function<void()>> m_minMaxJobs;
+	int m_textureBuffer = 1; // glb files have a single buffer
+	static const size_t m_GLBChunkSize = 8 << 20;
 
 	std::vector<std::pair<int32_t, int32_t>> m_primitiveIndexRanges;
 	std::vector<unsigned long> m_offsets; //TODO(skade) type
@@ -108,151 +116,92 @@ public:
 private:
 //TODO(skade) move elsewhere
 #pragma region accessor_read
-	template<class T>
-	void readBuffer(unsigned char* pBuffer, const int element_count, const int offset, const int component_count,
-	                const bool is_matrix, const int stride, std::vector<T>* pData) {
-		int type_size = sizeof(T);
-
-		if (is_matrix) {
-			assert(component_count == 16);
-			assert(type_size == 4);
-		}
-
-		pData->reserve(element_count * component_count);
-
-		T* raw_data = (T*)(pBuffer + offset);
-
-		int jump = stride / type_size;
-		if (jump == 0) jump = component_count;
+	/**
+	 * \brief Typed strided view on the elements of an accessor, points into the loaded buffer.
+	*/
+	struct AccessorView {
+		const unsigned char* pData = nullptr; // first element, nullptr if the accessor has no buffer view
+		size_t Count = 0;
+		size_t Stride = 0; // bytes from one element to the next
+		int ComponentType = 0;
+		int Components = 0;
+	};
 
-		for (int i = 0; i < element_count; i++) {
-			int index = i * jump;
-			for (int k = 0; k < component_count; k++) {
-				T tmp = raw_data[index + k];
-				pData->push_back(tmp);
-			}
-		}
-	}
+	/**
+	 * \brief Checks that ByteCount bytes starting at ByteOffset lie inside the buffer view and its buffer.
+	 * \throws CrossForgeException if not
+	*/
+	const unsigned char* bufferViewData(const int bufferView, const size_t ByteOffset, const size_t ByteCount) const;
+
+	/**
+	 * \throws CrossForgeException if the accessor is invalid or reads outside of its buffer
+	*/
+	AccessorView accessorView(const int accessor) const;
+
+	/**
+	 * \brief Views on the substituted element indices and values of a sparse accessor.
+	*/
+	void sparseViews(const int accessor, AccessorView* pIndices, AccessorView* pValues) const;
+
+	/**
+	 * \brief Converts the elements of a view to DstComponents values of type T each, components the view does not
+	 *        have are left untouched. Tightly packed data of type T is copied in bulk.
+	*/
+	template<class S, class T>
+	static void convertView(const AccessorView& View, T* pDst, const int DstComponents, const bool Normalize);
 
 	template<class T>
-	void getAccessorDataScalar(const int accessor, std::vector<T>* pData) {
-		tinygltf::Accessor acc = m_model.accessors[accessor];
-		tinygltf::BufferView buffView = m_model.bufferViews[acc.bufferView];
-		tinygltf::Buffer buff = m_model.buffers[buffView.buffer];
-
-		if (acc.type != TINYGLTF_TYPE_SCALAR) {
-			//std::cout << "Called getAccessorDataScalar on a non scalar accessor!" << std::endl;
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_BYTE) {
-			std::vector<char> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-			std::vector<unsigned char> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_SHORT) {
-			std::vector<short> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-			std::vector<unsigned short> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_INT) {
-			std::vector<int32_t> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-			std::vector<int32_t> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
-			std::vector<float> data;
-
-			readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, 1, false, 0, &data);
-			for (auto d : data) pData->push_back((T)d);
-			return;
-		}
-	}
-
-	void getAccessorDataScalarFloat(const int accessor, std::vector<float>* pData);
+	static void decodeView(const AccessorView& View, T* pDst, const int DstComponents, const bool Normalize);
 
+	/**
+	 * \brief Decodes all elements of an accessor including sparse substitution into pDst, which needs room for
+	 *        count elements. Decodes straight into the destination array, no intermediate copies.
+	*/
 	template<class T>
-	void getAccessorData(const int accessor, std::vector<std::vector<T>>* pData) {
-		tinygltf::Accessor acc = m_model.accessors[accessor];
-		tinygltf::BufferView buffView = m_model.bufferViews[acc.bufferView];
-		tinygltf::Buffer buff = m_model.buffers[buffView.buffer];
-
-		if (acc.type == TINYGLTF_TYPE_SCALAR) {
-			//std::cout << "Called getAccessorData on a scalar accessor!" << std::endl;
-			return;
-		}
+	void decodeAccessor(const int accessor, T* pDst, const int DstComponents, const bool Normalize) const;
 
-		int nComponents = componentCount(acc.type);
+	void getAccessorDataScalar(const int accessor, std::vector<int32_t>* pData) const;
 
-		std::vector<T> unstructured;
+	/**
+	 * \brief Reads normalized integers and returns floats.
+	*/
+	void getAccessorDataScalarFloat(const int accessor, std::vector<float>* pData) const;
 
-		int remaining_size = buff.data.size() - acc.byteOffset - buffView.byteOffset;
+	void getAccessorData(const int accessor, std::vector<Eigen::Vector3f>* pData) const;
 
-		readBuffer(buff.data.data(), acc.count, acc.byteOffset + buffView.byteOffset, nComponents, componentIsMatrix(acc.type), buffView.byteStride, &unstructured);
+	void getAccessorData(const int accessor, std::vector<Eigen::Vector4f>* pData) const;
 
-		for (int i = 0; i < unstructured.size(); i += nComponents) {
-			std::vector<T> toAdd;
-			for (int j = 0; j < nComponents; j++) {
-				toAdd.push_back(unstructured[i + j]);
-			}
-			pData->push_back(toAdd);
-		}
-	}
-
-	int32_t getSparseAccessorData(const int accessor, std::vector<int32_t>* pIndices, std::vector<std::vector<float>>* pData);
-
-	void getAccessorDataFloat(const int accessor, std::vector<std::vector<float>>* pData);
+	void getAccessorData(const int accessor, std::vector<Eigen::Quaternionf>* pData) const;
 
-	void getAccessorData(const int accessor, std::vector<Eigen::Vector3f>* pData);
+	void getAccessorData(const int accessor, std::vector<Eigen::Matrix4f>* pData) const;
 
-	void getAccessorData(const int accessor, std::vector<Eigen::Vector4f>* pData);
-
-	void getAccessorData(const int accessor, std::vector<Eigen::Quaternionf>* pData);
+	/**
+	 * \brief Reads only the substituted elements of a sparse accessor.
+	 * \return false if the accessor is not sparse
+	*/
+	bool getSparseAccessorData(const int accessor, std::vector<int32_t>* pIndices, std::vector<Eigen::Vector3f>* pData) const;
 #pragma endregion
 
 #pragma region read
-	void readMeshes();
+	/**
+	 * \brief Vertex arrays of all primitives, each primitive decodes into its own range.
+	*/
+	struct VertexArrays {
+		std::vector<Eigen::Vector3f> Positions;
+		std::vector<Eigen::Vector3f> Normals;
+		std::vector<Eigen::Vector3f> Tangents;
+		std::vector<Eigen::Vector3f> UVWs;
+		std::vector<Eigen::Vector4f> Joints;
+		std::vector<Eigen::Vector4f> Weights;
+	};
 
-	T3DMesh<float>::Submesh* readPrimitive(tinygltf::Primitive* pPrimitive);
+	void readMeshes();
 
-	void readAttributes(tinygltf::Primitive* pPrimitive);
+	void readAttributes(const tinygltf::Primitive* pPrimitive, const size_t FirstVertex, const size_t VertexCount, VertexArrays* pArrays) const;
 
-	T3DMesh<float>::Submesh* readSubMeshes(tinygltf::Primitive* pPrimitive);
+	T3DMesh<float>::Submesh* readSubMeshes(const tinygltf::Primitive* pPrimitive, std::vector<T3DMesh<float>::Face>* pFaces);
 
-	void readFaces(tinygltf::Primitive* pPrimitive, std::vector<T3DMesh<float>::Face>* faces);
+	void readFaces(const tinygltf::Primitive* pPrimitive, const size_t FirstVertex, const size_t VertexCount, std::vector<T3DMesh<float>::Face>* pFaces) const;
 
 	void readMaterial(const int m_materialIndex, T3DMesh<float>::Material* pMaterial);
 
@@ -262,171 +211,150 @@ private:
 
 	void readSkeletalAnimations();
 
+	/**
+	 * \brief Keyframe IDs start at 0, pKeyframeCount receives the number of keyframes created.
+	 * \return nullptr for animations that only target morph weights
+	*/
+	T3DMesh<float>::SkeletalAnimation* readSkeletalAnimation(const tinygltf::Animation& animation, int32_t* pKeyframeCount) const;
+
 	void readSkinningData();
 
 	void readMorphTargets();
+
+	T3DMesh<float>::MorphTarget* readMorphTarget(const std::map<std::string, int>& target, const int32_t FirstVertex) const;
 #pragma endregion
 
 #pragma region accessor_write
-	template<class T>
-	void writeBuffer(std::vector<unsigned char>* pBuffer, const int offset, const int component_count, const bool is_matrix, const int stride, const std::vector<T>* pData) {
-		int type_size = sizeof(T);
-
-		if (is_matrix) {
-			assert(component_count == 16);
-			assert(type_size == 4);
-		}
-
-		while (pBuffer->size() < offset) pBuffer->push_back(0);
-
-		int index = offset;
-
-		for (int i = 0; i < pData->size(); i++) {
-			T element = (*pData)[i];
-			unsigned char* as_char_pointer = (unsigned char*)&element;
-
-			for (int k = 0; k < type_size; k++) {
-				if (index == pBuffer->size()) pBuffer->push_back(as_char_pointer[k]);
-				else (*pBuffer)[index] = as_char_pointer[k];
-				index++;
+	/**
+	 * \brief Reserves a 4 byte aligned range of the buffer for the payload.
+	 * \return Index of the new buffer view.
+	*/
+	int addBufferView(BinPayload Payload);
+
+	/**
+	 * \brief Adds an accessor whose elements are produced by Element(i, pValues) writing N values of type T.
+	 *        Element is called when min/max are computed and again when the binary data is written, so it must
+	 *        only reference data that lives until then.
+	 * \return Index of the new accessor.
+	*/
+	template<class T, int N, class Func>
+	int writeAccessor(const int type, const size_t Count, Func Element) {
+		BinPayload Payload;
+		Payload.ElementSize = sizeof(T) * N;
+		Payload.Count = Count;
+		Payload.Encode = [Element](unsigned char* pDst, size_t First, size_t Count) {
+			T Values[N];
+			for (size_t i = 0; i < Count; ++i) {
+				Element(First + i, Values);
+				std::memcpy(pDst + i * sizeof(Values), Values, sizeof(Values));
 			}
-
-			for (int k = 0; k < stride; k++) {
-				if (index == pBuffer->size()) pBuffer->push_back(0);
-				index++;
-			}
-		}
-	}
-
-	template<class T>
-	void writeAccessorDataScalar(const int bufferIndex, std::vector<T>* pData) {
-		std::cout << "write accessor size: " << pData->size() << ", scalar" << std::endl;
-
-		tinygltf::Buffer* pBuffer = &m_model.buffers[bufferIndex];
+		};
 
 		tinygltf::Accessor accessor;
+		accessor.bufferView = addBufferView(std::move(Payload));
+		accessor.byteOffset = 0;
+		accessor.componentType = getGltfComponentType(T(0));
+		accessor.type = type;
+		accessor.count = Count;
 
-		T min = std::numeric_limits<T>::max();
-		T max = std::numeric_limits<T>::lowest();
-
-		for (int i = 0; i < pData->size(); i++) {
-			T element = (*pData)[i];
-			if (element < min) min = element;
-			if (element > max) max = element;
-		}
-
-		accessor.minValues.push_back(min);
-		accessor.maxValues.push_back(max);
-
-		T t = 0;
-
-		accessor.bufferView = m_model.bufferViews.size();
-		accessor.byteOffset = (size_t)0;
-		accessor.componentType = getGltfComponentType(t);
-		accessor.type = TINYGLTF_TYPE_SCALAR;
-		accessor.count = pData->size();
-
+		const int accessorIndex = m_model.accessors.size();
 		m_model.accessors.push_back(accessor);
 
-		tinygltf::BufferView bufferView;
-
-		// The combined byteOffset must be a multiple of the size of the component datatype.
-		int type_size = sizeof(T);
-		int alignment = type_size - pBuffer->data.size() % type_size;
-
-		bufferView.byteOffset = pBuffer->data.size() + alignment;
-		bufferView.buffer = bufferIndex;
-		bufferView.byteLength = pData->size() * sizeof(T);
-
-		m_model.bufferViews.push_back(bufferView);
+		if (!componentIsMatrix(type)) {
+			m_minMaxJobs.push_back([this, accessorIndex, Count, Element]() {
+				T Values[N];
+				std::vector<double> Min(N, double(std::numeric_limits<T>::max()));
+				std::vector<double> Max(N, double(std::numeric_limits<T>::lowest()));
+				for (size_t i = 0; i < Count; ++i) {
+					Element(i, Values);
+					for (int k = 0; k < N; ++k) {
+						Min[k] = std::min(Min[k], double(Values[k]));
+						Max[k] = std::max(Max[k], double(Values[k]));
+					}
+				}
+				m_model.accessors[accessorIndex].minValues = Min;
+				m_model.accessors[accessorIndex].maxValues = Max;
+			});
+		}
 
-		writeBuffer(&pBuffer->data, bufferView.byteOffset + accessor.byteOffset,
-			accessor.count, false, bufferView.byteStride, pData);
+		return accessorIndex;
 	}
 
-	template<class T>
-	void writeAccessorData(const int bufferIndex, const int type, std::vector<std::vector<T>>* pData) {
-		std::cout << "write accessor size: " << pData->size() << ", vec " << (*pData)[0].size() << std::endl;
-
-		tinygltf::Buffer* pBuffer = &m_model.buffers[bufferIndex];
-
+	/**
+	 * \brief Adds a float accessor of Count elements that are zero except for the IndexCount elements listed by
+	 *        Index(i, pIndex), which get the values written by Value(i, pValues).
+	 * \return Index of the new accessor.
+	*/
+	template<int N, class IndexFunc, class ValueFunc>
+	int writeSparseAccessor(const int type, const size_t Count, const size_t IndexCount, IndexFunc Index, ValueFunc Value) {
 		tinygltf::Accessor accessor;
-
-		int component_count = componentCount(type);
-
-		bool is_matrix = componentIsMatrix(type);
-
-		if (!is_matrix) {
-			T n_min = std::numeric_limits<T>::max();
-			T n_max = std::numeric_limits<T>::lowest();
-
-			std::vector<T> min;
-			std::vector<T> max;
-
-			for (int i = 0; i < component_count; i++) {
-				min.push_back(n_min);
-				max.push_back(n_max);
+		accessor.bufferView = -1; // no base data, zeros
+		accessor.byteOffset = 0;
+		accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+		accessor.type = type;
+		accessor.count = Count;
+		accessor.sparse.isSparse = true;
+		accessor.sparse.count = IndexCount;
+
+		BinPayload Indices;
+		Indices.ElementSize = sizeof(uint32_t);
+		Indices.Count = IndexCount;
+		Indices.Encode = [Index](unsigned char* pDst, size_t First, size_t Count) {
+			for (size_t i = 0; i < Count; ++i) {
+				uint32_t ID;
+				Index(First + i, &ID);
+				std::memcpy(pDst + i * sizeof(ID), &ID, sizeof(ID));
 			}
-
-			for (int i = 0; i < pData->size(); i++) {
-				auto element = (*pData)[i];
-
-				for (int j = 0; j < component_count; j++) {
-					T value = element[j];
-
-					if (value < min[j]) min[j] = value;
-					if (value > max[j]) max[j] = value;
-				}
+		};
+		accessor.sparse.indices.bufferView = addBufferView(std::move(Indices));
+		accessor.sparse.indices.byteOffset = 0;
+		accessor.sparse.indices.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+
+		BinPayload Values;
+		Values.ElementSize = sizeof(float) * N;
+		Values.Count = IndexCount;
+		Values.Encode = [Value](unsigned char* pDst, size_t First, size_t Count) {
+			float Element[N];
+			for (size_t i = 0; i < Count; ++i) {
+				Value(First + i, Element);
+				std::memcpy(pDst + i * sizeof(Element), Element, sizeof(Element));
 			}
-
-			for (int i = 0; i < min.size(); i++) {
-				accessor.minValues.push_back(min[i]);
-				accessor.maxValues.push_back(max[i]);
-			}
-		}
-
-		T t = 0;
-
-		accessor.bufferView = m_model.bufferViews.size();
-		accessor.byteOffset = (size_t)0;
-		accessor.componentType = getGltfComponentType(t);
-		accessor.type = type;
-		accessor.count = pData->size();
-
-		// std::cout << "DEBUG Accessor index: " << model.accessors.size() << " count: " << accessor.count << " type: " << accessor.type << std::endl;
+		};
+		accessor.sparse.values.bufferView = addBufferView(std::move(Values));
+		accessor.sparse.values.byteOffset = 0;
 
 		m_model.accessors.push_back(accessor);
-
-		tinygltf::BufferView bufferView;
-
-		// The combined byteOffset must be a multiple of the size of the component datatype.
-		int type_size = sizeof(T);
-		int alignment = type_size - pBuffer->data.size() % type_size;
-
-		bufferView.byteOffset = pBuffer->data.size() + alignment;
-		bufferView.buffer = bufferIndex;
-		bufferView.byteLength = pData->size() * sizeof(T) * component_count;
-		bufferView.byteStride = 0;
-
-		m_model.bufferViews.push_back(bufferView);
-
-		std::vector<T> simplified;
-		for (auto v : *pData) {
-			for (auto e : v) simplified.push_back(e);
-		}
-
-		writeBuffer(&pBuffer->data, bufferView.byteOffset + accessor.byteOffset, component_count, is_matrix, bufferView.byteStride, &simplified);
+		return m_model.accessors.size() - 1;
 	}
 
-	int writeSparseAccessorData(const int buffer_index, const int type, const std::vector<int32_t>* pIndices, const std::vector<std::vector<float>>* pData);
+	/**
+	 * \brief Computes min and max of the accessors, in parallel.
+	*/
+	void finalizeAccessors();
+
+	/**
+	 * \brief Encodes all payloads into the data of m_model's buffers, in parallel.
+	*/
+	void encodePayloads();
+
+	/**
+	 * \brief Writes a binary glTF. The JSON chunk is written first, then the payloads are encoded piecewise into a
+	 *        staging buffer of m_GLBChunkSize bytes that is streamed into the BIN chunk, so the buffer data never
+	 *        exists in memory as a whole.
+	*/
+	void writeGLB(const std::string Filepath);
 #pragma endregion
 
 #pragma region write
 	int writePrimitive(const T3DMesh<float>::Submesh* pSubmesh);
 
-	void writeAttributes();
+	/**
+	 * \brief Writes the indices of a submesh relative to the lowest vertex it uses.
+	 * \return First and last vertex used by the submesh.
+	*/
+	std::pair<int, int> writeIndices(const T3DMesh<float>::Submesh* pSubmesh);
 
-	std::pair<int, int> prepareAttributeArrays(const T3DMesh<float>::Submesh* pSubmesh);
+	void writeAttributes(std::pair<int, int> minmax);
 
 	void writeMaterial(const T3DMesh<float>::Submesh* pSubmesh);
 
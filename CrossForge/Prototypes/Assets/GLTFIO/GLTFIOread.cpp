@@ -17,249 +17,305 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 #include <fstream>
 
 #include <crossforge/Math/CForgeMath.h>
+#include <crossforge/Core/Parallel.hpp>
 
 using namespace tinygltf;
 
 namespace CForge {
 
-#pragma region read
-
-	void GLTFIO::readMeshes() {
-		for (int i = 0; i < m_model.meshes.size(); i++) {
-			Mesh currentMesh = m_model.meshes[i];
-
-			//T3DMesh<float>::Submesh* pParentSubmesh;
-
-			//for (int j = 0; j < m_model.nodes.size(); j++) {
-			//	if (m_model.nodes[j].mesh == i) {
-			//		pParentSubmesh = m_pMesh->getSubmesh(j);
-			//		break;
-			//	}
-			//}
-
-			for (int k = 0; k < currentMesh.primitives.size(); k++) {
-				Primitive currentPrimitive = currentMesh.primitives[k];
-
-				T3DMesh<float>::Submesh* pSubmesh = readPrimitive(&currentPrimitive);
+namespace {
+	// normalized integers as defined by the glTF specification
+	inline float normalizedValue(const int8_t v) { return std::max(v / 127.0f, -1.0f); }
+	inline float normalizedValue(const uint8_t v) { return v / 255.0f; }
+	inline float normalizedValue(const int16_t v) { return std::max(v / 32767.0f, -1.0f); }
+	inline float normalizedValue(const uint16_t v) { return v / 65535.0f; }
+	inline float normalizedValue(const uint32_t v) { return float(v); }
+	inline float normalizedValue(const float v) { return v; }
+
+	static_assert(sizeof(Eigen::Vector3f) == 3 * sizeof(float), "Vector3f is expected to be tightly packed");
+	static_assert(sizeof(Eigen::Vector4f) == 4 * sizeof(float), "Vector4f is expected to be tightly packed");
+	static_assert(sizeof(Eigen::Quaternionf) == 4 * sizeof(float), "Quaternionf is expected to be x,y,z,w floats");
+	static_assert(sizeof(Eigen::Matrix4f) == 16 * sizeof(float), "Matrix4f is expected to be tightly packed");
+}
+
+#pragma region accessor_read
+
+	const unsigned char* GLTFIO::bufferViewData(const int bufferView, const size_t ByteOffset, const size_t ByteCount) const {
+		if (bufferView < 0 || bufferView >= m_model.bufferViews.size())
+			throw CForgeExcept("Buffer view " + std::to_string(bufferView) + " does not exist");
+		const BufferView& View = m_model.bufferViews[bufferView];
+		if (View.buffer < 0 || View.buffer >= m_model.buffers.size())
+			throw CForgeExcept("Buffer view " + std::to_string(bufferView) + " references a missing buffer");
+		const Buffer& Buff = m_model.buffers[View.buffer];
+		if (ByteOffset + ByteCount > View.byteLength || View.byteOffset + View.byteLength > Buff.data.size())
+			throw CForgeExcept("Access outside of buffer view " + std::to_string(bufferView));
+		return Buff.data.data() + View.byteOffset + ByteOffset;
+	}//bufferViewData
+
+	GLTFIO::AccessorView GLTFIO::accessorView(const int accessor) const {
+		if (accessor < 0 || accessor >= m_model.accessors.size())
+			throw CForgeExcept("Accessor " + std::to_string(accessor) + " does not exist");
+		const Accessor& Acc = m_model.accessors[accessor];
+
+		AccessorView Rval;
+		Rval.Count = Acc.count;
+		Rval.ComponentType = Acc.componentType;
+		Rval.Components = componentCount(Acc.type);
+		const size_t ElementSize = size_t(Rval.Components) * sizeOfGltfComponentType(Acc.componentType);
+		Rval.Stride = ElementSize;
+
+		// no buffer view: all zeros, only sparse substitutions carry data
+		if (Acc.bufferView < 0) return Rval;
+
+		const size_t Stride = m_model.bufferViews.at(Acc.bufferView).byteStride;
+		if (Stride != 0) Rval.Stride = Stride;
+		const size_t Bytes = (Rval.Count == 0) ? 0 : (Rval.Count - 1) * Rval.Stride + ElementSize;
+		Rval.pData = bufferViewData(Acc.bufferView, Acc.byteOffset, Bytes);
+		return Rval;
+	}//accessorView
+
+	void GLTFIO::sparseViews(const int accessor, AccessorView* pIndices, AccessorView* pValues) const {
+		const AccessorView Base = accessorView(accessor);
+		const auto& Sparse = m_model.accessors[accessor].sparse;
+
+		pIndices->Count = Sparse.count;
+		pIndices->ComponentType = Sparse.indices.componentType;
+		pIndices->Components = 1;
+		pIndices->Stride = sizeOfGltfComponentType(Sparse.indices.componentType);
+		pIndices->pData = bufferViewData(Sparse.indices.bufferView, Sparse.indices.byteOffset, pIndices->Count * pIndices->Stride);
+
+		pValues->Count = Sparse.count;
+		pValues->ComponentType = Base.ComponentType;
+		pValues->Components = Base.Components;
+		pValues->Stride = size_t(Base.Components) * sizeOfGltfComponentType(Base.ComponentType);
+		pValues->pData = bufferViewData(Sparse.values.bufferView, Sparse.values.byteOffset, pValues->Count * pValues->Stride);
+	}//sparseViews
+
+	template<class S, class T>
+	void GLTFIO::convertView(const AccessorView& View, T* pDst, const int DstComponents, const bool Normalize) {
+		const int Components = std::min(View.Components, DstComponents);
+
+		if (std::is_same<S, T>::value && Components == View.Components && Components == DstComponents && View.Stride == sizeof(S) * Components) {
+			std::memcpy(pDst, View.pData, View.Count * View.Stride);
+			return;
+		}
 
-				//TODO(skade)
-				//pParentSubmesh->Children.push_back(pSubmesh);
-				//pSubmesh->pParent = pParentSubmesh;
+		for (size_t i = 0; i < View.Count; ++i) {
+			const unsigned char* pSrc = View.pData + i * View.Stride;
+			T* pElement = pDst + i * DstComponents;
+			for (int k = 0; k < Components; ++k) {
+				S Value;
+				std::memcpy(&Value, pSrc + k * sizeof(S), sizeof(S)); // source may be unaligned
+				pElement[k] = Normalize ? T(normalizedValue(Value)) : T(Value);
 			}
 		}
+	}//convertView
+
+	template<class T>
+	void GLTFIO::decodeView(const AccessorView& View, T* pDst, const int DstComponents, const bool Normalize) {
+		switch (View.ComponentType) {
+		case TINYGLTF_COMPONENT_TYPE_BYTE: convertView<int8_t>(View, pDst, DstComponents, Normalize); break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: convertView<uint8_t>(View, pDst, DstComponents, Normalize); break;
+		case TINYGLTF_COMPONENT_TYPE_SHORT: convertView<int16_t>(View, pDst, DstComponents, Normalize); break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: convertView<uint16_t>(View, pDst, DstComponents, Normalize); break;
+		case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: convertView<uint32_t>(View, pDst, DstComponents, Normalize); break;
+		case TINYGLTF_COMPONENT_TYPE_FLOAT: convertView<float>(View, pDst, DstComponents, Normalize); break;
+		default: throw CForgeExcept("Unsupported accessor component type " + std::to_string(View.ComponentType));
+		}
+	}//decodeView
 
-		//TODO(skade) memory leak?
-		auto pCoord = new std::vector<Eigen::Matrix<float, 3, 1>>;
-		for (auto i : m_coord) pCoord->push_back(i);
-		auto pNormal = new std::vector<Eigen::Matrix<float, 3, 1>>;
-		for (auto i : m_normal) pNormal->push_back(i);
-		auto pTangent = new std::vector<Eigen::Matrix<float, 3, 1>>;
-		for (auto i : m_tangent) pTangent->push_back(i);
-		auto pTexCoord = new std::vector<Eigen::Matrix<float, 3, 1>>;
-		fromUVtoUVW(&m_texCoord, pTexCoord);
-
-		m_pMesh->vertices(pCoord);
-		m_pMesh->normals(pNormal);
-		m_pMesh->tangents(pTangent);
-		m_pMesh->textureCoordinates(pTexCoord);
-
-		delete pCoord;
-		delete pNormal;
-		delete pTangent;
-		delete pTexCoord;
-	}
-
-	T3DMesh<float>::Submesh* GLTFIO::readPrimitive(Primitive* pPrimitive) {
-		readAttributes(pPrimitive);
-
-		return readSubMeshes(pPrimitive);
-	}
-
-	void GLTFIO::readAttributes(Primitive* pPrimitive) {
-		int counter = 0;
-
-		for (auto keyValuePair : pPrimitive->attributes) {
-			if (keyValuePair.first == "POSITION") {
-				std::vector<std::vector<float>> positions;
-				getAccessorData(keyValuePair.second, &positions);
-
-				for (auto pos : positions) {
-					Eigen::Matrix<float, 3, 1> mat;
-
-					mat(0) = pos[0];
-					mat(1) = pos[1];
-					mat(2) = pos[2];
-
-					m_coord.push_back(mat);
+	template<class T>
+	void GLTFIO::decodeAccessor(const int accessor, T* pDst, const int DstComponents, const bool Normalize) const {
+		const AccessorView View = accessorView(accessor);
 
-					counter++;
-				}
-
-				continue;
+		if (nullptr != View.pData) {
+			decodeView(View, pDst, DstComponents, Normalize);
+		}
+		else {
+			const int Components = std::min(View.Components, DstComponents);
+			for (size_t i = 0; i < View.Count; ++i) {
+				for (int k = 0; k < Components; ++k) pDst[i * DstComponents + k] = T(0);
 			}
+		}
 
-			if (keyValuePair.first == "NORMAL") {
-				std::vector<std::vector<float>> normals;
-				getAccessorData(keyValuePair.second, &normals);
-
-				for (auto pos : normals) {
-					Eigen::Matrix<float, 3, 1> mat;
-
-					mat(0) = pos[0];
-					mat(1) = pos[1];
-					mat(2) = pos[2];
-
-					m_normal.push_back(mat);
-				}
-
-				continue;
-			}
+		if (!m_model.accessors[accessor].sparse.isSparse) return;
 
-			if (keyValuePair.first == "TANGENT") {
-				std::vector<std::vector<float>> tangents;
-				getAccessorData(keyValuePair.second, &tangents);
+		AccessorView Indices;
+		AccessorView Values;
+		sparseViews(accessor, &Indices, &Values);
 
-				for (auto pos : tangents) {
-					Eigen::Matrix<float, 3, 1> mat;
+		std::vector<uint32_t> ElementIDs(Indices.Count);
+		decodeView(Indices, ElementIDs.data(), 1, false);
 
-					mat(0) = pos[0];
-					mat(1) = pos[1];
-					mat(2) = pos[2];
+		for (size_t i = 0; i < ElementIDs.size(); ++i) {
+			if (ElementIDs[i] >= View.Count) throw CForgeExcept("Sparse index outside of accessor " + std::to_string(accessor));
+			AccessorView Element = Values;
+			Element.pData += i * Values.Stride;
+			Element.Count = 1;
+			decodeView(Element, pDst + size_t(ElementIDs[i]) * DstComponents, DstComponents, Normalize);
+		}
+	}//decodeAccessor
+
+	void GLTFIO::getAccessorDataScalar(const int accessor, std::vector<int32_t>* pData) const {
+		pData->resize(accessorView(accessor).Count);
+		decodeAccessor(accessor, pData->data(), 1, false);
+	}//getAccessorDataScalar
+
+	void GLTFIO::getAccessorDataScalarFloat(const int accessor, std::vector<float>* pData) const {
+		pData->resize(accessorView(accessor).Count);
+		decodeAccessor(accessor, pData->data(), 1, true);
+	}//getAccessorDataScalarFloat
+
+	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Vector3f>* pData) const {
+		pData->assign(accessorView(accessor).Count, Eigen::Vector3f::Zero());
+		decodeAccessor(accessor, pData->data()->data(), 3, m_model.accessors[accessor].normalized);
+	}//getAccessorData
+
+	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Vector4f>* pData) const {
+		pData->assign(accessorView(accessor).Count, Eigen::Vector4f::Zero());
+		decodeAccessor(accessor, pData->data()->data(), 4, m_model.accessors[accessor].normalized);
+	}//getAccessorData
+
+	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Quaternionf>* pData) const {
+		// Eigen stores x,y,z,w like glTF
+		pData->assign(accessorView(accessor).Count, Eigen::Quaternionf::Identity());
+		decodeAccessor(accessor, pData->data()->coeffs().data(), 4, m_model.accessors[accessor].normalized);
+	}//getAccessorData
+
+	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Matrix4f>* pData) const {
+		// both column major
+		pData->assign(accessorView(accessor).Count, Eigen::Matrix4f::Identity());
+		decodeAccessor(accessor, pData->data()->data(), 16, m_model.accessors[accessor].normalized);
+	}//getAccessorData
+
+	bool GLTFIO::getSparseAccessorData(const int accessor, std::vector<int32_t>* pIndices, std::vector<Eigen::Vector3f>* pData) const {
+		if (accessor < 0 || accessor >= m_model.accessors.size() || !m_model.accessors[accessor].sparse.isSparse) return false;
+
+		AccessorView Indices;
+		AccessorView Values;
+		sparseViews(accessor, &Indices, &Values);
+
+		pIndices->resize(Indices.Count);
+		decodeView(Indices, pIndices->data(), 1, false);
+		pData->assign(Values.Count, Eigen::Vector3f::Zero());
+		decodeView(Values, pData->data()->data(), 3, m_model.accessors[accessor].normalized);
+		return true;
+	}//getSparseAccessorData
 
-					m_tangent.push_back(mat);
-				}
+#pragma endregion
 
-				continue;
-			}
+#pragma region read
 
-			if (keyValuePair.first.find("TEXCOORD") != std::string::npos) {
-				int n = -1;
-				auto s = keyValuePair.first.substr(9);
-				n = std::stoi(s);
+	void GLTFIO::readMeshes() {
+		std::vector<const Primitive*> Primitives;
+		for (const Mesh& mesh : m_model.meshes) {
+			for (const Primitive& primitive : mesh.primitives) Primitives.push_back(&primitive);
+		}
 
-				//TODO: support multiple textures
-				if (n != 0) continue;
+		// every primitive gets its own range of the vertex arrays
+		std::vector<size_t> FirstVertex(Primitives.size() + 1, 0);
+		bool HasNormals = false;
+		bool HasTangents = false;
+		bool HasUVWs = false;
+		bool HasSkin = false;
+		for (size_t i = 0; i < Primitives.size(); ++i) {
+			const auto& Attributes = Primitives[i]->attributes;
+			auto itPosition = Attributes.find("POSITION");
+			const size_t Count = (itPosition == Attributes.end()) ? 0 : accessorView(itPosition->second).Count;
+			m_offsets.push_back(Count);
+			FirstVertex[i + 1] = FirstVertex[i] + Count;
+			if (Count == 0) continue;
+			if (Attributes.count("NORMAL")) HasNormals = true;
+			if (Attributes.count("TANGENT")) HasTangents = true;
+			if (Attributes.count("TEXCOORD_0")) HasUVWs = true;
+			if (Attributes.count("JOINTS_0") && Attributes.count("WEIGHTS_0")) HasSkin = true;
+		}
 
-				std::vector<std::vector<float>> texcoords;
-				getAccessorData(keyValuePair.second, &texcoords);
+		// only attributes present in any primitive are allocated, primitives without them keep zeros
+		const size_t VertexCount = FirstVertex.back();
+		VertexArrays Arrays;
+		Arrays.Positions.assign(VertexCount, Eigen::Vector3f::Zero());
+		if (HasNormals) Arrays.Normals.assign(VertexCount, Eigen::Vector3f::Zero());
+		if (HasTangents) Arrays.Tangents.assign(VertexCount, Eigen::Vector3f::Zero());
+		if (HasUVWs) Arrays.UVWs.assign(VertexCount, Eigen::Vector3f::Zero());
+		if (HasSkin) {
+			Arrays.Joints.assign(VertexCount, Eigen::Vector4f(-1, -1, -1, -1));
+			Arrays.Weights.assign(VertexCount, Eigen::Vector4f::Zero());
+		}
 
-				for (auto pos : texcoords) {
-					Eigen::Matrix<float, 2, 1> mat;
+		std::vector<std::vector<T3DMesh<float>::Face>> Faces(Primitives.size());
 
-					mat(0) = pos[0];
-					mat(1) = 1.0f - pos[1];
+		parallelForEach(Primitives.size(), [&](size_t i) {
+			const size_t Count = FirstVertex[i + 1] - FirstVertex[i];
+			readAttributes(Primitives[i], FirstVertex[i], Count, &Arrays);
+			readFaces(Primitives[i], FirstVertex[i], Count, &Faces[i]);
+		});
 
-					m_texCoord.push_back(mat);
-				}
+		// materials may write embedded textures, keep them in file order
+		for (size_t i = 0; i < Primitives.size(); ++i) readSubMeshes(Primitives[i], &Faces[i]);
 
-				continue;
+		//set vertex influences and weights for bones
+		for (size_t i = 0; i < Arrays.Joints.size(); i++) {
+			for (int j = 0; j < 4; j++) {
+				int32_t index = (int32_t)Arrays.Joints[i](j);
+				if (index < 0 || Arrays.Weights[i](j) == 0.f)
+					continue;
+				auto pBone = m_pMesh->getBone(index);
+				pBone->VertexInfluences.push_back(i);
+				pBone->VertexWeights.push_back(Arrays.Weights[i](j));
 			}
+		}
 
-			if (keyValuePair.first.find("JOINTS") != std::string::npos) {
-				int n = -1;
-				auto s = keyValuePair.first.substr(7);
-				n = std::stoi(s);
+		m_pMesh->vertices(std::move(Arrays.Positions));
+		if (HasNormals) m_pMesh->normals(std::move(Arrays.Normals));
+		if (HasTangents) m_pMesh->tangents(std::move(Arrays.Tangents));
+		if (HasUVWs) m_pMesh->textureCoordinates(std::move(Arrays.UVWs));
+	}
 
-				//TODO: support multiple joints
-				if (n != 0) continue;
+	void GLTFIO::readAttributes(const Primitive* pPrimitive, const size_t FirstVertex, const size_t VertexCount, VertexArrays* pArrays) const {
+		if (VertexCount == 0) return;
 
-				std::vector<Eigen::Vector4f> accJoints;
-				getAccessorData(keyValuePair.second, &accJoints);
+		for (const auto& keyValuePair : pPrimitive->attributes) {
+			const std::string& Name = keyValuePair.first;
+			const int accessor = keyValuePair.second;
 
-				for (auto j : accJoints) {
-					m_joint.push_back(j);
-				}
+			float* pDst = nullptr;
+			int Components = 3;
 
-				continue;
+			if (Name == "POSITION") pDst = pArrays->Positions[FirstVertex].data();
+			else if (Name == "NORMAL") pDst = pArrays->Normals[FirstVertex].data();
+			else if (Name == "TANGENT") pDst = pArrays->Tangents[FirstVertex].data(); // w (handedness) is dropped
+			//TODO: support multiple textures, joints and weights
+			else if (Name == "TEXCOORD_0") pDst = pArrays->UVWs[FirstVertex].data();
+			else if (Name == "JOINTS_0" && !pArrays->Joints.empty()) {
+				pDst = pArrays->Joints[FirstVertex].data();
+				Components = 4;
 			}
-
-			if (keyValuePair.first.find("WEIGHTS") != std::string::npos) {
-				int n = -1;
-				auto s = keyValuePair.first.substr(8);
-				n = std::stoi(s);
-
-				//TODO: support multiple weights
-				if (n != 0) continue;
-
-				std::vector<Eigen::Vector4f> accWeights;
-				getAccessorData(keyValuePair.second, &accWeights);
-
-				for (auto w : accWeights) {
-					m_weight.push_back(w);
-				}
-
-				continue;
+			else if (Name == "WEIGHTS_0" && !pArrays->Weights.empty()) {
+				pDst = pArrays->Weights[FirstVertex].data();
+				Components = 4;
 			}
+			if (nullptr == pDst) continue;
 
-			if (keyValuePair.first.find("COLOR") != std::string::npos) {
-				int n = -1;
-				auto s = keyValuePair.first.substr(6);
-				n = std::stoi(s);
+			if (accessorView(accessor).Count != VertexCount)
+				throw CForgeExcept("Attribute " + Name + " has a different element count than POSITION");
 
-				//TODO: support multiple colors
-				if (n != 0) continue;
+			decodeAccessor(accessor, pDst, Components, m_model.accessors[accessor].normalized);
 
-				std::vector<Eigen::Vector4f> accColors;
-				getAccessorData(keyValuePair.second, &accColors);
-
-				for (auto c : accColors) {
-					m_color.push_back(c);
-				}
-
-				continue;
+			if (Name == "TEXCOORD_0") {
+				for (size_t i = FirstVertex; i < FirstVertex + VertexCount; ++i) pArrays->UVWs[i].y() = 1.0f - pArrays->UVWs[i].y();
 			}
 		}//for attributes
-
-		//fill up the rest of the attributes with default values
-		for (int i = m_normal.size(); i < m_coord.size(); i++) {
-			Eigen::Vector3f vec(0, 0, 0);
-			m_normal.push_back(vec);
-		}
-		for (int i = m_tangent.size(); i < m_coord.size(); i++) {
-			Eigen::Vector3f vec(0, 0, 0);
-			m_tangent.push_back(vec);
-		}
-		for (int i = m_texCoord.size(); i < m_coord.size(); i++) {
-			Eigen::Vector2f vec(0, 0);
-			m_texCoord.push_back(vec);
-		}
-		for (int i = m_joint.size(); i < m_coord.size(); i++) {
-			Eigen::Vector4f vec(-1, -1, -1, -1);
-			m_joint.push_back(vec);
-		}
-		for (int i = m_weight.size(); i < m_coord.size(); i++) {
-			Eigen::Vector4f vec(0, 0, 0, 0);
-			m_weight.push_back(vec);
-		}
-		for (int i = m_color.size(); i < m_coord.size(); i++) {
-			Eigen::Vector4f vec(0, 0, 0, 0);
-			m_color.push_back(vec);
-		}
-
-		//set vertex influences and weights for bones
-		for (int i = 0; i < m_joint.size(); i++) {
-			for (int j = 0; j < 4; j++) {
-				int32_t index = (int32_t)m_joint[i](j);
-				if (index < 0 || m_weight[i](j) == 0.f)
-					continue;
-				auto pBone = m_pMesh->getBone(index);
-				pBone->VertexInfluences.push_back(i);
-				pBone->VertexWeights.push_back(m_weight[i](j));
-			}
-		}
-
-		m_offsets.push_back(counter);
 	}
 
-	T3DMesh<float>::Submesh* GLTFIO::readSubMeshes(Primitive* pPrimitive) {
+	T3DMesh<float>::Submesh* GLTFIO::readSubMeshes(const Primitive* pPrimitive, std::vector<T3DMesh<float>::Face>* pFaces) {
 		T3DMesh<float>::Submesh* pSubMesh = new T3DMesh<float>::Submesh;
 
-		std::vector<T3DMesh<float>::Face> faces;
-		readFaces(pPrimitive, &faces);
-		pSubMesh->Faces = faces;
+		pSubMesh->Faces = std::move(*pFaces);
 
 		T3DMesh<float>::Material* pMaterial = new T3DMesh<float>::Material;
 
@@ -276,54 +332,42 @@ namespace CForge {
 		return pSubMesh;
 	}
 
-	void GLTFIO::readFaces(Primitive* pPrimitive, std::vector<T3DMesh<float>::Face>* faces) {
-		int accessorIndex = pPrimitive->indices;
+	void GLTFIO::readFaces(const Primitive* pPrimitive, const size_t FirstVertex, const size_t VertexCount, std::vector<T3DMesh<float>::Face>* pFaces) const {
+		std::vector<int32_t> indices;
+		if (pPrimitive->indices >= 0) {
+			getAccessorDataScalar(pPrimitive->indices, &indices);
+		}
+		else {
+			// non indexed geometry uses the vertices in order
+			indices.resize(VertexCount);
+			for (size_t i = 0; i < VertexCount; ++i) indices[i] = int32_t(i);
+		}
 
-		std::vector<int> indices;
-		getAccessorDataScalar(accessorIndex, &indices);
+		for (int32_t i : indices) {
+			if (i < 0 || size_t(i) >= VertexCount) throw CForgeExcept("Vertex index outside of primitive");
+		}
 
-		int offset = 0;
-		for (int i = 0; i < m_offsets.size() - 1; i++) offset += m_offsets[i];
+		auto addFace = [&](int32_t a, int32_t b, int32_t c) {
+			T3DMesh<float>::Face face;
+			face.Vertices[0] = (int32_t)(FirstVertex + a);
+			face.Vertices[1] = (int32_t)(FirstVertex + b);
+			face.Vertices[2] = (int32_t)(FirstVertex + c);
+			pFaces->push_back(face);
+		};
 
 		if (pPrimitive->mode == TINYGLTF_MODE_TRIANGLES) {
-			for (int i = 0; i < indices.size(); i += 3) {
-				T3DMesh<float>::Face face;
-
-				face.Vertices[0] = (int32_t)(offset + indices[i]);
-				face.Vertices[1] = (int32_t)(offset + indices[i + 1]);
-				face.Vertices[2] = (int32_t)(offset + indices[i + 2]);
-
-				faces->push_back(face);
-			}
-
+			pFaces->reserve(indices.size() / 3);
+			for (size_t i = 0; i + 2 < indices.size(); i += 3) addFace(indices[i], indices[i + 1], indices[i + 2]);
 			return;
 		}
 
 		if (pPrimitive->mode == TINYGLTF_MODE_TRIANGLE_STRIP) {
-			for (int i = 0; i < indices.size(); i++) {
-				T3DMesh<float>::Face face;
-
-				face.Vertices[0] = (int32_t)(offset + indices[i]);
-				face.Vertices[1] = (int32_t)(offset + indices[i + (1 + i % 2)]);
-				face.Vertices[2] = (int32_t)(offset + indices[i + (2 - i % 2)]);
-
-				faces->push_back(face);
-			}
-
+			for (size_t i = 0; i + 2 < indices.size(); i++) addFace(indices[i], indices[i + (1 + i % 2)], indices[i + (2 - i % 2)]);
 			return;
 		}
 
 		if (pPrimitive->mode == TINYGLTF_MODE_TRIANGLE_FAN) {
-			for (int i = 0; i < indices.size(); i += 3) {
-				T3DMesh<float>::Face face;
-
-				face.Vertices[0] = (int32_t)(offset + indices[i + 1]);
-				face.Vertices[1] = (int32_t)(offset + indices[i + 2]);
-				face.Vertices[2] = (int32_t)(offset + indices[0]);
-
-				faces->push_back(face);
-			}
-
+			for (size_t i = 0; i + 2 < indices.size(); i++) addFace(indices[i + 1], indices[i + 2], indices[0]);
 			return;
 		}
 	}
@@ -390,200 +434,220 @@ namespace CForge {
 	}
 
 	void GLTFIO::readSkeletalAnimations() {
+		std::vector<T3DMesh<float>::SkeletalAnimation*> Animations(m_model.animations.size(), nullptr);
+		std::vector<int32_t> KeyframeCounts(m_model.animations.size(), 0);
+
+		try {
+			parallelForEach(m_model.animations.size(), [&](size_t i) {
+				Animations[i] = readSkeletalAnimation(m_model.animations[i], &KeyframeCounts[i]);
+			});
+		}
+		catch (...) {
+			for (auto pAnim : Animations) {
+				if (nullptr == pAnim) continue;
+				for (auto pKF : pAnim->Keyframes) delete pKF;
+				delete pAnim;
+			}
+			throw;
+		}
+
+		// keyframe IDs are numbered across all animations in file order
+		int32_t id_counter = 0;
+		for (size_t i = 0; i < Animations.size(); ++i) {
+			if (nullptr != Animations[i]) {
+				for (auto pKF : Animations[i]->Keyframes) pKF->ID += id_counter;
+				m_pMesh->addSkeletalAnimation(Animations[i], false);
+			}
+			id_counter += KeyframeCounts[i];
+		}
+	}
+
+	T3DMesh<float>::SkeletalAnimation* GLTFIO::readSkeletalAnimation(const Animation& animation, int32_t* pKeyframeCount) const {
 		T3DMesh<float>::SkeletalAnimation* pAnim;
 
 		int id_counter = 0;
 
-		for (Animation animation : m_model.animations) {
-			std::vector<T3DMesh<float>::BoneKeyframes*> keyframes;
-			std::vector<int> inputAccessors;
+		std::vector<T3DMesh<float>::BoneKeyframes*> keyframes;
+		std::vector<int> inputAccessors;
 
-			float duration = -1;
+		float duration = -1;
 
-			bool pure_morph_target_animation = true;
+		bool pure_morph_target_animation = true;
 
-			for (AnimationChannel channel : animation.channels) {
-				T3DMesh<float>::BoneKeyframes* pBoneKF = nullptr;
-				int input = animation.samplers[channel.sampler].input;
+		for (const AnimationChannel& channel : animation.channels) {
+			T3DMesh<float>::BoneKeyframes* pBoneKF = nullptr;
+			int input = animation.samplers[channel.sampler].input;
 
-				//A new BoneKeyFrames object is needed for every BoneID and Timestamps vector.
-				for (int i = 0; i < keyframes.size(); i++) {
-					if (keyframes[i]->BoneID == channel.target_node) { // && inputAccessors[i] == input) { //TODO no correlation?
-						pBoneKF = keyframes[i];
-						break;
-					}
+			//A new BoneKeyFrames object is needed for every BoneID and Timestamps vector.
+			for (int i = 0; i < keyframes.size(); i++) {
+				if (keyframes[i]->BoneID == channel.target_node) { // && inputAccessors[i] == input) { //TODO no correlation?
+					pBoneKF = keyframes[i];
+					break;
 				}
+			}
 
-				if (pBoneKF == nullptr) {
-					pBoneKF = new T3DMesh<float>::BoneKeyframes;
-					pBoneKF->BoneID = channel.target_node; //TODO is this correct?
-					pBoneKF->BoneName = m_model.nodes[channel.target_node].name;
-					pBoneKF->ID = id_counter++;
-					keyframes.push_back(pBoneKF);
-					inputAccessors.push_back(input);
-				}
+			if (pBoneKF == nullptr) {
+				pBoneKF = new T3DMesh<float>::BoneKeyframes;
+				pBoneKF->BoneID = channel.target_node; //TODO is this correct?
+				pBoneKF->BoneName = m_model.nodes[channel.target_node].name;
+				pBoneKF->ID = id_counter++;
+				keyframes.push_back(pBoneKF);
+				inputAccessors.push_back(input);
+			}
 
-				std::vector<float> timeValues;
-				getAccessorDataScalarFloat(input, &timeValues);
-				pBoneKF->Timestamps = timeValues;
+			getAccessorDataScalarFloat(input, &pBoneKF->Timestamps);
 
-				for (auto t : timeValues) duration = std::max(duration, t);
+			for (auto t : pBoneKF->Timestamps) duration = std::max(duration, t);
 
-				if (channel.target_path == "translation") {
-					std::vector<Eigen::Vector3f> translations;
-					int output = animation.samplers[channel.sampler].output;
+			if (channel.target_path == "translation") {
+				int output = animation.samplers[channel.sampler].output;
 
-					getAccessorData(output, &translations);
+				getAccessorData(output, &pBoneKF->Positions);
 
-					pBoneKF->Positions = translations;
+				pure_morph_target_animation = false;
+			}
+			else if (channel.target_path == "rotation") {
+				int output = animation.samplers[channel.sampler].output;
 
-					pure_morph_target_animation = false;
-				}
-				else if (channel.target_path == "rotation") {
-					std::vector<Eigen::Quaternionf> rotations;
-					int output = animation.samplers[channel.sampler].output;
+				getAccessorData(output, &pBoneKF->Rotations);
 
-					getAccessorData(output, &rotations);
+				pure_morph_target_animation = false;
+			}
+			else if (channel.target_path == "scale") {
+				int output = animation.samplers[channel.sampler].output;
 
-					pBoneKF->Rotations = rotations;
+				getAccessorData(output, &pBoneKF->Scalings);
 
-					pure_morph_target_animation = false;
-				}
-				else if (channel.target_path == "scale") {
-					std::vector<Eigen::Vector3f> scalings;
-					int output = animation.samplers[channel.sampler].output;
+				pure_morph_target_animation = false;
+			}
+			/*
+			"weights" as animation channel target is ignored,
+			because cross forge only stores the morph targets without animated weights.
+			*/
+		}
 
-					getAccessorData(output, &scalings);
+		*pKeyframeCount = id_counter;
 
-					pBoneKF->Scalings = scalings;
+		if (pure_morph_target_animation) {
+			for (auto pKF : keyframes) delete pKF;
+			return nullptr;
+		}
 
-					pure_morph_target_animation = false;
-				}
-				/*
-				"weights" as animation channel target is ignored,
-				because cross forge only stores the morph targets without animated weights.
-				*/
-			}
 
-			if (pure_morph_target_animation) continue;
-
-	
-			//TODO better fix
-			// CF expects length of Position Rotation Scale and Time to be the same
-			auto lerp3f = [](Eigen::Vector3f a, Eigen::Vector3f b, float p) {
-				Eigen::Vector3f r;
-				for (uint32_t i=0;i<3;++i)
-					r[i] = a[i]+(b[i]-a[i])*p;
-				return r;
-			};
-			for (T3DMesh<float>::BoneKeyframes* kf : keyframes) {
-				int len = 0;
-				len = std::max(len,(int) kf->Positions.size());
-				len = std::max(len,(int) kf->Rotations.size());
-				len = std::max(len,(int) kf->Scalings.size());
-				len = std::max(len,(int) kf->Timestamps.size());
-				if (kf->Positions.size() == 0) {
-					for (uint32_t i=0;i<len;++i)
-						kf->Positions.emplace_back();
-				} else if (kf->Positions.size() < len) {
-					std::vector<Eigen::Vector3f> nv;
-					for (uint32_t i = 0; i < len; ++i) {
-						// corresponding index on old range
-						float r = (float)i/len;
-						float or = r*kf->Positions.size();
-						int idxf = (int) std::floor(or);
-						int idxc = (int) std::ceil(or);
-						float itp = (or-idxf)/(idxc-idxf); // prog
-						if (idxc < kf->Positions.size() && idxc != idxf)
-							nv.push_back(lerp3f(kf->Positions[idxf],kf->Positions[idxc],itp));
-						else
-							nv.push_back(kf->Positions[idxf]);
-					}
-					kf->Positions = nv;
+		//TODO better fix
+		// CF expects length of Position Rotation Scale and Time to be the same
+		auto lerp3f = [](Eigen::Vector3f a, Eigen::Vector3f b, float p) {
+			Eigen::Vector3f r;
+			for (uint32_t i=0;i<3;++i)
+				r[i] = a[i]+(b[i]-a[i])*p;
+			return r;
+		};
+		for (T3DMesh<float>::BoneKeyframes* kf : keyframes) {
+			int len = 0;
+			len = std::max(len,(int) kf->Positions.size());
+			len = std::max(len,(int) kf->Rotations.size());
+			len = std::max(len,(int) kf->Scalings.size());
+			len = std::max(len,(int) kf->Timestamps.size());
+			if (kf->Positions.size() == 0) {
+				for (uint32_t i=0;i<len;++i)
+					kf->Positions.emplace_back();
+			} else if (kf->Positions.size() < len) {
+				std::vector<Eigen::Vector3f> nv;
+				for (uint32_t i = 0; i < len; ++i) {
+					// corresponding index on old range
+					float r = (float)i/len;
+					float or = r*kf->Positions.size();
+					int idxf = (int) std::floor(or);
+					int idxc = (int) std::ceil(or);
+					float itp = (or-idxf)/(idxc-idxf); // prog
+					if (idxc < kf->Positions.size() && idxc != idxf)
+						nv.push_back(lerp3f(kf->Positions[idxf],kf->Positions[idxc],itp));
+					else
+						nv.push_back(kf->Positions[idxf]);
 				}
-				if (kf->Rotations.size() == 0) {
-					for (uint32_t i=0;i<len;++i)
-						kf->Rotations.emplace_back();
-				} else if (kf->Rotations.size() < len) {
-					std::vector<Eigen::Quaternionf> nv;
-					for (uint32_t i = 0; i < len; ++i) {
-						// corresponding index on old range
-						float r = (float)i/len;
-						float or = r*kf->Rotations.size();
-						int idxf = (int) std::floor(or);
-						int idxc = (int) std::ceil(or);
-						float itp = (or-idxf)/(idxc-idxf); // prog
-						if (idxc < kf->Rotations.size() && idxc != idxf)
-							nv.push_back((kf->Rotations[idxf].slerp(itp,kf->Rotations[idxc])).normalized());
-						else
-							nv.push_back(kf->Rotations[idxf]);
-					}
-					kf->Rotations = nv;
+				kf->Positions = nv;
+			}
+			if (kf->Rotations.size() == 0) {
+				for (uint32_t i=0;i<len;++i)
+					kf->Rotations.emplace_back();
+			} else if (kf->Rotations.size() < len) {
+				std::vector<Eigen::Quaternionf> nv;
+				for (uint32_t i = 0; i < len; ++i) {
+					// corresponding index on old range
+					float r = (float)i/len;
+					float or = r*kf->Rotations.size();
+					int idxf = (int) std::floor(or);
+					int idxc = (int) std::ceil(or);
+					float itp = (or-idxf)/(idxc-idxf); // prog
+					if (idxc < kf->Rotations.size() && idxc != idxf)
+						nv.push_back((kf->Rotations[idxf].slerp(itp,kf->Rotations[idxc])).normalized());
+					else
+						nv.push_back(kf->Rotations[idxf]);
 				}
-				if (kf->Scalings.size() == 0) {
-					for (uint32_t i=0;i<len;++i)
-						kf->Scalings.emplace_back();
-				} else if (kf->Scalings.size() < len) {
-					std::vector<Eigen::Vector3f> nv;
-					for (uint32_t i = 0; i < len; ++i) {
-						// corresponding index on old range
-						float r = (float)i/len;
-						float or = r*kf->Scalings.size();
-						int idxf = (int) std::floor(or);
-						int idxc = (int) std::ceil(or);
-						float itp = (or-idxf)/(idxc-idxf); // prog
-						if (idxc < kf->Scalings.size() && idxc != idxf)
-							nv.push_back(lerp3f(kf->Scalings[idxf],kf->Scalings[idxc],itp));
-						else
-							nv.push_back(kf->Scalings[idxf]);
-					}
-					kf->Scalings = nv;
+				kf->Rotations = nv;
+			}
+			if (kf->Scalings.size() == 0) {
+				for (uint32_t i=0;i<len;++i)
+					kf->Scalings.emplace_back();
+			} else if (kf->Scalings.size() < len) {
+				std::vector<Eigen::Vector3f> nv;
+				for (uint32_t i = 0; i < len; ++i) {
+					// corresponding index on old range
+					float r = (float)i/len;
+					float or = r*kf->Scalings.size();
+					int idxf = (int) std::floor(or);
+					int idxc = (int) std::ceil(or);
+					float itp = (or-idxf)/(idxc-idxf); // prog
+					if (idxc < kf->Scalings.size() && idxc != idxf)
+						nv.push_back(lerp3f(kf->Scalings[idxf],kf->Scalings[idxc],itp));
+					else
+						nv.push_back(kf->Scalings[idxf]);
 				}
-				if (kf->Timestamps.size() == 0) {
-					for (uint32_t i=0;i<len;++i)
-						kf->Timestamps.emplace_back();
-				} else if (kf->Timestamps.size() < len) {
-					std::vector<float> nv;
-					for (uint32_t i = 0; i < len; ++i) {
-						// corresponding index on old range
-						float r = (float)i/len;
-						float or = r*kf->Timestamps.size();
-						int idxf = (int) std::floor(or);
-						int idxc = (int) std::ceil(or);
-						float itp = (or-idxf)/(idxc-idxf); // prog
-						if (idxc < kf->Timestamps.size() && idxc != idxf)
-							nv.push_back(CForgeMath::lerp(kf->Timestamps[idxf],kf->Timestamps[idxc],itp));
-						else
-							nv.push_back(kf->Timestamps[idxf]);
-					}
-					kf->Timestamps = nv;
+				kf->Scalings = nv;
+			}
+			if (kf->Timestamps.size() == 0) {
+				for (uint32_t i=0;i<len;++i)
+					kf->Timestamps.emplace_back();
+			} else if (kf->Timestamps.size() < len) {
+				std::vector<float> nv;
+				for (uint32_t i = 0; i < len; ++i) {
+					// corresponding index on old range
+					float r = (float)i/len;
+					float or = r*kf->Timestamps.size();
+					int idxf = (int) std::floor(or);
+					int idxc = (int) std::ceil(or);
+					float itp = (or-idxf)/(idxc-idxf); // prog
+					if (idxc < kf->Timestamps.size() && idxc != idxf)
+						nv.push_back(CForgeMath::lerp(kf->Timestamps[idxf],kf->Timestamps[idxc],itp));
+					else
+						nv.push_back(kf->Timestamps[idxf]);
 				}
+				kf->Timestamps = nv;
 			}
-			//END //TODO better fix
+		}
+		//END //TODO better fix
 
-			pAnim = new T3DMesh<float>::SkeletalAnimation;
+		pAnim = new T3DMesh<float>::SkeletalAnimation;
 
-			pAnim->Name = animation.name;
-			pAnim->Keyframes = keyframes;
-			pAnim->Duration = duration;
-			pAnim->SamplesPerSecond = 1.0;
+		pAnim->Name = animation.name;
+		pAnim->Keyframes = keyframes;
+		pAnim->Duration = duration;
+		pAnim->SamplesPerSecond = 1.0;
 
-			m_pMesh->addSkeletalAnimation(pAnim, false);
-		}
+		return pAnim;
 	}
 
 	void GLTFIO::readSkinningData() {
-		std::vector<T3DMesh<float>::Bone*>* pBones = new std::vector<T3DMesh<float>::Bone*>;
+		std::vector<T3DMesh<float>::Bone*> Bones;
+		std::vector<T3DMesh<float>::Bone*>* pBones = &Bones;
 		std::map<int, T3DMesh<float>::Bone*> bones_by_indices;
 
-		for (Skin skin : m_model.skins) {
-			std::vector<std::vector<float>> inverseBindMatrices;
-
-			getAccessorData(skin.inverseBindMatrices, &inverseBindMatrices);
-
+		for (const Skin& skin : m_model.skins) {
 			std::vector<Eigen::Matrix4f> offsetMatrices;
 
-			toMat4f(&inverseBindMatrices, &offsetMatrices);
+			if (skin.inverseBindMatrices >= 0) getAccessorData(skin.inverseBindMatrices, &offsetMatrices);
+			// missing matrices are identity
+			offsetMatrices.resize(std::max(offsetMatrices.size(), skin.joints.size()), Eigen::Matrix4f::Identity());
 
 			int counter = 0;
 
@@ -602,7 +666,7 @@ namespace CForge {
 			//link bones together
 			for (int i = 0; i < pBones->size(); i++) {
 				auto pBone = (*pBones)[i];
-				auto boneNode = m_model.nodes[pBone->ID];
+				const Node& boneNode = m_model.nodes[pBone->ID];
 
 				for (int32_t c : boneNode.children) {
 					auto childBone = bones_by_indices[c];
@@ -623,54 +687,73 @@ namespace CForge {
 	}
 
 	void GLTFIO::readMorphTargets() {
-		int offset_index = 0;
-
-		for (auto m : m_model.meshes) {
-			for (auto p : m.primitives) {
-				for (auto t : p.targets) {
-					T3DMesh<float>::MorphTarget* pMorphTarget = new T3DMesh<float>::MorphTarget;
-
-					pMorphTarget->ID = offset_index;
-
-					int32_t last_index_buff_view = -1;
+		struct TargetRef {
+			const std::map<std::string, int>* pTarget;
+			int32_t ID;
+			int32_t FirstVertex;
+		};
+		std::vector<TargetRef> Targets;
 
-					int32_t index_offset = 0;
-					for (int i = 0; i < offset_index; i++) index_offset += m_offsets[i];
+		int offset_index = 0;
+		int32_t index_offset = 0;
 
-					for (auto keyValuePair : t) {
-						std::vector<std::vector<float>> data;
-						std::vector<Eigen::Vector3f> attribute_offsets;
-						std::vector<int32_t> indices;
+		for (const Mesh& m : m_model.meshes) {
+			for (const Primitive& p : m.primitives) {
+				for (const auto& t : p.targets) Targets.push_back({ &t, offset_index, index_offset });
 
-						int32_t index_buff_view = getSparseAccessorData(keyValuePair.second, &indices, &data);
+				index_offset += m_offsets[offset_index];
+				offset_index += 1;
+			}
+		}
 
-						//Accessor is not sparse
-						if (index_buff_view == -1) {
-							getAccessorData(keyValuePair.second, &data);
-							for (int i = 0; i < data.size(); i++) indices.push_back(i);
-						}
+		std::vector<T3DMesh<float>::MorphTarget*> MorphTargets(Targets.size(), nullptr);
+		try {
+			parallelForEach(Targets.size(), [&](size_t i) {
+				MorphTargets[i] = readMorphTarget(*Targets[i].pTarget, Targets[i].FirstVertex);
+				MorphTargets[i]->ID = Targets[i].ID;
+			});
+		}
+		catch (...) {
+			for (auto pMorphTarget : MorphTargets) delete pMorphTarget;
+			throw;
+		}
 
-						for (int i = 0; i < indices.size(); i++) indices[i] += index_offset;
+		for (auto pMorphTarget : MorphTargets) {
+			if (pMorphTarget->VertexIDs.size()) m_pMesh->addMorphTarget(pMorphTarget, false);
+			else delete pMorphTarget;
+		}
+	}
 
-						toVec3f(&data, &attribute_offsets);
+	T3DMesh<float>::MorphTarget* GLTFIO::readMorphTarget(const std::map<std::string, int>& target, const int32_t FirstVertex) const {
+		T3DMesh<float>::MorphTarget* pMorphTarget = new T3DMesh<float>::MorphTarget;
 
-						if (keyValuePair.first == "POSITION") {
-							pMorphTarget->VertexOffsets = attribute_offsets;
-							pMorphTarget->VertexIDs = indices;
-						}
-						else if (keyValuePair.first == "NORMAL") {
-							pMorphTarget->NormalOffsets = attribute_offsets;
-							pMorphTarget->VertexIDs = indices;
+		try {
+			for (const auto& keyValuePair : target) {
+				if (keyValuePair.first != "POSITION" && keyValuePair.first != "NORMAL") continue;
 
-						}
-					}
+				std::vector<Eigen::Vector3f> attribute_offsets;
+				std::vector<int32_t> indices;
 
-					if (pMorphTarget->VertexIDs.size()) m_pMesh->addMorphTarget(pMorphTarget, false);
+				//Accessor is not sparse
+				if (!getSparseAccessorData(keyValuePair.second, &indices, &attribute_offsets)) {
+					getAccessorData(keyValuePair.second, &attribute_offsets);
+					indices.resize(attribute_offsets.size());
+					for (int i = 0; i < indices.size(); i++) indices[i] = i;
 				}
 
-				offset_index += 1;
+				for (int i = 0; i < indices.size(); i++) indices[i] += FirstVertex;
+
+				if (keyValuePair.first == "POSITION") pMorphTarget->VertexOffsets = std::move(attribute_offsets);
+				else pMorphTarget->NormalOffsets = std::move(attribute_offsets);
+				pMorphTarget->VertexIDs = std::move(indices);
 			}
 		}
+		catch (...) {
+			delete pMorphTarget;
+			throw;
+		}
+
+		return pMorphTarget;
 	}
 
 	/*
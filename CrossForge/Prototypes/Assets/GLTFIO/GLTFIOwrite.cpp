@@ -16,15 +16,163 @@
 #endif
 
 #include "Prototypes/SkeletonConvertion.hpp"
+#include <crossforge/Core/Parallel.hpp>
 
 #include <iostream>
 #include <algorithm>
 #include <fstream>
+#include <memory>
+#include <sstream>
 
 using namespace tinygltf;
 
 namespace CForge {
 
+namespace {
+	// payloads are encoded in pieces of about this size, so payloads of very different size spread over the threads
+	const size_t PieceSize = 1 << 16;
+
+	struct PayloadPiece {
+		size_t Payload;
+		size_t First;
+		size_t Count;
+	};
+}
+
+#pragma region accessor_write
+
+	int GLTFIO::addBufferView(BinPayload Payload) {
+		if (m_bufferSizes.size() <= Payload.Buffer) m_bufferSizes.resize(Payload.Buffer + 1, 0);
+
+		// 4 byte alignment suits every component type
+		Payload.Offset = (m_bufferSizes[Payload.Buffer] + 3) & ~size_t(3);
+		m_bufferSizes[Payload.Buffer] = Payload.Offset + Payload.ElementSize * Payload.Count;
+
+		BufferView bufferView;
+		bufferView.buffer = Payload.Buffer;
+		bufferView.byteOffset = Payload.Offset;
+		bufferView.byteLength = Payload.ElementSize * Payload.Count;
+		bufferView.byteStride = 0;
+		m_model.bufferViews.push_back(bufferView);
+
+		m_payloads.push_back(std::move(Payload));
+
+		return m_model.bufferViews.size() - 1;
+	}
+
+	void GLTFIO::finalizeAccessors() {
+		// every job writes min and max of its own accessor
+		parallelForEach(m_minMaxJobs.size(), [&](size_t i) { m_minMaxJobs[i](); });
+		m_minMaxJobs.clear();
+	}
+
+	void GLTFIO::encodePayloads() {
+		for (size_t i = 0; i < m_bufferSizes.size(); ++i) m_model.buffers[i].data.assign(m_bufferSizes[i], 0);
+
+		std::vector<PayloadPiece> Pieces;
+		for (size_t i = 0; i < m_payloads.size(); ++i) {
+			const size_t PieceElements = std::max(size_t(1), PieceSize / std::max(size_t(1), m_payloads[i].ElementSize));
+			for (size_t First = 0; First < m_payloads[i].Count; First += PieceElements) {
+				Pieces.push_back({ i, First, std::min(PieceElements, m_payloads[i].Count - First) });
+			}
+		}
+
+		parallelForEach(Pieces.size(), [&](size_t i) {
+			const BinPayload& Payload = m_payloads[Pieces[i].Payload];
+			unsigned char* pDst = m_model.buffers[Payload.Buffer].data.data() + Payload.Offset + Pieces[i].First * Payload.ElementSize;
+			Payload.Encode(pDst, Pieces[i].First, Pieces[i].Count);
+		});
+	}
+
+	void GLTFIO::writeGLB(const std::string Filepath) {
+		const size_t BinLength = m_bufferSizes.empty() ? 0 : m_bufferSizes[0];
+		const size_t BinChunkLength = (BinLength + 3) & ~size_t(3);
+
+		// The buffer data is never materialized. The model is serialized without buffers
+		// and the buffer of the BIN chunk is added to the JSON text.
+		std::vector<Buffer> Buffers;
+		std::swap(Buffers, m_model.buffers);
+		std::stringstream JsonStream;
+		TinyGLTF writer;
+		writer.WriteGltfSceneToStream(&m_model, JsonStream, false, false);
+		std::swap(Buffers, m_model.buffers);
+
+		std::string Json = JsonStream.str();
+		const size_t JsonEnd = Json.find_last_of('}');
+		if (JsonEnd == std::string::npos) throw CForgeExcept("Failed to serialize the glTF JSON of " + Filepath);
+		Json.resize(JsonEnd);
+		if (BinLength > 0) Json += ",\"buffers\":[{\"byteLength\":" + std::to_string(BinLength) + "}]";
+		Json += "}";
+		while (Json.size() % 4) Json.push_back(' ');
+
+		const size_t FileLength = 12 + 8 + Json.size() + ((BinLength > 0) ? 8 + BinChunkLength : 0);
+		if (FileLength > std::numeric_limits<uint32_t>::max()) throw CForgeExcept("Data of " + Filepath + " exceeds the 4 GB limit of glb files");
+
+		std::ofstream out(Filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!out) throw CForgeExcept("Failed to open " + Filepath + " for writing");
+
+		auto writeUInt32 = [&out](const uint32_t Value) { out.write((const char*)&Value, sizeof(Value)); };
+
+		writeUInt32(0x46546C67); // "glTF"
+		writeUInt32(2);
+		writeUInt32(uint32_t(FileLength));
+		writeUInt32(uint32_t(Json.size()));
+		writeUInt32(0x4E4F534A); // "JSON"
+		out.write(Json.data(), Json.size());
+
+		if (BinLength > 0) {
+			writeUInt32(uint32_t(BinChunkLength));
+			writeUInt32(0x004E4942); // "BIN"
+
+			// room for the alignment padding behind the last piece
+			std::vector<unsigned char> Chunk(m_GLBChunkSize + 4);
+
+			size_t Payload = 0;
+			size_t Element = 0;
+			size_t ChunkBegin = 0;
+
+			while (ChunkBegin < BinChunkLength) {
+				// collect pieces until the chunk is full, payloads are ordered by offset
+				std::vector<PayloadPiece> Pieces;
+				size_t ChunkEnd = ChunkBegin;
+
+				while (Payload < m_payloads.size()) {
+					const BinPayload& P = m_payloads[Payload];
+					if (P.Buffer != 0 || Element == P.Count) {
+						Payload++;
+						Element = 0;
+						continue;
+					}
+
+					const size_t Begin = P.Offset + Element * P.ElementSize;
+					if (Begin + P.ElementSize > ChunkBegin + m_GLBChunkSize) break;
+
+					const size_t PieceElements = std::max(size_t(1), PieceSize / P.ElementSize);
+					const size_t Count = std::min({ P.Count - Element, PieceElements, (ChunkBegin + m_GLBChunkSize - Begin) / P.ElementSize });
+
+					Pieces.push_back({ Payload, Element, Count });
+					Element += Count;
+					ChunkEnd = Begin + Count * P.ElementSize;
+				}
+				if (Payload == m_payloads.size()) ChunkEnd = BinChunkLength;
+
+				std::memset(Chunk.data(), 0, ChunkEnd - ChunkBegin);
+
+				parallelForEach(Pieces.size(), [&](size_t i) {
+					const BinPayload& P = m_payloads[Pieces[i].Payload];
+					P.Encode(Chunk.data() + P.Offset + Pieces[i].First * P.ElementSize - ChunkBegin, Pieces[i].First, Pieces[i].Count);
+				});
+
+				out.write((const char*)Chunk.data(), ChunkEnd - ChunkBegin);
+				ChunkBegin = ChunkEnd;
+			}
+		}
+
+		if (!out) throw CForgeExcept("Failed to write " + Filepath);
+	}
+
+#pragma endregion
+
 #pragma region write
 
 	int GLTFIO::writePrimitive(const T3DMesh<float>::Submesh* pSubmesh) {
@@ -38,8 +186,8 @@ namespace CForge {
 
 		m_model.meshes[meshIndex].primitives.push_back(primitive);
 
-		std::pair<int, int> minmax = prepareAttributeArrays(pSubmesh);
-		writeAttributes();
+		std::pair<int, int> minmax = writeIndices(pSubmesh);
+		writeAttributes(minmax);
 		writeMaterial(pSubmesh);
 		writeMorphTargets(minmax);
 
@@ -48,200 +196,103 @@ namespace CForge {
 		return meshIndex;
 	}//writePrimitive
 
-	std::pair<int, int> GLTFIO::prepareAttributeArrays(const T3DMesh<float>::Submesh* pSubmesh) {
-		m_coord.clear();
-		m_normal.clear();
-		m_tangent.clear();
-		m_texCoord.clear();
-		m_color.clear();
-		m_joint.clear();
-		m_weight.clear();
-
+	std::pair<int, int> GLTFIO::writeIndices(const T3DMesh<float>::Submesh* pSubmesh) {
 		int32_t min = -1;
 		int32_t max = -1;
 
-		std::vector<int32_t> indices;
-
-		bool values_found = false;
-
-		for (int i = 0; i < pSubmesh->Faces.size(); i++) {
-			auto face = pSubmesh->Faces[i];
-
+		for (const auto& face : pSubmesh->Faces) {
 			for (int j = 0; j < 3; j++) {
-				int32_t index = face.Vertices[j];
-
-				if (index < 0) index = 0;
+				int32_t index = std::max(face.Vertices[j], 0);
 
 				if (min == -1 || index < min)
 					min = index;
 
 				if (max == -1 || index > max)
 					max = index;
-
-				indices.push_back(index);
-			}
-		}
-
-		std::pair<int, int> minmax(min, max);
-
-		for (int i = 0; i < indices.size(); i++) {
-
-			auto current_index = indices[i];
-
-			// fill up to index
-			for (int k = m_coord.size(); k <= current_index - min; k++) {
-				Eigen::Vector3f vec3(0, 0, 0);
-				m_coord.push_back(vec3);
-			}
-			Eigen::Vector3f pos = m_pCMesh->vertex(current_index);
-
-			m_coord[current_index - min] = pos;
-
-			if (m_pCMesh->normalCount() > 0) {
-				// fill up to index
-				for (int k = m_normal.size(); k <= current_index - min; k++) {
-					Eigen::Vector3f vec3(0, 0, 0);
-					m_normal.push_back(vec3);
-				}
-				Eigen::Vector3f norm = m_pCMesh->normal(current_index).normalized();
-				m_normal[current_index - min] = norm;
-			}
-
-			if (m_pCMesh->tangentCount() > 0) {
-				// fill up to index
-				for (int k = m_tangent.size(); k <= current_index - min; k++) {
-					Eigen::Vector3f vec3(0, 0, 0);
-					m_tangent.push_back(vec3);
-				}
-				Eigen::Vector3f tan = m_pCMesh->tangent(current_index);
-				m_tangent[current_index - min] = tan;
-			}
-
-			if (m_pCMesh->textureCoordinatesCount() > 0) {
-				// fill up to index
-				for (int k = m_texCoord.size(); k <= current_index - min; k++) {
-					Eigen::Vector2f vec2(0, 0);
-					m_texCoord.push_back(vec2);
-				}
-
-				if (current_index >= m_pCMesh->textureCoordinatesCount()) continue;
-
-				Eigen::Vector3f tex = m_pCMesh->textureCoordinate(current_index);
-				tex(1) = 1.0f - tex(1);
-				m_texCoord[current_index - min](0) = tex(0);
-				m_texCoord[current_index - min](1) = tex(1);
 			}
-
-			if (m_pCMesh->colorCount() > 0) {
-				// fill up to index
-				for (int k = m_color.size(); k <= current_index - min; k++) {
-					Eigen::Vector4f vec4(0, 0, 0, 0);
-					m_color.push_back(vec4);
-				}
-				Eigen::Vector3f meshCol = m_pCMesh->color(current_index);
-				Eigen::Vector4f col;
-				col(0) = meshCol(0);
-				col(1) = meshCol(1);
-				col(2) = meshCol(2);
-				col(3) = meshCol(3);
-				m_color[current_index - min] = col;
-			}
-
-			indices[i] -= min;
 		}
 
-		writeAccessorDataScalar(m_model.buffers.size() - 1, &indices);
 		int meshIndex = m_model.meshes.size() - 1;
-		m_model.meshes[meshIndex].primitives[0].indices = m_model.accessors.size() - 1;
-
-		std::cout << "m_coord " << m_coord.size() << std::endl;
-		std::cout << "m_normal " << m_normal.size() << std::endl;
-		std::cout << "m_tangent " << m_tangent.size() << std::endl;
-		std::cout << "m_texCoord " << m_texCoord.size() << std::endl;
-		std::cout << "m_color " << m_color.size() << std::endl;
-		std::cout << "m_joint " << m_joint.size() << std::endl;
-		std::cout << "m_weight " << m_weight.size() << std::endl;
+		m_model.meshes[meshIndex].primitives[0].indices = writeAccessor<uint32_t, 1>(TINYGLTF_TYPE_SCALAR, pSubmesh->Faces.size() * 3,
+			[pSubmesh, min](size_t i, uint32_t* pIndex) {
+				*pIndex = uint32_t(std::max(pSubmesh->Faces[i / 3].Vertices[i % 3], 0) - min);
+			});
 
-		return minmax;
+		return std::pair<int, int>(min, max);
 	}
 
-	void GLTFIO::writeAttributes() {
+	void GLTFIO::writeAttributes(std::pair<int, int> minmax) {
 		int meshIndex = m_model.meshes.size() - 1;
 		Primitive* pPrimitive = &(m_model.meshes[meshIndex].primitives[0]);
 
-		int bufferIndex = 0;
-		int accessorIndex = m_model.accessors.size();
-
-		std::vector<std::vector<float>> data;
-
-		pPrimitive->attributes.emplace("POSITION", accessorIndex++);
-
-		fromVec3f(&m_coord, &data);
-
-		writeAccessorData(bufferIndex, TINYGLTF_TYPE_VEC3, &data);
-		data.clear();
-
-		if (m_normal.size() > 0) {
-			pPrimitive->attributes.emplace("NORMAL", accessorIndex++);
-
-			for (int i = 0; i < m_normal.size(); i++) {
-				if (m_normal[i].norm() != 1.0) {
-					m_normal[i](0) = 1.0;
-					m_normal[i](1) = 0.0;
-					m_normal[i](2) = 0.0;
-				}
-			}
-
-			fromVec3f(&m_normal, &data);
-
-			writeAccessorData(bufferIndex, TINYGLTF_TYPE_VEC3, &data);
-			data.clear();
-		}
-
-		if (m_tangent.size() > 0) {
+		// the primitive uses the vertex range of its submesh
+		const T3DMesh<float>* pMesh = m_pCMesh;
+		const size_t first = minmax.first;
+		const size_t count = minmax.second - minmax.first + 1;
+
+		pPrimitive->attributes.emplace("POSITION", writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, count,
+			[pMesh, first](size_t i, float* pValues) {
+				const Eigen::Vector3f pos = pMesh->vertex(first + i);
+				pValues[0] = pos(0);
+				pValues[1] = pos(1);
+				pValues[2] = pos(2);
+			}));
+
+		if (pMesh->normalCount() > 0) {
+			// validator expects unit length normals
+			pPrimitive->attributes.emplace("NORMAL", writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, count,
+				[pMesh, first](size_t i, float* pValues) {
+					Eigen::Vector3f norm = (first + i < pMesh->normalCount()) ? pMesh->normal(first + i) : Eigen::Vector3f::Zero();
+					const float length = norm.norm();
+					norm = (length > 0.0f) ? Eigen::Vector3f(norm / length) : Eigen::Vector3f::UnitX();
+					pValues[0] = norm(0);
+					pValues[1] = norm(1);
+					pValues[2] = norm(2);
+				}));
+		}
+
+		if (pMesh->tangentCount() > 0) {
 			bool skip_tangents = false;
 
-			//normalize tangents
-			for (int i = 0; i < m_tangent.size(); i++) {
-				m_tangent[i].normalize();
-				if (m_tangent[i].norm() == 0) {
-					skip_tangents = true;
-					break;
-				}
+			for (size_t i = 0; i < count && !skip_tangents; i++) {
+				skip_tangents = (first + i >= pMesh->tangentCount()) || pMesh->tangent(first + i).norm() == 0.0f;
 			}
 
 			if (!skip_tangents) {
-				pPrimitive->attributes.emplace("TANGENT", accessorIndex++);
-
-				fromVec3f(&m_tangent, &data);
-
 				//add w component for compatibility
-				for (int i = 0; i < data.size(); i++) {
-					data[i].push_back(-1.0f);
-				}
-
-
-				writeAccessorData(bufferIndex, TINYGLTF_TYPE_VEC4, &data);
-				data.clear();
+				pPrimitive->attributes.emplace("TANGENT", writeAccessor<float, 4>(TINYGLTF_TYPE_VEC4, count,
+					[pMesh, first](size_t i, float* pValues) {
+						const Eigen::Vector3f tan = pMesh->tangent(first + i).normalized();
+						pValues[0] = tan(0);
+						pValues[1] = tan(1);
+						pValues[2] = tan(2);
+						pValues[3] = -1.0f;
+					}));
 			}
 		}
 
-		if (m_texCoord.size() > 0) {
-			pPrimitive->attributes.emplace("TEXCOORD_0", accessorIndex++);
-
-			fromVec2f(&m_texCoord, &data);
+		if (pMesh->textureCoordinatesCount() > 0) {
+			pPrimitive->attributes.emplace("TEXCOORD_0", writeAccessor<float, 2>(TINYGLTF_TYPE_VEC2, count,
+				[pMesh, first](size_t i, float* pValues) {
+					pValues[0] = 0.0f;
+					pValues[1] = 0.0f;
+					if (first + i >= pMesh->textureCoordinatesCount()) return;
 
-			writeAccessorData(bufferIndex, TINYGLTF_TYPE_VEC2, &data);
-			data.clear();
+					const Eigen::Vector3f tex = pMesh->textureCoordinate(first + i);
+					pValues[0] = tex(0);
+					pValues[1] = 1.0f - tex(1);
+				}));
 		}
 
-		if (m_color.size() > 0) {
-			pPrimitive->attributes.emplace("COLOR_0", accessorIndex++);
-
-			fromVec4f(&m_color, &data);
-
-			writeAccessorData(bufferIndex, TINYGLTF_TYPE_VEC4, &data);
-			data.clear();
+		if (pMesh->colorCount() > 0) {
+			pPrimitive->attributes.emplace("COLOR_0", writeAccessor<float, 4>(TINYGLTF_TYPE_VEC4, count,
+				[pMesh, first](size_t i, float* pValues) {
+					const Eigen::Vector3f col = (first + i < pMesh->colorCount()) ? pMesh->color(first + i) : Eigen::Vector3f::Zero();
+					pValues[0] = col(0);
+					pValues[1] = col(1);
+					pValues[2] = col(2);
+					pValues[3] = 1.0f;
+				}));
 		}
 	}
 
@@ -289,22 +340,20 @@ namespace CForge {
 
 		Image gltfImage;
 		gltfImage.mimeType = "image/" + extension.substr(1, extension.length() - 1);
-		gltfImage.bufferView = m_model.bufferViews.size();
-
-
-		BufferView imageBufferView;
-		imageBufferView.buffer = 1;
-		Buffer* pBuffer = &m_model.buffers[imageBufferView.buffer];
-		imageBufferView.byteOffset = pBuffer->data.size();
-		imageBufferView.byteLength = STD_FS::file_size(texPath);
-
-		std::ifstream infile(texPath, std::ios_base::binary);
 
-		pBuffer->data.reserve(pBuffer->data.size() + imageBufferView.byteLength);
-
-		std::copy(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>(), std::back_inserter(pBuffer->data));
-
-		m_model.bufferViews.push_back(imageBufferView);
+		// the file content is copied when the buffer is written
+		BinPayload imagePayload;
+		imagePayload.Buffer = m_textureBuffer;
+		imagePayload.ElementSize = 1;
+		imagePayload.Count = STD_FS::file_size(texPath);
+		imagePayload.Encode = [path](unsigned char* pDst, size_t First, size_t Count) {
+			std::ifstream infile(path, std::ios_base::binary);
+			infile.seekg(First);
+			infile.read((char*)pDst, Count);
+			if (infile.gcount() != std::streamsize(Count)) throw CForgeExcept("Texture " + path + " changed while it was stored");
+		};
+
+		gltfImage.bufferView = addBufferView(std::move(imagePayload));
 		m_model.images.push_back(gltfImage);
 
 		gltfTexture.sampler = 0;
@@ -374,12 +423,16 @@ namespace CForge {
 	}
 
 	void GLTFIO::writeMorphTargets(std::pair<int, int> minmax) {
+		const size_t vertexCount = minmax.second - minmax.first + 1;
+
 		for (int i = 0; i < m_pCMesh->morphTargetCount(); i++) {
-			auto pTarget = m_pCMesh->getMorphTarget(i);
+			const T3DMesh<float>::MorphTarget* pTarget = m_pCMesh->getMorphTarget(i);
 
 			int min = minmax.first;
 			int max = minmax.second;
 
+			if (pTarget->VertexIDs.empty()) continue;
+
 			int first_index = pTarget->VertexIDs[0];
 
 			if (first_index >= min && first_index <= max) {
@@ -388,56 +441,52 @@ namespace CForge {
 				int mesh_index = m_model.meshes.size() - 1;
 				int primitve_index = m_model.meshes[mesh_index].primitives.size() - 1;
 
-				Primitive* pCurrentPrimitive = &m_model.meshes[mesh_index].primitives[primitve_index];
-
 				std::map<std::string, int> targetMap;
-				std::vector<std::vector<float>> data;
 
-				if (pTarget->VertexIDs.size() < m_coord.size()) {
-					std::vector<int32_t>* pIndices;
+				if (pTarget->VertexIDs.size() < vertexCount) {
+					// sparse indices are relative to the primitive
+					auto index = [pTarget, min](size_t k, uint32_t* pIndex) {
+						*pIndex = uint32_t(pTarget->VertexIDs[k] - min);
+					};
 
 					if (pTarget->VertexOffsets.size()) {
-						fromVec3f(&pTarget->VertexOffsets, &data);
-
-						int accessor_index = writeSparseAccessorData(0, TINYGLTF_TYPE_VEC3,
-							&pTarget->VertexIDs, &data);
+						int accessor_index = writeSparseAccessor<3>(TINYGLTF_TYPE_VEC3, vertexCount,
+							std::min(pTarget->VertexIDs.size(), pTarget->VertexOffsets.size()), index,
+							[pTarget](size_t k, float* pValues) {
+								for (int c = 0; c < 3; c++) pValues[c] = pTarget->VertexOffsets[k](c);
+							});
 						targetMap.emplace("POSITION", accessor_index);
-
-						data.clear();
 					}
 
 					if (pTarget->NormalOffsets.size()) {
-						fromVec3f(&pTarget->NormalOffsets, &data);
-
-						int accessor_index = writeSparseAccessorData(0, TINYGLTF_TYPE_VEC3,
-							nullptr, &data);
+						int accessor_index = writeSparseAccessor<3>(TINYGLTF_TYPE_VEC3, vertexCount,
+							std::min(pTarget->VertexIDs.size(), pTarget->NormalOffsets.size()), index,
+							[pTarget](size_t k, float* pValues) {
+								for (int c = 0; c < 3; c++) pValues[c] = pTarget->NormalOffsets[k](c);
+							});
 						targetMap.emplace("NORMAL", accessor_index);
 					}
 				}
 				else {
 					if (pTarget->VertexOffsets.size()) {
-						fromVec3f(&pTarget->VertexOffsets, &data);
-
-						writeAccessorData(0, TINYGLTF_TYPE_VEC3, &data);
-						int accessor_index = m_model.accessors.size() - 1;
-
+						int accessor_index = writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, pTarget->VertexOffsets.size(),
+							[pTarget](size_t k, float* pValues) {
+								for (int c = 0; c < 3; c++) pValues[c] = pTarget->VertexOffsets[k](c);
+							});
 						targetMap.emplace("POSITION", accessor_index);
-
-						data.clear();
 					}
 
 					if (pTarget->NormalOffsets.size()) {
-						fromVec3f(&pTarget->NormalOffsets, &data);
-
-						writeAccessorData(0, TINYGLTF_TYPE_VEC3, &data);
-						int accessor_index = m_model.accessors.size() - 1;
-
+						int accessor_index = writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, pTarget->NormalOffsets.size(),
+							[pTarget](size_t k, float* pValues) {
+								for (int c = 0; c < 3; c++) pValues[c] = pTarget->NormalOffsets[k](c);
+							});
 						targetMap.emplace("NORMAL", accessor_index);
 					}
 				}
 
 				if (targetMap.size()) {
-					pCurrentPrimitive->targets.push_back(targetMap);
+					m_model.meshes[mesh_index].primitives[primitve_index].targets.push_back(targetMap);
 				}
 
 				return;
@@ -455,30 +504,48 @@ namespace CForge {
 		* Alle Bones durchgehen und das Primitiv ermitteln was sie beeinflussen.
 		* Nun muss eine Umwandlung gefunden werden, sodass nicht die Vertices pro Knochen aufgelistet werden,
 		* sondern die 4 beeinflussenden Knochen für jeden Vertex.
-		* Dafür pro Bone alle influences (indices) und weights durchgehen und in zwei Datenstrukturen (vector<vector<float>>) sammeln.
-		* Die Datenstrukturen sollten die selbe Indexbasis haben wie die Attribute des Primitivs.
-		* Dadurch entstehen pro Vertex eine Liste mit Knochen und Gewichten, welche Schritt für Schritt mit den Werten ausgefüllt werden.
-		* Pro Vertex gibt es also eine Liste mit Node-Indices die ihn beeinflussen und eine Liste mit den Gewichtungen für diese Nodes.
-		* Diese Listen werden dann gekürzt so dass nur die stärksten 4 Einflüsse erhalten bleiben.
-		* Die Listen werden dann als Joints und Weights in Accessoren geschrieben und als Attribute dem Primitiv zugefügt.
+		* Dafür pro Bone alle influences (indices) und weights durchgehen und pro Vertex die 4 stärksten Einflüsse behalten.
+		* Die Datenstrukturen haben die selbe Indexbasis wie die Attribute des Primitivs.
+		* Die Einflüsse werden dann als Joints und Weights in Accessoren geschrieben und als Attribute dem Primitiv zugefügt.
 		*/
 
-		//mesh index	vertex index	joints/weights
-		std::vector<std::vector<std::vector<unsigned short>>> mesh_influences;
-		std::vector<std::vector<std::vector<float>>> mesh_weights;
+		// strongest 4 influences of a vertex, gltf only supports 4 weights per vertex
+		struct Influences {
+			unsigned short Joints[4] = { 0, 0, 0, 0 };
+			float Weights[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		};
 
-		for (int i = 0; i < m_model.meshes.size(); i++) {
-			std::vector<std::vector<unsigned short>> influences;
-			std::vector<std::vector<float>> weights;
+		auto addInfluence = [](Influences* pInfluences, unsigned short joint, float weight) {
+			if (!(weight > 0.0f)) return;
+
+			for (int k = 0; k < 4; k++) {
+				if (pInfluences->Weights[k] > 0.0f && pInfluences->Joints[k] == joint) {
+					// Weight of vertex already exists, update weight if current one is larger.
+					pInfluences->Weights[k] = std::max(pInfluences->Weights[k], weight);
+					return;
+				}
+			}
 
-			mesh_influences.push_back(influences);
-			mesh_weights.push_back(weights);
+			int weakest = 0;
+			for (int k = 1; k < 4; k++) {
+				if (pInfluences->Weights[k] < pInfluences->Weights[weakest]) weakest = k;
+			}
+			if (weight > pInfluences->Weights[weakest]) {
+				pInfluences->Joints[weakest] = joint;
+				pInfluences->Weights[weakest] = weight;
+			}
+		};
+
+		//mesh index	vertex index relative to the first vertex of the primitive
+		std::vector<std::shared_ptr<std::vector<Influences>>> mesh_influences;
+
+		for (int i = 0; i < m_model.meshes.size(); i++) {
+			const std::pair<int, int> minmax = m_primitiveIndexRanges[i];
+			mesh_influences.push_back(std::make_shared<std::vector<Influences>>(minmax.second - minmax.first + 1));
 		}
 
 		int node_offset = m_model.nodes.size();
 
-		std::vector<Eigen::Matrix4f> inverseBindMatrices;
-
 		//TODO this is dirty
 		T3DMesh<float>::Bone* p_cRoot = const_cast<T3DMesh<float>::Bone*>(m_pCMesh->rootBone());
 	
@@ -496,8 +563,6 @@ namespace CForge {
 		for (int i = 0; i < m_pCMesh->boneCount(); i++) {
 			auto pBone = m_pCMesh->getBone(i);
 
-			inverseBindMatrices.push_back(pBone->InvBindPoseMatrix);
-
 			Node newNode;
 
 			//TODO(skade) there seems to be a bug where to root node gets rotated randomly sometimes.
@@ -522,55 +587,15 @@ namespace CForge {
 			std::vector<int> meshesContainInfl = getMeshIndexByCrossForgeVertexIndex(pBone->VertexInfluences[0]);
 
 			for (int j = 0; j < pBone->VertexInfluences.size(); j++) {
-				int32_t vertex_index = pBone->VertexInfluences[j];
 				float weight = pBone->VertexWeights[j];
 
 				for (uint32_t l=0;l<meshesContainInfl.size();++l) {
 					int mesh_index = meshesContainInfl[l];
-					
-					// Push back new slots.
-					for (int k = mesh_influences[mesh_index].size(); k <= vertex_index; k++) {
-						mesh_influences[mesh_index].push_back(std::vector<unsigned short>());
-						mesh_weights[mesh_index].push_back(std::vector<float>());
-					}
+					int32_t vertex_index = pBone->VertexInfluences[j] - m_primitiveIndexRanges[mesh_index].first;
 
-					bool found = false;
-
-					for (int k = 0; k < mesh_influences[mesh_index][vertex_index].size(); k++) {
-						if (mesh_influences[mesh_index][vertex_index][k] == i) {
-							// Weight of vertex already exists.
-							
-							// Update Weight if current one is larger.
-							float oldWeight = mesh_weights[mesh_index][vertex_index][k];
-							if (oldWeight < weight) {
-								mesh_influences[mesh_index][vertex_index][k] = i;
-								mesh_weights[mesh_index][vertex_index][k] = weight;
-							}
-							
-							found = true; // vertex already added.
-							//break;
-						}
-					}
+					if (vertex_index < 0 || vertex_index >= mesh_influences[mesh_index]->size()) continue;
 
-					// Weight of Vertex is new.
-					if (!found && weight > 0.0) {
-						mesh_influences[mesh_index][vertex_index].push_back(i);
-						mesh_weights[mesh_index][vertex_index].push_back(weight);
-					}
-				}
-			}
-		}
-		std::cout << "stop" << std::endl;
-		//TODO might be a unwanted sideeffect? / Move into extra function?
-		// Normalize weights.
-		for (uint32_t i = 0; i < mesh_weights.size(); ++i) {
-			for (uint32_t j = 0; j < mesh_weights[i].size(); ++j) {
-				double total = 0.0;
-				for (uint32_t k = 0; k < mesh_weights[i][j].size(); ++k) {
-					total += (double) mesh_weights[i][j][k];
-				}
-				for (uint32_t k = 0; k < mesh_weights[i][j].size(); ++k) {
-					mesh_weights[i][j][k] /= total;
+					addInfluence(&(*mesh_influences[mesh_index])[vertex_index], i, weight);
 				}
 			}
 		}
@@ -588,81 +613,48 @@ namespace CForge {
 			}
 		}
 
-		// sort and write the 4 strongest weights per vertex
 		for (int i = 0; i < mesh_influences.size(); i++) {
-			for (int j = 0; j < mesh_influences[i].size(); j++) {
-				auto joints = &mesh_influences[i][j];
-				auto weights = &mesh_weights[i][j];
-
-				if (joints->size() > 0 && weights->size() > 0) {
-					// bubble sort
-					bool found = true;
-					while (found) {
-						found = false;
-						for (int pos = 0; pos < joints->size() - 1; pos++) {
-							if ((*joints)[pos] > (*joints)[pos + 1]) {
-								std::swap((*joints)[pos], (*joints)[pos + 1]);
-								std::swap((*weights)[pos], (*weights)[pos + 1]);
-								found = true;
-							}
-						}
-					}
-				}
+			std::shared_ptr<std::vector<Influences>> pInfluences = mesh_influences[i];
 
-				// Trim size to 4 as gltf only supports 4 weights per vertex.
-				for (int k = joints->size(); k > 4; k--) {
-					joints->pop_back();
-					weights->pop_back();
-				}
-				while (joints->size() < 4) joints->push_back(0);
-				while (weights->size() < 4) weights->push_back(0.0f);
+			bool influenced = false;
 
+			// normalize weights
+			for (Influences& infl : *pInfluences) {
 				float sum = 0.0f;
-
-				// normalize weights
-				for (int k = 0; k < weights->size(); k++) {
-					sum += (*weights)[k];
-				}
-				for (uint32_t k=0;k<weights->size();++k)
-					(*weights)[k] /= sum;
-				
-				//if (sum < 1.0f) (*weights)[0] += 1.0f - sum;
+				for (int k = 0; k < 4; k++) sum += infl.Weights[k];
+				if (sum <= 0.0f) continue;
+				for (int k = 0; k < 4; k++) infl.Weights[k] /= sum;
+				influenced = true;
 			}
 
-			if (mesh_weights[i].size() == 0 || mesh_influences[i].size() == 0)
-				continue;
+			if (!influenced) continue;
 
 			// write primitive attributes
 			Primitive* pPrimitive = &m_model.meshes[i].primitives[0];
 
-			int count = m_model.accessors[pPrimitive->attributes["POSITION"]].count;
-
-			while (mesh_weights[i].size() > count)
-				mesh_weights[i].pop_back();
-			
-			while (mesh_influences[i].size() > count)
-				mesh_influences[i].pop_back();
-
-			writeAccessorData(0, TINYGLTF_TYPE_VEC4, &mesh_weights[i]);
-			int accessor = m_model.accessors.size() - 1;
+			int accessor = writeAccessor<float, 4>(TINYGLTF_TYPE_VEC4, pInfluences->size(),
+				[pInfluences](size_t k, float* pValues) {
+					std::memcpy(pValues, (*pInfluences)[k].Weights, 4 * sizeof(float));
+				});
 			pPrimitive->attributes.emplace("WEIGHTS_0", accessor);
 
-			writeAccessorData(0, TINYGLTF_TYPE_VEC4, &mesh_influences[i]);
-			accessor = m_model.accessors.size() - 1;
+			accessor = writeAccessor<unsigned short, 4>(TINYGLTF_TYPE_VEC4, pInfluences->size(),
+				[pInfluences](size_t k, unsigned short* pValues) {
+					std::memcpy(pValues, (*pInfluences)[k].Joints, 4 * sizeof(unsigned short));
+				});
 			pPrimitive->attributes.emplace("JOINTS_0", accessor);
 		}
 
 		// write inverse bind matrices
-		std::vector<std::vector<float>> data;
-		fromMat4f(&inverseBindMatrices, &data);
-
-		// Validator complains if last value of mat4 is not 1.
-		for (int i = 0; i < data.size(); i++) {
-			data[i][15] = 1.0f;
-		}
+		const T3DMesh<float>* pMesh = m_pCMesh;
+		int accessor = writeAccessor<float, 16>(TINYGLTF_TYPE_MAT4, m_pCMesh->boneCount(),
+			[pMesh](size_t i, float* pValues) {
+				// both column major
+				std::memcpy(pValues, pMesh->getBone(i)->InvBindPoseMatrix.data(), 16 * sizeof(float));
 
-		writeAccessorData(0, TINYGLTF_TYPE_MAT4, &data);
-		int accessor = m_model.accessors.size() - 1;
+				// Validator complains if last value of mat4 is not 1.
+				pValues[15] = 1.0f;
+			});
 
 		Skin skin;
 		for (int i = node_offset; i < m_model.nodes.size(); i++) {
@@ -705,7 +697,7 @@ namespace CForge {
 			newGltfAnim.name = pAnim->Name;
 
 			for (int j = 0; j < pAnim->Keyframes.size(); j++) {
-				auto pBoneKf = pAnim->Keyframes[j];
+				const T3DMesh<float>::BoneKeyframes* pBoneKf = pAnim->Keyframes[j];
 
 				int target_node = 0;
 				std::string boneName;
@@ -721,24 +713,17 @@ namespace CForge {
 					continue;
 				}
 
-				std::vector<float> Timestamps;
-				for (int k = 0; k < pBoneKf->Timestamps.size(); k++) {
-					if (pAnim->SamplesPerSecond != 0.0)
-						Timestamps.push_back(pBoneKf->Timestamps[k] / pAnim->SamplesPerSecond);
-					else
-						Timestamps.push_back(pBoneKf->Timestamps[k]);
-				}
-
-				writeAccessorDataScalar(0, &Timestamps);
-				int indexAccessor = m_model.accessors.size() - 1;
+				const float samplesPerSecond = pAnim->SamplesPerSecond;
+				int indexAccessor = writeAccessor<float, 1>(TINYGLTF_TYPE_SCALAR, pBoneKf->Timestamps.size(),
+					[pBoneKf, samplesPerSecond](size_t k, float* pValue) {
+						*pValue = (samplesPerSecond != 0.0f) ? pBoneKf->Timestamps[k] / samplesPerSecond : pBoneKf->Timestamps[k];
+					});
 
 				if (pBoneKf->Positions.size()) {
-					std::vector<std::vector<float>> data;
-
-					fromVec3f(&pBoneKf->Positions, &data);
-
-					writeAccessorData(0, TINYGLTF_TYPE_VEC3, &data);
-					int positionAccessor = m_model.accessors.size() - 1;
+					int positionAccessor = writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, pBoneKf->Positions.size(),
+						[pBoneKf](size_t k, float* pValues) {
+							for (int c = 0; c < 3; c++) pValues[c] = pBoneKf->Positions[k](c);
+						});
 
 					AnimationSampler sampler;
 					sampler.input = indexAccessor;
@@ -757,12 +742,14 @@ namespace CForge {
 				}
 
 				if (pBoneKf->Rotations.size()) {
-					std::vector<std::vector<float>> data;
-
-					fromQuatf(&pBoneKf->Rotations, &data);
-
-					writeAccessorData(0, TINYGLTF_TYPE_VEC4, &data);
-					int rotationAccessor = m_model.accessors.size() - 1;
+					int rotationAccessor = writeAccessor<float, 4>(TINYGLTF_TYPE_VEC4, pBoneKf->Rotations.size(),
+						[pBoneKf](size_t k, float* pValues) {
+							const Eigen::Quaternionf& q = pBoneKf->Rotations[k];
+							pValues[0] = q.x();
+							pValues[1] = q.y();
+							pValues[2] = q.z();
+							pValues[3] = q.w();
+						});
 
 					AnimationSampler sampler;
 					sampler.input = indexAccessor;
@@ -780,12 +767,10 @@ namespace CForge {
 				}
 
 				if (pBoneKf->Scalings.size()) {
-					std::vector<std::vector<float>> data;
-
-					fromVec3f(&pBoneKf->Scalings, &data);
-
-					writeAccessorData(0, TINYGLTF_TYPE_VEC3, &data);
-					int scaleAccessor = m_model.accessors.size() - 1;
+					int scaleAccessor = writeAccessor<float, 3>(TINYGLTF_TYPE_VEC3, pBoneKf->Scalings.size(),
+						[pBoneKf](size_t k, float* pValues) {
+							for (int c = 0; c < 3; c++) pValues[c] = pBoneKf->Scalings[k](c);
+						});
 
 					AnimationSampler sampler;
 					sampler.input = indexAccessor;
@@ -808,244 +793,6 @@ namespace CForge {
 	}
 
 #pragma endregion
-	//returns indices buffer view to identify index data
-	int32_t GLTFIO::getSparseAccessorData(const int accessor, std::vector<int32_t>* pIndices, std::vector<std::vector<float>>* pData) {
-		Accessor acc = m_model.accessors[accessor];
-
-		if (!acc.sparse.isSparse) {
-			std::cout << "Accessor is not sparse" << std::endl;
-
-			return -1;
-		}
-
-		int component_count = componentCount(acc.type);
-
-		int index_type = acc.sparse.indices.componentType;
-		int index_type_size = sizeOfGltfComponentType(index_type);
-		int index_byte_offset = acc.sparse.indices.byteOffset;
-		BufferView index_buff_view = m_model.bufferViews[acc.sparse.indices.bufferView];
-		Buffer index_buff = m_model.buffers[index_buff_view.buffer];
-
-		int value_type = acc.componentType;
-		int value_type_size = sizeOfGltfComponentType(acc.componentType);
-		int value_byte_offset = acc.sparse.values.byteOffset;
-		BufferView value_buff_view = m_model.bufferViews[acc.sparse.values.bufferView];
-		Buffer value_buff = m_model.buffers[value_buff_view.buffer];
-
-
-
-		//read index data
-
-		if (index_type == TINYGLTF_COMPONENT_TYPE_BYTE) {
-			std::vector<char> indices;
-			readBuffer(index_buff.data.data(), acc.sparse.count, acc.byteOffset + index_byte_offset, 1, false, 0, &indices);
-			for (int i = 0; i < acc.sparse.count; i++) {
-				pIndices->push_back((int32_t)(indices[i]));
-			}
-		}
-		else if (index_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-			std::vector<unsigned char> indices;
-			readBuffer(index_buff.data.data(), acc.sparse.count, acc.byteOffset + index_byte_offset, 1, false, 0, &indices);
-			for (int i = 0; i < acc.sparse.count; i++) {
-				pIndices->push_back((int32_t)(indices[i]));
-			}
-		}
-		else if (index_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-			std::vector<unsigned short> indices;
-			readBuffer(index_buff.data.data(), acc.sparse.count, acc.byteOffset + index_byte_offset, 1, false, 0, &indices);
-			for (int i = 0; i < acc.sparse.count; i++) {
-				pIndices->push_back((int32_t)(indices[i]));
-			}
-		}
-		else if (index_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-			std::vector<uint32_t> indices;
-			readBuffer(index_buff.data.data(), acc.sparse.count, acc.byteOffset + index_byte_offset, 1, false, 0, &indices);
-			for (int i = 0; i < acc.sparse.count; i++) {
-				pIndices->push_back((int32_t)(indices[i]));
-			}
-		}
-		else if (index_type == TINYGLTF_COMPONENT_TYPE_INT) {
-			readBuffer(index_buff.data.data(), acc.sparse.count, acc.byteOffset + index_byte_offset, 1, false, 0, pIndices);
-		}
-		else {
-			std::cout << "Unsupported index type" << std::endl;
-		}
-
-
-		//read value data
-
-		readBuffer(value_buff.data.data(), acc.sparse.count, acc.byteOffset + value_byte_offset, component_count, componentIsMatrix(acc.type), 0, pData);
-
-		return acc.sparse.indices.bufferView;
-	}
-
-	//reads normalized integers and returns floats
-	void GLTFIO::getAccessorDataScalarFloat(const int accessor, std::vector<float>* pData) {
-		Accessor acc = m_model.accessors[accessor];
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_BYTE) {
-			std::vector<char> normalizedData;
-			getAccessorDataScalar(accessor, &normalizedData);
-			for (auto d : normalizedData) {
-				pData->push_back(std::max(d / 127.0f, -1.0f));
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-			std::vector<unsigned char> normalizedData;
-			getAccessorDataScalar(accessor, &normalizedData);
-			for (auto d : normalizedData) {
-				pData->push_back(d / 255.0f);
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_SHORT) {
-			std::vector<short> normalizedData;
-			getAccessorDataScalar(accessor, &normalizedData);
-			for (auto d : normalizedData) {
-				pData->push_back(std::max(d / 32767.0f, -1.0f));
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-			std::vector<unsigned short> normalizedData;
-			getAccessorDataScalar(accessor, &normalizedData);
-			for (auto d : normalizedData) {
-				pData->push_back(d / 65535.0f);
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) {
-			getAccessorDataScalar(accessor, pData);
-		}
-		else {
-			std::cout << "Unsupported component type for normalized integer conversion: " << acc.componentType << std::endl;
-		}
-	}
-
-	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Vector3f>* pData) {
-		std::vector<std::vector<float>> vData;
-
-		getAccessorDataFloat(accessor, &vData);
-
-		toVec3f(&vData, pData);
-	}
-
-	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Vector4f>* pData) {
-		std::vector<std::vector<float>> vData;
-
-		getAccessorDataFloat(accessor, &vData);
-
-		toVec4f(&vData, pData);
-	}
-
-	void GLTFIO::getAccessorData(const int accessor, std::vector<Eigen::Quaternionf>* pData) {
-		std::vector<std::vector<float>> vData;
-
-		getAccessorDataFloat(accessor, &vData);
-
-		toQuatf(&vData, pData);
-	}
-
-	//Construct floats from normalized integers.
-	void GLTFIO::getAccessorDataFloat(const int accessor, std::vector<std::vector<float>>* pData) {
-		Accessor acc = m_model.accessors[accessor];
-
-		//TODO getAccessorData is wrong? conversion from unsigned byte range 0-255 to 0-1
-
-		if (acc.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT) getAccessorData(accessor, pData);
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_BYTE) {
-			std::vector<std::vector<char>> normalizedData;
-			getAccessorData(accessor, &normalizedData);
-			for (auto e : normalizedData) {
-				std::vector<float> toAdd;
-				//for (auto d : e) toAdd.push_back(std::max(d / 127.0f, -1.0f));
-				for (auto d : e) toAdd.push_back(float(d));
-				pData->push_back(toAdd);
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE) {
-			std::vector<std::vector<unsigned char>> normalizedData;
-			getAccessorData(accessor, &normalizedData);
-			for (auto e : normalizedData) {
-				std::vector<float> toAdd;
-				//for (auto d : e) toAdd.push_back(d / 255.0f);
-				for (auto d : e) toAdd.push_back(float(d));
-				pData->push_back(toAdd);
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_SHORT) {
-			std::vector<std::vector<short>> normalizedData;
-			getAccessorData(accessor, &normalizedData);
-			for (auto e : normalizedData) {
-				std::vector<float> toAdd;
-				//for (auto d : e) toAdd.push_back(std::max(d / 32767.0f, -1.0f));
-				for (auto d : e) toAdd.push_back(float(d));
-				pData->push_back(toAdd);
-			}
-		}
-		else if (acc.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-			std::vector<std::vector<unsigned short>> normalizedData;
-			getAccessorData(accessor, &normalizedData);
-			for (auto e : normalizedData) {
-				std::vector<float> toAdd;
-				//for (auto d : e) toAdd.push_back(d / 65535.0f);
-				for (auto d : e) toAdd.push_back(float(d));
-				pData->push_back(toAdd);
-			}
-		}
-		else std::cout << "Unsupported component type: " << acc.componentType << " for normalized integer conversion!" << std::endl;
-	}
-
-	int GLTFIO::writeSparseAccessorData(const int buffer_index, const int type, const std::vector<int32_t>* pIndices, const std::vector<std::vector<float>>* pData) {
-		Buffer* pBuffer = &m_model.buffers[buffer_index];
-
-		Accessor accessor;
-
-		accessor.bufferView = 0;
-		accessor.byteOffset = 0;
-		accessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
-		accessor.type = type;
-		accessor.count = pData->size();
-		accessor.sparse.isSparse = true;
-		accessor.sparse.count = pData->size();
-
-
-		if (pIndices != nullptr) {
-			BufferView index_buffer_view;
-
-			index_buffer_view.byteOffset = pBuffer->data.size();
-			index_buffer_view.buffer = buffer_index;
-			index_buffer_view.byteLength = pIndices->size() * sizeof(int32_t);
-			index_buffer_view.byteStride = 0;
-
-			accessor.sparse.indices.bufferView = m_model.bufferViews.size();
-			accessor.sparse.indices.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
-
-			m_model.bufferViews.push_back(index_buffer_view);
-
-			writeBuffer(&pBuffer->data, index_buffer_view.byteOffset + accessor.byteOffset,
-				accessor.sparse.count, false, index_buffer_view.byteStride, pIndices);
-		}
-
-		BufferView value_buffer_view;
-
-		value_buffer_view.byteOffset = pBuffer->data.size();
-		value_buffer_view.buffer = buffer_index;
-		value_buffer_view.byteLength = pData->size() * sizeof(float) * componentCount(type);
-		value_buffer_view.byteStride = 0;
-
-		accessor.sparse.values.bufferView = m_model.bufferViews.size();
-
-		m_model.bufferViews.push_back(value_buffer_view);
-
-		bool is_matrix = componentIsMatrix(type);
-
-
-		writeBuffer(&pBuffer->data, value_buffer_view.byteOffset + accessor.byteOffset,
-			accessor.sparse.count, is_matrix, value_buffer_view.byteStride, pData);
-
-
-		m_model.accessors.push_back(accessor);
-
-		return m_model.accessors.size() - 1;
-	}
 
 	/*
 	* Returns the gltf mesh index for a given index of a vertex in the CrossForge Mesh.
@@ -1075,6 +822,4 @@ namespace CForge {
 		return -1;
 	}
 
-#pragma endregion
-
 }//CForge
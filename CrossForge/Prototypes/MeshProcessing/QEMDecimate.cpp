@@ -0,0 +1,666 @@
+#include "QEMDecimate.h"
+#include <crossforge/Core/Parallel.hpp>
+#include <algorithm>
+#include <numeric>
+
+using namespace Eigen;
+
+namespace CForge {
+
+void QEMDecimator::Quadric::clear(void) {
+	for (uint8_t i = 0; i < 10; ++i) A[i] = 0.0;
+}//clear
+
+void QEMDecimator::Quadric::plane(const Vector3d& N, double D, double Weight) {
+	A[0] += Weight * N.x() * N.x(); A[1] += Weight * N.x() * N.y(); A[2] += Weight * N.x() * N.z(); A[3] += Weight * N.x() * D;
+	A[4] += Weight * N.y() * N.y(); A[5] += Weight * N.y() * N.z(); A[6] += Weight * N.y() * D;
+	A[7] += Weight * N.z() * N.z(); A[8] += Weight * N.z() * D;
+	A[9] += Weight * D * D;
+}//plane
+
+void QEMDecimator::Quadric::add(const Quadric& Q) {
+	for (uint8_t i = 0; i < 10; ++i) A[i] += Q.A[i];
+}//add
+
+double QEMDecimator::Quadric::error(const Vector3d& P)const {
+	const double x = P.x(), y = P.y(), z = P.z();
+	return A[0]*x*x + 2.0*A[1]*x*y + 2.0*A[2]*x*z + 2.0*A[3]*x
+	     + A[4]*y*y + 2.0*A[5]*y*z + 2.0*A[6]*y
+	     + A[7]*z*z + 2.0*A[8]*z
+	     + A[9];
+}//error
+
+bool QEMDecimator::Quadric::optimum(Vector3d* pP)const {
+	Matrix3d M;
+	M << A[0], A[1], A[2],
+	     A[1], A[4], A[5],
+	     A[2], A[5], A[7];
+	const double Scale = M.diagonal().cwiseAbs().maxCoeff();
+	// flat or cylindrical neighbourhoods have no unique minimum
+	if (Scale <= 0.0 || std::abs(M.determinant()) <= 1e-10 * Scale * Scale * Scale) return false;
+	(*pP) = M.inverse() * Vector3d(-A[3], -A[6], -A[8]);
+	return true;
+}//optimum
+
+QEMDecimator::QEMDecimator(void) {
+	m_pMesh = nullptr;
+	m_FaceCount = 0;
+}//Constructor
+
+QEMDecimator::~QEMDecimator(void) {
+	clear();
+}//Destructor
+
+void QEMDecimator::clear(void) {
+	m_pMesh = nullptr;
+	m_Positions.clear();
+	m_Quadrics.clear();
+	m_Versions.clear();
+	m_VertexAlive.clear();
+	m_Locked.clear();
+	m_VertexFaces.clear();
+	m_Faces.clear();
+	m_FaceSubmesh.clear();
+	m_FaceAlive.clear();
+	m_FaceCount = 0;
+	m_Region.clear();
+	m_Interior.clear();
+	m_RegionHeaps.clear();
+	m_Heap.clear();
+	m_Collapses.clear();
+}//clear
+
+void QEMDecimator::init(const T3DMesh<float>* pMesh) {
+	if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+	clear();
+	m_pMesh = pMesh;
+
+	const int32_t VertexCount = pMesh->vertexCount();
+	m_Positions.resize(VertexCount);
+	for (int32_t i = 0; i < VertexCount; ++i) m_Positions[i] = pMesh->vertex(i).cast<double>();
+
+	for (uint32_t s = 0; s < pMesh->submeshCount(); ++s) {
+		for (const auto& F : pMesh->getSubmesh(s)->Faces) {
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (F.Vertices[k] < 0 || F.Vertices[k] >= VertexCount) throw IndexOutOfBoundsExcept("Face.Vertices");
+			}
+			if (F.Vertices[0] == F.Vertices[1] || F.Vertices[1] == F.Vertices[2] || F.Vertices[0] == F.Vertices[2]) continue;
+			m_Faces.push_back(Vector3i(F.Vertices[0], F.Vertices[1], F.Vertices[2]));
+			m_FaceSubmesh.push_back(s);
+		}//for[faces]
+	}//for[submeshes]
+	m_FaceAlive.assign(m_Faces.size(), 1);
+	m_FaceCount = m_Faces.size();
+
+	m_VertexFaces.resize(VertexCount);
+	for (int32_t f = 0; f < int32_t(m_Faces.size()); ++f) {
+		for (uint8_t k = 0; k < 3; ++k) m_VertexFaces[m_Faces[f][k]].push_back(f);
+	}
+	m_VertexAlive.assign(VertexCount, 1);
+	m_Versions.assign(VertexCount, 0);
+
+	// vertices split for differing attributes share their position, runs of equal positions after sorting
+	m_Locked.assign(VertexCount, 0);
+	std::vector<int32_t> Order(VertexCount);
+	std::iota(Order.begin(), Order.end(), 0);
+	auto Less = [&](int32_t a, int32_t b) {
+		const Vector3d& A = m_Positions[a];
+		const Vector3d& B = m_Positions[b];
+		return std::tie(A.x(), A.y(), A.z()) < std::tie(B.x(), B.y(), B.z());
+	};
+	std::sort(Order.begin(), Order.end(), Less);
+	for (int32_t i = 1; i < VertexCount; ++i) {
+		if (m_Positions[Order[i]] == m_Positions[Order[i - 1]]) m_Locked[Order[i]] = m_Locked[Order[i - 1]] = 1;
+	}
+
+	// face planes weighted by area, borders additionally by planes perpendicular to the face through the border edge
+	m_Quadrics.resize(VertexCount);
+	parallelFor(0, VertexCount, [&](size_t Begin, size_t End) {
+		for (size_t v = Begin; v < End; ++v) {
+			Quadric& Q = m_Quadrics[v];
+			Q.clear();
+			for (int32_t f : m_VertexFaces[v]) {
+				const Vector3i& F = m_Faces[f];
+				Vector3d N = (m_Positions[F[1]] - m_Positions[F[0]]).cross(m_Positions[F[2]] - m_Positions[F[0]]);
+				const double Area2 = N.norm();
+				if (Area2 <= 0.0) continue;
+				N /= Area2;
+				Q.plane(N, -N.dot(m_Positions[F[0]]), 0.5 * Area2);
+
+				for (uint8_t k = 0; k < 3; ++k) {
+					const int32_t w = F[k];
+					if (w == int32_t(v)) continue;
+					bool Border = true;
+					for (int32_t g : m_VertexFaces[v]) {
+						if (g == f || m_FaceSubmesh[g] != m_FaceSubmesh[f]) continue;
+						const Vector3i& G = m_Faces[g];
+						if (G[0] == w || G[1] == w || G[2] == w) {
+							Border = false;
+							break;
+						}
+					}//for[faces of v]
+					if (!Border) continue;
+					const Vector3d E = m_Positions[w] - m_Positions[v];
+					Vector3d NB = E.cross(N);
+					if (NB.squaredNorm() <= 0.0) continue;
+					NB.normalize();
+					Q.plane(NB, -NB.dot(m_Positions[v]), m_BoundaryWeight * E.squaredNorm());
+				}//for[edges of f]
+			}//for[faces of v]
+		}//for[vertices]
+	});
+
+	// regions, a grid over the bounding box with enough cells to keep all threads busy
+	m_Region.assign(VertexCount, 0);
+	m_Interior.assign(VertexCount, 1);
+	int32_t Cells = 1;
+	if (VertexCount > 0) {
+		const size_t Threads = parallelRangeCount(VertexCount, m_MinRegionVertices);
+		while (size_t((Cells + 1) * (Cells + 1) * (Cells + 1)) <= 4 * Threads
+			&& VertexCount / ((Cells + 1) * (Cells + 1) * (Cells + 1)) >= int32_t(m_MinRegionVertices)) Cells++;
+
+		Vector3d Min = m_Positions[0];
+		Vector3d Max = m_Positions[0];
+		for (const auto& P : m_Positions) {
+			Min = Min.cwiseMin(P);
+			Max = Max.cwiseMax(P);
+		}
+		const Vector3d Extent = (Max - Min).cwiseMax(Vector3d::Constant(1e-12));
+		for (int32_t v = 0; v < VertexCount; ++v) {
+			Vector3i C;
+			for (uint8_t k = 0; k < 3; ++k) C[k] = std::min(Cells - 1, int32_t((m_Positions[v][k] - Min[k]) / Extent[k] * Cells));
+			m_Region[v] = (C.z() * Cells + C.y()) * Cells + C.x();
+		}
+	}
+	const int32_t RegionCount = Cells * Cells * Cells;
+	if (RegionCount > 1) {
+		parallelFor(0, VertexCount, [&](size_t Begin, size_t End) {
+			for (size_t v = Begin; v < End; ++v) m_Interior[v] = isInterior(v);
+		});
+	}
+
+	std::vector<std::vector<int32_t>> RegionVertices(RegionCount);
+	for (int32_t v = 0; v < VertexCount; ++v) RegionVertices[m_Region[v]].push_back(v);
+
+	m_RegionHeaps.resize(RegionCount);
+	std::vector<std::vector<Edge>> CrossEdges(RegionCount);
+	parallelFor(0, RegionCount, [&](size_t Begin, size_t End) {
+		for (size_t r = Begin; r < End; ++r) {
+			for (int32_t v : RegionVertices[r]) {
+				pushEdges(v, true, true, &m_RegionHeaps[r]);
+				if (RegionCount > 1) pushEdges(v, false, true, &CrossEdges[r]);
+			}
+			std::make_heap(m_RegionHeaps[r].begin(), m_RegionHeaps[r].end());
+		}
+	}, 1);
+
+	// with a single region the region queue holds every edge
+	if (RegionCount > 1) {
+		for (auto& i : CrossEdges) m_Heap.insert(m_Heap.end(), i.begin(), i.end());
+		std::make_heap(m_Heap.begin(), m_Heap.end());
+	}
+}//initialize
+
+uint32_t QEMDecimator::decimate(uint32_t TargetFaces) {
+	if (nullptr == m_pMesh) throw CForgeExcept("Decimator was not initialized");
+	if (m_FaceCount <= TargetFaces) return m_FaceCount;
+
+	const int32_t RegionCount = m_RegionHeaps.size();
+	const double Ratio = double(TargetFaces) / m_FaceCount;
+	if (RegionCount > 1 && TargetFaces / RegionCount < m_MinRegionFaces) return decimateGlobal(TargetFaces);
+
+	// every region shrinks its inner faces by the same ratio, but stops short of the target so the global queue
+	// spends the rest where it is cheapest, which includes the faces touching other regions
+	const double RegionRatio = (RegionCount > 1) ? Ratio + (1.0 - Ratio) * m_GlobalShare : Ratio;
+	std::vector<uint32_t> RegionFaces(RegionCount, 0);
+	for (size_t f = 0; f < m_Faces.size(); ++f) {
+		if (!m_FaceAlive[f]) continue;
+		const int32_t r = m_Region[m_Faces[f][0]];
+		if (r == m_Region[m_Faces[f][1]] && r == m_Region[m_Faces[f][2]]) RegionFaces[r]++;
+	}
+
+	std::vector<std::vector<Collapse>> Records(RegionCount);
+	std::vector<uint32_t> Removed(RegionCount, 0);
+	parallelFor(0, RegionCount, [&](size_t Begin, size_t End) {
+		for (size_t r = Begin; r < End; ++r) {
+			const uint32_t Target = uint32_t(RegionFaces[r] * RegionRatio);
+			uint32_t Faces = RegionFaces[r];
+			Candidate C;
+			while (Faces > Target && popValid(&m_RegionHeaps[r], true, &C)) {
+				uint32_t RemovedFaces = 0;
+				collapse(C, &Records[r], &RemovedFaces);
+				Faces -= std::min(Faces, RemovedFaces);
+				Removed[r] += RemovedFaces;
+
+				const size_t Old = m_RegionHeaps[r].size();
+				pushEdges(C.Kept, true, false, &m_RegionHeaps[r]);
+				for (size_t i = Old; i < m_RegionHeaps[r].size(); ++i) std::push_heap(m_RegionHeaps[r].begin(), m_RegionHeaps[r].begin() + i + 1);
+			}//while[region above target]
+		}//for[regions]
+	}, 1);
+
+	const size_t RegionBegin = m_Collapses.size();
+	for (int32_t r = 0; r < RegionCount; ++r) {
+		m_Collapses.insert(m_Collapses.end(), Records[r].begin(), Records[r].end());
+		m_FaceCount -= Removed[r];
+	}
+	if (RegionCount == 1) return m_FaceCount;
+
+	// the global queue has not seen the edges created by the regions
+	for (size_t i = RegionBegin; i < m_Collapses.size(); ++i) {
+		const int32_t Kept = m_Collapses[i].Kept;
+		if (!m_VertexAlive[Kept]) continue;
+		const size_t Old = m_Heap.size();
+		pushEdges(Kept, false, false, &m_Heap);
+		for (size_t k = Old; k < m_Heap.size(); ++k) std::push_heap(m_Heap.begin(), m_Heap.begin() + k + 1);
+	}
+
+	return decimateGlobal(TargetFaces);
+}//decimate
+
+uint32_t QEMDecimator::decimateGlobal(uint32_t TargetFaces) {
+	std::vector<int32_t> Touched;
+	std::vector<int32_t> N;
+	Candidate C;
+	while (m_FaceCount > TargetFaces && popValid(&m_Heap, false, &C)) {
+		uint32_t RemovedFaces = 0;
+		collapse(C, &m_Collapses, &RemovedFaces);
+		m_FaceCount -= std::min(m_FaceCount, RemovedFaces);
+
+		const size_t Old = m_Heap.size();
+		pushEdges(C.Kept, false, false, &m_Heap);
+		for (size_t k = Old; k < m_Heap.size(); ++k) std::push_heap(m_Heap.begin(), m_Heap.begin() + k + 1);
+
+		// the merged one-ring may now span regions or lie within one
+		neighbours(C.Kept, &N);
+		N.push_back(C.Kept);
+		for (int32_t v : N) {
+			m_Interior[v] = isInterior(v);
+			Touched.push_back(v);
+		}
+	}//while[above target]
+
+	std::sort(Touched.begin(), Touched.end());
+	Touched.erase(std::unique(Touched.begin(), Touched.end()), Touched.end());
+	for (int32_t v : Touched) {
+		if (!m_VertexAlive[v] || !m_Interior[v]) continue;
+		std::vector<Edge>* pHeap = &m_RegionHeaps[m_Region[v]];
+		const size_t Old = pHeap->size();
+		pushEdges(v, true, false, pHeap);
+		for (size_t k = Old; k < pHeap->size(); ++k) std::push_heap(pHeap->begin(), pHeap->begin() + k + 1);
+	}
+
+	return m_FaceCount;
+}//decimateGlobal
+
+bool QEMDecimator::evaluate(int32_t A, int32_t B, Candidate* pC)const {
+	if (m_Locked[A] && m_Locked[B]) return false;
+	if (m_Locked[B]) std::swap(A, B);
+	pC->Kept = A;
+	pC->Removed = B;
+
+	Quadric Q = m_Quadrics[A];
+	Q.add(m_Quadrics[B]);
+	const Vector3d& PA = m_Positions[A];
+	const Vector3d& PB = m_Positions[B];
+	const Vector3d D = PB - PA;
+
+	if (m_Locked[A]) {
+		pC->Position = PA;
+	}
+	else if (!Q.optimum(&pC->Position) || (pC->Position - 0.5 * (PA + PB)).squaredNorm() > 4.0 * D.squaredNorm()) {
+		const Vector3d Options[3] = { PA, PB, 0.5 * (PA + PB) };
+		double Best = std::numeric_limits<double>::max();
+		for (const auto& P : Options) {
+			const double E = Q.error(P);
+			if (E < Best) {
+				Best = E;
+				pC->Position = P;
+			}
+		}
+	}
+
+	const double Length2 = D.squaredNorm();
+	pC->T = (Length2 > 0.0) ? float(std::clamp((pC->Position - PA).dot(D) / Length2, 0.0, 1.0)) : 0.0f;
+	pC->Cost = std::max(0.0, Q.error(pC->Position));
+	return true;
+}//evaluate
+
+bool QEMDecimator::canCollapse(const Candidate& C)const {
+	const int32_t a = C.Kept;
+	const int32_t b = C.Removed;
+
+	thread_local std::vector<int32_t> NA;
+	thread_local std::vector<int32_t> NB;
+	neighbours(a, &NA);
+	neighbours(b, &NB);
+
+	uint32_t EdgeFaces = 0;
+	for (int32_t f : m_VertexFaces[a]) {
+		const Vector3i& F = m_Faces[f];
+		if (F[0] == b || F[1] == b || F[2] == b) EdgeFaces++;
+	}
+	if (EdgeFaces == 0) return false;
+
+	// link condition, the only shared neighbours are the opposite corners of the edge faces
+	uint32_t Common = 0;
+	auto ia = NA.begin();
+	auto ib = NB.begin();
+	while (ia != NA.end() && ib != NB.end()) {
+		if (*ia < *ib) ++ia;
+		else if (*ib < *ia) ++ib;
+		else {
+			Common++;
+			++ia;
+			++ib;
+		}
+	}
+	if (Common != EdgeFaces) return false;
+	if (EdgeFaces > 1 && NA.size() <= 3 && NB.size() <= 3) return false; // tetrahedron
+	if (EdgeFaces > 1 && isBoundary(a) && isBoundary(b)) return false; // would pinch the surface
+
+	for (int32_t v : { a, b }) {
+		for (int32_t f : m_VertexFaces[v]) {
+			const Vector3i& F = m_Faces[f];
+			if ((F[0] == a || F[1] == a || F[2] == a) && (F[0] == b || F[1] == b || F[2] == b)) continue;
+			Vector3d P[3];
+			for (uint8_t k = 0; k < 3; ++k) P[k] = m_Positions[F[k]];
+			const Vector3d Before = (P[1] - P[0]).cross(P[2] - P[0]);
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (F[k] == v) P[k] = C.Position;
+			}
+			const Vector3d After = (P[1] - P[0]).cross(P[2] - P[0]);
+			const double LengthBefore = Before.norm();
+			const double LengthAfter = After.norm();
+			if (LengthBefore <= 0.0) continue;
+			if (LengthAfter <= 1e-12 * LengthBefore) return false;
+			if (Before.dot(After) < m_MinNormalDot * LengthBefore * LengthAfter) return false;
+		}//for[faces of v]
+	}//for[edge vertices]
+
+	return true;
+}//canCollapse
+
+void QEMDecimator::collapse(const Candidate& C, std::vector<Collapse>* pRecord, uint32_t* pRemovedFaces) {
+	const int32_t a = C.Kept;
+	const int32_t b = C.Removed;
+
+	m_Positions[a] = C.Position;
+	m_Quadrics[a].add(m_Quadrics[b]);
+	m_Versions[a]++;
+	m_VertexAlive[b] = 0;
+
+	uint32_t RemovedFaces = 0;
+	for (int32_t f : m_VertexFaces[b]) {
+		Vector3i& F = m_Faces[f];
+		if (F[0] == a || F[1] == a || F[2] == a) {
+			m_FaceAlive[f] = 0;
+			RemovedFaces++;
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (F[k] == b) continue;
+				auto& Faces = m_VertexFaces[F[k]];
+				Faces.erase(std::find(Faces.begin(), Faces.end(), f));
+			}
+		}
+		else {
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (F[k] == b) F[k] = a;
+			}
+			m_VertexFaces[a].push_back(f);
+		}
+	}//for[faces of b]
+	m_VertexFaces[b].clear();
+
+	Collapse Rec;
+	Rec.Kept = a;
+	Rec.Removed = b;
+	Rec.T = C.T;
+	Rec.Position = C.Position.cast<float>();
+	pRecord->push_back(Rec);
+	(*pRemovedFaces) = RemovedFaces;
+}//collapse
+
+void QEMDecimator::neighbours(int32_t V, std::vector<int32_t>* pN)const {
+	pN->clear();
+	for (int32_t f : m_VertexFaces[V]) {
+		for (uint8_t k = 0; k < 3; ++k) {
+			if (m_Faces[f][k] != V) pN->push_back(m_Faces[f][k]);
+		}
+	}
+	std::sort(pN->begin(), pN->end());
+	pN->erase(std::unique(pN->begin(), pN->end()), pN->end());
+}//neighbours
+
+bool QEMDecimator::isBoundary(int32_t V)const {
+	for (int32_t f : m_VertexFaces[V]) {
+		for (uint8_t k = 0; k < 3; ++k) {
+			const int32_t w = m_Faces[f][k];
+			if (w == V) continue;
+			uint32_t Shared = 0;
+			for (int32_t g : m_VertexFaces[V]) {
+				const Vector3i& G = m_Faces[g];
+				if (G[0] == w || G[1] == w || G[2] == w) Shared++;
+			}
+			if (Shared == 1) return true;
+		}
+	}
+	return false;
+}//isBoundary
+
+bool QEMDecimator::isInterior(int32_t V)const {
+	const int32_t r = m_Region[V];
+	for (int32_t f : m_VertexFaces[V]) {
+		for (uint8_t k = 0; k < 3; ++k) {
+			if (m_Region[m_Faces[f][k]] != r) return false;
+		}
+	}
+	return true;
+}//isInterior
+
+void QEMDecimator::pushEdges(int32_t V, bool RegionOnly, bool HigherOnly, std::vector<Edge>* pHeap)const {
+	if (RegionOnly && !m_Interior[V]) return;
+	thread_local std::vector<int32_t> N;
+	neighbours(V, &N);
+	for (int32_t c : N) {
+		if (HigherOnly && c < V) continue;
+		if (RegionOnly && (!m_Interior[c] || m_Region[c] != m_Region[V])) continue;
+		Candidate C;
+		if (!evaluate(V, c, &C)) continue;
+		Edge E;
+		E.Cost = C.Cost;
+		E.A = V;
+		E.B = c;
+		E.VersionA = m_Versions[V];
+		E.VersionB = m_Versions[c];
+		pHeap->push_back(E);
+	}
+}//pushEdges
+
+bool QEMDecimator::popValid(std::vector<Edge>* pHeap, bool RegionOnly, Candidate* pC)const {
+	while (!pHeap->empty()) {
+		std::pop_heap(pHeap->begin(), pHeap->end());
+		const Edge E = pHeap->back();
+		pHeap->pop_back();
+
+		// stale entries are skipped, the current version of the edge was pushed when it changed
+		if (!m_VertexAlive[E.A] || !m_VertexAlive[E.B]) continue;
+		if (m_Versions[E.A] != E.VersionA || m_Versions[E.B] != E.VersionB) continue;
+		if (RegionOnly && (!m_Interior[E.A] || !m_Interior[E.B] || m_Region[E.A] != m_Region[E.B])) continue;
+		if (!evaluate(E.A, E.B, pC) || !canCollapse(*pC)) continue;
+		return true;
+	}
+	return false;
+}//popValid
+
+void QEMDecimator::extract(uint32_t CollapseCount, T3DMesh<float>* pMesh)const {
+	if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+	if (nullptr == m_pMesh) throw CForgeExcept("Decimator was not initialized");
+	if (CollapseCount > m_Collapses.size()) throw IndexOutOfBoundsExcept("CollapseCount");
+
+	const T3DMesh<float>* pRef = m_pMesh;
+	const int32_t VertexCount = pRef->vertexCount();
+
+	// replay the collapse prefix on the original attributes
+	std::vector<Vector3f> Positions(VertexCount), Normals, Tangents, UVWs, Colors;
+	for (int32_t i = 0; i < VertexCount; ++i) Positions[i] = pRef->vertex(i);
+	if (pRef->normalCount() == uint32_t(VertexCount)) {
+		for (int32_t i = 0; i < VertexCount; ++i) Normals.push_back(pRef->normal(i));
+	}
+	if (pRef->tangentCount() == uint32_t(VertexCount)) {
+		for (int32_t i = 0; i < VertexCount; ++i) Tangents.push_back(pRef->tangent(i));
+	}
+	if (pRef->textureCoordinatesCount() == uint32_t(VertexCount)) {
+		for (int32_t i = 0; i < VertexCount; ++i) UVWs.push_back(pRef->textureCoordinate(i));
+	}
+	if (pRef->colorCount() == uint32_t(VertexCount)) {
+		for (int32_t i = 0; i < VertexCount; ++i) Colors.push_back(pRef->color(i));
+	}
+
+	std::vector<std::vector<std::pair<int32_t, float>>> Weights;
+	if (pRef->boneCount() > 0) {
+		Weights.resize(VertexCount);
+		for (uint32_t i = 0; i < pRef->boneCount(); ++i) {
+			const T3DMesh<float>::Bone* pBone = pRef->getBone(i);
+			for (size_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
+				const int32_t v = pBone->VertexInfluences[k];
+				if (v >= 0 && v < VertexCount) Weights[v].push_back(std::make_pair(int32_t(i), pBone->VertexWeights[k]));
+			}
+		}
+	}
+
+	std::vector<int32_t> Parent(VertexCount);
+	std::iota(Parent.begin(), Parent.end(), 0);
+	for (uint32_t i = 0; i < CollapseCount; ++i) {
+		const Collapse& C = m_Collapses[i];
+		const int32_t K = C.Kept;
+		const int32_t R = C.Removed;
+		Parent[R] = K;
+		Positions[K] = C.Position;
+		for (auto pChannel : { &Normals, &Tangents, &UVWs, &Colors }) {
+			if (!pChannel->empty()) (*pChannel)[K] = (1.0f - C.T) * (*pChannel)[K] + C.T * (*pChannel)[R];
+		}
+		if (!Weights.empty()) {
+			for (auto& w : Weights[K]) w.second *= (1.0f - C.T);
+			for (const auto& w : Weights[R]) {
+				auto itr = std::find_if(Weights[K].begin(), Weights[K].end(), [&](const std::pair<int32_t, float>& x) { return x.first == w.first; });
+				if (itr != Weights[K].end()) itr->second += C.T * w.second;
+				else Weights[K].push_back(std::make_pair(w.first, C.T * w.second));
+			}
+		}
+	}//for[collapses]
+
+	auto Root = [&](int32_t v) {
+		while (Parent[v] != v) {
+			Parent[v] = Parent[Parent[v]];
+			v = Parent[v];
+		}
+		return v;
+	};
+
+	pMesh->init(pRef);
+
+	std::vector<int32_t> NewIndex(VertexCount, -1);
+	std::vector<Vector3f> NewPositions, NewNormals, NewTangents, NewUVWs, NewColors;
+	std::vector<int32_t> Used;
+	for (uint32_t s = 0; s < pRef->submeshCount(); ++s) {
+		T3DMesh<float>::Submesh* pSubmesh = pMesh->getSubmesh(s);
+		pSubmesh->Faces.clear();
+		pSubmesh->FaceNormals.clear();
+		pSubmesh->FaceTangents.clear();
+
+		for (const auto& F : pRef->getSubmesh(s)->Faces) {
+			int32_t R[3];
+			for (uint8_t k = 0; k < 3; ++k) R[k] = Root(F.Vertices[k]);
+			if (R[0] == R[1] || R[1] == R[2] || R[0] == R[2]) continue; // collapsed
+
+			T3DMesh<float>::Face Face;
+			for (uint8_t k = 0; k < 3; ++k) {
+				if (NewIndex[R[k]] < 0) {
+					NewIndex[R[k]] = NewPositions.size();
+					Used.push_back(R[k]);
+					NewPositions.push_back(Positions[R[k]]);
+					if (!Normals.empty()) NewNormals.push_back(Normals[R[k]].normalized());
+					if (!Tangents.empty()) NewTangents.push_back(Tangents[R[k]].normalized());
+					if (!UVWs.empty()) NewUVWs.push_back(UVWs[R[k]]);
+					if (!Colors.empty()) NewColors.push_back(Colors[R[k]]);
+				}
+				Face.Vertices[k] = NewIndex[R[k]];
+			}
+			pSubmesh->Faces.push_back(Face);
+		}//for[faces]
+	}//for[submeshes]
+
+	pMesh->vertices(&NewPositions);
+	pMesh->normals(&NewNormals);
+	pMesh->tangents(&NewTangents);
+	pMesh->textureCoordinates(&NewUVWs);
+	pMesh->colors(&NewColors);
+
+	for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
+		pMesh->getBone(i)->VertexInfluences.clear();
+		pMesh->getBone(i)->VertexWeights.clear();
+	}
+	if (!Weights.empty()) {
+		for (int32_t v : Used) {
+			for (const auto& w : Weights[v]) {
+				if (w.second <= 0.0f) continue;
+				pMesh->getBone(w.first)->VertexInfluences.push_back(NewIndex[v]);
+				pMesh->getBone(w.first)->VertexWeights.push_back(w.second);
+			}
+		}
+	}
+
+	if (!NewPositions.empty()) pMesh->computeAxisAlignedBoundingBox();
+}//extract
+
+const std::vector<QEMDecimator::Collapse>& QEMDecimator::collapses(void)const {
+	return m_Collapses;
+}//collapses
+
+uint32_t QEMDecimator::faceCount(void)const {
+	return m_FaceCount;
+}//faceCount
+
+void QEMDecimator::generateLODs(const T3DMesh<float>* pMesh, std::vector<float>* pStages, std::vector<T3DMesh<float>*>* pLODMeshes) {
+	if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+	if (nullptr == pStages) throw NullpointerExcept("pStages");
+	if (nullptr == pLODMeshes) throw NullpointerExcept("pLODMeshes");
+	if (pStages->size() < 2) return;
+
+	QEMDecimator Decimator;
+	Decimator.init(pMesh);
+	const uint32_t FaceCount = Decimator.faceCount();
+
+	// one collapse sequence, each stage is a prefix of it
+	std::vector<uint32_t> Prefixes;
+	for (size_t i = 1; i < pStages->size(); ++i) {
+		if ((*pStages)[i] > (*pStages)[i - 1]) throw CForgeExcept("decimation stages are in wrong order");
+		const uint32_t Target = uint32_t(FaceCount * ((*pStages)[i] / (*pStages)[0]));
+		const size_t Before = Decimator.collapses().size();
+		const uint32_t Left = Decimator.decimate(Target);
+		if (Left == 0 || (Left > Target && Decimator.collapses().size() == Before)) break; // mesh can not get coarser
+		Prefixes.push_back(Decimator.collapses().size());
+	}
+
+	std::vector<T3DMesh<float>*> Meshes(Prefixes.size(), nullptr);
+	for (auto& i : Meshes) i = new T3DMesh<float>();
+	parallelFor(0, Prefixes.size(), [&](size_t Begin, size_t End) {
+		for (size_t i = Begin; i < End; ++i) Decimator.extract(Prefixes[i], Meshes[i]);
+	}, 1);
+
+	// a submesh that vanished ends the chain
+	size_t Levels = 0;
+	for (; Levels < Meshes.size(); ++Levels) {
+		bool Faceless = false;
+		for (uint32_t s = 0; s < Meshes[Levels]->submeshCount(); ++s) {
+			if (Meshes[Levels]->getSubmesh(s)->Faces.empty() && !pMesh->getSubmesh(s)->Faces.empty()) Faceless = true;
+		}
+		if (Faceless || Meshes[Levels]->vertexCount() < 3) break;
+	}
+	for (size_t i = Levels; i < Meshes.size(); ++i) delete Meshes[i];
+
+	pStages->erase(pStages->begin() + 1 + Levels, pStages->end());
+	pLODMeshes->insert(pLODMeshes->end(), Meshes.begin(), Meshes.begin() + Levels);
+}//generateLODs
+
+}//CForge
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <crossforge/AssetIO/T3DMesh.hpp>
+
+namespace CForge {
+	/**
+	* Quadric error metric edge collapse decimation (Garland and Heckbert 1997) for LOD chains.
+	* All levels come from one progressive collapse sequence, a level is the mesh after a prefix of collapses(),
+	* so decimate can be called with decreasing targets and every level is extracted from the same record.
+	* Vertices are split into spatial regions, edges inside one region are collapsed in parallel with a priority queue
+	* per region, edges crossing regions afterwards with a global queue.
+	* Skin weights, UVs, normals, tangents and colors of a collapsed vertex pair are interpolated along the edge.
+	* Open boundaries and submesh borders are constrained, vertices sharing their position with another vertex
+	* (attribute seams) keep their position and are never removed, so seams stay closed.
+	*/
+	class QEMDecimator {
+	public:
+		struct Collapse {
+			int32_t Kept;				///< Vertex that stays and moves to Position.
+			int32_t Removed;			///< Vertex merged into Kept.
+			float T;					///< Attributes of Kept become (1-T)*Kept + T*Removed.
+			Eigen::Vector3f Position;
+		};
+
+		QEMDecimator(void);
+		~QEMDecimator(void);
+
+		/**
+		* @param pMesh - has to stay alive while levels are extracted
+		*/
+		void init(const T3DMesh<float>* pMesh);
+		void clear(void);
+
+		/**
+		* continues collapsing until at most TargetFaces faces remain or no valid collapse is left
+		* @return number of faces left
+		*/
+		uint32_t decimate(uint32_t TargetFaces);
+
+		/**
+		* builds the mesh after the first CollapseCount collapses, including skeleton, animations and materials
+		*/
+		void extract(uint32_t CollapseCount, T3DMesh<float>* pMesh)const;
+
+		const std::vector<Collapse>& collapses(void)const;
+		uint32_t faceCount(void)const;
+
+		/**
+		* generates a LOD chain in one pass
+		* @param in/out pStages - face amount of each level relative to pMesh (first entry is pMesh itself), stages where decimation failed get removed
+		* @param out pLODMeshes - receives one mesh per remaining stage except the first
+		*/
+		static void generateLODs(const T3DMesh<float>* pMesh, std::vector<float>* pStages, std::vector<T3DMesh<float>*>* pLODMeshes);
+
+	private:
+		struct Quadric {
+			double A[10]; // upper triangle of the symmetric 4x4 matrix, row major
+
+			void clear(void);
+			void plane(const Eigen::Vector3d& N, double D, double Weight);
+			void add(const Quadric& Q);
+			double error(const Eigen::Vector3d& P)const;
+			bool optimum(Eigen::Vector3d* pP)const;
+		};
+
+		struct Edge {
+			double Cost;
+			int32_t A;
+			int32_t B;
+			uint32_t VersionA;
+			uint32_t VersionB;
+
+			bool operator<(const Edge& Other)const { return Cost > Other.Cost; } // std heaps are max heaps
+		};
+
+		struct Candidate {
+			int32_t Kept;
+			int32_t Removed;
+			Eigen::Vector3d Position;
+			float T;
+			double Cost;
+		};
+
+		uint32_t decimateGlobal(uint32_t TargetFaces);
+		bool evaluate(int32_t A, int32_t B, Candidate* pC)const;
+		bool canCollapse(const Candidate& C)const;
+		void collapse(const Candidate& C, std::vector<Collapse>* pRecord, uint32_t* pRemovedFaces);
+		void neighbours(int32_t V, std::vector<int32_t>* pN)const;
+		bool isBoundary(int32_t V)const;
+		bool isInterior(int32_t V)const;
+		void pushEdges(int32_t V, bool RegionOnly, bool HigherOnly, std::vector<Edge>* pHeap)const;
+		bool popValid(std::vector<Edge>* pHeap, bool RegionOnly, Candidate* pC)const;
+
+		const T3DMesh<float>* m_pMesh;
+		std::vector<Eigen::Vector3d> m_Positions;
+		std::vector<Quadric> m_Quadrics;
+		std::vector<uint32_t> m_Versions;
+		std::vector<uint8_t> m_VertexAlive;
+		std::vector<uint8_t> m_Locked;					///< Seam vertices.
+		std::vector<std::vector<int32_t>> m_VertexFaces;
+		std::vector<Eigen::Vector3i> m_Faces;
+		std::vector<int32_t> m_FaceSubmesh;
+		std::vector<uint8_t> m_FaceAlive;
+		uint32_t m_FaceCount;
+
+		std::vector<int32_t> m_Region;
+		std::vector<uint8_t> m_Interior;				///< All faces of the vertex lie in its region.
+		std::vector<std::vector<Edge>> m_RegionHeaps;
+		std::vector<Edge> m_Heap;						///< All edges, used for edges crossing regions.
+
+		std::vector<Collapse> m_Collapses;
+
+		static constexpr double m_BoundaryWeight = 100.0;
+		static constexpr double m_MinNormalDot = 0.2;		///< Cosine between old and new face normal, smaller is a flip.
+		static constexpr double m_GlobalShare = 0.25;		///< Part of each level's reduction left to the global queue.
+		static const uint32_t m_MinRegionVertices = 4096;
+		static const uint32_t m_MinRegionFaces = 8192;		///< Smaller levels are decimated with the global queue only.
+	};
+}
@@ -0,0 +1,353 @@
+#include "FootCleanup.hpp"
+
+#include <algorithm>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace {
+	using Quats = Array<float,4,Dynamic,RowMajor>; // x,y,z,w rows, one column per frame
+	using Points = FootCleanup::Points;
+
+	Points cross(const Points& a, const Points& b) {
+		Points r(3,a.cols());
+		r.row(0) = a.row(1)*b.row(2) - a.row(2)*b.row(1);
+		r.row(1) = a.row(2)*b.row(0) - a.row(0)*b.row(2);
+		r.row(2) = a.row(0)*b.row(1) - a.row(1)*b.row(0);
+		return r;
+	}
+
+	Quats qmul(const Quats& a, const Quats& b) {
+		Quats r(4,a.cols());
+		r.row(0) = a.row(3)*b.row(0) + a.row(0)*b.row(3) + a.row(1)*b.row(2) - a.row(2)*b.row(1);
+		r.row(1) = a.row(3)*b.row(1) - a.row(0)*b.row(2) + a.row(1)*b.row(3) + a.row(2)*b.row(0);
+		r.row(2) = a.row(3)*b.row(2) + a.row(0)*b.row(1) - a.row(1)*b.row(0) + a.row(2)*b.row(3);
+		r.row(3) = a.row(3)*b.row(3) - a.row(0)*b.row(0) - a.row(1)*b.row(1) - a.row(2)*b.row(2);
+		const Array<float,1,Dynamic> invLen = r.square().colwise().sum().rsqrt();
+		return r.rowwise() * invLen;
+	}
+
+	// v + 2w(q x v) + 2 q x (q x v)
+	Points qrot(const Quats& q, const Points& v) {
+		const Points qv = q.topRows<3>();
+		const Points t = 2.f * cross(qv,v);
+		return v + t.rowwise() * q.row(3) + cross(qv,t);
+	}
+
+	const std::vector<float>* keyframeTimes(T3DMesh<float>::SkeletalAnimation* pAnim) {
+		// SkeletalPoseController::addAnimationData resamples all joints onto the same timestamps
+		const std::vector<float>* pTimes = nullptr;
+		for (auto* pK : pAnim->Keyframes) {
+			if (!pK->BoneName.empty() && (!pTimes || pK->Timestamps.size() > pTimes->size()))
+				pTimes = &pK->Timestamps;
+		}
+		return pTimes;
+	}
+
+	bool hasKeyframe(T3DMesh<float>::SkeletalAnimation* pAnim, int32_t joint, int32_t frame) {
+		return joint < pAnim->Keyframes.size() && !pAnim->Keyframes[joint]->BoneName.empty()
+			&& frame < pAnim->Keyframes[joint]->Rotations.size();
+	}
+}
+
+FootCleanup::Result FootCleanup::process(IKController* pController, int32_t animationID, const Config& config) {
+	if (!pController)
+		throw NullpointerExcept("pController");
+	m_config = config;
+	m_config.up.normalize();
+	const Vector3f& up = m_config.up;
+
+	T3DMesh<float>::SkeletalAnimation* pAnim = pController->animation(animationID);
+	const std::vector<float>* pTimes = keyframeTimes(pAnim);
+	Result res;
+	if (!pTimes || pTimes->empty())
+		return res;
+	const std::vector<float> times = *pTimes;
+	const int32_t frames = times.size();
+	res.frames = frames;
+
+	// contact speeds are per second, keyframe timestamps are in ticks of the source
+	std::vector<float> seconds(times);
+	for (float& t : seconds)
+		t /= pController->ticksPerSecond(animationID);
+
+	m_chains.clear();
+	for (const std::string& name : m_config.footChains) {
+		IKChain* pChain = pController->getIKChain(name);
+		if (!pChain)
+			throw CForgeExcept("FootCleanup: chain not found: " + name);
+		if (pChain->joints.size() < 2)
+			throw CForgeExcept("FootCleanup: chain " + name + " needs at least 2 joints");
+		if (!pChain->ikSolver)
+			throw CForgeExcept("FootCleanup: chain " + name + " has no IK solver");
+		m_chains.push_back(pChain);
+	}
+
+	// keep controller state, restored at the end
+	m_restPose.clear();
+	for (uint32_t i = 0; i < pController->boneCount(); ++i) {
+		const SkeletalPoseController::SkeletalJoint* pJ = pController->getBone(i);
+		m_restPose.push_back(LocalPose{ pJ->LocalPosition, pJ->LocalRotation, pJ->LocalScale });
+	}
+	std::vector<Vector3f> targetPos;
+	for (auto& t : pController->m_targets)
+		targetPos.push_back(t->pos);
+
+	std::vector<Points> footPos;
+	sweepFeet(pController,pAnim,frames,&footPos);
+
+	// per foot lock target and blend weight of every frame
+	std::vector<Points> lockPos(m_chains.size());
+	std::vector<ArrayXf> weight(m_chains.size());
+	res.contacts.resize(m_chains.size());
+	for (uint32_t c = 0; c < m_chains.size(); ++c) {
+		float legLength = 0.f;
+		for (uint32_t j = 0; j + 1 < m_chains[c]->joints.size(); ++j)
+			legLength += m_chains[c]->joints[j]->LocalPosition.norm();
+
+		const float ground = m_config.autoGround ? (up.transpose() * footPos[c].matrix()).minCoeff() : m_config.groundHeight;
+		detectContacts(footPos[c],seconds,legLength,ground,&res.contacts[c]);
+		res.maxSlideBefore = std::max(res.maxSlideBefore,maxSlide(footPos[c],res.contacts[c]));
+
+		lockPos[c] = footPos[c];
+		weight[c] = ArrayXf::Zero(frames);
+		for (const Contact& ct : res.contacts[c]) {
+			const int32_t b = std::max(0,ct.begin - m_config.blendFrames);
+			const int32_t e = std::min(frames,ct.end + m_config.blendFrames);
+			for (int32_t k = b; k < e; ++k) {
+				float w = 1.f;
+				if (k < ct.begin)
+					w = 1.f - float(ct.begin - k) / (m_config.blendFrames + 1);
+				else if (k >= ct.end)
+					w = 1.f - float(k - ct.end + 1) / (m_config.blendFrames + 1);
+				if (w > weight[c][k]) {
+					weight[c][k] = w;
+					lockPos[c].col(k) = ct.lockPos;
+				}
+			}
+		}
+	}
+
+	// chains without target get a temporary one for the solver
+	std::vector<std::shared_ptr<IKTarget>> tempTargets;
+	for (IKChain* pChain : m_chains) {
+		if (pChain->target.expired()) {
+			tempTargets.push_back(std::make_shared<IKTarget>(pChain->name + " cleanup target",BoundingVolume()));
+			pChain->target = tempTargets.back();
+		}
+		for (auto* pJ : pChain->joints)
+			ensureKeyframes(pAnim,pJ,times);
+	}
+	// solvers may translate the root, its keyframes receive the solved position
+	ensureKeyframes(pAnim,pController->getRoot(),times);
+
+	for (int32_t k = 0; k < frames; ++k) {
+		bool affected = false;
+		for (uint32_t c = 0; c < m_chains.size(); ++c)
+			affected |= weight[c][k] > 0.f;
+		if (!affected)
+			continue;
+
+		setFramePose(pController,pAnim,k);
+		pController->forwardKinematics();
+		for (uint32_t c = 0; c < m_chains.size(); ++c) {
+			const float w = weight[c][k];
+			if (w <= 0.f)
+				continue;
+			IKChain* pChain = m_chains[c];
+			pChain->target.lock()->pos = (1.f - w) * footPos[c].col(k).matrix() + w * lockPos[c].col(k).matrix();
+			pChain->ikSolver->solve(pChain->name,pController);
+			pController->forwardKinematics();
+
+			for (auto* pJ : pChain->joints)
+				writeKeyframe(pAnim,pJ,k);
+		}
+		writeKeyframe(pAnim,pController->getRoot(),k);
+		res.solvedFrames++;
+	}
+
+	for (IKChain* pChain : m_chains) {
+		for (auto& t : tempTargets) {
+			if (pChain->target.lock() == t)
+				pChain->target.reset();
+		}
+	}
+
+	sweepFeet(pController,pAnim,frames,&footPos);
+	for (uint32_t c = 0; c < m_chains.size(); ++c)
+		res.maxSlideAfter = std::max(res.maxSlideAfter,maxSlide(footPos[c],res.contacts[c]));
+
+	for (uint32_t i = 0; i < pController->boneCount(); ++i) {
+		SkeletalPoseController::SkeletalJoint* pJ = pController->getBone(i);
+		pJ->LocalPosition = m_restPose[i].pos;
+		pJ->LocalRotation = m_restPose[i].rot;
+		pJ->LocalScale = m_restPose[i].scale;
+	}
+	pController->forwardKinematics();
+	for (uint32_t i = 0; i < targetPos.size(); ++i)
+		pController->m_targets[i]->pos = targetPos[i];
+
+	return res;
+}//process
+
+void FootCleanup::sweepFeet(IKController* pController, T3DMesh<float>::SkeletalAnimation* pAnim, int32_t frames,
+		std::vector<Points>* pFootPos) {
+	const int32_t J = pController->boneCount();
+
+	// only ancestors of the feet are needed
+	std::vector<bool> needed(J,false);
+	for (IKChain* pChain : m_chains) {
+		for (int32_t j = pChain->joints[0]->ID; j != -1 && !needed[j]; j = pController->getBone(j)->Parent)
+			needed[j] = true;
+	}
+	std::vector<int32_t> order = { pController->getRoot()->ID };
+	for (uint32_t i = 0; i < order.size(); ++i) {
+		for (int32_t c : pController->getBone(order[i])->Children) {
+			if (needed[c])
+				order.push_back(c);
+		}
+	}
+
+	// same convention as IKController::forwardKinematics, scale is ignored
+	std::vector<Points> pos(J);
+	std::vector<Quats> rot(J);
+	for (int32_t j : order) {
+		Points lp(3,frames);
+		Quats lr(4,frames);
+		for (int32_t k = 0; k < frames; ++k) {
+			const bool key = hasKeyframe(pAnim,j,k);
+			lp.col(k) = key ? pAnim->Keyframes[j]->Positions[k] : m_restPose[j].pos;
+			lr.col(k) = key ? pAnim->Keyframes[j]->Rotations[k].coeffs() : m_restPose[j].rot.coeffs();
+		}
+
+		const int32_t p = pController->getBone(j)->Parent;
+		if (p == -1 || j == pController->getRoot()->ID) {
+			pos[j] = lp;
+			rot[j] = lr.rowwise() * lr.square().colwise().sum().rsqrt();
+		}
+		else {
+			pos[j] = qrot(rot[p],lp) + pos[p];
+			rot[j] = qmul(rot[p],lr);
+		}
+	}
+
+	pFootPos->clear();
+	for (IKChain* pChain : m_chains)
+		pFootPos->push_back(pos[pChain->joints[0]->ID]);
+}//sweepFeet
+
+void FootCleanup::detectContacts(const Points& footPos, const std::vector<float>& times, float legLength, float ground,
+		std::vector<Contact>* pContacts) {
+	const int32_t F = footPos.cols();
+	const Vector3f& up = m_config.up;
+	pContacts->clear();
+
+	const Array<float,1,Dynamic> height = (up.transpose() * footPos.matrix()).array() - ground;
+
+	// central differences, one sided at clip borders
+	Points vel = Points::Zero(3,F);
+	if (F > 1) {
+		const Map<const Array<float,1,Dynamic>> t(times.data(),F);
+		Array<float,1,Dynamic> dt(F);
+		dt[0] = t[1] - t[0];
+		dt[F-1] = t[F-1] - t[F-2];
+		vel.col(0) = footPos.col(1) - footPos.col(0);
+		vel.col(F-1) = footPos.col(F-1) - footPos.col(F-2);
+		if (F > 2) {
+			dt.segment(1,F-2) = t.tail(F-2) - t.head(F-2);
+			vel.middleCols(1,F-2) = footPos.rightCols(F-2) - footPos.leftCols(F-2);
+		}
+		vel = vel.rowwise() / dt.max(1e-6f);
+	}
+	const Array<float,1,Dynamic> vUp = (up.transpose() * vel.matrix()).array();
+	const Points vHor = vel - (up.array().replicate(1,F).rowwise() * vUp);
+	const Array<float,1,Dynamic> speed = vHor.square().colwise().sum().sqrt();
+
+	const float hEnter = m_config.heightEnter * legLength, hExit = m_config.heightExit * legLength;
+	const float sEnter = m_config.speedEnter * legLength, sExit = m_config.speedExit * legLength;
+
+	bool inContact = false;
+	int32_t begin = 0;
+	auto closeContact = [&](int32_t end) {
+		if (end - begin < m_config.minContactFrames)
+			return;
+		Contact c;
+		c.begin = begin;
+		c.end = end;
+		c.lockPos = footPos.middleCols(begin,end - begin).rowwise().mean();
+		if (m_config.snapToGround)
+			c.lockPos += up * (ground - up.dot(c.lockPos));
+		pContacts->push_back(c);
+	};
+	for (int32_t k = 0; k < F; ++k) {
+		if (!inContact && height[k] < hEnter && speed[k] < sEnter) {
+			inContact = true;
+			begin = k;
+		}
+		else if (inContact && (height[k] > hExit || speed[k] > sExit)) {
+			inContact = false;
+			closeContact(k);
+		}
+	}
+	if (inContact)
+		closeContact(F);
+}//detectContacts
+
+float FootCleanup::maxSlide(const Points& footPos, const std::vector<Contact>& contacts) {
+	const Vector3f& up = m_config.up;
+	float ret = 0.f;
+	for (const Contact& c : contacts) {
+		for (int32_t k = c.begin; k < c.end; ++k) {
+			Vector3f d = footPos.col(k).matrix() - c.lockPos;
+			d -= up * up.dot(d);
+			ret = std::max(ret,d.norm());
+		}
+	}
+	return ret;
+}//maxSlide
+
+void FootCleanup::ensureKeyframes(T3DMesh<float>::SkeletalAnimation* pAnim, SkeletalPoseController::SkeletalJoint* pJoint,
+		const std::vector<float>& times) {
+	const int32_t j = pJoint->ID;
+	while (pAnim->Keyframes.size() <= j)
+		pAnim->Keyframes.push_back(new T3DMesh<float>::BoneKeyframes());
+
+	T3DMesh<float>::BoneKeyframes* pK = pAnim->Keyframes[j];
+	if (!pK->BoneName.empty() && pK->Rotations.size() >= times.size())
+		return;
+
+	// joint was not animated, hold its pose over the clip
+	pK->BoneName = pJoint->Name;
+	pK->BoneID = j;
+	pK->Timestamps = times;
+	pK->Positions.assign(times.size(),m_restPose[j].pos);
+	pK->Rotations.assign(times.size(),m_restPose[j].rot);
+	pK->Scalings.assign(times.size(),m_restPose[j].scale);
+}//ensureKeyframes
+
+void FootCleanup::writeKeyframe(T3DMesh<float>::SkeletalAnimation* pAnim, SkeletalPoseController::SkeletalJoint* pJoint, int32_t frame) {
+	T3DMesh<float>::BoneKeyframes* pK = pAnim->Keyframes[pJoint->ID];
+	if (frame < pK->Positions.size())
+		pK->Positions[frame] = pJoint->LocalPosition;
+	pK->Rotations[frame] = pJoint->LocalRotation;
+	if (frame < pK->Scalings.size())
+		pK->Scalings[frame] = pJoint->LocalScale;
+}//writeKeyframe
+
+void FootCleanup::setFramePose(IKController* pController, T3DMesh<float>::SkeletalAnimation* pAnim, int32_t frame) {
+	for (uint32_t j = 0; j < pController->boneCount(); ++j) {
+		SkeletalPoseController::SkeletalJoint* pJ = pController->getBone(j);
+		if (hasKeyframe(pAnim,j,frame)) {
+			pJ->LocalPosition = pAnim->Keyframes[j]->Positions[frame];
+			pJ->LocalRotation = pAnim->Keyframes[j]->Rotations[frame];
+			pJ->LocalScale = pAnim->Keyframes[j]->Scalings[frame];
+		}
+		else {
+			pJ->LocalPosition = m_restPose[j].pos;
+			pJ->LocalRotation = m_restPose[j].rot;
+			pJ->LocalScale = m_restPose[j].scale;
+		}
+	}
+}//setFramePose
+
+}//CForge
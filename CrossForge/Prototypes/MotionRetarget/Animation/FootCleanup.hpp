@@ -0,0 +1,87 @@
+#pragma once
+
+#include <Prototypes/MotionRetarget/IK/IKController.hpp>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Offline foot skate cleanup of a whole clip.
+ *        Foot positions of all frames are computed in one sweep over the joint hierarchy,
+ *        vectorized over frames. Contacts are detected with hysteresis on foot height and
+ *        horizontal speed, the feet are locked during contacts and the leg chain IK is solved
+ *        only on affected frames. The solved local poses of the leg chains and the root (position,
+ *        rotation and scale) are written back into the keyframes of the controllers animation,
+ *        so playback and export pick them up.
+ *        Thresholds are relative to the length of the leg chain and therefore independent of skeleton scale.
+*/
+class FootCleanup {
+public:
+	using Points = Array<float,3,Dynamic,RowMajor>; // one column per frame
+
+	struct Config {
+		std::vector<std::string> footChains; // IKChain names, front() joint of each is the foot
+		Vector3f up = Vector3f::UnitY();
+		bool autoGround = true;        // ground height per foot is its lowest point in the clip
+		float groundHeight = 0.f;      // used if !autoGround
+		bool snapToGround = true;      // locked height is ground height instead of mean contact height
+
+		// hysteresis, contact starts if height and speed are below the enter thresholds
+		// and ends if either exceeds its exit threshold. Heights in leg lengths, speeds in leg lengths per second.
+		float heightEnter = 0.05f;
+		float heightExit = 0.08f;
+		float speedEnter = 0.3f;
+		float speedExit = 0.6f;
+
+		int32_t minContactFrames = 3;  // shorter contacts are ignored
+		int32_t blendFrames = 4;       // frames to ease the lock in and out around a contact
+	};
+
+	struct Contact {
+		int32_t begin, end; // frame range [begin,end)
+		Vector3f lockPos;   // controller space foot position during contact
+	};
+
+	struct Result {
+		std::vector<std::vector<Contact>> contacts; // per foot chain
+		int32_t frames = 0;
+		int32_t solvedFrames = 0;       // frames on which any leg chain was solved
+		float maxSlideBefore = 0.f;     // max horizontal distance of a foot from its lock position during contacts
+		float maxSlideAfter = 0.f;
+	};
+
+	/**
+	 * @brief cleans up animation animationID of pController in place.
+	 *        Pose and target positions of the controller are restored afterwards.
+	*/
+	Result process(IKController* pController, int32_t animationID, const Config& config);
+
+private:
+	/**
+	 * @brief global positions of the foot joints over all frames, one 3 x frames matrix per foot.
+	*/
+	void sweepFeet(IKController* pController, T3DMesh<float>::SkeletalAnimation* pAnim, int32_t frames,
+		std::vector<Points>* pFootPos);
+	void detectContacts(const Points& footPos, const std::vector<float>& times, float legLength, float ground,
+		std::vector<Contact>* pContacts);
+	float maxSlide(const Points& footPos, const std::vector<Contact>& contacts);
+	void ensureKeyframes(T3DMesh<float>::SkeletalAnimation* pAnim, SkeletalPoseController::SkeletalJoint* pJoint,
+		const std::vector<float>& times);
+	/**
+	 * @brief writes the local position, rotation and scale of pJoint into its keyframe at frame.
+	*/
+	void writeKeyframe(T3DMesh<float>::SkeletalAnimation* pAnim, SkeletalPoseController::SkeletalJoint* pJoint, int32_t frame);
+	void setFramePose(IKController* pController, T3DMesh<float>::SkeletalAnimation* pAnim, int32_t frame);
+
+	struct LocalPose {
+		Vector3f pos;
+		Quaternionf rot;
+		Vector3f scale;
+	};
+
+	Config m_config;
+	std::vector<IKChain*> m_chains;
+	std::vector<LocalPose> m_restPose; // controller pose before processing, used for joints without keyframes
+};//FootCleanup
+
+}//CForge
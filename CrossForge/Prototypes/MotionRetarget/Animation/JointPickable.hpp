@@ -1,6 +1,6 @@
 #pragma once
 
-#include <crossforge/Graphics/Controller/SkeletalAnimationController.h>
+#include <crossforge/Graphics/Controller/SkeletalPoseController.h>
 
 #include <Prototypes/MotionRetarget/CMN/Picking.hpp>
 
@@ -33,7 +33,7 @@ public:
 	void update(Matrix4f sgnT);
 	void render(RenderDevice* pRD);
 
-	JointPickable(JointPickableMesh* pMesh, SkeletalAnimationController::SkeletalJoint* pJoint, IKController* pIKC)
+	JointPickable(JointPickableMesh* pMesh, SkeletalPoseController::SkeletalJoint* pJoint, IKController* pIKC)
 	              : m_pJPMesh(pMesh), m_pJoint(pJoint), m_pIKC(pIKC) {};
 
 	void pckMove(const Matrix4f& trans);
@@ -65,7 +65,7 @@ public:
 
 	Vector4f colorSelect = Vector4f(227./255,142./255,48./255,1.);
 	Vector4f colorSelect0 = Vector4f(227./255,142./255,48./255,1.); // standard color for reset
-	SkeletalAnimationController::SkeletalJoint* m_pJoint;
+	SkeletalPoseController::SkeletalJoint* m_pJoint;
 private:
 	Matrix4f m_transform; // global space transform of joint
 	Matrix4f m_transformGuizmo; // global space transform of joint
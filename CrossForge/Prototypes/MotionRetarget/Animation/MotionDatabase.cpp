@@ -0,0 +1,411 @@
+#include "MotionDatabase.hpp"
+
+#include <crossforge/Math/CForgeMath.h>
+
+#include <algorithm>
+
+namespace CForge {
+using namespace Eigen;
+
+void MotionDatabase::clear() {
+	m_dim = 0;
+	m_root = -1;
+	m_effectors.clear();
+	m_effectorNames.clear();
+	m_jointOrder.clear();
+	m_features.clear();
+	m_rows.clear();
+	m_mean.clear();
+	m_scale.clear();
+	m_nodes.clear();
+}//clear
+
+void MotionDatabase::build(SkeletalPoseController* pController, const Config& config) {
+	if (!pController)
+		throw NullpointerExcept("pController");
+	clear();
+	m_config = config;
+	m_config.leafSize = std::max(1,m_config.leafSize);
+
+	std::vector<SkeletalPoseController::SkeletalJoint*> skeleton = pController->retrieveSkeleton();
+	if (skeleton.empty())
+		throw CForgeExcept("MotionDatabase: controller has no skeleton");
+
+	auto findJoint = [&](const std::string& name) {
+		for (auto* pJ : skeleton) {
+			if (pJ->Name == name)
+				return pJ->ID;
+		}
+		return -1;
+	};
+
+	// joint order with parents before children, starting at every root
+	for (auto* pJ : skeleton) {
+		if (pJ->Parent == -1)
+			m_jointOrder.push_back(pJ->ID);
+	}
+	for (uint32_t i = 0; i < m_jointOrder.size(); ++i) {
+		for (int32_t c : skeleton[m_jointOrder[i]]->Children)
+			m_jointOrder.push_back(c);
+	}
+
+	m_root = m_config.rootJoint.empty() ? m_jointOrder[0] : findJoint(m_config.rootJoint);
+	if (m_root < 0)
+		throw CForgeExcept("MotionDatabase: root joint not found: " + m_config.rootJoint);
+
+	if (m_config.effectors.empty()) {
+		for (auto* pJ : skeleton) {
+			if (pJ->Children.empty() && pJ->ID != m_root)
+				m_effectors.push_back(pJ->ID);
+		}
+	}
+	else {
+		for (const std::string& name : m_config.effectors) {
+			int32_t id = findJoint(name);
+			if (id < 0)
+				throw CForgeExcept("MotionDatabase: effector not found: " + name);
+			m_effectors.push_back(id);
+		}
+	}
+	for (int32_t e : m_effectors)
+		m_effectorNames.push_back(skeleton[e]->Name);
+
+	m_dim = m_effectors.size() * 6 + m_config.trajectoryTimes.size() * 4;
+
+	std::vector<float> raw;
+	for (uint32_t a = 0; a < pController->animationCount(); ++a)
+		sampleAnimation(a,pController->animation(a),pController->ticksPerSecond(a),skeleton,&raw);
+
+	for (auto* pJ : skeleton)
+		delete pJ;
+
+	if (m_rows.empty() || m_dim == 0)
+		return;
+
+	normalize(&raw);
+
+	// tree over permutation, rows are then reordered so every node covers a contiguous block
+	std::vector<int32_t> perm(m_rows.size());
+	for (uint32_t i = 0; i < perm.size(); ++i)
+		perm[i] = i;
+	m_nodes.reserve(2 * m_rows.size() / m_config.leafSize + 1);
+	buildNode(&perm,raw,0,perm.size());
+
+	m_features.resize(raw.size());
+	std::vector<Row> rows(m_rows.size());
+	for (uint32_t i = 0; i < perm.size(); ++i) {
+		std::copy_n(&raw[size_t(perm[i]) * m_dim],m_dim,&m_features[size_t(i) * m_dim]);
+		rows[i] = m_rows[perm[i]];
+	}
+	m_rows = std::move(rows);
+}//build
+
+Matrix4f MotionDatabase::characterSpace(const Matrix4f& rootGlobal) const {
+	const Vector3f up = m_config.up.normalized();
+	Vector3f p = rootGlobal.block<3,1>(0,3);
+	p -= up * p.dot(up);
+
+	Vector3f f = rootGlobal.block<3,3>(0,0) * m_config.forward;
+	f -= up * f.dot(up);
+	if (f.squaredNorm() < 1e-12f) {
+		// root faces straight up or down, keep any ground plane direction
+		f = up.unitOrthogonal();
+	}
+	f.normalize();
+	const Vector3f r = up.cross(f);
+
+	Matrix3f R;
+	R.col(0) = r;
+	R.col(1) = up;
+	R.col(2) = f;
+
+	Matrix4f ret = Matrix4f::Identity();
+	ret.block<3,3>(0,0) = R.transpose();
+	ret.block<3,1>(0,3) = -R.transpose() * p;
+	return ret;
+}//characterSpace
+
+void MotionDatabase::sampleAnimation(int32_t animID, T3DMesh<float>::SkeletalAnimation* pAnim, float ticksPerSecond,
+		const std::vector<SkeletalPoseController::SkeletalJoint*>& skeleton, std::vector<float>* pRaw) {
+	// SkeletalPoseController::addAnimationData resamples all keyframes of a joint onto the same timestamps
+	const std::vector<float>* pTimes = nullptr;
+	for (auto* pK : pAnim->Keyframes) {
+		if (!pK->BoneName.empty() && (!pTimes || pK->Timestamps.size() > pTimes->size()))
+			pTimes = &pK->Timestamps;
+	}
+	if (!pTimes || pTimes->empty())
+		return;
+	// timestamps are in ticks or frames of the source, trajectory times and velocities are in seconds
+	std::vector<float> times(pTimes->size());
+	for (size_t i = 0; i < times.size(); ++i)
+		times[i] = (*pTimes)[i] / ticksPerSecond;
+	const int32_t frames = times.size();
+	const int32_t E = m_effectors.size();
+
+	// global pose of every frame
+	std::vector<Matrix4f> charSpace(frames);
+	std::vector<Vector3f> effectorPos(size_t(frames) * E);
+	std::vector<Vector3f> rootPos(frames), rootDir(frames);
+	std::vector<Matrix4f> global(skeleton.size());
+	for (int32_t k = 0; k < frames; ++k) {
+		for (int32_t j : m_jointOrder) {
+			const SkeletalPoseController::SkeletalJoint* pJ = skeleton[j];
+			Vector3f pos = pJ->LocalPosition;
+			Quaternionf rot = pJ->LocalRotation;
+			Vector3f scale = pJ->LocalScale;
+			if (size_t(j) < pAnim->Keyframes.size()) {
+				const T3DMesh<float>::BoneKeyframes* pK = pAnim->Keyframes[j];
+				if (!pK->BoneName.empty() && size_t(k) < pK->Positions.size()) {
+					pos = pK->Positions[k];
+					rot = pK->Rotations[k];
+					scale = pK->Scalings[k];
+				}
+			}
+			const Matrix4f local = CForgeMath::translationMatrix(pos) * CForgeMath::rotationMatrix(rot) * CForgeMath::scaleMatrix(scale);
+			global[j] = (pJ->Parent == -1) ? local : global[pJ->Parent] * local;
+		}
+
+		charSpace[k] = characterSpace(global[m_root]);
+		const Matrix4f worldFromChar = charSpace[k].inverse();
+		rootPos[k] = worldFromChar.block<3,1>(0,3);
+		rootDir[k] = worldFromChar.block<3,1>(0,2);
+		for (int32_t e = 0; e < E; ++e)
+			effectorPos[size_t(k) * E + e] = global[m_effectors[e]].block<3,1>(0,3);
+	}
+
+	const size_t first = pRaw->size();
+	pRaw->resize(first + size_t(frames) * m_dim);
+	for (int32_t k = 0; k < frames; ++k) {
+		const Matrix3f R = charSpace[k].block<3,3>(0,0);
+		const Vector3f t = charSpace[k].block<3,1>(0,3);
+		float* pF = &(*pRaw)[first + size_t(k) * m_dim];
+
+		// central differences, one sided at clip borders
+		const int32_t k0 = std::max(0,k-1);
+		const int32_t k1 = std::min(frames-1,k+1);
+		const float dt = times[k1] - times[k0];
+
+		for (int32_t e = 0; e < E; ++e) {
+			const Vector3f p = R * effectorPos[size_t(k) * E + e] + t;
+			Vector3f v = Vector3f::Zero();
+			if (dt > 0.f)
+				v = R * (effectorPos[size_t(k1) * E + e] - effectorPos[size_t(k0) * E + e]) / dt;
+			for (int32_t i = 0; i < 3; ++i) {
+				pF[e*3 + i] = p[i];
+				pF[E*3 + e*3 + i] = v[i];
+			}
+		}
+
+		float* pT = pF + E*6;
+		for (uint32_t s = 0; s < m_config.trajectoryTimes.size(); ++s) {
+			// first frame at or after the sample time, clamped to the end of the clip
+			auto it = std::lower_bound(times.begin() + k,times.end(),times[k] + m_config.trajectoryTimes[s]);
+			const int32_t m = std::min<int32_t>(frames-1,it - times.begin());
+			const Vector3f p = R * rootPos[m] + t;
+			const Vector3f d = R * rootDir[m];
+			pT[s*2 + 0] = p.x();
+			pT[s*2 + 1] = p.z();
+			pT[m_config.trajectoryTimes.size()*2 + s*2 + 0] = d.x();
+			pT[m_config.trajectoryTimes.size()*2 + s*2 + 1] = d.z();
+		}
+
+		m_rows.push_back(Row{ animID, k, times[k] });
+	}
+}//sampleAnimation
+
+void MotionDatabase::normalize(std::vector<float>* pRaw) {
+	const size_t N = m_rows.size();
+	const int32_t E = m_effectors.size();
+	const int32_t T = m_config.trajectoryTimes.size();
+
+	std::vector<double> mean(m_dim,0.), var(m_dim,0.);
+	for (size_t r = 0; r < N; ++r) {
+		for (int32_t d = 0; d < m_dim; ++d)
+			mean[d] += (*pRaw)[r*m_dim + d];
+	}
+	for (int32_t d = 0; d < m_dim; ++d)
+		mean[d] /= N;
+	for (size_t r = 0; r < N; ++r) {
+		for (int32_t d = 0; d < m_dim; ++d) {
+			const double x = (*pRaw)[r*m_dim + d] - mean[d];
+			var[d] += x*x;
+		}
+	}
+
+	// one deviation per feature group keeps the relative scale of its dimensions
+	struct Group { int32_t begin, end; float weight; };
+	const Group groups[] = {
+		{ 0, E*3, m_config.weightEffectorPos },
+		{ E*3, E*6, m_config.weightEffectorVel },
+		{ E*6, E*6 + T*2, m_config.weightTrajectoryPos },
+		{ E*6 + T*2, E*6 + T*4, m_config.weightTrajectoryDir } };
+
+	m_mean.assign(m_dim,0.f);
+	m_scale.assign(m_dim,0.f);
+	for (const Group& g : groups) {
+		if (g.begin == g.end)
+			continue;
+		double v = 0.;
+		for (int32_t d = g.begin; d < g.end; ++d)
+			v += var[d];
+		const float sd = float(std::sqrt(v / (double(N) * (g.end - g.begin))));
+		for (int32_t d = g.begin; d < g.end; ++d) {
+			m_mean[d] = float(mean[d]);
+			m_scale[d] = sd > 1e-6f ? g.weight / sd : g.weight;
+		}
+	}
+
+	for (size_t r = 0; r < N; ++r) {
+		for (int32_t d = 0; d < m_dim; ++d) {
+			float& x = (*pRaw)[r*m_dim + d];
+			x = (x - m_mean[d]) * m_scale[d];
+		}
+	}
+}//normalize
+
+int32_t MotionDatabase::buildNode(std::vector<int32_t>* pPerm, const std::vector<float>& data, int32_t begin, int32_t end) {
+	const int32_t id = m_nodes.size();
+	m_nodes.push_back(Node{ begin, end, -1, -1, -1, 0.f });
+	if (end - begin <= m_config.leafSize)
+		return id;
+
+	// split widest dimension at its median
+	int32_t splitDim = 0;
+	float maxSpread = -1.f;
+	for (int32_t d = 0; d < m_dim; ++d) {
+		float lo = FLT_MAX, hi = -FLT_MAX;
+		for (int32_t i = begin; i < end; ++i) {
+			const float x = data[size_t((*pPerm)[i]) * m_dim + d];
+			lo = std::min(lo,x);
+			hi = std::max(hi,x);
+		}
+		if (hi - lo > maxSpread) {
+			maxSpread = hi - lo;
+			splitDim = d;
+		}
+	}
+	if (maxSpread <= 0.f)
+		return id; // identical rows
+
+	const int32_t mid = begin + (end - begin) / 2;
+	std::nth_element(pPerm->begin() + begin,pPerm->begin() + mid,pPerm->begin() + end,
+		[&](int32_t a, int32_t b) {
+			return data[size_t(a) * m_dim + splitDim] < data[size_t(b) * m_dim + splitDim];
+		});
+
+	m_nodes[id].splitDim = splitDim;
+	m_nodes[id].splitVal = data[size_t((*pPerm)[mid]) * m_dim + splitDim];
+	const int32_t left = buildNode(pPerm,data,begin,mid);
+	const int32_t right = buildNode(pPerm,data,mid,end);
+	m_nodes[id].left = left;
+	m_nodes[id].right = right;
+	return id;
+}//buildNode
+
+VectorXf MotionDatabase::toVector(const Feature& f) const {
+	const uint32_t E = m_effectors.size();
+	const uint32_t T = m_config.trajectoryTimes.size();
+	if (f.effectorPos.size() != E || f.effectorVel.size() != E || f.trajectoryPos.size() != T || f.trajectoryDir.size() != T)
+		throw CForgeExcept("MotionDatabase: feature does not match database layout");
+
+	VectorXf ret(m_dim);
+	for (uint32_t e = 0; e < E; ++e) {
+		ret.segment<3>(e*3) = f.effectorPos[e];
+		ret.segment<3>(E*3 + e*3) = f.effectorVel[e];
+	}
+	for (uint32_t s = 0; s < T; ++s) {
+		ret.segment<2>(E*6 + s*2) = f.trajectoryPos[s];
+		ret.segment<2>(E*6 + T*2 + s*2) = f.trajectoryDir[s];
+	}
+	return ret;
+}//toVector
+
+VectorXf MotionDatabase::rawFeature(int32_t row) const {
+	if (row < 0 || size_t(row) >= m_rows.size())
+		throw IndexOutOfBoundsExcept("row");
+	VectorXf ret(m_dim);
+	for (int32_t d = 0; d < m_dim; ++d)
+		ret[d] = (m_scale[d] != 0.f) ? m_features[size_t(row) * m_dim + d] / m_scale[d] + m_mean[d] : m_mean[d];
+	return ret;
+}//rawFeature
+
+void MotionDatabase::normalizeQuery(const VectorXf& rawQuery, VectorXf* pQuery) const {
+	if (rawQuery.size() != m_dim)
+		throw CForgeExcept("MotionDatabase: query dimension does not match database");
+	pQuery->resize(m_dim);
+	for (int32_t d = 0; d < m_dim; ++d)
+		(*pQuery)[d] = (rawQuery[d] - m_mean[d]) * m_scale[d];
+}//normalizeQuery
+
+std::vector<MotionDatabase::Match> MotionDatabase::query(const Feature& q, int32_t k,
+		int32_t excludeAnimation, int32_t excludeFrame, int32_t excludeFrames) const {
+	return query(toVector(q),k,excludeAnimation,excludeFrame,excludeFrames);
+}//query
+
+std::vector<MotionDatabase::Match> MotionDatabase::query(const VectorXf& rawQuery, int32_t k,
+		int32_t excludeAnimation, int32_t excludeFrame, int32_t excludeFrames) const {
+	std::vector<Match> best;
+	if (m_nodes.empty() || k <= 0)
+		return best;
+
+	Search s;
+	s.k = size_t(k);
+	s.excludeAnimation = excludeAnimation;
+	s.excludeFrame = excludeFrame;
+	s.excludeFrames = excludeFrames;
+	s.pBest = &best;
+	normalizeQuery(rawQuery,&s.q);
+	s.offset.assign(m_dim,0.f);
+	best.reserve(k+1);
+
+	searchNode(0,0.f,&s);
+	return best;
+}//query
+
+void MotionDatabase::searchNode(int32_t node, float boxDist, Search* pS) const {
+	const Node& n = m_nodes[node];
+	std::vector<Match>& best = *pS->pBest;
+
+	if (n.left < 0) {
+		const float* pQ = pS->q.data();
+		for (int32_t r = n.begin; r < n.end; ++r) {
+			const Row& row = m_rows[r];
+			if (row.animation == pS->excludeAnimation && std::abs(row.frame - pS->excludeFrame) <= pS->excludeFrames)
+				continue;
+			const float* pF = &m_features[size_t(r) * m_dim];
+			float dist = 0.f;
+			for (int32_t d = 0; d < m_dim; ++d) {
+				const float x = pF[d] - pQ[d];
+				dist += x*x;
+			}
+			if (dist >= pS->worst())
+				continue;
+			Match m{ row.animation, row.frame, row.time, dist, r };
+			auto it = std::upper_bound(best.begin(),best.end(),m,[](const Match& a, const Match& b) {
+				return a.distance < b.distance;
+			});
+			best.insert(it,m);
+			if (best.size() > pS->k)
+				best.pop_back();
+		}
+		return;
+	}
+
+	// near side first, far side bounded by the squared distance to its cell (incremental over the split dimensions)
+	const int32_t d = n.splitDim;
+	const float diff = pS->q[d] - n.splitVal;
+	const int32_t nearNode = diff < 0.f ? n.left : n.right;
+	const int32_t farNode = diff < 0.f ? n.right : n.left;
+
+	searchNode(nearNode,boxDist,pS);
+
+	const float oldOffset = pS->offset[d];
+	const float farDist = boxDist - oldOffset*oldOffset + diff*diff;
+	if (farDist < pS->worst()) {
+		pS->offset[d] = diff;
+		searchNode(farNode,farDist,pS);
+		pS->offset[d] = oldOffset;
+	}
+}//searchNode
+
+}//CForge
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <crossforge/Graphics/Controller/SkeletalPoseController.h>
+
+#include <cfloat>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Pose feature database for motion matching over all SkeletalAnimations of a controller.
+ *        Every keyframe of every animation becomes one feature row, containing
+ *        end-effector positions and velocities and future root trajectory samples,
+ *        all expressed in character space (root projected onto ground plane, facing along +Z).
+ *        Rows are normalized and stored contiguously in KD-tree order for nearest pose queries.
+ *        Does not modify the pose of the controller it is built from.
+*/
+class MotionDatabase {
+public:
+	struct Config {
+		std::string rootJoint;                 // joint defining character space, skeleton root if empty
+		std::vector<std::string> effectors;    // leaf joints if empty
+		std::vector<float> trajectoryTimes = { 1.f/3.f, 2.f/3.f, 1.f }; // future root samples in seconds
+		Vector3f up = Vector3f::UnitY();
+		Vector3f forward = Vector3f::UnitZ(); // facing direction of root joint in its local frame
+		float weightEffectorPos = 1.f;
+		float weightEffectorVel = 1.f;
+		float weightTrajectoryPos = 1.f;
+		float weightTrajectoryDir = 1.f;
+		int32_t leafSize = 16;
+	};
+
+	/**
+	 * @brief raw (not normalized) query feature in character space
+	*/
+	struct Feature {
+		std::vector<Vector3f> effectorPos;
+		std::vector<Vector3f> effectorVel;
+		std::vector<Vector2f> trajectoryPos; // ground plane (right, forward)
+		std::vector<Vector2f> trajectoryDir; // normalized facing on ground plane
+	};
+
+	struct Match {
+		int32_t animation; // SkeletalPoseController animation ID
+		int32_t frame;     // keyframe index
+		float time;        // keyframe timestamp in seconds
+		float distance;    // squared distance in normalized, weighted feature space
+		int32_t row;       // feature row, see rawFeature
+	};
+
+	/**
+	 * @brief samples all animations of pController and builds the index.
+	*/
+	void build(SkeletalPoseController* pController, const Config& config);
+	void clear();
+
+	/**
+	 * @brief K nearest poses, sorted by distance.
+	 * @param excludeAnimation skip frames of this animation within excludeFrames of excludeFrame, e.g. the currently playing frame
+	*/
+	std::vector<Match> query(const Feature& q, int32_t k = 1,
+		int32_t excludeAnimation = -1, int32_t excludeFrame = -1, int32_t excludeFrames = 0) const;
+	std::vector<Match> query(const VectorXf& rawQuery, int32_t k = 1,
+		int32_t excludeAnimation = -1, int32_t excludeFrame = -1, int32_t excludeFrames = 0) const;
+
+	VectorXf toVector(const Feature& f) const;
+	/**
+	 * @brief raw feature of a database row, allows querying from the current frame with a modified trajectory.
+	*/
+	VectorXf rawFeature(int32_t row) const;
+	/**
+	 * @brief ground plane transform of a root joint global transform, maps world to character space.
+	*/
+	Matrix4f characterSpace(const Matrix4f& rootGlobal) const;
+
+	int32_t rowCount() const { return m_rows.size(); }
+	int32_t dimension() const { return m_dim; }
+	const std::vector<std::string>& effectorNames() const { return m_effectorNames; }
+private:
+	struct Row {
+		int32_t animation;
+		int32_t frame;
+		float time;        // seconds
+	};
+	struct Node {
+		int32_t begin, end;  // row range
+		int32_t left, right; // child nodes, -1 for leaf
+		int32_t splitDim;
+		float splitVal;
+	};
+	struct Search {
+		VectorXf q;                  // normalized query
+		std::vector<float> offset;   // per dimension distance of current cell to the query
+		std::vector<Match>* pBest;   // sorted, worst match last
+		size_t k;
+		int32_t excludeAnimation, excludeFrame, excludeFrames;
+		float worst() const { return pBest->size() < k ? FLT_MAX : pBest->back().distance; }
+	};
+
+	void sampleAnimation(int32_t animID, T3DMesh<float>::SkeletalAnimation* pAnim, float ticksPerSecond,
+		const std::vector<SkeletalPoseController::SkeletalJoint*>& skeleton, std::vector<float>* pRaw);
+	void normalize(std::vector<float>* pRaw);
+	int32_t buildNode(std::vector<int32_t>* pPerm, const std::vector<float>& data, int32_t begin, int32_t end);
+	void normalizeQuery(const VectorXf& rawQuery, VectorXf* pQuery) const;
+	void searchNode(int32_t node, float boxDist, Search* pS) const;
+
+	Config m_config;
+	int32_t m_dim = 0;
+	int32_t m_root = -1;
+	std::vector<int32_t> m_effectors;
+	std::vector<std::string> m_effectorNames;
+	std::vector<int32_t> m_jointOrder; // parents before children
+
+	std::vector<float> m_features; // normalized rows in tree order, rowCount() x m_dim
+	std::vector<Row> m_rows;
+	std::vector<float> m_mean;
+	std::vector<float> m_scale;    // feature weight divided by std of its group
+	std::vector<Node> m_nodes;
+};//MotionDatabase
+
+}//CForge
@@ -5,17 +5,18 @@
 namespace CForge {
 using namespace Eigen;
 
-void MRlimb::initialize(std::shared_ptr<CharEntity> source, std::shared_ptr<CharEntity> target, std::vector<int> corr) {
+void MRlimb::initialize(std::shared_ptr<IKController> source, std::shared_ptr<IKController> target, std::vector<int> corr,
+                        Matrix4f targetTransform) {
 	reset();
 
-	m_sCE = source;
-	m_tCE = target;
+	m_sCtrl = source;
+	m_tCtrl = target;
 	m_ikcorr = corr;
 	m_active = true;
 
 	// assign limb scaling values
-	auto& sCtrl = source->controller;
-	auto& tCtrl = target->controller;
+	auto& sCtrl = source;
+	auto& tCtrl = target;
 
 	for (int it = 0; it < m_ikcorr.size();++it) {
 		int is = m_ikcorr[it];
@@ -44,8 +45,8 @@ void MRlimb::initialize(std::shared_ptr<CharEntity> source, std::shared_ptr<Char
 	m_tar_rootPos = tCtrl->getRoot()->LocalPosition;
 
 	// reinitialize targets
-	source->autoCreateTargets();
-	target->autoCreateTargets();
+	sCtrl->initTargetPoints();
+	tCtrl->initTargetPoints();
 
 	// create copyies of source iktargets for target char
 	m_targets.clear();
@@ -58,28 +59,24 @@ void MRlimb::initialize(std::shared_ptr<CharEntity> source, std::shared_ptr<Char
 		std::shared_ptr<IKTarget> t =
 			std::make_shared<IKTarget>(*sCtrl->m_ikArmature.m_jointChains[is].target.lock().get());
 
-		Vector3f pos; Quaternionf rot; Vector3f scale;
-		target->sgn.buildTansformation(&pos,&rot,&scale);
-		t->m_sgnT = CForgeMath::translationMatrix(pos) * CForgeMath::rotationMatrix(rot) * CForgeMath::scaleMatrix(scale);
+		t->m_sgnT = targetTransform;
 
 		m_targets.emplace_back(t);
 		ct.target = t;
 	}
 };
 int MRlimb::jointIndexingFunc(int tarIdx, IKChain& cs, IKChain& ct) {
-	auto source = m_sCE.lock();
-	auto target = m_tCE.lock();
-	if (!source || !target) {
+	auto sCtrl = m_sCtrl.lock();
+	auto tCtrl = m_tCtrl.lock();
+	if (!sCtrl || !tCtrl) {
 		m_active = false;
 		return -1;
 	}
-	auto& sCtrl = source->controller;
-	auto& tCtrl = target->controller;
 #if 0
 	// by distance
 	float closestDist = std::numeric_limits<float>::max();
 	int closestIdx = -1;
-	SkeletalAnimationController::SkeletalJoint* jt = ct.joints[tarIdx];
+	SkeletalPoseController::SkeletalJoint* jt = ct.joints[tarIdx];
 	for (int i=0;i<cs.joints.size();++i) {
 		auto* js = cs.joints[i];
 		float dist = (tCtrl->m_IKJoints[jt].posGlobal-sCtrl->m_IKJoints[js].posGlobal).norm(); //TODO(skade) from current pose, need rest pose global pos instead
@@ -102,9 +99,9 @@ int MRlimb::jointIndexingFunc(int tarIdx, IKChain& cs, IKChain& ct) {
 	return -1; // no match
 }
 void MRlimb::update() {
-	auto source = m_sCE.lock();
-	auto target = m_tCE.lock();
-	if (!source || !target)
+	auto sCtrl = m_sCtrl.lock();
+	auto tCtrl = m_tCtrl.lock();
+	if (!sCtrl || !tCtrl)
 		m_active = false;
 	if (!m_active) {
 		//m_ikcorr.clear(); //TODO(skade) more cleanup?
@@ -112,9 +109,6 @@ void MRlimb::update() {
 		return;
 	}
 
-	auto& sCtrl = source->controller;
-	auto& tCtrl = target->controller;
-
 	for (int it = 0; it < m_ikcorr.size();++it) {
 		int is = m_ikcorr[it];
 		IKChain& cs = sCtrl->m_ikArmature.m_jointChains[is];
@@ -149,13 +143,13 @@ void MRlimb::update() {
 ////		// imitate joint angles, start from root of chain
 //		for (int i=ct.joints.size()-1; i >= 0; --i) {
 //			// joint, apply angle to
-//			SkeletalAnimationController::SkeletalJoint* jt = ct.joints[i];
+//			SkeletalPoseController::SkeletalJoint* jt = ct.joints[i];
 //
 //			// find closest source joint to imitate angle from
 //			int matchIdx = jointIndexingFunc(i,cs,ct);
 //			if (matchIdx != -1) {
 //				 // source joint
-//				SkeletalAnimationController::SkeletalJoint* js = cs.joints[matchIdx];
+//				SkeletalPoseController::SkeletalJoint* js = cs.joints[matchIdx];
 //#if 1
 //				jt->LocalRotation = js->LocalRotation;
 //				jt->OffsetMatrix = js->OffsetMatrix;
@@ -176,15 +170,15 @@ void MRlimb::update() {
 	}
 
 	// create map of joints which chains they contain //TODOff(skade) only compute once
-	std::map<SkeletalAnimationController::SkeletalJoint*,std::vector<IKChain*>> jointToChain;
+	std::map<SkeletalPoseController::SkeletalJoint*,std::vector<IKChain*>> jointToChain;
 	auto& chains = tCtrl->m_ikArmature.m_jointChains;
 	for (uint32_t i = 0; i < chains.size(); ++i)
 		for (auto j : chains[i].joints)
 			jointToChain[j].push_back(&chains[i]);
 
-	std::function<void(SkeletalAnimationController::SkeletalJoint* j, Matrix4f parentT)> imitate;
+	std::function<void(SkeletalPoseController::SkeletalJoint* j, Matrix4f parentT)> imitate;
 
-	imitate = [&](SkeletalAnimationController::SkeletalJoint* jt, Matrix4f parentT) {
+	imitate = [&](SkeletalPoseController::SkeletalJoint* jt, Matrix4f parentT) {
 		IKChain* ct = nullptr;
 		if (jointToChain[jt].size() > 0)
 			ct = jointToChain[jt][0]; //TODOff(skade) multiple chains?
@@ -201,7 +195,7 @@ void MRlimb::update() {
 			int matchIdx = jointIndexingFunc(i,cs,*ct);
 
 			if (matchIdx != -1) {
-				SkeletalAnimationController::SkeletalJoint* js = cs.joints[matchIdx];
+				SkeletalPoseController::SkeletalJoint* js = cs.joints[matchIdx];
 				Eigen::Matrix4f jsT = CForgeMath::translationMatrix(js->LocalPosition)
 				                    * CForgeMath::rotationMatrix(js->LocalRotation)
 				                    * CForgeMath::scaleMatrix(js->LocalScale);
@@ -334,8 +328,8 @@ void MRlimb::reset() {
 	m_src_limbLen.clear();
 
 	m_ikcorr.clear();
-	m_sCE.reset();
-	m_tCE.reset();
+	m_sCtrl.reset();
+	m_tCtrl.reset();
 	m_active = false;
 }
 
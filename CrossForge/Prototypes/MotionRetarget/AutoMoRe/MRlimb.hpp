@@ -3,7 +3,6 @@
 #include "IMoRe.hpp"
 
 #include <Prototypes/MotionRetarget/IK/IKChain.hpp>
-#include <Prototypes/MotionRetarget/CharEntity.hpp>
 #include <Prototypes/MotionRetarget/IK/IKController.hpp>
 
 namespace CForge {
@@ -15,8 +14,10 @@ public:
 	//TODO(skade) 
 	/*
 	 * @param corr source to target chain correspondence
+	 * @param targetTransform world transform of target character, applied to created ik targets
 	*/
-	void initialize(std::shared_ptr<CharEntity> source, std::shared_ptr<CharEntity> target, std::vector<int> corr);
+	void initialize(std::shared_ptr<IKController> source, std::shared_ptr<IKController> target, std::vector<int> corr,
+	                Matrix4f targetTransform = Matrix4f::Identity());
 	void update();
 	void reset();
 	bool active() {return m_active;};
@@ -29,8 +30,8 @@ public:
 	std::vector<float> m_scale_limbs;
 
 	std::vector<std::shared_ptr<IKTarget>> m_targets;
-	std::weak_ptr<CharEntity> m_sCE;
-	std::weak_ptr<CharEntity> m_tCE;
+	std::weak_ptr<IKController> m_sCtrl;
+	std::weak_ptr<IKController> m_tCtrl;
 private:
 	Vector3f m_src_rootPos;
 	Vector3f m_tar_rootPos;
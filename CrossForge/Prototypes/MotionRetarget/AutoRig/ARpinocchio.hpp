@@ -1,28 +1,94 @@
 #pragma once
 
 #include "IAutoRigger.hpp"
+#include "BoneHeat.hpp"
+#include "VoxelBind.hpp"
+#include "RigCache.hpp"
 #include <Thirdparty/Pinocchio/PinocchioTools.hpp>
 #include <Thirdparty/Pinocchio/skeleton.h>
 
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
 namespace nsPiT = nsPinocchioTools;
 
 namespace CForge {
 using namespace Eigen;
 
 struct ARpinocchioOptions {
-
+	bool nativeWeights = false; // opt-in: BoneHeat solver instead of the Pinocchio attachment
+	float heatWeight = 1.f;
+	bool voxelWeights = false; // with nativeWeights: geodesic voxel binding instead of bone heat, for broken scans
+	int32_t voxelResolution = 128;
+	bool useCache = true; // reuse result of a previous run on the same mesh with the same options
 };
 
-class ARpinocchio : IAutoRigger<ARpinocchioOptions> {
+class ARpinocchio : public IAutoRigger<ARpinocchioOptions> {
 public:
 
 	void rig(T3DMesh<float>* mesh, ARpinocchioOptions options) {
+		RigCache cache;
+		uint64_t cacheKey = 0;
+		std::vector<Vector3f> inputVertices;
+		if (options.useCache) {
+			std::stringstream rigger;
+			rigger << std::setprecision(9) << "pinocchio human " << options.nativeWeights << " " << options.heatWeight;
+			if (options.voxelWeights)
+				rigger << " voxel " << options.voxelResolution;
+			cacheKey = RigCache::key(*mesh, rigger.str());
+			report(0.f, "rig cache");
+			if (cache.load(cacheKey, mesh)) {
+				mesh->clearSkeletalAnimations();
+				return;
+			}
+			for (uint32_t i = 0; i < mesh->vertexCount(); ++i)
+				inputVertices.push_back(std::as_const(*mesh).vertex(i));
+		}
+
+		report(0.f, "convert mesh");
 		nsPiT::CVScalingInfo cvsInfo;
 
 		nsPinocchio::Skeleton skl = nsPinocchio::HumanSkeleton(); //TODOff(skade) other predefined skl in skeleton.h
 		nsPinocchio::Mesh piM;// = new nsPinocchio::Mesh(); //("MyAssets/muppetshow/Model1.obj"); //TODOff(skade) test original
 		nsPiT::convertMesh(*mesh, &piM);
-		nsPinocchio::PinocchioOutput rig = nsPiT::autorig(skl, &piM);
+
+		std::vector<BoneHeat::Influences> weights;
+		nsPiT::AttachmentFunc attach = nullptr;
+		if (options.nativeWeights) {
+			attach = [&](const nsPinocchio::Mesh& pm, const std::vector<nsPinocchio::Vector3>& embedding,
+			             const nsPinocchio::VisibilityTester* tester) {
+				// embedding and distance field live in the normalized pinocchio cube, weights are solved on the input mesh
+				const Vector3f toAdd = Vector3f(pm.toAdd[0],pm.toAdd[1],pm.toAdd[2]);
+				const float scale = pm.scale;
+				auto toMesh = [&](const nsPinocchio::Vector3& v) { return (Vector3f(v[0],v[1],v[2]) - toAdd) / scale; };
+
+				std::vector<BoneHeat::Segment> bones;
+				for (uint32_t j = 1; j < embedding.size(); ++j)
+					bones.push_back({ toMesh(embedding[j]), toMesh(embedding[skl.fPrev()[j]]) });
+
+				if (options.voxelWeights) {
+					VoxelBind::Config config;
+					config.resolution = options.voxelResolution;
+					VoxelBind vb;
+					vb.compute(*mesh, bones, config, &weights,
+					           [&](float progress) { report(0.65f + 0.25f * progress, "voxel binding"); });
+					return;
+				}
+
+				BoneHeat::Config config;
+				config.heatWeight = options.heatWeight;
+				config.canSee = [&](const Vector3f& from, const Vector3f& to) {
+					Vector3f f = from * scale + toAdd, t = to * scale + toAdd;
+					return tester->canSee(nsPinocchio::Vector3(f[0],f[1],f[2]), nsPinocchio::Vector3(t[0],t[1],t[2]));
+				};
+				BoneHeat bh;
+				bh.compute(*mesh, bones, config, &weights);
+			};
+		}
+		nsPinocchio::PinocchioOutput rig = nsPiT::autorig(skl, &piM, attach,
+			[&](float progress, const char* stage) { report(0.05f + 0.85f * progress, stage); });
+		report(0.9f, "apply weights");
 
 		//TODOff(skade) fix bones, wrong
 		std::vector<T3DMesh<float>::Bone*> bones;
@@ -86,10 +152,17 @@ public:
 			}
 		}
 
-		if (rig.attachment)
+		if (options.nativeWeights && !weights.empty())
+			nsPiT::applyWeights(&skl, &piM, mesh, cvsInfo, rig, weights);
+		else if (rig.attachment)
 			nsPiT::applyWeights(&skl, &piM, mesh, cvsInfo, rig, mesh->vertexCount());
-		else
+		else {
 			std::cerr << "ARpinocchio::rig failed, rig contains no attachment." << std::endl; //TODOff(skade)
+			return;
+		}
+
+		if (options.useCache)
+			cache.store(cacheKey, inputVertices, *mesh);
 
 		// do not delete, we dont copy bones
 		//for (uint32_t i=0;i<bones.size();++i)
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "IAutoRigger.hpp"
+#include "WeightTransfer.hpp"
+#include "RigCache.hpp"
+#include <Prototypes/MeshProcessing/MeshDecimate.h>
+#include <Prototypes/MotionRetarget/CMN/MergeVertices.hpp>
+
+#include <iostream>
+#include <map>
+#include <utility>
+
+namespace CForge {
+using namespace Eigen;
+
+template<typename AROptions>
+struct ARproxyOptions {
+	AROptions rigger;
+	uint32_t targetFaces = 20000; // proxy face count, meshes with fewer faces are rigged directly
+	WeightTransfer::Config transfer;
+};
+
+/**
+ * @brief Rigs a decimated proxy of the mesh with another rigger and transfers skeleton and skin weights
+ *        back to the full resolution mesh, rigging time depends on the proxy size only.
+ *        Riggers may move the mesh into their own space (e.g. ARpinocchio rescales it), the similarity
+ *        they applied to the proxy is estimated and applied to the full mesh as well.
+*/
+template<typename AROptions>
+class ARproxy : public IAutoRigger<ARproxyOptions<AROptions>> {
+public:
+	ARproxy(IAutoRigger<AROptions>* pRigger) : m_pRigger(pRigger) {
+		if (!pRigger)
+			throw NullpointerExcept("pRigger");
+	}
+
+	void rig(T3DMesh<float>* mesh, ARproxyOptions<AROptions> options) {
+		if (!mesh)
+			throw NullpointerExcept("mesh");
+
+		uint32_t faceCount = 0;
+		for (uint32_t i = 0; i < mesh->submeshCount(); ++i)
+			faceCount += mesh->getSubmesh(i)->Faces.size();
+		if (faceCount <= options.targetFaces) {
+			m_pRigger->progress(this->m_pProgress, this->m_progressBegin, this->m_progressEnd);
+			m_pRigger->rig(mesh, options.rigger);
+			return;
+		}
+
+		this->report(0.f, "decimate");
+		T3DMesh<float> proxy;
+		if (!MeshDecimator::decimateMesh(mesh, &proxy, float(options.targetFaces) / faceCount)) {
+			std::cerr << "ARproxy::rig decimation failed, rigging full mesh." << std::endl;
+			m_pRigger->progress(this->m_pProgress, this->m_progressBegin, this->m_progressEnd);
+			m_pRigger->rig(mesh, options.rigger);
+			return;
+		}
+		// decimator emits separate vertices per face corner, weights need connected triangles
+		mergeRedundantVertices(&proxy);
+
+		const uint32_t proxyVerts = proxy.vertexCount();
+		std::vector<Vector3f> before(proxyVerts);
+		for (uint32_t i = 0; i < proxyVerts; ++i)
+			before[i] = std::as_const(proxy).vertex(i);
+
+		const float f = this->m_progressEnd - this->m_progressBegin;
+		m_pRigger->progress(this->m_pProgress, this->m_progressBegin + 0.1f * f, this->m_progressBegin + 0.85f * f);
+		m_pRigger->rig(&proxy, options.rigger);
+		this->report(0.85f, "transfer weights");
+		if (proxy.boneCount() == 0 || proxy.vertexCount() != proxyVerts) {
+			std::cerr << "ARproxy::rig rigging proxy failed." << std::endl;
+			return;
+		}
+
+		// move full mesh into the space the rigger left the proxy in
+		const Matrix4f T = RigCache::vertexTransform(before, proxy);
+		if (!T.isIdentity())
+			RigCache::transformMesh(T, mesh);
+
+		{ // copy skeleton, bone IDs are kept as the rigger assigned them
+			std::map<T3DMesh<float>::Bone*, T3DMesh<float>::Bone*> copies;
+			std::vector<T3DMesh<float>::Bone*> bones;
+			for (uint32_t i = 0; i < proxy.boneCount(); ++i) {
+				T3DMesh<float>::Bone* b = new T3DMesh<float>::Bone();
+				T3DMesh<float>::Bone* src = proxy.getBone(i);
+				b->ID = src->ID;
+				b->Name = src->Name;
+				b->InvBindPoseMatrix = src->InvBindPoseMatrix;
+				copies[src] = b;
+				bones.push_back(b);
+			}
+			for (uint32_t i = 0; i < proxy.boneCount(); ++i) {
+				T3DMesh<float>::Bone* src = proxy.getBone(i);
+				bones[i]->pParent = src->pParent ? copies[src->pParent] : nullptr;
+				for (auto c : src->Children)
+					bones[i]->Children.push_back(copies[c]);
+			}
+			mesh->bones(&bones, false);
+			mesh->clearSkeletalAnimations();
+		}
+
+		WeightTransfer wt;
+		wt.transfer(proxy, mesh, options.transfer);
+	}//rig
+
+private:
+	IAutoRigger<AROptions>* m_pRigger;
+};//ARproxy
+
+}//CForge
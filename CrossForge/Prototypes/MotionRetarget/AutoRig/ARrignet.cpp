@@ -6,7 +6,10 @@
 #include <Prototypes/MotionRetarget/CMN/MergeVertices.hpp>
 
 #include <Prototypes/MotionRetarget/CMN/EigenFWD.hpp>
+#include "RigCache.hpp"
 #include <iostream> //TODOff(skade) SLogger
+#include <iomanip>
+#include <utility>
 
 #include <Prototypes/MotionRetarget/CMN/MergeVertices.hpp>
 
@@ -14,7 +17,26 @@ namespace CForge {
 using namespace Eigen;
 
 void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
-	std::string objPath = "MyAssets/Cache/Rignet/";
+	// key of mesh, backend and options, hashing the mesh once
+	std::stringstream rigger;
+	rigger << std::setprecision(9) << "rignet quick_start.py " << options.bandwidth << " " << options.threshold;
+	const uint64_t cacheKey = RigCache::key(*mesh, rigger.str());
+
+	// one folder per mesh and options, meshes can be rigged concurrently
+	std::stringstream objPathSS;
+	objPathSS << "MyAssets/Cache/Rignet/" << std::hex << cacheKey << "/";
+	std::string objPath = objPathSS.str();
+
+	// the python pipeline is only run if this mesh was not rigged with these options before
+	RigCache cache;
+	const bool useCache = options.useCache && !options.parseOutputOnly;
+	if (useCache) {
+		report(0.f, "rig cache");
+		if (cache.load(cacheKey, mesh))
+			return;
+	}
+
+	report(0.f, "merge vertices");
 
 	// merge vertices
 	T3DMesh<float> mergedMesh = *mesh;
@@ -33,25 +55,23 @@ void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
 		std::filesystem::create_directories(objPath);
 
 		// export file for script
+		report(0.05f, "export mesh");
 		objImportExport::exportAsObjFile(objPath+"mesh.obj", &mergedMesh);
 
 		// assemble command
+		std::string exePath = std::filesystem::current_path().string();
 
-		//TODOfff(skade) linux support / crossplatform
+#if defined(_WIN32)
 		//TODOfff(skade) no space allowable?
-		//std::string command = "\""+condaPath + "/Scripts/activate.bat\" " + "\""+condaPath+"/\"";
 		std::string command = condaPath + "/Scripts/activate.bat " + condaPath;
-
-		//std::filesystem::remove(std::filesystem::path(objPath));
-
-		// commands
 		command.append(" & conda activate rignet");
-		command.append(" & conda info");
-
-		std::string exePath = std::filesystem::current_path().string();
-
 		command.append(" & cd \""+rignetPath + "/\"");
 		command.append(" & python quick_start.py");
+#else
+		// conda run needs no activated shell
+		std::string command = "cd \"" + rignetPath + "/\"";
+		command.append(" && \"" + condaPath + "/bin/conda\" run -n rignet python quick_start.py");
+#endif
 
 		// rignet arg
 		command.append(" \"" + exePath + "/" + objPath + "\""); // input folder
@@ -64,10 +84,14 @@ void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
 		std::cout << command << std::endl;
 
 		//TODO(skade) option to not run script but parse cache instead
-		// run script
-		std::system(command.c_str());
+		// run script, blocks until rignet is done and can not be interrupted
+		report(0.1f, "rignet");
+		if (std::system(command.c_str()) != 0)
+			throw CForgeExcept("RigNet: quick_start.py failed, see console output");
 	}
 
+	report(0.9f, "parse output");
+
 	// parse output of script
 	struct RNrig {
 		std::vector<std::pair<std::string,Vector3f>> joints;
@@ -79,6 +103,8 @@ void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
 	} rig;
 
 	std::ifstream ifs(objPath+"/mesh_rig.txt");
+	if (!ifs.is_open())
+		throw CForgeExcept("RigNet: no output in " + objPath);
 	std::string line;
 	while (std::getline(ifs,line)) {
 		std::istringstream iss(line);
@@ -103,9 +129,8 @@ void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
 			std::string parent, child;
 			iss >> parent >> child;
 			rig.hier[parent].push_back(child);
-		} else { // Handle unknown line type
-			std::cout << "Unknown line type: " << line << std::endl;
-			__debugbreak();
+		} else {
+			throw CForgeExcept("RigNet: unknown line type in mesh_rig.txt: " + line);
 		}
 	}
 
@@ -191,6 +216,13 @@ void ARrignet::rig(T3DMesh<float>* mesh, ARrignetOptions options) {
 
 	// add rig to mesh
 	mesh->bones(bones,false);
+
+	if (useCache && mesh->boneCount() > 0) {
+		std::vector<Vector3f> inputVertices;
+		for (uint32_t i = 0; i < mesh->vertexCount(); ++i)
+			inputVertices.push_back(std::as_const(*mesh).vertex(i));
+		cache.store(cacheKey, inputVertices, *mesh);
+	}
 };
 
 }//CForge
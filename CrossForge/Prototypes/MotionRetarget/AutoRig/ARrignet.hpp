@@ -9,11 +9,18 @@ struct ARrignetOptions {
 	float bandwidth = 0.0429;
 	float threshold = 1e-5;
 	bool parseOutputOnly = false;
+	bool useCache = true; // reuse result of a previous run on the same mesh with the same options, ignored when parsing output only
 };
 
-class ARrignet : IAutoRigger<ARrignetOptions> {
+/**
+ * @brief rigs a mesh with RigNet by running its quick_start.py in the conda environment "rignet" on an OBJ export
+ *        of the mesh and reading back mesh_rig.txt. Every uncached call starts python and loads the networks,
+ *        there is no in-process inference backend.
+ *        Throws CrossForgeException if the script fails or leaves no readable output.
+*/
+class ARrignet : public IAutoRigger<ARrignetOptions> {
 public:
-	// path to anaconda installation, folder which should contain _conda.exe
+	// path to anaconda installation, folder which should contain _conda.exe (Windows) or bin/conda
 	std::string condaPath;//"C:/Users/Admin/miniconda3/";
 
 	// path to rignet root, folder which should contain quick_start.py
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "IAutoRigger.hpp"
+#include "VoxelBind.hpp"
+
+#include <map>
+
+namespace CForge {
+using namespace Eigen;
+
+struct ARvoxelBindOptions {
+	VoxelBind::Config voxel;
+};
+
+/**
+ * @brief Replaces the skin weights of the skeleton already bound to the mesh (imported, RigNet, Pinocchio)
+ *        with geodesic voxel binding. Bone i covers the segment from its joint to its first child,
+ *        leaf bones are points.
+*/
+class ARvoxelBind : public IAutoRigger<ARvoxelBindOptions> {
+public:
+	void rig(T3DMesh<float>* mesh, ARvoxelBindOptions options) {
+		if (!mesh)
+			throw NullpointerExcept("mesh");
+		if (mesh->boneCount() == 0)
+			throw CForgeExcept("ARvoxelBind: mesh has no skeleton");
+
+		report(0.f, "voxelize");
+		std::map<const T3DMesh<float>::Bone*,uint32_t> boneIdx;
+		std::vector<Vector3f> joints;
+		for (uint32_t i = 0; i < mesh->boneCount(); ++i) {
+			const T3DMesh<float>::Bone* b = mesh->getBone(i);
+			boneIdx[b] = i;
+			joints.push_back(b->InvBindPoseMatrix.inverse().block<3,1>(0,3));
+		}
+		std::vector<VoxelBind::Segment> bones;
+		for (uint32_t i = 0; i < mesh->boneCount(); ++i) {
+			const T3DMesh<float>::Bone* b = mesh->getBone(i);
+			const Vector3f end = b->Children.empty() ? joints[i] : joints[boneIdx[b->Children[0]]];
+			bones.push_back({ joints[i], end });
+		}
+
+		std::vector<VoxelBind::Influences> weights;
+		VoxelBind vb;
+		vb.compute(*mesh, bones, options.voxel, &weights,
+		           [&](float progress) { report(0.95f * progress, "voxel binding"); });
+
+		report(0.95f, "apply weights");
+		for (uint32_t i = 0; i < mesh->boneCount(); ++i) {
+			mesh->getBone(i)->VertexInfluences.clear();
+			mesh->getBone(i)->VertexWeights.clear();
+		}
+		for (uint32_t v = 0; v < weights.size(); ++v) {
+			for (auto [j, w] : weights[v]) {
+				mesh->getBone(j)->VertexInfluences.push_back(v);
+				mesh->getBone(j)->VertexWeights.push_back(w);
+			}
+		}
+	}
+};
+
+}//CForge
@@ -0,0 +1,237 @@
+#include "BoneHeat.hpp"
+
+#include <crossforge/Core/Parallel.hpp>
+
+#include <algorithm>
+#include <cfloat>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace {
+	Vector3f projToSeg(const Vector3f& p, const BoneHeat::Segment& s) {
+		const Vector3f d = s.end - s.begin;
+		const float len2 = d.squaredNorm();
+		if (len2 <= 0.f)
+			return s.begin;
+		const float t = std::clamp((p - s.begin).dot(d) / len2, 0.f, 1.f);
+		return s.begin + t*d;
+	}
+}
+
+void BoneHeat::compute(const T3DMesh<float>& mesh, const std::vector<Segment>& bones, const Config& config,
+                       std::vector<Influences>* pWeights) {
+	if (!pWeights)
+		throw NullpointerExcept("pWeights");
+	if (bones.empty())
+		throw CForgeExcept("BoneHeat: no bones given");
+
+	buildHalfEdges(mesh);
+	heat(bones, config);
+
+	const int32_t nv = m_pos.size();
+	const int32_t nb = bones.size();
+	pWeights->assign(nv, Influences());
+	if (nv == 0)
+		return;
+
+	SparseMatrix<double> A;
+	assemble(&A);
+	SimplicialLDLT<SparseMatrix<double>> ldlt(A);
+	if (ldlt.info() != Success)
+		throw CForgeExcept("BoneHeat: factorization of heat system failed");
+
+	// all bones share the factorization, each worker solves a block of right hand sides
+	MatrixXf W(nv, nb);
+	parallelFor(0, nb, [&](size_t b, size_t e) {
+		MatrixXd rhs = MatrixXd::Zero(nv, e - b);
+		for (int32_t i = 0; i < nv; ++i) {
+			for (size_t j = b; j < e; ++j) {
+				if (m_hot[size_t(i)*nb + j])
+					rhs(i, j - b) = m_heat[i] * (1e-10 + m_area[i]);
+			}
+		}
+		W.middleCols(b, e - b) = ldlt.solve(rhs).cast<float>();
+	}, 1);
+
+	parallelFor(0, nv, [&](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			Influences& inf = (*pWeights)[i];
+			float sum = 0.f;
+			for (int32_t j = 0; j < nb; ++j) {
+				const float w = std::min(W(i, j), 1.f); // clip just in case
+				if (w > config.minWeight) {
+					inf.push_back(std::make_pair(j, w));
+					sum += w;
+				}
+			}
+			if (inf.empty()) {
+				inf.push_back(std::make_pair(m_closest[i], 1.f));
+				continue;
+			}
+			for (auto& [j, w] : inf)
+				w /= sum;
+		}
+	});
+}//compute
+
+void BoneHeat::buildHalfEdges(const T3DMesh<float>& mesh) {
+	const int32_t nv = mesh.vertexCount();
+	m_pos.resize(nv);
+	for (int32_t i = 0; i < nv; ++i)
+		m_pos[i] = mesh.vertex(i);
+
+	m_halfEdges.clear();
+	for (uint32_t s = 0; s < mesh.submeshCount(); ++s) {
+		for (const auto& f : mesh.getSubmesh(s)->Faces) {
+			const int32_t* v = f.Vertices;
+			bool valid = v[0] != v[1] && v[1] != v[2] && v[2] != v[0];
+			for (int32_t k = 0; k < 3; ++k)
+				valid &= v[k] >= 0 && v[k] < nv;
+			if (!valid)
+				continue;
+			for (int32_t k = 0; k < 3; ++k)
+				m_halfEdges.push_back({ v[(k+1)%3], -1 });
+		}
+	}
+	const int32_t nh = m_halfEdges.size();
+
+	// twins, half-edges sorted by undirected edge key. Only edges shared by exactly two
+	// oppositely oriented half-edges are paired, all others stay open.
+	std::vector<std::pair<uint64_t,int32_t>> keys(nh);
+	parallelFor(0, nh, [&](size_t b, size_t e) {
+		for (size_t h = b; h < e; ++h) {
+			uint64_t v0 = m_halfEdges[prev(h)].vertex, v1 = m_halfEdges[h].vertex;
+			if (v0 > v1)
+				std::swap(v0, v1);
+			keys[h] = std::make_pair((v0 << 32) | v1, int32_t(h));
+		}
+	});
+	std::sort(keys.begin(), keys.end());
+	for (int32_t i = 0; i < nh;) {
+		int32_t e = i + 1;
+		while (e < nh && keys[e].first == keys[i].first)
+			++e;
+		const int32_t h0 = keys[i].second;
+		const int32_t h1 = keys[i+1 < nh ? i+1 : i].second;
+		if (e - i == 2 && m_halfEdges[h0].vertex != m_halfEdges[h1].vertex) {
+			m_halfEdges[h0].twin = h1;
+			m_halfEdges[h1].twin = h0;
+		}
+		i = e;
+	}
+
+	// outgoing half-edges per vertex, one per incident triangle
+	m_vertOffset.assign(nv + 1, 0);
+	for (int32_t h = 0; h < nh; ++h)
+		m_vertOffset[m_halfEdges[prev(h)].vertex + 1]++;
+	for (int32_t i = 0; i < nv; ++i)
+		m_vertOffset[i+1] += m_vertOffset[i];
+	m_vertEdges.resize(nh);
+	std::vector<int32_t> fill(m_vertOffset.begin(), m_vertOffset.end() - 1);
+	for (int32_t h = 0; h < nh; ++h)
+		m_vertEdges[fill[m_halfEdges[prev(h)].vertex]++] = h;
+}//buildHalfEdges
+
+void BoneHeat::heat(const std::vector<Segment>& bones, const Config& config) {
+	const int32_t nv = m_pos.size();
+	const int32_t nb = bones.size();
+	m_area.assign(nv, 0.);
+	m_heat.assign(nv, 0.);
+	m_closest.assign(nv, 0);
+	m_hot.assign(size_t(nv) * nb, 0);
+
+	// keeps heat finite for vertices on a bone, relative to mesh size
+	float eps = 0.f;
+	if (nv > 0) {
+		AlignedBox3f box;
+		for (const auto& p : m_pos)
+			box.extend(p);
+		eps = 1e-8f * box.diagonal().norm();
+	}
+
+	// visibility tests dominate, vertices are independent
+	parallelFor(0, nv, [&](size_t b, size_t e) {
+		std::vector<float> dist(nb);
+		for (size_t i = b; i < e; ++i) {
+			const Vector3f& pos = m_pos[i];
+
+			Vector3f normal = Vector3f::Zero();
+			for (int32_t k = m_vertOffset[i]; k < m_vertOffset[i+1]; ++k) {
+				const int32_t h = m_vertEdges[k];
+				const Vector3f& p1 = m_pos[m_halfEdges[h].vertex];
+				const Vector3f& p2 = m_pos[m_halfEdges[next(h)].vertex];
+				const Vector3f n = (p1 - pos).cross(p2 - pos);
+				const float len = n.norm();
+				m_area[i] += len;
+				if (len > 0.f)
+					normal += n / len;
+			}
+			normal.normalize();
+
+			float minDist = FLT_MAX;
+			for (int32_t j = 0; j < nb; ++j) {
+				dist[j] = (pos - projToSeg(pos, bones[j])).norm();
+				if (dist[j] < minDist) {
+					minDist = dist[j];
+					m_closest[i] = j;
+				}
+			}
+
+			// not just the closest bone, if two are equally close both are factored in
+			for (int32_t j = 0; j < nb; ++j) {
+				if (dist[j] > minDist * 1.0001f)
+					continue;
+				const Vector3f p = projToSeg(pos, bones[j]);
+				const bool facing = (pos - p).normalized().dot(normal) > 0.5f;
+				if (!facing || (config.canSee && !config.canSee(pos, p)))
+					continue;
+				m_hot[i*nb + j] = 1;
+				m_heat[i] += config.heatWeight / ((eps + minDist) * (eps + minDist));
+			}
+		}
+	}, 256);
+}//heat
+
+void BoneHeat::assemble(SparseMatrix<double>* pA) const {
+	const int32_t nv = m_pos.size();
+	const int32_t nh = m_halfEdges.size();
+
+	// cotangent of the angle opposite to half-edge h
+	auto cot = [&](int32_t h) {
+		const Vector3d o = m_pos[m_halfEdges[next(h)].vertex].cast<double>();
+		const Vector3d a = m_pos[m_halfEdges[prev(h)].vertex].cast<double>() - o;
+		const Vector3d c = m_pos[m_halfEdges[h].vertex].cast<double>() - o;
+		return a.dot(c) / (1e-6 * a.norm() * c.norm() + a.cross(c).norm());
+	};
+
+	std::vector<double> diag(nv, 0.);
+	std::vector<Triplet<double>> triplets;
+	triplets.reserve(nh + nv);
+	for (int32_t h = 0; h < nh; ++h) {
+		const int32_t t = m_halfEdges[h].twin;
+		if (t >= 0 && t < h)
+			continue; // undirected edge handled from its twin
+		const double w = cot(h) + (t >= 0 ? cot(t) : 0.);
+		const int32_t i = m_halfEdges[prev(h)].vertex;
+		const int32_t j = m_halfEdges[h].vertex;
+		triplets.push_back(Triplet<double>(i, j, -w));
+		triplets.push_back(Triplet<double>(j, i, -w));
+		diag[i] += w;
+		diag[j] += w;
+	}
+	// heat term H/D, D being the inverse vertex area. The small regularization keeps pieces
+	// without any heated vertex (loose parts, isolated vertices) from making the system singular,
+	// their weights solve to zero.
+	double reg = 0.;
+	for (int32_t i = 0; i < nv; ++i)
+		reg += diag[i];
+	reg = 1e-9 * reg / nv + 1e-30;
+	for (int32_t i = 0; i < nv; ++i)
+		triplets.push_back(Triplet<double>(i, i, diag[i] + m_heat[i] * (1e-10 + m_area[i]) + reg));
+
+	pA->resize(nv, nv);
+	pA->setFromTriplets(triplets.begin(), triplets.end());
+}//assemble
+
+}//CForge
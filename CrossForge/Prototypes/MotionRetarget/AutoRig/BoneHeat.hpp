@@ -0,0 +1,70 @@
+#pragma once
+
+#include <crossforge/AssetIO/T3DMesh.hpp>
+
+#include <Eigen/Sparse>
+#include <functional>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Bone heat skin weights (Baran and Popovic 2007) without the Pinocchio attachment.
+ *        Solves (-L + H) w_j = H p_j for every bone j, L being the cotangent Laplacian of the mesh,
+ *        H the heat each vertex receives from its closest visible bone(s) and p_j the indicator of bone j being one of them.
+ *        The system matrix does not depend on the bone, it is factored once with a sparse Cholesky (LDLT)
+ *        and all bones are solved as right hand sides in parallel. Adjacency is built from half-edges,
+ *        vertices on open or non-manifold edges need no special treatment.
+*/
+class BoneHeat {
+public:
+	using Influences = std::vector<std::pair<int32_t,float>>; // (bone, weight), weights of a vertex sum to 1
+
+	struct Segment {
+		Vector3f begin;
+		Vector3f end;
+	};
+
+	struct Config {
+		float heatWeight = 1.f;
+		float minWeight = 1e-8f; // smaller weights are dropped
+		/**
+		 * @brief optional, true if the segment point to can be seen from vertex from (e.g. line not leaving the volume).
+		 *        Called from worker threads. Only the facing test against the vertex one-ring is done if empty.
+		*/
+		std::function<bool(const Vector3f& from, const Vector3f& to)> canSee;
+	};
+
+	/**
+	 * @brief computes skin weights for all vertices of pMesh, all submeshes together form the surface.
+	 * @param bones segments in mesh space, index of a segment is the bone index of the resulting influences
+	 * @param pWeights one entry per vertex. Vertices receiving no heat (e.g. separate pieces without visible bone)
+	 *                 are bound fully to their closest bone.
+	*/
+	void compute(const T3DMesh<float>& mesh, const std::vector<Segment>& bones, const Config& config,
+		std::vector<Influences>* pWeights);
+
+private:
+	struct HalfEdge {
+		int32_t vertex; // vertex the edge points to, it starts at prev(h).vertex
+		int32_t twin;   // -1 on open edges
+	};
+	static int32_t next(int32_t h) { return (h % 3 == 2) ? h - 2 : h + 1; }
+	static int32_t prev(int32_t h) { return (h % 3 == 0) ? h + 2 : h - 1; }
+
+	void buildHalfEdges(const T3DMesh<float>& mesh);
+	void heat(const std::vector<Segment>& bones, const Config& config);
+	void assemble(Eigen::SparseMatrix<double>* pA) const;
+
+	std::vector<Vector3f> m_pos;
+	std::vector<HalfEdge> m_halfEdges; // 3 per triangle
+	std::vector<int32_t> m_vertOffset; // CSR of outgoing half-edges per vertex
+	std::vector<int32_t> m_vertEdges;
+
+	std::vector<double> m_area; // sum of doubled areas of incident triangles
+	std::vector<double> m_heat;
+	std::vector<int32_t> m_closest;  // closest bone per vertex
+	std::vector<uint8_t> m_hot;      // per vertex and bone, bone heats vertex
+};//BoneHeat
+
+}//CForge
@@ -2,12 +2,55 @@
 
 #include <crossforge/AssetIO/T3DMesh.hpp>
 
+#include <atomic>
+
 namespace CForge {
 
+/**
+ * @brief progress and cancellation token of a running rig, shared with the thread that started it.
+*/
+struct RigProgress {
+	std::atomic<float> progress{0.f};          // [0,1]
+	std::atomic<const char*> stage{"waiting"}; // string literal naming the current step
+	std::atomic<bool> cancelled{false};        // set by the owner, riggers stop at the next report
+};
+
+/**
+ * @brief thrown by IAutoRigger::report if the rig was cancelled.
+*/
+struct RigCancelled {};
+
 template<typename AROptions>
 class IAutoRigger {
 public:
 	virtual void rig(T3DMesh<float>* mesh, AROptions options) = 0;
+
+	/**
+	 * @brief progress of following rig calls is reported to pProgress, mapped to [begin,end]. nullptr disables reporting.
+	*/
+	void progress(RigProgress* pProgress, float begin = 0.f, float end = 1.f) {
+		m_pProgress = pProgress;
+		m_progressBegin = begin;
+		m_progressEnd = end;
+	}
+
+protected:
+	/**
+	 * @brief called by riggers between their steps, throws RigCancelled if cancellation was requested.
+	 *        The mesh passed to rig may be partially modified then.
+	*/
+	void report(float progress, const char* stage) {
+		if (!m_pProgress)
+			return;
+		if (m_pProgress->cancelled)
+			throw RigCancelled();
+		m_pProgress->progress = m_progressBegin + progress * (m_progressEnd - m_progressBegin);
+		m_pProgress->stage = stage;
+	}
+
+	RigProgress* m_pProgress = nullptr;
+	float m_progressBegin = 0.f;
+	float m_progressEnd = 1.f;
 };
 
 }//CForge
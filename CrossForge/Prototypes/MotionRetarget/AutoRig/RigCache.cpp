@@ -0,0 +1,218 @@
+#include "RigCache.hpp"
+
+#include <Eigen/Geometry>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace {
+	struct FNV1a {
+		uint64_t h = 14695981039346656037ull;
+		void add(const void* data, size_t size) {
+			const unsigned char* p = (const unsigned char*)data;
+			for (size_t i = 0; i < size; ++i) {
+				h ^= p[i];
+				h *= 1099511628211ull;
+			}
+		}
+	};
+
+	template<typename T>
+	void write(std::ostream& os, const T& v) {
+		os.write((const char*)&v, sizeof(T));
+	}
+	template<typename T>
+	void writeVec(std::ostream& os, const std::vector<T>& v) {
+		write(os, uint32_t(v.size()));
+		os.write((const char*)v.data(), v.size() * sizeof(T));
+	}
+	template<typename T>
+	bool read(std::istream& is, T* pV) {
+		is.read((char*)pV, sizeof(T));
+		return bool(is);
+	}
+	template<typename T>
+	bool readVec(std::istream& is, std::vector<T>* pV, uint32_t maxSize) {
+		uint32_t size;
+		if (!read(is, &size) || size > maxSize)
+			return false;
+		pV->resize(size);
+		is.read((char*)pV->data(), size * sizeof(T));
+		return bool(is);
+	}
+}
+
+RigCache::RigCache(std::string directory) : m_directory(directory) {
+
+}//Constructor
+
+uint64_t RigCache::key(const T3DMesh<float>& mesh, const std::string& rigger) {
+	FNV1a h;
+	const uint32_t vertexCount = mesh.vertexCount();
+	h.add(&vertexCount, sizeof(uint32_t));
+	for (uint32_t i = 0; i < vertexCount; ++i)
+		h.add(mesh.vertex(i).data(), 3 * sizeof(float));
+	for (uint32_t s = 0; s < mesh.submeshCount(); ++s) {
+		for (const auto& f : mesh.getSubmesh(s)->Faces)
+			h.add(f.Vertices, 3 * sizeof(int32_t));
+	}
+	h.add(rigger.data(), rigger.size());
+	return h.h;
+}//key
+
+std::string RigCache::path(uint64_t key) const {
+	std::stringstream ss;
+	ss << m_directory << std::hex << std::setw(16) << std::setfill('0') << key << ".rig";
+	return ss.str();
+}//path
+
+bool RigCache::load(uint64_t key, T3DMesh<float>* pMesh) const {
+	if (!pMesh)
+		throw NullpointerExcept("pMesh");
+
+	std::ifstream ifs(path(key), std::ios::binary);
+	if (!ifs)
+		return false;
+
+	uint32_t magic, version, vertexCount, boneCount;
+	uint64_t fileKey;
+	Matrix4f T;
+	if (!read(ifs, &magic) || !read(ifs, &version) || !read(ifs, &fileKey) || !read(ifs, &vertexCount)
+		|| !read(ifs, &boneCount) || !read(ifs, &T))
+		return false;
+	if (magic != m_Magic || version != m_Version || fileKey != key || vertexCount != pMesh->vertexCount())
+		return false;
+
+	// bones are only handed to the mesh if the whole file is valid
+	std::vector<T3DMesh<float>::Bone*> bones;
+	for (uint32_t i = 0; i < boneCount; ++i)
+		bones.push_back(new T3DMesh<float>::Bone());
+	auto fail = [&]() {
+		for (auto b : bones)
+			delete b;
+		std::cerr << "RigCache: invalid entry " << path(key) << std::endl;
+		return false;
+	};
+
+	for (uint32_t i = 0; i < boneCount; ++i) {
+		T3DMesh<float>::Bone* b = bones[i];
+		int32_t parent;
+		std::vector<char> name;
+		std::vector<int32_t> children;
+		if (!read(ifs, &b->ID) || !readVec(ifs, &name, 1 << 16) || !read(ifs, &b->InvBindPoseMatrix)
+			|| !read(ifs, &parent) || !readVec(ifs, &children, boneCount)
+			|| !readVec(ifs, &b->VertexInfluences, vertexCount) || !readVec(ifs, &b->VertexWeights, vertexCount))
+			return fail();
+		if (parent >= int32_t(boneCount) || b->VertexInfluences.size() != b->VertexWeights.size())
+			return fail();
+		b->Name = std::string(name.begin(), name.end());
+		b->pParent = parent < 0 ? nullptr : bones[parent];
+		for (int32_t c : children) {
+			if (c < 0 || c >= int32_t(boneCount))
+				return fail();
+			b->Children.push_back(bones[c]);
+		}
+		for (int32_t v : b->VertexInfluences) {
+			if (v < 0 || v >= int32_t(vertexCount))
+				return fail();
+		}
+	}
+
+	pMesh->bones(&bones, false);
+	if (!T.isIdentity())
+		transformMesh(T, pMesh);
+	return true;
+}//load
+
+void RigCache::store(uint64_t key, const std::vector<Vector3f>& inputVertices, const T3DMesh<float>& rigged) const {
+	if (inputVertices.size() != rigged.vertexCount())
+		throw CForgeExcept("RigCache: vertex count of input and rigged mesh differ");
+
+	std::map<const T3DMesh<float>::Bone*, int32_t> index;
+	for (uint32_t i = 0; i < rigged.boneCount(); ++i)
+		index[rigged.getBone(i)] = i;
+
+	const Matrix4f T = vertexTransform(inputVertices, rigged);
+
+	// written to a temporary first, readers never see partial files. The temporary is unique per thread,
+	// concurrent rigs of the same mesh write the same content.
+	std::filesystem::create_directories(m_directory);
+	const std::string p = path(key);
+	const std::string tmp = p + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+	std::ofstream ofs(tmp, std::ios::binary | std::ios::trunc);
+	write(ofs, uint32_t(m_Magic));
+	write(ofs, uint32_t(m_Version));
+	write(ofs, key);
+	write(ofs, uint32_t(rigged.vertexCount()));
+	write(ofs, uint32_t(rigged.boneCount()));
+	write(ofs, T);
+	for (uint32_t i = 0; i < rigged.boneCount(); ++i) {
+		const T3DMesh<float>::Bone* b = rigged.getBone(i);
+		write(ofs, b->ID);
+		writeVec(ofs, std::vector<char>(b->Name.begin(), b->Name.end()));
+		write(ofs, b->InvBindPoseMatrix);
+		write(ofs, b->pParent ? index.at(b->pParent) : int32_t(-1));
+		std::vector<int32_t> children;
+		for (auto c : b->Children)
+			children.push_back(index.at(c));
+		writeVec(ofs, children);
+		writeVec(ofs, b->VertexInfluences);
+		writeVec(ofs, b->VertexWeights);
+	}
+	ofs.close();
+	if (!ofs) {
+		std::cerr << "RigCache: failed to write " << p << std::endl;
+		return;
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmp, p, ec);
+	if (ec)
+		std::cerr << "RigCache: failed to write " << p << ": " << ec.message() << std::endl;
+}//store
+
+void RigCache::clear() const {
+	std::error_code ec;
+	std::filesystem::remove_all(m_directory, ec);
+}//clear
+
+Matrix4f RigCache::vertexTransform(const std::vector<Vector3f>& before, const T3DMesh<float>& after) {
+	if (before.size() != after.vertexCount())
+		throw CForgeExcept("RigCache: vertex count of before and after differ");
+
+	bool moved = false;
+	for (uint32_t i = 0; i < before.size() && !moved; ++i)
+		moved = before[i] != after.vertex(i);
+	if (!moved || before.size() < 3)
+		return Matrix4f::Identity();
+
+	Matrix3Xf src(3, before.size()), dst(3, before.size());
+	for (uint32_t i = 0; i < before.size(); ++i) {
+		src.col(i) = before[i];
+		dst.col(i) = after.vertex(i);
+	}
+	return umeyama(src, dst, true);
+}//vertexTransform
+
+void RigCache::transformMesh(const Matrix4f& T, T3DMesh<float>* pMesh) {
+	if (!pMesh)
+		throw NullpointerExcept("pMesh");
+	const Matrix3f R = T.block<3,3>(0,0);
+	const Vector3f t = T.block<3,1>(0,3);
+	for (uint32_t i = 0; i < pMesh->vertexCount(); ++i)
+		pMesh->vertex(i) = R * pMesh->vertex(i) + t;
+	pMesh->geometryChanged();
+	const Matrix3f N = R.inverse().transpose();
+	for (uint32_t i = 0; i < pMesh->normalCount(); ++i)
+		pMesh->normal(i) = (N * pMesh->normal(i)).normalized();
+	for (uint32_t i = 0; i < pMesh->tangentCount(); ++i)
+		pMesh->tangent(i) = (R * pMesh->tangent(i)).normalized();
+}//transformMesh
+
+}//CForge
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <crossforge/AssetIO/T3DMesh.hpp>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Content addressed cache of auto rigging results. The key is a hash of the mesh geometry (positions and faces)
+ *        and a string describing rigger and options, so unchanged scans are not rigged again.
+ *        One binary file per key holds skeleton, bind poses, weights and the similarity the rigger applied to the
+ *        mesh vertices (e.g. ARpinocchio moves the mesh into its own space).
+*/
+class RigCache {
+public:
+	RigCache(std::string directory = "MyAssets/Cache/Rigs/");
+
+	/**
+	 * @param rigger name and all options of the rigger affecting the result
+	*/
+	static uint64_t key(const T3DMesh<float>& mesh, const std::string& rigger);
+
+	/**
+	 * @brief replaces skeleton of pMesh with the cached one and applies the cached vertex transform.
+	 * @return false if there is no valid entry for key, pMesh is unchanged then
+	*/
+	bool load(uint64_t key, T3DMesh<float>* pMesh) const;
+
+	/**
+	 * @param inputVertices vertices of the mesh before rigging, used to recover the vertex transform of the rigger
+	*/
+	void store(uint64_t key, const std::vector<Vector3f>& inputVertices, const T3DMesh<float>& rigged) const;
+
+	void clear() const;
+
+	/**
+	 * @brief similarity (rotation, uniform scale, translation) mapping before to the vertices of after, least squares
+	*/
+	static Matrix4f vertexTransform(const std::vector<Vector3f>& before, const T3DMesh<float>& after);
+	/**
+	 * @brief applies similarity T to vertices, normals and tangents of pMesh
+	*/
+	static void transformMesh(const Matrix4f& T, T3DMesh<float>* pMesh);
+
+private:
+	std::string path(uint64_t key) const;
+
+	std::string m_directory;
+	static const uint32_t m_Magic = 0x43524643; // "CFRC"
+	static const uint32_t m_Version = 1;
+};//RigCache
+
+}//CForge
@@ -0,0 +1,80 @@
+#include "RigJob.hpp"
+
+namespace CForge {
+
+RigJob::RigJob(const T3DMesh<float>& mesh, RigFunc rig)
+	: m_mesh(mesh), m_state(STATE_RUNNING), m_thread(&RigJob::run, this, std::move(rig)) {
+
+}//Constructor
+
+RigJob::~RigJob() {
+	cancel();
+	wait();
+}//Destructor
+
+void RigJob::run(RigFunc rig) {
+	State result = STATE_DONE;
+	try {
+		rig(&m_mesh, &m_progress);
+		if (m_progress.cancelled)
+			result = STATE_CANCELLED;
+	}
+	catch (const RigCancelled&) {
+		result = STATE_CANCELLED;
+	}
+	catch (const CrossForgeException& e) {
+		m_error = e.msg();
+		result = STATE_FAILED;
+	}
+	catch (const std::exception& e) {
+		m_error = e.what();
+		result = STATE_FAILED;
+	}
+	catch (...) {
+		m_error = "unknown exception";
+		result = STATE_FAILED;
+	}
+	if (result == STATE_DONE) {
+		m_progress.progress = 1.f;
+		m_progress.stage = "done";
+	}
+	m_state = result;
+}//run
+
+RigJob::State RigJob::state() const {
+	return State(m_state.load());
+}//state
+
+float RigJob::progress() const {
+	return m_progress.progress;
+}//progress
+
+const char* RigJob::stage() const {
+	return m_progress.stage;
+}//stage
+
+std::string RigJob::error() const {
+	return (state() == STATE_FAILED) ? m_error : "";
+}//error
+
+void RigJob::cancel() {
+	m_progress.cancelled = true;
+}//cancel
+
+bool RigJob::finish(T3DMesh<float>* pMesh) {
+	if (!pMesh)
+		throw NullpointerExcept("pMesh");
+	if (m_finished || state() != STATE_DONE)
+		return false;
+	wait();
+	pMesh->swap(m_mesh);
+	m_finished = true;
+	return true;
+}//finish
+
+void RigJob::wait() {
+	if (m_thread.joinable())
+		m_thread.join();
+}//wait
+
+}//CForge
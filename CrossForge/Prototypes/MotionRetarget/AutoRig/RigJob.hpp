@@ -0,0 +1,75 @@
+#pragma once
+
+#include "IAutoRigger.hpp"
+
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace CForge {
+
+/**
+ * @brief Runs an auto rigger on a worker thread against a private copy of the mesh, so the caller stays responsive.
+ *        The owner polls state() and takes the result with finish(). Several jobs may run at the same time.
+*/
+class RigJob {
+public:
+	using RigFunc = std::function<void(T3DMesh<float>* pMesh, RigProgress* pProgress)>;
+
+	enum State : int32_t {
+		STATE_RUNNING,
+		STATE_DONE,
+		STATE_FAILED,
+		STATE_CANCELLED,
+	};
+
+	/**
+	 * @brief copies mesh and starts rig on it.
+	*/
+	RigJob(const T3DMesh<float>& mesh, RigFunc rig);
+
+	/**
+	 * @brief job for a single IAutoRigger, the job keeps pRigger alive.
+	*/
+	template<typename Rigger, typename AROptions>
+	RigJob(const T3DMesh<float>& mesh, std::shared_ptr<Rigger> pRigger, AROptions options)
+		: RigJob(mesh, [pRigger, options](T3DMesh<float>* pMesh, RigProgress* pProgress) {
+			pRigger->progress(pProgress);
+			pRigger->rig(pMesh, options);
+		}) { }
+
+	/**
+	 * @brief cancels and waits for the worker.
+	*/
+	~RigJob();
+
+	State state() const;
+	float progress() const;
+	const char* stage() const;
+	std::string error() const; // message if state is STATE_FAILED
+
+	/**
+	 * @brief requests cancellation, riggers stop at their next progress report.
+	*/
+	void cancel();
+
+	/**
+	 * @brief swaps the rigged mesh into pMesh if the job is done.
+	 * @return true if pMesh was replaced, only once per job
+	*/
+	bool finish(T3DMesh<float>* pMesh);
+
+	void wait();
+
+private:
+	void run(RigFunc rig);
+
+	T3DMesh<float> m_mesh;
+	RigProgress m_progress;
+	std::atomic<int32_t> m_state;
+	std::string m_error; // written by the worker before m_state changes
+	bool m_finished = false;
+	std::thread m_thread; // last, started after all members are initialized
+};//RigJob
+
+}//CForge
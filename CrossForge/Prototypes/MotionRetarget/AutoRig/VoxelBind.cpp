@@ -0,0 +1,397 @@
+#include "VoxelBind.hpp"
+
+#include <crossforge/Core/Parallel.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <queue>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace {
+	Vector3f projToSeg(const Vector3f& p, const VoxelBind::Segment& s) {
+		const Vector3f d = s.end - s.begin;
+		const float len2 = d.squaredNorm();
+		if (len2 <= 0.f)
+			return s.begin;
+		const float t = std::clamp((p - s.begin).dot(d) / len2, 0.f, 1.f);
+		return s.begin + t*d;
+	}
+
+	// Ericson, Real-Time Collision Detection 5.1.5
+	Vector3f closestOnTriangle(const Vector3f& p, const Vector3f& a, const Vector3f& b, const Vector3f& c) {
+		const Vector3f ab = b - a, ac = c - a, ap = p - a;
+		const float d1 = ab.dot(ap), d2 = ac.dot(ap);
+		if (d1 <= 0.f && d2 <= 0.f)
+			return a;
+		const Vector3f bp = p - b;
+		const float d3 = ab.dot(bp), d4 = ac.dot(bp);
+		if (d3 >= 0.f && d4 <= d3)
+			return b;
+		const float vc = d1*d4 - d3*d2;
+		if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f)
+			return a + d1 / (d1 - d3) * ab;
+		const Vector3f cp = p - c;
+		const float d5 = ab.dot(cp), d6 = ac.dot(cp);
+		if (d6 >= 0.f && d5 <= d6)
+			return c;
+		const float vb = d5*d2 - d1*d6;
+		if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f)
+			return a + d2 / (d2 - d6) * ac;
+		const float va = d3*d6 - d5*d4;
+		if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f)
+			return b + (d4 - d3) / ((d4 - d3) + (d5 - d6)) * (c - b);
+		const float denom = 1.f / (va + vb + vc);
+		return a + ab * (vb * denom) + ac * (vc * denom);
+	}
+}
+
+void VoxelBind::compute(const T3DMesh<float>& mesh, const std::vector<Segment>& bones, const Config& config,
+                        std::vector<Influences>* pWeights, const std::function<void(float)>& progress) {
+	if (!pWeights)
+		throw NullpointerExcept("pWeights");
+	if (bones.empty())
+		throw CForgeExcept("VoxelBind: no bones given");
+	if (config.resolution < 4)
+		throw CForgeExcept("VoxelBind: resolution too small");
+
+	const int32_t nv = mesh.vertexCount();
+	const int32_t nb = bones.size();
+	pWeights->assign(nv, Influences());
+	if (nv == 0)
+		return;
+
+	voxelize(mesh, config);
+	fillInterior(config.closeRadius);
+	if (progress)
+		progress(0.1f);
+
+	// geodesic distance of every vertex to every bone, one Dijkstra per bone. Bones are processed in batches
+	// of one per thread, progress is reported between the batches on the calling thread.
+	std::vector<float> dist(size_t(nv)*nb); // per bone, then per vertex
+	const int32_t batch = int32_t(parallelRangeCount(nb, 1));
+	for (int32_t b = 0; b < nb; b += batch) {
+		const int32_t e = std::min(nb, b + batch);
+		parallelFor(b, e, [&](size_t jb, size_t je) {
+			for (size_t j = jb; j < je; ++j)
+				distances(bones[j], config, &dist[j*nv]);
+		}, 1);
+		if (progress)
+			progress(0.1f + 0.85f * float(e) / nb);
+	}
+
+	// normalized by the grid size, the falloff does not depend on the mesh scale
+	const float norm = 1.f / (m_h * config.resolution);
+	const float alpha = config.falloff;
+	const int32_t maxInf = std::max(1, config.maxInfluences);
+	parallelFor(0, nv, [&](size_t b, size_t e) {
+		std::vector<std::pair<float,int32_t>> cand;
+		for (size_t i = b; i < e; ++i) {
+			cand.clear();
+			for (int32_t j = 0; j < nb; ++j) {
+				const float d = dist[size_t(j)*nv + i];
+				if (d < FLT_MAX)
+					cand.push_back(std::make_pair(std::max(d * norm, 1e-4f), j));
+			}
+			Influences& inf = (*pWeights)[i];
+			if (cand.empty()) {
+				// vertex voxel unreachable, bind to the closest bone
+				float best = FLT_MAX;
+				int32_t bestJ = 0;
+				for (int32_t j = 0; j < nb; ++j) {
+					const float d = (projToSeg(m_pos[i], bones[j]) - m_pos[i]).squaredNorm();
+					if (d < best) {
+						best = d;
+						bestJ = j;
+					}
+				}
+				inf.push_back(std::make_pair(bestJ, 1.f));
+				continue;
+			}
+
+			const int32_t k = std::min<int32_t>(maxInf, cand.size());
+			std::partial_sort(cand.begin(), cand.begin() + k, cand.end());
+			float sum = 0.f;
+			for (int32_t c = 0; c < k; ++c) {
+				const float d = cand[c].first;
+				const float f = (1.f - alpha)*d + alpha*d*d;
+				const float w = 1.f / (f*f);
+				inf.push_back(std::make_pair(cand[c].second, w));
+				sum += w;
+			}
+			// prune relative to the total, closest bone always survives
+			float kept = 0.f;
+			auto last = std::remove_if(inf.begin() + 1, inf.end(), [&](const std::pair<int32_t,float>& p) {
+				return p.second / sum < config.minWeight; });
+			inf.erase(last, inf.end());
+			for (auto& [j, w] : inf)
+				kept += w;
+			for (auto& [j, w] : inf)
+				w /= kept;
+			std::sort(inf.begin(), inf.end());
+		}
+	});
+}//compute
+
+Vector3f VoxelBind::center(int32_t idx) const {
+	const int32_t x = idx % m_dim[0];
+	const int32_t y = (idx / m_dim[0]) % m_dim[1];
+	const int32_t z = idx / (m_dim[0]*m_dim[1]);
+	return m_origin + m_h * Vector3f(x + 0.5f, y + 0.5f, z + 0.5f);
+}//center
+
+void VoxelBind::voxelize(const T3DMesh<float>& mesh, const Config& config) {
+	const int32_t nv = mesh.vertexCount();
+	m_pos.resize(nv);
+	Vector3f bbMin = Vector3f::Constant(FLT_MAX), bbMax = Vector3f::Constant(-FLT_MAX);
+	for (int32_t i = 0; i < nv; ++i) {
+		m_pos[i] = mesh.vertex(i);
+		bbMin = bbMin.cwiseMin(m_pos[i]);
+		bbMax = bbMax.cwiseMax(m_pos[i]);
+	}
+
+	// empty padding on every side, the exterior stays connected around the mesh after dilating the surface
+	const int32_t pad = std::max(0, config.closeRadius) + 2;
+	m_h = std::max((bbMax - bbMin).maxCoeff(), 1e-6f) / config.resolution;
+	m_origin = bbMin - Vector3f::Constant(pad * m_h);
+	for (int32_t d = 0; d < 3; ++d)
+		m_dim[d] = int32_t(std::ceil((bbMax[d] - bbMin[d]) / m_h)) + 2*pad;
+	m_voxels.assign(size_t(m_dim[0])*m_dim[1]*m_dim[2], VOXEL_EMPTY);
+
+	std::vector<Vector3i> tris;
+	for (uint32_t s = 0; s < mesh.submeshCount(); ++s) {
+		for (const auto& f : mesh.getSubmesh(s)->Faces) {
+			const int32_t* v = f.Vertices;
+			if (v[0] >= 0 && v[0] < nv && v[1] >= 0 && v[1] < nv && v[2] >= 0 && v[2] < nv)
+				tris.emplace_back(v[0], v[1], v[2]);
+		}
+	}
+
+	// voxel bounds of the triangles, grown by one voxel for the conservative test below
+	std::vector<std::pair<Vector3i,Vector3i>> triBounds(tris.size());
+	parallelFor(0, tris.size(), [&](size_t b, size_t e) {
+		for (size_t t = b; t < e; ++t) {
+			Vector3f lo = m_pos[tris[t][0]].cwiseMin(m_pos[tris[t][1]]).cwiseMin(m_pos[tris[t][2]]);
+			Vector3f hi = m_pos[tris[t][0]].cwiseMax(m_pos[tris[t][1]]).cwiseMax(m_pos[tris[t][2]]);
+			Vector3i l, u;
+			for (int32_t d = 0; d < 3; ++d) {
+				l[d] = std::max(0, int32_t(std::floor((lo[d] - m_origin[d]) / m_h)) - 1);
+				u[d] = std::min(m_dim[d] - 1, int32_t(std::floor((hi[d] - m_origin[d]) / m_h)) + 1);
+			}
+			triBounds[t] = std::make_pair(l, u);
+		}
+	});
+
+	// a voxel is part of the surface if a triangle comes closer to its center than half its diagonal.
+	// Every worker owns a range of z slices, so no two threads write the same voxel.
+	const float r = 0.5f * std::sqrt(3.f) * m_h;
+	parallelFor(0, m_dim[2], [&](size_t zb, size_t ze) {
+		for (size_t t = 0; t < tris.size(); ++t) {
+			const auto& [l, u] = triBounds[t];
+			const int32_t z0 = std::max<int32_t>(l[2], zb), z1 = std::min<int32_t>(u[2], ze - 1);
+			if (z0 > z1)
+				continue;
+			const Vector3f& a = m_pos[tris[t][0]];
+			const Vector3f& b = m_pos[tris[t][1]];
+			const Vector3f& c = m_pos[tris[t][2]];
+			Vector3f n = (b - a).cross(c - a);
+			const float nLen = n.norm();
+			if (nLen > 0.f)
+				n /= nLen;
+			for (int32_t z = z0; z <= z1; ++z) {
+				for (int32_t y = l[1]; y <= u[1]; ++y) {
+					for (int32_t x = l[0]; x <= u[0]; ++x) {
+						const int32_t idx = index(x, y, z);
+						if (m_voxels[idx] == VOXEL_SURFACE)
+							continue;
+						const Vector3f p = m_origin + m_h * Vector3f(x + 0.5f, y + 0.5f, z + 0.5f);
+						if (nLen > 0.f && std::abs(n.dot(p - a)) > r)
+							continue; // plane too far
+						if ((closestOnTriangle(p, a, b, c) - p).squaredNorm() <= r*r)
+							m_voxels[idx] = VOXEL_SURFACE;
+					}
+				}
+			}
+		}
+	}, 1);
+
+	// vertices lie in surface voxels by construction
+	m_vertVoxel.resize(nv);
+	m_isTarget.assign(m_voxels.size(), 0);
+	m_targets.clear();
+	for (int32_t i = 0; i < nv; ++i) {
+		Vector3i v;
+		for (int32_t d = 0; d < 3; ++d)
+			v[d] = std::clamp(int32_t((m_pos[i][d] - m_origin[d]) / m_h), 0, m_dim[d] - 1);
+		const int32_t idx = index(v[0], v[1], v[2]);
+		m_vertVoxel[i] = idx;
+		if (!m_isTarget[idx]) {
+			m_isTarget[idx] = 1;
+			m_targets.push_back(idx);
+		}
+	}
+}//voxelize
+
+void VoxelBind::fillInterior(int32_t closeRadius) {
+	// morphological closing: the surface is dilated by closeRadius voxels, the exterior flooded from the grid
+	// border around the dilated surface and grown back by closeRadius. Empty voxels the exterior does not reach are
+	// enclosed. Larger holes let the flood leak inside, only the surface shell stays solid then and Dijkstra
+	// crosses the inside at emptyCost.
+	const uint8_t far = 0xFF;
+	std::vector<uint8_t> surfDist(m_voxels.size(), far); // voxel steps to the surface, up to closeRadius
+	std::vector<int32_t> front;
+	for (int32_t i = 0; i < (int32_t)m_voxels.size(); ++i) {
+		if (m_voxels[i] == VOXEL_SURFACE) {
+			surfDist[i] = 0;
+			front.push_back(i);
+		}
+	}
+	grow(&front, &surfDist, closeRadius, VOXEL_EMPTY, VOXEL_EMPTY);
+
+	// flood exterior, the border is outside the dilated surface because of the padding
+	std::vector<int32_t> stack;
+	auto push = [&](int32_t x, int32_t y, int32_t z) {
+		const int32_t idx = index(x, y, z);
+		if (m_voxels[idx] == VOXEL_EMPTY && surfDist[idx] == far) {
+			m_voxels[idx] = VOXEL_OUTSIDE;
+			stack.push_back(idx);
+		}
+	};
+	push(0, 0, 0);
+	while (!stack.empty()) {
+		const int32_t idx = stack.back();
+		stack.pop_back();
+		const int32_t x = idx % m_dim[0];
+		const int32_t y = (idx / m_dim[0]) % m_dim[1];
+		const int32_t z = idx / (m_dim[0]*m_dim[1]);
+		if (x > 0) push(x - 1, y, z);
+		if (x < m_dim[0] - 1) push(x + 1, y, z);
+		if (y > 0) push(x, y - 1, z);
+		if (y < m_dim[1] - 1) push(x, y + 1, z);
+		if (z > 0) push(x, y, z - 1);
+		if (z < m_dim[2] - 1) push(x, y, z + 1);
+	}
+
+	// erode, the exterior takes back the dilated empty voxels it touches
+	std::vector<uint8_t> outDist(m_voxels.size(), far);
+	front.clear();
+	for (int32_t i = 0; i < (int32_t)m_voxels.size(); ++i) {
+		if (m_voxels[i] == VOXEL_OUTSIDE) {
+			outDist[i] = 0;
+			front.push_back(i);
+		}
+	}
+	grow(&front, &outDist, closeRadius, VOXEL_EMPTY, VOXEL_OUTSIDE);
+
+	for (auto& v : m_voxels) {
+		if (v == VOXEL_EMPTY)
+			v = VOXEL_INTERIOR;
+	}
+}//fillInterior
+
+void VoxelBind::grow(std::vector<int32_t>* pFront, std::vector<uint8_t>* pDist, int32_t steps, uint8_t from, uint8_t to) {
+	// breadth first over the 26 neighbourhood, voxels of type from within steps get their distance and become type to
+	std::vector<int32_t> next;
+	for (int32_t s = 1; s <= steps && !pFront->empty(); ++s) {
+		next.clear();
+		for (int32_t idx : *pFront) {
+			const int32_t x = idx % m_dim[0];
+			const int32_t y = (idx / m_dim[0]) % m_dim[1];
+			const int32_t z = idx / (m_dim[0]*m_dim[1]);
+			for (int32_t dz = -1; dz <= 1; ++dz) {
+				for (int32_t dy = -1; dy <= 1; ++dy) {
+					for (int32_t dx = -1; dx <= 1; ++dx) {
+						const int32_t nx = x + dx, ny = y + dy, nz = z + dz;
+						if (nx < 0 || ny < 0 || nz < 0 || nx >= m_dim[0] || ny >= m_dim[1] || nz >= m_dim[2])
+							continue;
+						const int32_t nIdx = index(nx, ny, nz);
+						if (m_voxels[nIdx] != from || (*pDist)[nIdx] <= s)
+							continue;
+						(*pDist)[nIdx] = s;
+						m_voxels[nIdx] = to;
+						next.push_back(nIdx);
+					}
+				}
+			}
+		}
+		pFront->swap(next);
+	}
+}//grow
+
+void VoxelBind::distances(const Segment& bone, const Config& config, float* pVertDist) const {
+	const size_t n = m_voxels.size();
+	std::vector<float> dist(n, FLT_MAX);
+	std::vector<uint8_t> done(n, 0);
+	using Entry = std::pair<float,int32_t>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+
+	// sources: voxels along the bone, starting with their distance to the bone
+	const float len = (bone.end - bone.begin).norm();
+	const int32_t steps = std::max(1, int32_t(std::ceil(2.f * len / m_h)));
+	for (int32_t s = 0; s <= steps; ++s) {
+		const Vector3f p = bone.begin + (bone.end - bone.begin) * (float(s) / steps);
+		Vector3i v;
+		for (int32_t d = 0; d < 3; ++d)
+			v[d] = std::clamp(int32_t(std::floor((p[d] - m_origin[d]) / m_h)), 0, m_dim[d] - 1);
+		const int32_t idx = index(v[0], v[1], v[2]);
+		const Vector3f c = center(idx);
+		const float d = (projToSeg(c, bone) - c).norm();
+		if (d < dist[idx]) {
+			dist[idx] = d;
+			queue.push(Entry(d, idx));
+		}
+	}
+
+	// 26 neighbourhood
+	int32_t offsets[26];
+	float lengths[26];
+	int32_t k = 0;
+	for (int32_t dz = -1; dz <= 1; ++dz) {
+		for (int32_t dy = -1; dy <= 1; ++dy) {
+			for (int32_t dx = -1; dx <= 1; ++dx) {
+				if (dx == 0 && dy == 0 && dz == 0)
+					continue;
+				offsets[k] = (dz*m_dim[1] + dy)*m_dim[0] + dx;
+				lengths[k] = m_h * std::sqrt(float(dx*dx + dy*dy + dz*dz));
+				++k;
+			}
+		}
+	}
+
+	size_t remaining = m_targets.size();
+	while (!queue.empty() && remaining > 0) {
+		const auto [d, idx] = queue.top();
+		queue.pop();
+		if (done[idx])
+			continue;
+		done[idx] = 1;
+		if (m_isTarget[idx])
+			--remaining;
+
+		const int32_t x = idx % m_dim[0];
+		const int32_t y = (idx / m_dim[0]) % m_dim[1];
+		const int32_t z = idx / (m_dim[0]*m_dim[1]);
+		if (x == 0 || y == 0 || z == 0 || x == m_dim[0] - 1 || y == m_dim[1] - 1 || z == m_dim[2] - 1)
+			continue; // border voxels are never solid, paths around the mesh do not need them
+		const bool solid = m_voxels[idx] >= VOXEL_SURFACE;
+		for (int32_t o = 0; o < 26; ++o) {
+			const int32_t nIdx = idx + offsets[o];
+			if (done[nIdx])
+				continue;
+			const bool nSolid = m_voxels[nIdx] >= VOXEL_SURFACE;
+			const float nd = d + lengths[o] * ((solid && nSolid) ? 1.f : config.emptyCost);
+			if (nd < dist[nIdx]) {
+				dist[nIdx] = nd;
+				queue.push(Entry(nd, nIdx));
+			}
+		}
+	}
+
+	for (size_t i = 0; i < m_pos.size(); ++i) {
+		const int32_t idx = m_vertVoxel[i];
+		pVertDist[i] = (dist[idx] < FLT_MAX) ? dist[idx] + (m_pos[i] - center(idx)).norm() : FLT_MAX;
+	}
+}//distances
+
+}//CForge
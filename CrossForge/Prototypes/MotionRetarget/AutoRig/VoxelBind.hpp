@@ -0,0 +1,67 @@
+#pragma once
+
+#include "BoneHeat.hpp"
+
+#include <functional>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Geodesic voxel binding skin weights (Dionne and de Lasa 2013). The mesh is voxelized into a solid grid,
+ *        the distance of every vertex to every bone is measured along paths inside the solid (multi source Dijkstra
+ *        per bone, seeded by the voxels the bone passes through) and weights fall off with that distance.
+ *        Holes, self intersections and non-manifold parts of scans only change the voxels, paths leaving the solid
+ *        are penalized instead of forbidden, so every vertex receives weights. Cost depends on the grid resolution,
+ *        not on the mesh quality.
+*/
+class VoxelBind {
+public:
+	using Influences = BoneHeat::Influences; // (bone, weight), weights of a vertex sum to 1
+	using Segment = BoneHeat::Segment;
+
+	struct Config {
+		int32_t resolution = 128;  // voxels along the longest side of the mesh bounds
+		float falloff = 0.5f;      // alpha, weight is ((1-alpha)*d + alpha*d^2)^-2 with d the geodesic distance
+		int32_t closeRadius = 2;   // voxels, holes up to about twice as wide are closed before the inside is filled
+		float emptyCost = 8.f;     // cost factor of paths through voxels outside the solid
+		int32_t maxInfluences = 4; // closest bones kept per vertex
+		float minWeight = 1e-3f;   // smaller weights are dropped, remaining ones renormalized
+	};
+
+	/**
+	 * @brief computes skin weights for all vertices of mesh, all submeshes together form the surface.
+	 * @param bones segments in mesh space, index of a segment is the bone index of the resulting influences
+	 * @param progress optional, called from the calling thread with values in [0,1], may throw to abort
+	*/
+	void compute(const T3DMesh<float>& mesh, const std::vector<Segment>& bones, const Config& config,
+		std::vector<Influences>* pWeights, const std::function<void(float)>& progress = nullptr);
+
+private:
+	enum Voxel : uint8_t {
+		VOXEL_EMPTY = 0,
+		VOXEL_OUTSIDE,  // empty and connected to the grid border
+		VOXEL_SURFACE,  // touched by a triangle
+		VOXEL_INTERIOR, // enclosed by surface voxels
+	};
+
+	int32_t index(int32_t x, int32_t y, int32_t z) const { return (z*m_dim[1] + y)*m_dim[0] + x; }
+	Vector3f center(int32_t idx) const;
+
+	void voxelize(const T3DMesh<float>& mesh, const Config& config);
+	void fillInterior(int32_t closeRadius);
+	void grow(std::vector<int32_t>* pFront, std::vector<uint8_t>* pDist, int32_t steps, uint8_t from, uint8_t to);
+	void distances(const Segment& bone, const Config& config, float* pVertDist) const;
+
+	Vector3f m_origin; // corner of voxel 0
+	float m_h;         // voxel edge length
+	Vector3i m_dim;
+	std::vector<uint8_t> m_voxels;
+
+	std::vector<Vector3f> m_pos;
+	std::vector<int32_t> m_vertVoxel;  // voxel containing each vertex
+	std::vector<int32_t> m_targets;    // distinct vertex voxels, Dijkstra stops once all are settled
+	std::vector<uint8_t> m_isTarget;   // per voxel
+};//VoxelBind
+
+}//CForge
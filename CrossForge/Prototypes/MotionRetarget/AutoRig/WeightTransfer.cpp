@@ -0,0 +1,328 @@
+#include "WeightTransfer.hpp"
+
+#include <crossforge/Core/Parallel.hpp>
+
+#include <algorithm>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace {
+	/**
+	 * @brief closest point on triangle abc to p (Ericson, Real-Time Collision Detection 5.1.5)
+	 * @return barycentric coordinates of the closest point
+	*/
+	Vector3f closestBarycentric(const Vector3f& p, const Vector3f& a, const Vector3f& b, const Vector3f& c) {
+		const Vector3f ab = b - a, ac = c - a, ap = p - a;
+		const float d1 = ab.dot(ap), d2 = ac.dot(ap);
+		if (d1 <= 0.f && d2 <= 0.f)
+			return Vector3f(1.f, 0.f, 0.f);
+
+		const Vector3f bp = p - b;
+		const float d3 = ab.dot(bp), d4 = ac.dot(bp);
+		if (d3 >= 0.f && d4 <= d3)
+			return Vector3f(0.f, 1.f, 0.f);
+
+		const float vc = d1*d4 - d3*d2;
+		if (vc <= 0.f && d1 >= 0.f && d3 <= 0.f) {
+			const float v = d1 / (d1 - d3);
+			return Vector3f(1.f - v, v, 0.f);
+		}
+
+		const Vector3f cp = p - c;
+		const float d5 = ab.dot(cp), d6 = ac.dot(cp);
+		if (d6 >= 0.f && d5 <= d6)
+			return Vector3f(0.f, 0.f, 1.f);
+
+		const float vb = d5*d2 - d1*d6;
+		if (vb <= 0.f && d2 >= 0.f && d6 <= 0.f) {
+			const float w = d2 / (d2 - d6);
+			return Vector3f(1.f - w, 0.f, w);
+		}
+
+		const float va = d3*d6 - d5*d4;
+		if (va <= 0.f && (d4 - d3) >= 0.f && (d5 - d6) >= 0.f) {
+			const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+			return Vector3f(0.f, 1.f - w, w);
+		}
+
+		const float denom = 1.f / (va + vb + vc);
+		const float v = vb * denom, w = vc * denom;
+		return Vector3f(1.f - v - w, v, w);
+	}
+
+	// adds s*in to pOut, both sorted by bone
+	void accumulate(const WeightTransfer::Influences& in, float s, WeightTransfer::Influences* pOut) {
+		WeightTransfer::Influences merged;
+		merged.reserve(in.size() + pOut->size());
+		auto a = pOut->begin();
+		auto b = in.begin();
+		while (a != pOut->end() || b != in.end()) {
+			if (b == in.end() || (a != pOut->end() && a->first < b->first))
+				merged.push_back(*a++);
+			else if (a == pOut->end() || b->first < a->first) {
+				merged.push_back(std::make_pair(b->first, s * b->second));
+				++b;
+			}
+			else {
+				merged.push_back(std::make_pair(a->first, a->second + s * b->second));
+				++a;
+				++b;
+			}
+		}
+		pOut->swap(merged);
+	}
+
+	void prune(float minWeight, WeightTransfer::Influences* pInf) {
+		float sum = 0.f;
+		for (const auto& [j, w] : *pInf)
+			sum += w;
+		// keep the strongest influence even if all are small
+		const float threshold = std::min(minWeight * sum, std::max_element(pInf->begin(), pInf->end(),
+			[](const auto& a, const auto& b) { return a.second < b.second; })->second);
+		pInf->erase(std::remove_if(pInf->begin(), pInf->end(),
+			[&](const auto& i) { return i.second < threshold; }), pInf->end());
+		sum = 0.f;
+		for (const auto& [j, w] : *pInf)
+			sum += w;
+		for (auto& [j, w] : *pInf)
+			w /= sum;
+	}
+}
+
+void WeightTransfer::transfer(const T3DMesh<float>& proxy, T3DMesh<float>* pTarget, const Config& config) {
+	if (!pTarget)
+		throw NullpointerExcept("pTarget");
+	if (proxy.boneCount() != pTarget->boneCount())
+		throw CForgeExcept("WeightTransfer: proxy and target bone count differ");
+	if (proxy.vertexCount() == 0)
+		throw CForgeExcept("WeightTransfer: proxy has no vertices");
+
+	buildProxy(proxy);
+
+	const T3DMesh<float>& target = *pTarget;
+	const int32_t nv = target.vertexCount();
+	std::vector<Influences> weights(nv);
+	parallelFor(0, nv, [&](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i)
+			project(target.vertex(i), std::max(1, config.candidates), &weights[i]);
+	}, 1024);
+
+	if (config.smoothIterations > 0)
+		smooth(*pTarget, config, &weights);
+
+	parallelFor(0, nv, [&](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			if (!weights[i].empty())
+				prune(config.minWeight, &weights[i]);
+		}
+	});
+
+	for (uint32_t j = 0; j < pTarget->boneCount(); ++j) {
+		pTarget->getBone(j)->VertexInfluences.clear();
+		pTarget->getBone(j)->VertexWeights.clear();
+	}
+	for (int32_t i = 0; i < nv; ++i) {
+		for (const auto& [j, w] : weights[i]) {
+			T3DMesh<float>::Bone* pBone = pTarget->getBone(j);
+			pBone->VertexInfluences.push_back(i);
+			pBone->VertexWeights.push_back(w);
+		}
+	}
+}//transfer
+
+void WeightTransfer::buildProxy(const T3DMesh<float>& proxy) {
+	const int32_t nv = proxy.vertexCount();
+	m_pos.resize(nv);
+	for (int32_t i = 0; i < nv; ++i)
+		m_pos[i] = proxy.vertex(i);
+
+	m_tris.clear();
+	for (uint32_t s = 0; s < proxy.submeshCount(); ++s) {
+		for (const auto& f : proxy.getSubmesh(s)->Faces) {
+			const int32_t* v = f.Vertices;
+			bool valid = v[0] != v[1] && v[1] != v[2] && v[2] != v[0];
+			for (int32_t k = 0; k < 3; ++k)
+				valid &= v[k] >= 0 && v[k] < nv;
+			// zero area triangles would divide by zero in the projection
+			if (valid && (m_pos[v[1]] - m_pos[v[0]]).cross(m_pos[v[2]] - m_pos[v[0]]).squaredNorm() > 0.f)
+				m_tris.push_back(Vector3i(v[0], v[1], v[2]));
+		}
+	}
+
+	m_vertTriOffset.assign(nv + 1, 0);
+	for (const auto& t : m_tris) {
+		for (int32_t k = 0; k < 3; ++k)
+			m_vertTriOffset[t[k] + 1]++;
+	}
+	for (int32_t i = 0; i < nv; ++i)
+		m_vertTriOffset[i+1] += m_vertTriOffset[i];
+	m_vertTris.resize(m_vertTriOffset[nv]);
+	std::vector<int32_t> fill(m_vertTriOffset.begin(), m_vertTriOffset.end() - 1);
+	for (int32_t t = 0; t < (int32_t)m_tris.size(); ++t) {
+		for (int32_t k = 0; k < 3; ++k)
+			m_vertTris[fill[m_tris[t][k]]++] = t;
+	}
+
+	// bone i of the proxy is bone i of the target
+	m_proxyWeights.assign(nv, Influences());
+	for (uint32_t j = 0; j < proxy.boneCount(); ++j) {
+		const T3DMesh<float>::Bone* pBone = proxy.getBone(j);
+		for (size_t k = 0; k < pBone->VertexInfluences.size() && k < pBone->VertexWeights.size(); ++k) {
+			const int32_t v = pBone->VertexInfluences[k];
+			if (v >= 0 && v < nv && pBone->VertexWeights[k] > 0.f)
+				m_proxyWeights[v].push_back(std::make_pair(int32_t(j), pBone->VertexWeights[k]));
+		}
+	}
+	for (auto& inf : m_proxyWeights)
+		std::sort(inf.begin(), inf.end());
+
+	m_order.resize(nv);
+	for (int32_t i = 0; i < nv; ++i)
+		m_order[i] = i;
+	m_nodes.clear();
+	buildNode(0, nv);
+}//buildProxy
+
+int32_t WeightTransfer::buildNode(int32_t begin, int32_t end) {
+	const int32_t id = m_nodes.size();
+	m_nodes.push_back(KDNode{ begin, end, -1, -1, -1, 0.f });
+	if (end - begin <= m_LeafSize)
+		return id;
+
+	// split widest dimension at its median
+	AlignedBox3f box;
+	for (int32_t i = begin; i < end; ++i)
+		box.extend(m_pos[m_order[i]]);
+	int32_t splitDim;
+	if (box.sizes().maxCoeff(&splitDim) <= 0.f)
+		return id; // identical points
+
+	const int32_t mid = begin + (end - begin) / 2;
+	std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+		[&](int32_t a, int32_t b) { return m_pos[a][splitDim] < m_pos[b][splitDim]; });
+
+	m_nodes[id].splitDim = splitDim;
+	m_nodes[id].splitVal = m_pos[m_order[mid]][splitDim];
+	const int32_t left = buildNode(begin, mid);
+	const int32_t right = buildNode(mid, end);
+	m_nodes[id].left = left;
+	m_nodes[id].right = right;
+	return id;
+}//buildNode
+
+void WeightTransfer::searchNode(int32_t node, float boxDist, Search* pS) const {
+	const KDNode& n = m_nodes[node];
+	std::vector<std::pair<float,int32_t>>& best = *pS->pBest;
+
+	if (n.left < 0) {
+		for (int32_t i = n.begin; i < n.end; ++i) {
+			const int32_t v = m_order[i];
+			const float dist = (m_pos[v] - pS->q).squaredNorm();
+			if (dist >= pS->worst())
+				continue;
+			const auto m = std::make_pair(dist, v);
+			best.insert(std::upper_bound(best.begin(), best.end(), m), m);
+			if ((int32_t)best.size() > pS->k)
+				best.pop_back();
+		}
+		return;
+	}
+
+	// near side first, far side bounded by the squared distance to its cell
+	const int32_t d = n.splitDim;
+	const float diff = pS->q[d] - n.splitVal;
+	const int32_t nearNode = diff < 0.f ? n.left : n.right;
+	const int32_t farNode = diff < 0.f ? n.right : n.left;
+
+	searchNode(nearNode, boxDist, pS);
+
+	const float oldOffset = pS->offset[d];
+	const float farDist = boxDist - oldOffset*oldOffset + diff*diff;
+	if (farDist < pS->worst()) {
+		pS->offset[d] = diff;
+		searchNode(farNode, farDist, pS);
+		pS->offset[d] = oldOffset;
+	}
+}//searchNode
+
+void WeightTransfer::project(const Vector3f& p, int32_t candidates, Influences* pOut) const {
+	std::vector<std::pair<float,int32_t>> nearest;
+	Search s{ p, Vector3f::Zero(), candidates, &nearest };
+	searchNode(0, 0.f, &s);
+
+	float bestDist = FLT_MAX;
+	int32_t bestTri = -1;
+	Vector3f bestBary;
+	for (const auto& [d, v] : nearest) {
+		for (int32_t k = m_vertTriOffset[v]; k < m_vertTriOffset[v+1]; ++k) {
+			const Vector3i& t = m_tris[m_vertTris[k]];
+			const Vector3f bary = closestBarycentric(p, m_pos[t[0]], m_pos[t[1]], m_pos[t[2]]);
+			const float dist = (bary[0]*m_pos[t[0]] + bary[1]*m_pos[t[1]] + bary[2]*m_pos[t[2]] - p).squaredNorm();
+			if (dist < bestDist) {
+				bestDist = dist;
+				bestTri = m_vertTris[k];
+				bestBary = bary;
+			}
+		}
+	}
+
+	pOut->clear();
+	if (bestTri < 0) {
+		// nearest proxy vertices have no faces
+		*pOut = m_proxyWeights[nearest.front().second];
+		return;
+	}
+	for (int32_t k = 0; k < 3; ++k) {
+		if (bestBary[k] > 0.f)
+			accumulate(m_proxyWeights[m_tris[bestTri][k]], bestBary[k], pOut);
+	}
+}//project
+
+void WeightTransfer::smooth(const T3DMesh<float>& target, const Config& config, std::vector<Influences>* pWeights) const {
+	const int32_t nv = target.vertexCount();
+
+	// unique neighbours per vertex from the face edges
+	std::vector<std::pair<int32_t,int32_t>> edges;
+	for (uint32_t s = 0; s < target.submeshCount(); ++s) {
+		for (const auto& f : target.getSubmesh(s)->Faces) {
+			for (int32_t k = 0; k < 3; ++k) {
+				const int32_t a = f.Vertices[k], b = f.Vertices[(k+1)%3];
+				if (a == b || a < 0 || b < 0 || a >= nv || b >= nv)
+					continue;
+				edges.push_back(std::make_pair(a, b));
+				edges.push_back(std::make_pair(b, a));
+			}
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+	std::vector<int32_t> offset(nv + 1, 0);
+	for (const auto& e : edges)
+		offset[e.first + 1]++;
+	for (int32_t i = 0; i < nv; ++i)
+		offset[i+1] += offset[i];
+
+	// jacobi iterations, w = (1-s) w + s avg(neighbours)
+	std::vector<Influences> next(nv);
+	for (int32_t it = 0; it < config.smoothIterations; ++it) {
+		parallelFor(0, nv, [&](size_t b, size_t e) {
+			for (size_t i = b; i < e; ++i) {
+				const int32_t count = offset[i+1] - offset[i];
+				if (count == 0) {
+					next[i] = (*pWeights)[i];
+					continue;
+				}
+				Influences avg;
+				for (int32_t k = offset[i]; k < offset[i+1]; ++k)
+					accumulate((*pWeights)[edges[k].second], config.smoothStrength / count, &avg);
+				next[i].clear();
+				accumulate((*pWeights)[i], 1.f - config.smoothStrength, &next[i]);
+				accumulate(avg, 1.f, &next[i]);
+			}
+		}, 1024);
+		pWeights->swap(next);
+	}
+}//smooth
+
+}//CForge
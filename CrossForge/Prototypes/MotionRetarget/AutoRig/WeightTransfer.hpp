@@ -0,0 +1,67 @@
+#pragma once
+
+#include <crossforge/AssetIO/T3DMesh.hpp>
+
+#include <cfloat>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Transfers skin weights from a rigged proxy (e.g. a decimated scan) to a mesh covering the same surface.
+ *        Every target vertex is projected onto the closest proxy triangle, candidates are the triangles around
+ *        the nearest proxy vertices found with a KD-tree. Weights of the triangle corners are interpolated
+ *        barycentrically. Optional smoothing along the target mesh edges removes the faceting of the proxy.
+*/
+class WeightTransfer {
+public:
+	using Influences = std::vector<std::pair<int32_t,float>>; // (bone, weight), sorted by bone
+
+	struct Config {
+		int32_t candidates = 8;      // nearest proxy vertices whose triangles are tested
+		int32_t smoothIterations = 0;
+		float smoothStrength = 0.5f; // blend towards the neighbour average per iteration
+		float minWeight = 1e-4f;     // smaller weights are dropped, remaining ones renormalized
+	};
+
+	/**
+	 * @brief sets VertexInfluences and VertexWeights of all bones of pTarget.
+	 *        Bone i of pTarget receives the weights of bone i of proxy, both must have the same bone count.
+	*/
+	void transfer(const T3DMesh<float>& proxy, T3DMesh<float>* pTarget, const Config& config);
+
+private:
+	struct KDNode {
+		int32_t begin, end;  // point range
+		int32_t left, right; // child nodes, -1 for leaf
+		int32_t splitDim;
+		float splitVal;
+	};
+	struct Search {
+		Vector3f q;
+		Vector3f offset; // per dimension distance of current cell to the query
+		int32_t k;
+		std::vector<std::pair<float,int32_t>>* pBest; // (squared distance, proxy vertex), sorted
+		float worst() const { return (int32_t)pBest->size() < k ? FLT_MAX : pBest->back().first; }
+	};
+
+	void buildProxy(const T3DMesh<float>& proxy);
+	int32_t buildNode(int32_t begin, int32_t end);
+	void searchNode(int32_t node, float boxDist, Search* pS) const;
+	void project(const Vector3f& p, int32_t candidates, Influences* pOut) const;
+	void smooth(const T3DMesh<float>& target, const Config& config, std::vector<Influences>* pWeights) const;
+
+	// proxy surface
+	std::vector<Vector3f> m_pos;
+	std::vector<Vector3i> m_tris;
+	std::vector<int32_t> m_vertTriOffset; // CSR of triangles per proxy vertex
+	std::vector<int32_t> m_vertTris;
+	std::vector<Influences> m_proxyWeights;
+
+	// KD-tree over proxy vertices
+	std::vector<int32_t> m_order; // proxy vertex ids in tree order
+	std::vector<KDNode> m_nodes;
+	static const int32_t m_LeafSize = 8;
+};//WeightTransfer
+
+}//CForge
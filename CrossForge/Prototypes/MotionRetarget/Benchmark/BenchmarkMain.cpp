@@ -0,0 +1,68 @@
+#include "RetargetBenchmark.hpp"
+
+#include <crossforge/Core/SCrossForgeDevice.h>
+#include <crossforge/Core/SLogger.h>
+
+#include <sstream>
+
+using namespace CForge;
+
+namespace {
+	void printUsage() {
+		printf("usage: MRBenchmark --target <mesh> --clips <dir> [options]\n"
+		       "  --target-armature <json>   armature of target, auto created if omitted\n"
+		       "  --source-armature <json>   armature applied to every clip, auto created if omitted\n"
+		       "  --corr <i,j,...>           source chain index for every target chain\n"
+		       "  --out <path>               output prefix, writes <path>.csv and <path>.json\n"
+		       "  --iterations <n>           max solver iterations\n"
+		       "  --frames <n>               max frames per clip\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	RetargetBenchmark::Config config;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		std::string val = (i+1 < argc) ? argv[i+1] : "";
+		if (arg == "--target") { config.targetPath = val; ++i; }
+		else if (arg == "--target-armature") { config.targetArmature = val; ++i; }
+		else if (arg == "--source-armature") { config.sourceArmature = val; ++i; }
+		else if (arg == "--clips") { config.clipDir = val; ++i; }
+		else if (arg == "--out") { config.outPath = val; ++i; }
+		else if (arg == "--iterations") { config.maxIterations = std::stoi(val); ++i; }
+		else if (arg == "--frames") { config.maxFrames = std::stoi(val); ++i; }
+		else if (arg == "--corr") {
+			std::stringstream ss(val);
+			std::string item;
+			while (std::getline(ss,item,','))
+				config.corr.push_back(std::stoi(item));
+			++i;
+		}
+		else {
+			printUsage();
+			return -1;
+		}
+	}
+	if (config.targetPath.empty() || config.clipDir.empty()) {
+		printUsage();
+		return -1;
+	}
+
+	SCrossForgeDevice* pDev = nullptr;
+	int ret = 0;
+	try {
+		pDev = SCrossForgeDevice::instance();
+
+		RetargetBenchmark bench;
+		bench.run(config);
+		printf("wrote %s.csv and %s.json\n", config.outPath.c_str(), config.outPath.c_str());
+	}
+	catch (const CrossForgeException& e) {
+		printf("Exception occurred: %s\n", e.msg().c_str());
+		SLogger::logException(e);
+		ret = -1;
+	}
+
+	if (nullptr != pDev) pDev->release();
+	return ret;
+}//main
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Prototypes/MotionRetarget/IK/IKController.hpp>
+#include <Prototypes/MotionRetarget/IK/Solver/CCDSolver.hpp>
+#include <Prototypes/MotionRetarget/IK/Solver/FABRIKSolver.hpp>
+#include <Prototypes/MotionRetarget/IK/Solver/JacInvSolver.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+
+namespace CForge {
+namespace BenchUtil {
+
+/**
+ * @brief named factory for every IIKSolver implementation and mode, shared by the benchmarks
+*/
+struct SolverVariant {
+	std::string name;
+	std::function<std::unique_ptr<IIKSolver>()> create;
+};
+
+inline std::vector<SolverVariant> solverVariants() {
+	std::vector<SolverVariant> ret;
+	ret.push_back({"CCD_FORWARD", []() {
+		auto s = std::make_unique<IKSccd>(); s->m_type = IKSccd::FORWARD; return std::unique_ptr<IIKSolver>(std::move(s)); }});
+	ret.push_back({"CCD_BACKWARD", []() {
+		auto s = std::make_unique<IKSccd>(); s->m_type = IKSccd::BACKWARD; return std::unique_ptr<IIKSolver>(std::move(s)); }});
+	ret.push_back({"FABRIK", []() {
+		return std::unique_ptr<IIKSolver>(std::make_unique<IKSfabrik>()); }});
+	ret.push_back({"JACINV_TRANSPOSE", []() {
+		auto s = std::make_unique<IKSjacInv>(); s->m_type = IKSjacInv::TRANSPOSE; return std::unique_ptr<IIKSolver>(std::move(s)); }});
+	ret.push_back({"JACINV_SVD", []() {
+		auto s = std::make_unique<IKSjacInv>(); s->m_type = IKSjacInv::SVD; return std::unique_ptr<IIKSolver>(std::move(s)); }});
+	ret.push_back({"JACINV_DLS", []() {
+		auto s = std::make_unique<IKSjacInv>(); s->m_type = IKSjacInv::DLS; return std::unique_ptr<IIKSolver>(std::move(s)); }});
+	return ret;
+}//solverVariants
+
+/**
+ * @brief nearest rank percentile, p in [0,1]
+*/
+inline double percentile(std::vector<double> values, double p) {
+	if (values.empty())
+		return 0.;
+	std::sort(values.begin(),values.end());
+	size_t rank = size_t(std::ceil(p * values.size()));
+	return values[std::min(values.size()-1, rank > 0 ? rank-1 : 0)];
+}//percentile
+
+/**
+ * @brief local joint transforms of a controller, used to start every solver from the same pose
+*/
+struct PoseCache {
+	std::vector<Eigen::Vector3f> pos;
+	std::vector<Eigen::Quaternionf> rot;
+	std::vector<Eigen::Vector3f> scale;
+};
+
+inline void storePose(IKController* pCtrl, PoseCache* pPose) {
+	pPose->pos.resize(pCtrl->boneCount());
+	pPose->rot.resize(pCtrl->boneCount());
+	pPose->scale.resize(pCtrl->boneCount());
+	for (uint32_t i = 0; i < pCtrl->boneCount(); ++i) {
+		auto* j = pCtrl->getBone(i);
+		pPose->pos[i] = j->LocalPosition;
+		pPose->rot[i] = j->LocalRotation;
+		pPose->scale[i] = j->LocalScale;
+	}
+}//storePose
+
+inline void restorePose(IKController* pCtrl, const PoseCache& pose) {
+	for (uint32_t i = 0; i < pCtrl->boneCount(); ++i) {
+		auto* j = pCtrl->getBone(i);
+		j->LocalPosition = pose.pos[i];
+		j->LocalRotation = pose.rot[i];
+		j->LocalScale = pose.scale[i];
+	}
+	pCtrl->forwardKinematics();
+}//restorePose
+
+using Clock = std::chrono::steady_clock;
+inline double elapsedMs(Clock::time_point a, Clock::time_point b) {
+	return std::chrono::duration<double,std::milli>(b-a).count();
+}
+inline double elapsedNs(Clock::time_point a, Clock::time_point b) {
+	return std::chrono::duration<double,std::nano>(b-a).count();
+}
+
+}//BenchUtil
+}//CForge
@@ -0,0 +1,237 @@
+#include "IKBenchmark.hpp"
+
+#include <fstream>
+#include <map>
+#include <tuple>
+
+namespace CForge {
+using namespace Eigen;
+
+using BenchUtil::Clock;
+using BenchUtil::elapsedNs;
+using BenchUtil::percentile;
+using BenchUtil::PoseCache;
+using BenchUtil::storePose;
+using BenchUtil::restorePose;
+
+namespace {
+	Vector3f randomDirection(std::mt19937& rng) {
+		std::normal_distribution<float> n(0.f,1.f);
+		Vector3f d;
+		do {
+			d = Vector3f(n(rng),n(rng),n(rng));
+		} while (d.squaredNorm() < 1e-8f);
+		return d.normalized();
+	}
+
+	Quaternionf randomRotation(std::mt19937& rng, float maxAngle) {
+		std::uniform_real_distribution<float> a(-maxAngle,maxAngle);
+		return Quaternionf(AngleAxisf(a(rng),randomDirection(rng)));
+	}
+
+	std::string jointName(int32_t chain, int32_t joint) {
+		return "c" + std::to_string(chain) + "_" + std::to_string(joint);
+	}
+}
+
+IKBenchmark::IKBenchmark() {
+	m_variants = BenchUtil::solverVariants();
+}
+
+void IKBenchmark::createSkeleton(T3DMesh<float>* pMesh, int32_t chainLength, int32_t branching, std::mt19937& rng) {
+	if (!pMesh)
+		throw NullpointerExcept("pMesh");
+	if (chainLength < 2 || branching < 1)
+		throw CForgeExcept("Synthetic skeleton needs chains of at least 2 joints");
+
+	std::uniform_real_distribution<float> boneLen(0.5f,1.5f);
+	std::vector<T3DMesh<float>::Bone*> bones;
+	std::vector<Matrix4f> global;
+
+	auto addBone = [&](std::string name, T3DMesh<float>::Bone* pParent, Matrix4f localT) {
+		T3DMesh<float>::Bone* pB = new T3DMesh<float>::Bone();
+		pB->ID = bones.size();
+		pB->Name = name;
+		pB->pParent = pParent;
+		Matrix4f g = pParent ? global[pParent->ID] * localT : localT;
+		pB->InvBindPoseMatrix = g.inverse();
+		if (pParent)
+			pParent->Children.push_back(pB);
+		bones.push_back(pB);
+		global.push_back(g);
+		return pB;
+	};
+
+	T3DMesh<float>::Bone* pRoot = addBone("root",nullptr,Matrix4f::Identity());
+
+	for (int32_t k = 0; k < branching; ++k) {
+		T3DMesh<float>::Bone* pParent = pRoot;
+		// first joint spreads branches around root, following joints mostly continue the chain
+		Vector3f dir = randomDirection(rng);
+		for (int32_t j = 0; j < chainLength; ++j) {
+			Matrix4f localT = Matrix4f::Identity();
+			localT.block<3,3>(0,0) = randomRotation(rng,EIGEN_PI*.25f).toRotationMatrix();
+			localT.block<3,1>(0,3) = (j == 0 ? dir : Vector3f::UnitY()) * boneLen(rng);
+			pParent = addBone(jointName(k,j),pParent,localT);
+		}
+	}
+
+	pMesh->clear();
+	pMesh->bones(&bones,true);
+	for (auto* pB : bones)
+		delete pB;
+}//createSkeleton
+
+std::vector<Vector3f> IKBenchmark::createTargets(IKController* pCtrl, IKChain& chain, bool reachable, std::mt19937& rng) {
+	std::vector<Vector3f> ret;
+	ret.reserve(m_config.targetCount);
+
+	if (reachable) {
+		// end-effector positions of random chain poses
+		PoseCache rest;
+		storePose(pCtrl,&rest);
+		for (int32_t t = 0; t < m_config.targetCount; ++t) {
+			for (uint32_t j = 1; j < chain.joints.size(); ++j)
+				chain.joints[j]->LocalRotation = randomRotation(rng,EIGEN_PI*.5f) * chain.joints[j]->LocalRotation;
+			pCtrl->forwardKinematics();
+			ret.push_back(pCtrl->m_IKJoints[chain.joints[0]].posGlobal);
+			restorePose(pCtrl,rest);
+		}
+	}
+	else {
+		float length = 0.f;
+		for (uint32_t j = 1; j < chain.joints.size(); ++j)
+			length += (pCtrl->m_IKJoints[chain.joints[j-1]].posGlobal - pCtrl->m_IKJoints[chain.joints[j]].posGlobal).norm();
+		const Vector3f base = pCtrl->m_IKJoints[chain.joints.back()].posGlobal;
+		for (int32_t t = 0; t < m_config.targetCount; ++t)
+			ret.push_back(base + randomDirection(rng) * length * 1.5f);
+	}
+	return ret;
+}//createTargets
+
+void IKBenchmark::run(const Config& config) {
+	m_config = config;
+	m_samples.clear();
+	std::mt19937 rng(m_config.seed);
+
+	for (int32_t len : m_config.chainLengths) {
+		for (int32_t br : m_config.branching) {
+			T3DMesh<float> mesh;
+			createSkeleton(&mesh,len,br,rng);
+
+			IKController ctrl;
+			ctrl.init(&mesh);
+			for (int32_t k = 0; k < br; ++k)
+				ctrl.buildKinematicChain("c" + std::to_string(k),jointName(k,0),jointName(k,len-1));
+			ctrl.forwardKinematics();
+			ctrl.initTargetPoints();
+
+			PoseCache rest;
+			storePose(&ctrl,&rest);
+
+			// targets are shared by all solvers and thresholds, [chain][unreachable]
+			std::vector<std::vector<std::vector<Vector3f>>> targets(br);
+			for (int32_t k = 0; k < br; ++k) {
+				targets[k].push_back(createTargets(&ctrl,ctrl.getJointChains()[k],true,rng));
+				targets[k].push_back(createTargets(&ctrl,ctrl.getJointChains()[k],false,rng));
+			}
+
+			printf("chain length %d, branching %d\n", len, br);
+
+			for (float td : m_config.thresholdDist) {
+				for (float tp : m_config.thresholdPosChange) {
+					for (uint32_t v = 0; v < m_variants.size(); ++v) {
+						// solver instances are reused over all solves, like during playback
+						for (auto& c : ctrl.getJointChains()) {
+							c.ikSolver = m_variants[v].create();
+							c.ikSolver->m_MaxIterations = m_config.maxIterations;
+							c.ikSolver->m_thresholdDist = td;
+							c.ikSolver->m_thresholdPosChange = tp;
+						}
+
+						for (int32_t k = 0; k < br; ++k) {
+							IKChain& chain = ctrl.getJointChains()[k];
+							std::shared_ptr<IKTarget> pTarget = chain.target.lock();
+							for (int32_t r = 0; r < 2; ++r) {
+								for (uint32_t t = 0; t < targets[k][r].size(); ++t) {
+									for (int32_t rep = 0; rep < m_config.repetitions; ++rep) {
+										restorePose(&ctrl,rest);
+										pTarget->pos = targets[k][r][t];
+
+										uint64_t a0 = m_config.pAllocCounter ? m_config.pAllocCounter->load(std::memory_order_relaxed) : 0;
+										auto t0 = Clock::now();
+										chain.ikSolver->solve(chain.name,&ctrl);
+										auto t1 = Clock::now();
+										uint64_t a1 = m_config.pAllocCounter ? m_config.pAllocCounter->load(std::memory_order_relaxed) : 0;
+
+										Sample s;
+										s.chainLength = len;
+										s.branching = br;
+										s.solver = v;
+										s.thresholdDist = td;
+										s.thresholdPosChange = tp;
+										s.reachable = r == 0;
+										s.target = t;
+										s.ns = elapsedNs(t0,t1);
+										s.iterations = chain.ikSolver->m_lastIterations;
+										s.error = (ctrl.m_IKJoints[chain.joints[0]].posGlobal - pTarget->pos).norm();
+										// early termination is no criterion, FABRIK stops after one pass for unreachable targets
+										s.converged = s.error <= td;
+										s.allocations = m_config.pAllocCounter ? int64_t(a1 - a0) : -1;
+										m_samples.push_back(s);
+									}//for[repetitions]
+								}//for[targets]
+							}//for[reachability]
+						}//for[chains]
+					}//for[solver variants]
+				}//for[thresholdPosChange]
+			}//for[thresholdDist]
+		}//for[branching]
+	}//for[chain lengths]
+
+	writeCSV(m_config.outPath + ".csv");
+}//run
+
+void IKBenchmark::writeCSV(std::string path) {
+	std::ofstream f(path);
+	if (!f.is_open())
+		throw CForgeExcept("Could not open " + path);
+
+	f << "chain_length,branching,solver,threshold_dist,threshold_pos_change,reachable,target,ns,iterations,converged,error,allocations\n";
+	for (const Sample& s : m_samples) {
+		f << s.chainLength << "," << s.branching << "," << m_variants[s.solver].name << ","
+		  << s.thresholdDist << "," << s.thresholdPosChange << "," << s.reachable << "," << s.target << ","
+		  << s.ns << "," << s.iterations << "," << s.converged << "," << s.error << "," << s.allocations << "\n";
+	}
+}//writeCSV
+
+void IKBenchmark::printSummary() {
+	// group samples by everything except target and repetition
+	using Key = std::tuple<int32_t,int32_t,float,float,int32_t,bool>;
+	std::map<Key,std::vector<const Sample*>> groups;
+	for (const Sample& s : m_samples)
+		groups[Key(s.chainLength,s.branching,s.thresholdDist,s.thresholdPosChange,s.solver,!s.reachable)].push_back(&s);
+
+	printf("%4s %3s %9s %9s %-17s %-5s %10s %10s %8s %6s %10s %8s\n",
+	       "len", "br", "thrDist", "thrPos", "solver", "reach", "ns_p50", "ns_p99", "iter", "conv%", "err_mean", "allocs");
+	for (auto& [key,samples] : groups) {
+		std::vector<double> ns;
+		double iter = 0., conv = 0., err = 0., allocs = 0.;
+		for (const Sample* s : samples) {
+			ns.push_back(s->ns);
+			iter += s->iterations;
+			conv += s->converged ? 1. : 0.;
+			err += s->error;
+			allocs += s->allocations;
+		}
+		const double n = samples.size();
+		const Sample* s = samples.front();
+		printf("%4d %3d %9.2g %9.2g %-17s %-5s %10.0f %10.0f %8.2f %6.1f %10.4g %8.2f\n",
+		       s->chainLength, s->branching, s->thresholdDist, s->thresholdPosChange,
+		       m_variants[s->solver].name.c_str(), s->reachable ? "yes" : "no",
+		       percentile(ns,.5), percentile(ns,.99), iter/n, 100.*conv/n, err/n,
+		       s->allocations < 0 ? -1. : allocs/n);
+	}
+}//printSummary
+
+}//CForge
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Prototypes/MotionRetarget/IK/IKController.hpp>
+#include "BenchmarkUtil.hpp"
+
+#include <atomic>
+#include <random>
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Micro benchmark of single IIKSolver::solve calls on synthetic skeletons.
+ *        Skeletons are generated without mesh or GL context, a root with a number of
+ *        branches each holding one chain of random rest pose.
+ *        Every solver starts from the rest pose for every target.
+*/
+class IKBenchmark {
+public:
+	struct Config {
+		std::vector<int32_t> chainLengths = { 2, 4, 8, 16, 32 }; // joints per chain
+		std::vector<int32_t> branching = { 1, 4 };               // chains per skeleton
+		int32_t targetCount = 64;                                // per chain and reachability
+		int32_t repetitions = 5;                                 // solves per target, all recorded
+		std::vector<float> thresholdDist = { 1e-6f };            // IIKSolver::m_thresholdDist
+		std::vector<float> thresholdPosChange = { 1e-6f };       // IIKSolver::m_thresholdPosChange
+		int32_t maxIterations = 100;
+		uint32_t seed = 42;
+		std::string outPath = "MRIKBenchmark"; // writes outPath.csv
+		const std::atomic<uint64_t>* pAllocCounter = nullptr; // global allocation count, allocations are not reported if null
+	};
+
+	/**
+	 * @brief single solve of one chain
+	*/
+	struct Sample {
+		int32_t chainLength;
+		int32_t branching;
+		int32_t solver;
+		float thresholdDist;
+		float thresholdPosChange;
+		bool reachable;
+		int32_t target;
+		double ns;
+		int32_t iterations;
+		bool converged;    // end effector error within m_thresholdDist
+		float error;       // end effector to target distance
+		int64_t allocations; // -1 if not counted
+	};
+
+	IKBenchmark();
+
+	void run(const Config& config);
+	void writeCSV(std::string path);
+	void printSummary();
+
+	/**
+	 * @brief creates bones of a root joint with branching chains of chainLength random joints.
+	 *        Chain k is made of joints named "c<k>_0" (chain root) to "c<k>_<chainLength-1>" (end-effector).
+	*/
+	static void createSkeleton(T3DMesh<float>* pMesh, int32_t chainLength, int32_t branching, std::mt19937& rng);
+
+	std::vector<Sample> m_samples;
+private:
+	/**
+	 * @brief random reachable (pose of chain) or unreachable (outside of chain length) end-effector targets
+	*/
+	std::vector<Vector3f> createTargets(IKController* pCtrl, IKChain& chain, bool reachable, std::mt19937& rng);
+
+	Config m_config;
+	std::vector<BenchUtil::SolverVariant> m_variants;
+};//IKBenchmark
+
+}//CForge
@@ -0,0 +1,127 @@
+#include "IKBenchmark.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+using namespace CForge;
+
+// counts every heap allocation of the process, read around each solve call
+static std::atomic<uint64_t> g_allocCount{0};
+
+#if defined(__GLIBC__)
+// Eigen allocates through malloc directly, count there so dynamic matrices are included
+extern "C" {
+	void* __libc_malloc(std::size_t size);
+	void* __libc_calloc(std::size_t n, std::size_t size);
+	void* __libc_realloc(void* p, std::size_t size);
+
+	void* malloc(std::size_t size) {
+		g_allocCount.fetch_add(1,std::memory_order_relaxed);
+		return __libc_malloc(size);
+	}
+	void* calloc(std::size_t n, std::size_t size) {
+		g_allocCount.fetch_add(1,std::memory_order_relaxed);
+		return __libc_calloc(n,size);
+	}
+	void* realloc(void* p, std::size_t size) {
+		g_allocCount.fetch_add(1,std::memory_order_relaxed);
+		return __libc_realloc(p,size);
+	}
+}
+#define COUNT_OPERATOR_NEW 0
+#else
+#define COUNT_OPERATOR_NEW 1
+#endif
+
+void* operator new(std::size_t size) {
+	if (COUNT_OPERATOR_NEW)
+		g_allocCount.fetch_add(1,std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+	template<typename T>
+	std::vector<T> parseList(const std::string& val) {
+		std::vector<T> ret;
+		std::stringstream ss(val);
+		std::string item;
+		while (std::getline(ss,item,','))
+			ret.push_back(T(std::stod(item)));
+		return ret;
+	}
+
+	void printUsage() {
+		printf("usage: MRIKBenchmark [options]\n"
+		       "  --lengths <n,...>               joints per chain\n"
+		       "  --branching <n,...>             chains per skeleton\n"
+		       "  --targets <n>                   reachable and unreachable targets per chain\n"
+		       "  --repetitions <n>               solves per target\n"
+		       "  --thresholdDist <f,...>         IIKSolver::m_thresholdDist values\n"
+		       "  --thresholdPosChange <f,...>    IIKSolver::m_thresholdPosChange values\n"
+		       "  --iterations <n>                max solver iterations\n"
+		       "  --seed <n>                      random seed of skeletons and targets\n"
+		       "  --out <path>                    output prefix, writes <path>.csv\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	IKBenchmark::Config config;
+	try {
+		for (int i = 1; i < argc; ++i) {
+			std::string arg = argv[i];
+			std::string val = (i+1 < argc) ? argv[i+1] : "";
+			if (arg == "--lengths") { config.chainLengths = parseList<int32_t>(val); ++i; }
+			else if (arg == "--branching") { config.branching = parseList<int32_t>(val); ++i; }
+			else if (arg == "--targets") { config.targetCount = std::stoi(val); ++i; }
+			else if (arg == "--repetitions") { config.repetitions = std::stoi(val); ++i; }
+			else if (arg == "--thresholdDist") { config.thresholdDist = parseList<float>(val); ++i; }
+			else if (arg == "--thresholdPosChange") { config.thresholdPosChange = parseList<float>(val); ++i; }
+			else if (arg == "--iterations") { config.maxIterations = std::stoi(val); ++i; }
+			else if (arg == "--seed") { config.seed = uint32_t(std::stoul(val)); ++i; }
+			else if (arg == "--out") { config.outPath = val; ++i; }
+			else {
+				printUsage();
+				return -1;
+			}
+		}
+	}
+	catch (const std::exception&) {
+		printUsage();
+		return -1;
+	}
+	config.pAllocCounter = &g_allocCount;
+
+	// links against the GL free core libraries only, no device or window required
+	int ret = 0;
+	try {
+		IKBenchmark bench;
+		bench.run(config);
+		bench.printSummary();
+		printf("wrote %s.csv\n", config.outPath.c_str());
+	}
+	catch (const CrossForgeException& e) {
+		printf("Exception occurred: %s\n", e.msg().c_str());
+		ret = -1;
+	}
+
+	return ret;
+}//main
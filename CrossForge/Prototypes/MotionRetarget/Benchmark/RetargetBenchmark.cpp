@@ -0,0 +1,274 @@
+#include "RetargetBenchmark.hpp"
+
+#include <crossforge/AssetIO/SAssetIO.h>
+#include <crossforge/Core/SLogger.h>
+#include <crossforge/Utility/CForgeUtility.h>
+#include <Prototypes/Assets/GLTFIO/GLTFIO.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+
+namespace CForge {
+using namespace Eigen;
+
+using BenchUtil::Clock;
+using BenchUtil::elapsedMs;
+using BenchUtil::percentile;
+using BenchUtil::PoseCache;
+using BenchUtil::storePose;
+using BenchUtil::restorePose;
+
+RetargetBenchmark::RetargetBenchmark() {
+	m_variants = BenchUtil::solverVariants();
+}
+
+void RetargetBenchmark::loadMesh(std::string path, T3DMesh<float>* pMesh) {
+	std::string ext = CForgeUtility::toLowerCase(std::filesystem::path(path).extension().string());
+	if (ext == ".gltf" || ext == ".glb")
+		GLTFIO::load(path,pMesh);
+	else
+		SAssetIO::load(path,pMesh);
+}//loadMesh
+
+std::shared_ptr<CharEntity> RetargetBenchmark::createCharacter(std::string meshPath, std::string armaturePath) {
+	std::shared_ptr<CharEntity> c = std::make_shared<CharEntity>();
+	c->name = std::filesystem::path(meshPath).filename().string();
+	loadMesh(meshPath,&c->mesh);
+	if (!c->mesh.rootBone())
+		throw CForgeExcept("Mesh has no skeleton: " + meshPath);
+
+	c->controller = std::make_shared<IKController>();
+	c->controller->init(&c->mesh);
+	for (uint32_t i = 0; i < c->mesh.skeletalAnimationCount(); ++i) {
+		if (c->mesh.getSkeletalAnimation(i)->Keyframes[0]->ID != -1)
+			c->controller->addAnimationData(c->mesh.getSkeletalAnimation(i));
+	}
+
+	if (armaturePath.empty()) {
+		c->autoCreateArmature();
+		c->extractArmature();
+	}
+	else {
+		c->importArmature(armaturePath);
+		c->parseArmature();
+	}
+	c->controller->forwardKinematics();
+	c->controller->initTargetPoints();
+	return c;
+}//createCharacter
+
+std::vector<int> RetargetBenchmark::buildCorrespondence(CharEntity* source, CharEntity* target) {
+	auto& sChains = source->controller->m_ikArmature.m_jointChains;
+	auto& tChains = target->controller->m_ikArmature.m_jointChains;
+
+	if (!m_config.corr.empty()) {
+		if (m_config.corr.size() != tChains.size())
+			throw CForgeExcept("Correspondence count does not match target chain count");
+		for (int is : m_config.corr) {
+			if (is < 0 || is >= sChains.size())
+				throw IndexOutOfBoundsExcept("corr");
+		}
+		return m_config.corr;
+	}
+
+	// match by chain name, fall back to index
+	std::vector<int> ret;
+	for (uint32_t it = 0; it < tChains.size(); ++it) {
+		int match = -1;
+		for (uint32_t is = 0; is < sChains.size(); ++is) {
+			if (sChains[is].name == tChains[it].name) {
+				match = is;
+				break;
+			}
+		}
+		if (match == -1)
+			match = std::min<int>(it,sChains.size()-1);
+		ret.push_back(match);
+	}
+	return ret;
+}//buildCorrespondence
+
+void RetargetBenchmark::run(const Config& config) {
+	m_config = config;
+	m_samples.clear();
+	m_clipLoadMs.clear();
+
+	std::shared_ptr<CharEntity> target = createCharacter(m_config.targetPath,m_config.targetArmature);
+	IKController* tCtrl = target->controller.get();
+
+	PoseCache restPose, retargetPose;
+	storePose(tCtrl,&restPose);
+
+	// collect clips in stable order
+	std::vector<std::string> clips;
+	for (auto& e : std::filesystem::directory_iterator(m_config.clipDir)) {
+		if (!e.is_regular_file())
+			continue;
+		std::string p = e.path().string();
+		if (SAssetIO::accepted(p,I3DMeshIO::OP_LOAD) || GLTFIO::accepted(p,I3DMeshIO::OP_LOAD))
+			clips.push_back(p);
+	}
+	std::sort(clips.begin(),clips.end());
+	if (clips.empty())
+		SLogger::log("RetargetBenchmark: no clips found in " + m_config.clipDir);
+
+	for (const std::string& clipPath : clips) {
+		std::string clipName = std::filesystem::path(clipPath).filename().string();
+
+		std::shared_ptr<CharEntity> source;
+		auto tl0 = Clock::now();
+		try {
+			source = createCharacter(clipPath,m_config.sourceArmature);
+		}
+		catch (const CrossForgeException& e) {
+			SLogger::log("RetargetBenchmark: skipping " + clipName + ": " + e.msg());
+			continue;
+		}
+		m_clipLoadMs[clipName] = elapsedMs(tl0,Clock::now());
+		IKController* sCtrl = source->controller.get();
+
+		for (uint32_t a = 0; a < sCtrl->animationCount(); ++a) {
+			restorePose(tCtrl,restPose);
+
+			MRlimb mrlimb;
+			mrlimb.initialize(source->controller,target->controller,buildCorrespondence(source.get(),target.get()));
+
+			SkeletalPoseController::Animation* pA = sCtrl->createAnimation(a,1.f,0.f);
+			int32_t frameCount = std::max(1,int32_t(pA->Duration * pA->SamplesPerSecond));
+			if (m_config.maxFrames >= 0)
+				frameCount = std::min(frameCount,m_config.maxFrames);
+
+			printf("%s [%d] %d frames\n", clipName.c_str(), a, frameCount);
+
+			for (int32_t f = 0; f < frameCount; ++f) {
+				pA->t = f / pA->SamplesPerSecond;
+
+				auto t0 = Clock::now();
+				sCtrl->applyAnimation(pA);
+				auto t1 = Clock::now();
+				mrlimb.update();
+				auto t2 = Clock::now();
+
+				storePose(tCtrl,&retargetPose);
+
+				for (uint32_t v = 0; v < m_variants.size(); ++v) {
+					restorePose(tCtrl,retargetPose);
+					for (auto& c : tCtrl->m_ikArmature.m_jointChains) {
+						c.ikSolver = m_variants[v].create();
+						c.ikSolver->m_MaxIterations = m_config.maxIterations;
+					}
+
+					auto t3 = Clock::now();
+					tCtrl->update(1.f);
+					auto t4 = Clock::now();
+
+					Sample s;
+					s.clip = clipName;
+					s.animation = a;
+					s.frame = f;
+					s.solver = v;
+					s.sampleMs = elapsedMs(t0,t1);
+					s.retargetMs = elapsedMs(t1,t2);
+					s.solveMs = elapsedMs(t3,t4);
+					s.iterations = 0;
+					for (auto& c : tCtrl->m_ikArmature.m_jointChains) {
+						s.iterations += c.ikSolver->m_lastIterations;
+						if (auto t = c.target.lock())
+							s.chainErrors.push_back((tCtrl->m_IKJoints[c.joints[0]].posGlobal - t->pos).norm());
+					}
+					m_samples.push_back(std::move(s));
+				}//for[solver variants]
+
+				// next frame continues from retargeted pose, independent of last solver
+				restorePose(tCtrl,retargetPose);
+			}//for[frames]
+
+			sCtrl->destroyAnimation(pA);
+			mrlimb.reset();
+		}//for[animations]
+	}//for[clips]
+
+	writeCSV(m_config.outPath + ".csv");
+	writeJSON(m_config.outPath + ".json");
+}//run
+
+void RetargetBenchmark::writeCSV(std::string path) {
+	std::ofstream f(path);
+	if (!f.is_open())
+		throw CForgeExcept("Could not open " + path);
+
+	f << "clip,animation,frame,solver,sample_ms,retarget_ms,solve_ms,iterations,error_mean,error_max\n";
+	for (const Sample& s : m_samples) {
+		float errMean = 0.f, errMax = 0.f;
+		for (float e : s.chainErrors) {
+			errMean += e;
+			errMax = std::max(errMax,e);
+		}
+		if (!s.chainErrors.empty())
+			errMean /= s.chainErrors.size();
+
+		f << s.clip << "," << s.animation << "," << s.frame << "," << m_variants[s.solver].name << ","
+		  << s.sampleMs << "," << s.retargetMs << "," << s.solveMs << "," << s.iterations << ","
+		  << errMean << "," << errMax << "\n";
+	}
+}//writeCSV
+
+void RetargetBenchmark::writeJSON(std::string path) {
+	auto stats = [](const std::vector<double>& v) {
+		double sum = 0.;
+		for (double d : v)
+			sum += d;
+		return nlohmann::json{
+			{"mean", v.empty() ? 0. : sum / v.size()},
+			{"p50", percentile(v,.5)},
+			{"p90", percentile(v,.9)},
+			{"p99", percentile(v,.99)},
+			{"max", percentile(v,1.)}};
+	};
+
+	nlohmann::json out;
+	out["config"] = {
+		{"target", m_config.targetPath},
+		{"clipDir", m_config.clipDir},
+		{"maxIterations", m_config.maxIterations}};
+	out["clipLoadMs"] = m_clipLoadMs;
+
+	// stages independent of solver, every frame is recorded once per solver
+	std::vector<double> sampleMs, retargetMs;
+	for (const Sample& s : m_samples) {
+		if (s.solver != 0)
+			continue;
+		sampleMs.push_back(s.sampleMs);
+		retargetMs.push_back(s.retargetMs);
+	}
+	out["stages"]["sampleMs"] = stats(sampleMs);
+	out["stages"]["retargetMs"] = stats(retargetMs);
+
+	for (uint32_t v = 0; v < m_variants.size(); ++v) {
+		std::vector<double> solveMs, iterations, errors;
+		for (const Sample& s : m_samples) {
+			if (s.solver != v)
+				continue;
+			solveMs.push_back(s.solveMs);
+			iterations.push_back(s.iterations);
+			for (float e : s.chainErrors)
+				errors.push_back(e);
+		}
+		nlohmann::json& j = out["solvers"][m_variants[v].name];
+		j["frames"] = solveMs.size();
+		j["solveMs"] = stats(solveMs);
+		j["iterations"] = stats(iterations);
+		j["endEffectorError"] = stats(errors);
+	}
+
+	std::ofstream f(path);
+	if (!f.is_open())
+		throw CForgeExcept("Could not open " + path);
+	f << std::setw(4) << out << std::endl;
+}//writeJSON
+
+}//CForge
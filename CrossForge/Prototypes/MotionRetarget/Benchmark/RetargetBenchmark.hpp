@@ -0,0 +1,65 @@
+#pragma once
+
+#include <Prototypes/MotionRetarget/CharEntity.hpp>
+#include <Prototypes/MotionRetarget/AutoMoRe/MRlimb.hpp>
+#include "BenchmarkUtil.hpp"
+
+namespace CForge {
+using namespace Eigen;
+
+/**
+ * @brief Headless benchmark of the whole retargeting pipeline.
+ *        Plays every frame of every clip in a directory on the source character,
+ *        retargets it onto the target character via MRlimb and solves the target armature
+ *        with every IK solver variant. Each variant starts from the same retargeted pose.
+*/
+class RetargetBenchmark {
+public:
+	struct Config {
+		std::string targetPath;        // rigged target mesh
+		std::string targetArmature;    // armature json of target, empty to auto create chains
+		std::string sourceArmature;    // armature json applied to every clip, empty to auto create chains
+		std::string clipDir;           // directory containing animated source files
+		std::vector<int> corr;         // source chain index for every target chain, empty to match by name
+		std::string outPath = "MRBenchmark"; // writes outPath.csv and outPath.json
+		int32_t maxIterations = 100;
+		int32_t maxFrames = -1;        // frames per clip, -1 for all
+	};
+
+	/**
+	 * @brief single measurement, one per clip, frame and solver
+	*/
+	struct Sample {
+		std::string clip;
+		int32_t animation;
+		int32_t frame;
+		int32_t solver;
+		double sampleMs;   // source animation sampling
+		double retargetMs; // MRlimb update
+		double solveMs;    // IK solve of target armature
+		int32_t iterations; // summed over all chains
+		std::vector<float> chainErrors; // end effector to target distance per chain
+	};
+
+	RetargetBenchmark();
+
+	void run(const Config& config);
+	void writeCSV(std::string path);
+	void writeJSON(std::string path);
+
+	/**
+	 * @brief loads mesh, initializes controller and armature without creating any actors
+	*/
+	static std::shared_ptr<CharEntity> createCharacter(std::string meshPath, std::string armaturePath);
+	static void loadMesh(std::string path, T3DMesh<float>* pMesh);
+
+	std::vector<Sample> m_samples;
+private:
+	std::vector<int> buildCorrespondence(CharEntity* source, CharEntity* target);
+
+	Config m_config;
+	std::vector<BenchUtil::SolverVariant> m_variants;
+	std::map<std::string,double> m_clipLoadMs;
+};//RetargetBenchmark
+
+}//CForge
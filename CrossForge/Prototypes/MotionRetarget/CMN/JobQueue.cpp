@@ -0,0 +1,109 @@
+#include "JobQueue.hpp"
+
+#include <crossforge/Core/CrossForgeException.h>
+#include <crossforge/Core/Parallel.hpp>
+
+#include <algorithm>
+
+namespace CForge {
+
+JobQueue::JobQueue(uint32_t threadCount) {
+	if (threadCount == 0)
+		threadCount = std::max(2u,std::thread::hardware_concurrency()) - 1;
+	for (uint32_t i = 0; i < threadCount; ++i)
+		m_workers.emplace_back(&JobQueue::run, this);
+}//Constructor
+
+JobQueue::~JobQueue() {
+	cancelAll();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto& w : m_workers)
+		w.join();
+}//Destructor
+
+std::shared_ptr<JobQueue::Job> JobQueue::push(std::function<void(Job* pJob)> work) {
+	auto job = std::make_shared<Job>();
+	job->m_work = std::move(work);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queue.push_back(job);
+	}
+	m_wake.notify_one();
+	return job;
+}//push
+
+void JobQueue::cancelAll() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	for (auto& j : m_queue) {
+		j->cancel();
+		j->m_state = STATE_CANCELLED;
+	}
+	m_queue.clear();
+	for (auto* j : m_running)
+		j->cancel();
+}//cancelAll
+
+uint32_t JobQueue::pending() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_queue.size() + m_running.size();
+}//pending
+
+void JobQueue::run() {
+	while (true) {
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+			if (m_stop)
+				return;
+			job = std::move(m_queue.front());
+			m_queue.pop_front();
+			m_running.push_back(job.get());
+		}
+
+		State result = STATE_DONE;
+		if (job->m_cancelled) {
+			result = STATE_CANCELLED;
+		}
+		else {
+			job->m_state = STATE_RUNNING;
+			// parallel loops of this and other threads only use the cores not taken by running jobs
+			ParallelScope busy;
+			try {
+				job->m_work(job.get());
+				if (job->m_cancelled)
+					result = STATE_CANCELLED;
+			}
+			catch (const Cancelled&) {
+				result = STATE_CANCELLED;
+			}
+			catch (const CrossForgeException& e) {
+				job->m_error = e.msg();
+				result = STATE_FAILED;
+			}
+			catch (const std::exception& e) {
+				job->m_error = e.what();
+				result = STATE_FAILED;
+			}
+			catch (...) {
+				job->m_error = "unknown exception";
+				result = STATE_FAILED;
+			}
+		}
+		job->m_work = nullptr; // release captured data on the worker
+		if (result == STATE_DONE) {
+			job->m_progress = 1.f;
+			job->m_stage = "done";
+		}
+		job->m_state = result;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_running.erase(std::find(m_running.begin(), m_running.end(), job.get()));
+	}
+}//run
+
+}//CForge
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace CForge {
+
+/**
+ * @brief FIFO of jobs run by a fixed pool of worker threads. Used for work that must not block the render thread
+ *        (asset import). Jobs must not touch GL, results are taken over by the owner once state() is STATE_DONE.
+*/
+class JobQueue {
+public:
+	enum State : int32_t {
+		STATE_QUEUED,
+		STATE_RUNNING,
+		STATE_DONE,
+		STATE_FAILED,
+		STATE_CANCELLED,
+	};
+
+	/**
+	 * @brief thrown by Job::report if the job was cancelled.
+	*/
+	struct Cancelled {};
+
+	class Job {
+	public:
+		State state() const { return State(m_state.load()); }
+		float progress() const { return m_progress; }
+		const char* stage() const { return m_stage; }
+		std::string error() const { return (state() == STATE_FAILED) ? m_error : ""; } // written by the worker before m_state changes
+
+		/**
+		 * @brief queued jobs are dropped, running jobs stop at their next report.
+		*/
+		void cancel() { m_cancelled = true; }
+		bool cancelled() const { return m_cancelled; }
+
+		/**
+		 * @brief called by the work function between its steps.
+		 * @throws Cancelled if cancellation was requested
+		*/
+		void report(float progress, const char* stage) {
+			if (m_cancelled)
+				throw Cancelled();
+			m_progress = progress;
+			m_stage = stage;
+		}
+
+	private:
+		friend class JobQueue;
+		std::function<void(Job* pJob)> m_work;
+		std::atomic<int32_t> m_state{STATE_QUEUED};
+		std::atomic<float> m_progress{0.f};
+		std::atomic<const char*> m_stage{"queued"}; // string literal
+		std::atomic<bool> m_cancelled{false};
+		std::string m_error;
+	};
+
+	/**
+	 * @param threadCount 0 uses one thread less than the hardware has, at least one
+	*/
+	JobQueue(uint32_t threadCount = 0);
+
+	/**
+	 * @brief cancels all jobs and waits for the workers.
+	*/
+	~JobQueue();
+
+	/**
+	 * @brief appends a job, work is called on a worker thread with the job as progress and cancellation token.
+	*/
+	std::shared_ptr<Job> push(std::function<void(Job* pJob)> work);
+
+	void cancelAll();
+
+	/**
+	 * @return number of jobs not yet finished, failed or cancelled
+	*/
+	uint32_t pending() const;
+
+private:
+	void run();
+
+	std::vector<std::thread> m_workers;
+	std::deque<std::shared_ptr<Job>> m_queue;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::vector<Job*> m_running; // jobs taken by a worker
+	bool m_stop = false;
+};//JobQueue
+
+}//CForge
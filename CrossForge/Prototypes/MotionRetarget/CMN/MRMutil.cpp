@@ -8,12 +8,6 @@ using namespace Eigen;
 */
 namespace MRMutil {
 
-Matrix4f buildTransformation(ISceneGraphNode& sgn) {
-	Vector3f p,s; Quaternionf r;
-	sgn.buildTansformation(&p,&r,&s);
-	return CForgeMath::translationMatrix(p)*CForgeMath::rotationMatrix(r)*CForgeMath::scaleMatrix(s);
-}
-
 void deconstructMatrix(Matrix4f t, Vector3f* pos, Quaternionf* rot, Vector3f* scale) {
 	*pos = t.block<3,1>(0,3);
 	*scale = Vector3f(t.block<3,1>(0,0).norm(),
@@ -1,16 +1,16 @@
 #pragma once
-#include <crossforge/Graphics/SceneGraph/ISceneGraphNode.h>
 #include <crossforge/Math/CForgeMath.h>
 
 namespace CForge {
 using namespace Eigen;
+class ISceneGraphNode;
 
 /**
  * @brief various (lin algebra) utilities
 */
 namespace MRMutil {
 
-Matrix4f buildTransformation(ISceneGraphNode& sgn);
+Matrix4f buildTransformation(ISceneGraphNode& sgn); // MRMutilSGN.cpp, scene graph layer
 void deconstructMatrix(Matrix4f t, Vector3f* pos, Quaternionf* rot, Vector3f* scale);
 
 }//MRMutil
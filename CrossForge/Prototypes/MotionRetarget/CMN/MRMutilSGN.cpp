@@ -0,0 +1,17 @@
+#include "MRMutil.hpp"
+
+#include <crossforge/Graphics/SceneGraph/ISceneGraphNode.h>
+
+namespace CForge {
+using namespace Eigen;
+
+namespace MRMutil {
+
+Matrix4f buildTransformation(ISceneGraphNode& sgn) {
+	Vector3f p,s; Quaternionf r;
+	sgn.buildTansformation(&p,&r,&s);
+	return CForgeMath::translationMatrix(p)*CForgeMath::rotationMatrix(r)*CForgeMath::scaleMatrix(s);
+}
+
+}//MRMutils
+}//CForge
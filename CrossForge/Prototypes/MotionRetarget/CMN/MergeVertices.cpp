@@ -1,112 +1,200 @@
 #include "MergeVertices.hpp"
 
+#include <crossforge/Core/Parallel.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
 namespace CForge {
+using namespace Eigen;
 
-uint32_t getMatchingVertex(uint32_t RedundantVertexID, std::vector<std::pair<uint32_t, uint32_t>> *pRedundantVertices) {
-	uint32_t Rval = 0;
+namespace {
+	uint64_t cellHash(int64_t x, int64_t y, int64_t z) {
+		return uint64_t(x) * 73856093ull ^ uint64_t(y) * 19349663ull ^ uint64_t(z) * 83492791ull;
+	}
 
-	for (auto [original,copy] : (*pRedundantVertices)) {
-		if (copy == RedundantVertexID) {
-			Rval = original;
-			break;
+	uint64_t exactHash(const Vector3f& v) {
+		// +0.f turns -0 into 0 so both hash equally
+		uint32_t b[3];
+		for (int32_t i = 0; i < 3; ++i) {
+			const float f = v[i] + 0.f;
+			std::memcpy(&b[i],&f,sizeof(float));
 		}
+		return cellHash(b[0],b[1],b[2]);
 	}
-	return Rval;
-}//getMatchingVertex
-
-std::vector<uint32_t> mergeRedundantVertices(T3DMesh<float>* pMesh) {
-	float Epsilon = /**/std::numeric_limits<float>::min();//*/0.00025f;//TODO
-
-	std::vector<std::pair<uint32_t, uint32_t>> RedundantVertices; // <first occurence, copy>
-
-	std::vector<uint32_t> vertCorr; // old to new vertex correspondence
-	
-	std::vector<bool> IsRedundant;
-	std::vector <uint32_t> VertexMapping;
-	for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) {
-		IsRedundant.push_back(false);
-		VertexMapping.push_back(i);
-		vertCorr.push_back(i);
-	}
+}
+
+std::vector<uint32_t> mergeRedundantVertices(T3DMesh<float>* pMesh, float epsilon) {
+	if (!pMesh)
+		throw NullpointerExcept("pMesh");
+
+	// read through a const reference, non-const accessors would write shared vertex data from several threads
+	const T3DMesh<float>& mesh = *pMesh;
+	const uint32_t N = mesh.vertexCount();
+	const float eps2 = epsilon * epsilon;
+	const float invCell = epsilon > 0.f ? 1.f / epsilon : 0.f;
+
+	std::vector<Vector3f> pos(N);
+	std::vector<int64_t> cell(size_t(N) * 3);
+	parallelFor(0,N,[&](size_t b, size_t e) {
+		for (size_t i = b; i < e; ++i) {
+			pos[i] = mesh.vertex(i);
+			if (epsilon > 0.f) {
+				for (int32_t k = 0; k < 3; ++k)
+					cell[i*3 + k] = int64_t(std::floor(pos[i][k] * invCell));
+			}
+		}
+	});
+
+	// kept vertices of a hash bucket form a linked list over next
+	std::unordered_map<uint64_t,uint32_t> head;
+	head.reserve(N);
+	std::vector<uint32_t> next(N,UINT32_MAX);
+	std::vector<uint32_t> vertCorr(N); // old to new vertex correspondence
+	std::vector<uint32_t> kept;        // new to old vertex
+
+	// lowest index of a kept vertex in the bucket within epsilon of v
+	auto findInBucket = [&](uint64_t h, const Vector3f& v) {
+		uint32_t ret = UINT32_MAX;
+		auto it = head.find(h);
+		if (it == head.end())
+			return ret;
+		for (uint32_t r = it->second; r != UINT32_MAX; r = next[r]) {
+			if ((pos[r] - v).squaredNorm() <= eps2)
+				ret = std::min(ret,r);
+		}
+		return ret;
+	};
+
+	for (uint32_t i = 0; i < N; ++i) {
+		uint32_t match = UINT32_MAX;
+		uint64_t h;
+		if (epsilon > 0.f) {
+			const int64_t* c = &cell[size_t(i)*3];
+			// all neighbour cells are searched, so the lowest index is kept and not the first match
+			for (int64_t dx = -1; dx <= 1; ++dx) {
+				for (int64_t dy = -1; dy <= 1; ++dy) {
+					for (int64_t dz = -1; dz <= 1; ++dz)
+						match = std::min(match,findInBucket(cellHash(c[0]+dx,c[1]+dy,c[2]+dz),pos[i]));
+				}
+			}
+			h = cellHash(c[0],c[1],c[2]);
+		}
+		else {
+			h = exactHash(pos[i]);
+			match = findInBucket(h,pos[i]);
+		}
 
-	// find redundant vertices
-	for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) {
-		if (IsRedundant[i])
+		if (match != UINT32_MAX) {
+			vertCorr[i] = vertCorr[match];
 			continue;
-		auto v1 = pMesh->vertex(i);
-
-		for (uint32_t k = i+1; k < pMesh->vertexCount(); ++k) {
-			auto v2 = pMesh->vertex(k);
-
-			if ((v2 - v1).dot(v2 - v1) < Epsilon) {
-				RedundantVertices.push_back(std::pair<uint32_t, uint32_t>(i,k));
-				IsRedundant[k] = true;
-				vertCorr[k] = i;
-			}
-		}//for[all remaining vertices]
+		}
+		vertCorr[i] = kept.size();
+		kept.push_back(i);
+		auto it = head.find(h);
+		if (it != head.end()) {
+			next[i] = it->second;
+			it->second = i;
+		}
+		else
+			head.emplace(h,i);
 	}//for[all vertices]
 
-	printf("Found %d double vertices                             \n", uint32_t(RedundantVertices.size()));
-
-	// rebuild vertices, normals, tangents
-	std::vector<Eigen::Vector3f> Vertices;
-	for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) {
-		VertexMapping[i] = Vertices.size();
-		if (!IsRedundant[i])
-			Vertices.push_back(pMesh->vertex(i));
-	}
-
-	for (uint32_t i=0;i<vertCorr.size();++i)
-		vertCorr[i] = VertexMapping[vertCorr[i]];
-
-	std::vector<Eigen::Vector3f> Normals;
-	for (uint32_t i = 0; i < pMesh->normalCount(); ++i) {
-		if (!IsRedundant[i]) Normals.push_back(pMesh->normal(i));
-	}
-
-	std::vector<Eigen::Vector3f> Tangents;
-	for (uint32_t i = 0; i < pMesh->tangentCount(); ++i) {
-		if (!IsRedundant[i]) Tangents.push_back(pMesh->tangent(i));
-	}
+	const uint32_t M = kept.size();
+	printf("Found %d double vertices                             \n", N - M);
+	if (M == N)
+		return vertCorr;
+
+	// rebuild per vertex data
+	std::vector<Vector3f> Vertices(M);
+	for (uint32_t i = 0; i < M; ++i)
+		Vertices[i] = pos[kept[i]];
+
+	auto averaged = [&](uint32_t count, auto get) {
+		std::vector<Vector3f> ret;
+		if (count != N)
+			return ret;
+		ret.assign(M,Vector3f::Zero());
+		for (uint32_t i = 0; i < N; ++i)
+			ret[vertCorr[i]] += get(i);
+		for (uint32_t i = 0; i < M; ++i) {
+			const float len = ret[i].norm();
+			ret[i] = len > 1e-12f ? Vector3f(ret[i] / len) : get(kept[i]);
+		}
+		return ret;
+	};
+	auto firstOfCluster = [&](uint32_t count, auto get) {
+		std::vector<Vector3f> ret;
+		if (count != N)
+			return ret;
+		ret.resize(M);
+		for (uint32_t i = 0; i < M; ++i)
+			ret[i] = get(kept[i]);
+		return ret;
+	};
+
+	std::vector<Vector3f> Normals = averaged(mesh.normalCount(),[&](uint32_t i) { return mesh.normal(i); });
+	std::vector<Vector3f> Tangents = averaged(mesh.tangentCount(),[&](uint32_t i) { return mesh.tangent(i); });
+	std::vector<Vector3f> UVWs = firstOfCluster(mesh.textureCoordinatesCount(),[&](uint32_t i) { return mesh.textureCoordinate(i); });
+	std::vector<Vector3f> Colors = firstOfCluster(mesh.colorCount(),[&](uint32_t i) { return mesh.color(i); });
 
 	// replace indices in faces
 	for (uint32_t i = 0; i < pMesh->submeshCount(); ++i) {
 		auto* pM = pMesh->getSubmesh(i);
-		for (auto& f : pM->Faces) {
-			if (IsRedundant[f.Vertices[0]]) f.Vertices[0] = getMatchingVertex(f.Vertices[0], &RedundantVertices);
-			if (IsRedundant[f.Vertices[1]]) f.Vertices[1] = getMatchingVertex(f.Vertices[1], &RedundantVertices);
-			if (IsRedundant[f.Vertices[2]]) f.Vertices[2] = getMatchingVertex(f.Vertices[2], &RedundantVertices);
-
-			// and remap
-			f.Vertices[0] = VertexMapping[f.Vertices[0]];
-			f.Vertices[1] = VertexMapping[f.Vertices[1]];
-			f.Vertices[2] = VertexMapping[f.Vertices[2]];
-
-		}//for[faces of submesh]
+		T3DMesh<float>::Face* pFaces = pM->Faces.data(); // clones shared faces once, before the workers start
+		parallelFor(0,pM->Faces.size(),[&](size_t b, size_t e) {
+			for (size_t f = b; f < e; ++f) {
+				for (int32_t k = 0; k < 3; ++k)
+					pFaces[f].Vertices[k] = vertCorr[pFaces[f].Vertices[k]];
+			}
+		});
 	}//for[submeshes]
 
-	// replace vertex weights
-	for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
-		auto* pBone = pMesh->getBone(i);
-
-		// collect data
-		std::vector<int32_t> Influences;
-		std::vector<float> Weights;
-
-		for (uint32_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
-			uint32_t ID = pBone->VertexInfluences[k];
-			if (IsRedundant[ID]) pBone->VertexInfluences[k] = getMatchingVertex(ID, &RedundantVertices);
+	// replace vertex weights, influences of a bone on merged vertices become one averaged influence
+	parallelFor(0,pMesh->boneCount(),[&](size_t b, size_t e) {
+		std::vector<int32_t> slot(M,-1);
+		for (size_t i = b; i < e; ++i) {
+			auto* pBone = pMesh->getBone(i);
+			std::vector<int32_t> Influences;
+			std::vector<float> Weights;
+			std::vector<int32_t> Counts;
+			Influences.reserve(pBone->VertexInfluences.size());
+			Weights.reserve(pBone->VertexInfluences.size());
+
+			for (uint32_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
+				const uint32_t ID = vertCorr[pBone->VertexInfluences[k]];
+				const float w = k < pBone->VertexWeights.size() ? pBone->VertexWeights[k] : 0.f;
+				if (slot[ID] < 0) {
+					slot[ID] = Influences.size();
+					Influences.push_back(ID);
+					Weights.push_back(w);
+					Counts.push_back(1);
+				}
+				else {
+					Weights[slot[ID]] += w;
+					Counts[slot[ID]]++;
+				}
+			}
+			for (uint32_t k = 0; k < Influences.size(); ++k) {
+				Weights[k] /= Counts[k];
+				slot[Influences[k]] = -1;
+			}
 
-			pBone->VertexInfluences[k] = VertexMapping[pBone->VertexInfluences[k]];
+			pBone->VertexInfluences = std::move(Influences);
+			if (!pBone->VertexWeights.empty())
+				pBone->VertexWeights = std::move(Weights);
 		}
-	}//for[all bones]
+	},1);
 
 	// replace mesh data
-	if (Vertices.size() > 0) pMesh->vertices(&Vertices);
+	pMesh->vertices(&Vertices);
 	if (Normals.size() > 0) pMesh->normals(&Normals);
 	if (Tangents.size() > 0) pMesh->tangents(&Tangents);
+	if (UVWs.size() > 0) pMesh->textureCoordinates(&UVWs);
+	if (Colors.size() > 0) pMesh->colors(&Colors);
 
 	return vertCorr;
-}//mergeDoubleVertices
+}//mergeRedundantVertices
 
 }//CForge
@@ -5,14 +5,15 @@
 namespace CForge {
 
 /**
- * @brief returns first vertex id of redundant vertex
-*/
-uint32_t getMatchingVertex(uint32_t RedundantVertexID, std::vector<std::pair<uint32_t, uint32_t>> *pRedundantVertices);
-
-/**
- * @brief merges Vertices of Mesh
+ * @brief merges vertices of mesh closer than epsilon, using a spatial hash with cell size epsilon.
+ *        The first vertex (lowest index) of a cluster is kept. A vertex within epsilon of several kept vertices is merged
+ *        with the one of lowest index, merges are not chained.
+ *        epsilon 0 merges vertices with identical positions only.
+ *        Normals and tangents of merged vertices are averaged, texture coordinates and colors
+ *        of the kept vertex are used. Per vertex data is only rebuilt if its count matches the vertex count.
+ *        Faces and bone influences are remapped, influences of one bone on merged vertices are combined.
  * @return mapping from old mesh vert to reduced vert
 */
-std::vector<uint32_t> mergeRedundantVertices(T3DMesh<float>* pMesh);
+std::vector<uint32_t> mergeRedundantVertices(T3DMesh<float>* pMesh, float epsilon = 0.f);
 
 }//CForge
@@ -25,17 +25,48 @@ const BoundingVolume& CharEntity::pckBV() {
 }
 
 void CharEntity::init(SGNTransformation* sgnRoot) {
-	mesh.computePerVertexNormals(); //TODOff(skade) remove
+	prepare();
+	upload(sgnRoot);
+}
+
+void CharEntity::prepare() {
+	mesh.updatePerVertexNormals(); //TODOff(skade) remove
+	jointPickables.clear(); // reference joints of old controller
+	controller.reset();
 	if (mesh.rootBone()) {
-		controller = std::make_unique<IKController>();
+		controller = std::make_shared<IKController>();
 		controller->init(&mesh);
 
 		for (uint32_t i = 0; i < mesh.skeletalAnimationCount(); ++i) {
 			if (mesh.getSkeletalAnimation(i)->Keyframes[0]->ID != -1)
 				controller->addAnimationData(mesh.getSkeletalAnimation(i));
 		}
+	}
+
+	// set bounding volume
+	mesh.updateAxisAlignedBoundingBox();
+	Box aabb = mesh.aabb();
+	bv.init(aabb);
+
+	// load armature if one is bound
+	try {
+		parseArmature();
+	}
+	catch (...) {
+		SLogger::log("error occured curing parsing ik armature, deleting armature");
+		armatureInfo.limbs.clear();
+	}
+}
+
+void CharEntity::upload(SGNTransformation* sgnRoot) {
+	if (controller) {
+		// 16 bit skinning data, 8 influences only for characters which use more than 4
+		uint16_t boneData = VertexUtility::VPROP_BONEDATA16;
+		if (VertexUtility::maxBoneInfluences(&mesh) > 4)
+			boneData |= VertexUtility::VPROP_BONEINFLUENCES8;
 		actor = std::make_unique<IKSkeletalActor>();
-		actor->init(&mesh,controller.get());
+		actor->init(&mesh,controller.get(),boneData);
+		initJointPickables();
 
 		//TODOff(skade) into function?
 		sgn.init(sgnRoot,actor.get());
@@ -50,25 +81,26 @@ void CharEntity::init(SGNTransformation* sgnRoot) {
 		sgn.m_enableCulling = false;
 		isStatic = true;
 	}
+}
 
-	// set bounding volume
-	mesh.computeAxisAlignedBoundingBox();
-	Box aabb = mesh.aabb();
-	bv.init(aabb);
-
-	// load armature if one is bound
-	try {
-		parseArmature();
-	}
-	catch (...) {
-		SLogger::log("error occured curing parsing ik armature, deleting armature");
-		armatureInfo.limbs.clear();
+void CharEntity::initJointPickables() {
+	jointPickables.clear();
+	if (!controller)
+		return;
+	if (!jointPickableMesh)
+		jointPickableMesh = std::make_unique<JointPickableMesh>();
+	for (uint32_t i = 0; i < controller->boneCount(); ++i) {
+		auto* pJoint = controller->getBone(i);
+		jointPickables[pJoint] = std::make_shared<JointPickable>(jointPickableMesh.get(),pJoint,controller.get());
 	}
-}
+	for (auto& [sj,jp] : jointPickables)
+		jp->init();
+}//initJointPickables
 
 void CharEntity::removeArmature(SGNTransformation* sgnRoot) {
 	mesh.clearSkeleton();
 	mesh.clearSkeletalAnimations();
+	jointPickables.clear();
 	controller.reset();
 	actor.reset();
 	init(sgnRoot);
@@ -85,6 +117,7 @@ void CharEntity::applyTransformToMesh(SGNTransformation* sgnRoot) {
 		v = t*v;
 		mesh.vertex(i) = v.block<3,1>(0,0);
 	}
+	mesh.geometryChanged();
 
 	//TODOfff(skade) morph support
 	//mesh.addMorphTarget
@@ -134,6 +167,7 @@ void CharEntity::updateRestpose(SGNTransformation* sgnRoot) {
 	for (uint32_t i=0;i<mesh.vertexCount();++i) {
 		mesh.vertex(i) = actor->transformVertex(i);
 	}
+	mesh.geometryChanged();
 
 	// forwardKinematics to get updated global pos and rot in m_IKJoints
 	controller->forwardKinematics(controller->getRoot());
@@ -196,10 +230,10 @@ void CharEntity::autoCreateTargets() {
 void CharEntity::autoCreateArmature() {
 
 	if (auto ctrl = controller.get()) {
-		std::map<std::string,std::vector<SkeletalAnimationController::SkeletalJoint*>> ikc;
+		std::map<std::string,std::vector<SkeletalPoseController::SkeletalJoint*>> ikc;
 
-		std::function<void(SkeletalAnimationController::SkeletalJoint* pJoint, std::string name)> propagate;
-		propagate = [&](SkeletalAnimationController::SkeletalJoint* pJoint, std::string name) {
+		std::function<void(SkeletalPoseController::SkeletalJoint* pJoint, std::string name)> propagate;
+		propagate = [&](SkeletalPoseController::SkeletalJoint* pJoint, std::string name) {
 			
 			// end current chain and add all childs as new chains
 			int cc = pJoint->Children.size();
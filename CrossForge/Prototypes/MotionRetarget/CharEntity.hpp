@@ -3,6 +3,7 @@
 #include "CMN/Picking.hpp"
 #include "IK/IKSkeletalActor.hpp"
 #include "IK/IKController.hpp"
+#include "Animation/JointPickable.hpp"
 
 #include <crossforge/AssetIO/T3DMesh.hpp>
 #include <crossforge/Graphics/SceneGraph/SGNGeometry.h>
@@ -23,10 +24,25 @@ struct CharEntity : public IPickable {
 	std::unique_ptr<StaticActor> actorStatic;
 
 	// animation only
-	std::unique_ptr<IKController> controller;
+	std::shared_ptr<IKController> controller;
 	int animIdx = 0;
 	int animFrameCurr = 0;
-	SkeletalAnimationController::Animation* pAnimCurr = nullptr;
+	SkeletalPoseController::Animation* pAnimCurr = nullptr;
+
+	// joint visualization and picking, created with the actor
+	std::unique_ptr<JointPickableMesh> jointPickableMesh;
+	std::map<SkeletalPoseController::SkeletalJoint*,std::shared_ptr<JointPickable>> jointPickables;
+	void initJointPickables();
+	std::vector<std::weak_ptr<JointPickable>> getJointPickables() {
+		std::vector<std::weak_ptr<JointPickable>> ret;
+		ret.reserve(jointPickables.size());
+		for (auto& [sj,jp] : jointPickables)
+			ret.push_back(jp);
+		return ret;
+	};
+	std::weak_ptr<JointPickable> getJointPickable(SkeletalPoseController::SkeletalJoint* joint) {
+		return jointPickables[joint];
+	}
 
 	bool m_IKCupdate = false;
 	bool m_IKCupdateSingle = false;
@@ -37,6 +53,13 @@ struct CharEntity : public IPickable {
 	T3DMesh<float> mesh;
 	SGNGeometry sgn;
 	void init(SGNTransformation* sgnRoot);
+	/**
+	 * @brief init split for background loading. prepare does the CPU work (normals, bounding volume,
+	 *        controller and animations) and may run on a worker thread for entities not yet in the scene,
+	 *        upload creates actor and joint pickables and has to run on the render thread.
+	*/
+	void prepare();
+	void upload(SGNTransformation* sgnRoot);
 
 	BoundingVolume bv; // mesh bounding volume
 	float visibility = 1.;
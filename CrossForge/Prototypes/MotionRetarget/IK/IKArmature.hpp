@@ -13,7 +13,7 @@ class IKController;
 */
 template<typename ConstraintImpl>
 class IConstraint {
-//	virtual void apply(IKController::IKSegment* seg, SkeletalAnimationController::SkeletalJoint* cJoint);
+//	virtual void apply(IKController::IKSegment* seg, SkeletalPoseController::SkeletalJoint* cJoint);
 };//IConstraint
 
 /**
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <crossforge/Graphics/Controller/SkeletalAnimationController.h>
+#include <crossforge/Graphics/Controller/SkeletalPoseController.h>
 #include <Prototypes/MotionRetarget/IK/IKTarget.hpp>
 
 #include "Solver/CCDSolver.hpp"
@@ -34,7 +34,7 @@ struct IKJoint {
 */
 struct IKChain {
 	std::string name;
-	std::vector<SkeletalAnimationController::SkeletalJoint*> joints; // front() is end-effector joint
+	std::vector<SkeletalPoseController::SkeletalJoint*> joints; // front() is end-effector joint
 	std::weak_ptr<IKTarget> target;
 
 	//IKJoint* pRoot = nullptr; //TODO(skade) make sure memory safe, IKChain always deleted before corr controller
@@ -1,10 +1,6 @@
 #include "IKController.hpp"
 
-#include <crossforge/Graphics/Shader/SShaderManager.h>
 #include <crossforge/Math/CForgeMath.h>
-#include <crossforge/Core/SLogger.h>
-
-#include <crossforge/Graphics/RenderDevice.h> // for JointVis
 
 #include <Prototypes/MotionRetarget/CMN/EigenFWD.hpp>
 
@@ -15,29 +11,16 @@
 namespace CForge {
 using namespace Eigen;
 
-//TODOfff(skade) CForgeObject classname wrong
-IKController::IKController(void) : SkeletalAnimationController() {
+IKController::IKController(void) : SkeletalPoseController("IKController") {
 	m_pRoot = nullptr;
 	//m_pHead = nullptr;
-
-	m_pShadowPassShader = nullptr;
-	m_pShadowPassFSCode = nullptr;
-	m_pShadowPassVSCode = nullptr;
-
-#ifdef SHADER_GLES
-	m_GLSLVersionTag = "300 es";
-	m_GLSLPrecisionTag = "lowp";
-#else
-	m_GLSLVersionTag = "330 core";
-	m_GLSLPrecisionTag = "lowp";
-#endif
-
 }//constructor
 
 IKController::~IKController(void) {
 	clear();
 }//Destructor
 
+// pMesh has to hold skeletal definition
 void IKController::init(T3DMesh<float>* pMesh) {
 	clear();
 
@@ -75,43 +58,10 @@ void IKController::init(T3DMesh<float>* pMesh) {
 			break;
 		}
 	}//for[joints]
-	
-	// initialize UBO
-	m_UBO.init(m_Joints.size());
-
-	for (uint32_t i = 0; i < m_Joints.size(); ++i) {
-		m_UBO.skinningMatrix(i, m_Joints[i]->OffsetMatrix);
-	}//for[joints]
-
-	SShaderManager* pSMan = SShaderManager::instance();
-
-	m_pShadowPassFSCode = pSMan->createShaderCode("Shader/ShadowPassShader.frag",
-	                      m_GLSLVersionTag, 0, m_GLSLPrecisionTag);
-	m_pShadowPassVSCode = pSMan->createShaderCode("Shader/ShadowPassShader.vert", m_GLSLVersionTag,
-	                      ShaderCode::CONF_SKELETALANIMATION | ShaderCode::CONF_LIGHTING, m_GLSLPrecisionTag);
-
-	ShaderCode::SkeletalAnimationConfig SkelConfig;
-	SkelConfig.BoneCount = m_Joints.size();
-	m_pShadowPassVSCode->config(&SkelConfig);
-
-	std::vector<ShaderCode*> VSSources;
-	std::vector<ShaderCode*> FSSources;
-	VSSources.push_back(m_pShadowPassVSCode);
-	FSSources.push_back(m_pShadowPassFSCode);
-
-	m_pShadowPassShader = pSMan->buildShader(&VSSources, &FSSources, nullptr);
-
-	pSMan->release();
-
-	for (uint32_t i=0;i<m_Joints.size();++i)
-		m_jointPickables[m_Joints[i]] = std::make_shared<JointPickable>(&m_jointPickableMesh,m_Joints[i],this);
-	for (auto& [sj,jp] : m_jointPickables)
-		jp->init();
-		//m_jointPickables.emplace_back(std::make_shared<JointPickable>(&m_jointPickableMesh,m_Joints[i],this));
 
 	initJointProperties(pMesh);
 	initRestpose();
-}
+}//initialize
 
 // pMesh has to hold skeletal definition
 void IKController::init(T3DMesh<float>* pMesh, std::string ConfigFilepath) {
@@ -127,8 +77,8 @@ void IKController::init(T3DMesh<float>* pMesh, std::string ConfigFilepath) {
 }//initialize
 
 void IKController::initRestpose() {
-	std::function<void(SkeletalAnimationController::SkeletalJoint* pJoint, Matrix4f offP)> initJoint;
-	initJoint = [&](SkeletalAnimationController::SkeletalJoint* pJoint, Matrix4f offP) {
+	std::function<void(SkeletalPoseController::SkeletalJoint* pJoint, Matrix4f offP)> initJoint;
+	initJoint = [&](SkeletalPoseController::SkeletalJoint* pJoint, Matrix4f offP) {
 		Matrix4f iom = pJoint->OffsetMatrix.inverse();
 		Matrix4f t = offP.inverse() * iom;
 
@@ -158,14 +108,6 @@ void IKController::clear(void) {
 	
 	m_IKJoints.clear();
 	getJointChains().clear();
-	
-	m_UBO.clear();
-
-	// instances get deleted by the Shader Manager
-	m_pShadowPassShader = nullptr;
-	m_pShadowPassFSCode = nullptr;
-	m_pShadowPassVSCode = nullptr;
-
 }//clear
 
 
@@ -377,9 +319,9 @@ void IKController::update(float FPSScale) {
 	m_ikArmature.solve(this);
 }//update
 
-void IKController::applyAnimation(Animation* pAnim, bool UpdateUBO) {
+void IKController::applyAnimation(Animation* pAnim) {
 	if (pAnim) {
-		SkeletalAnimationController::applyAnimation(pAnim,UpdateUBO);
+		SkeletalPoseController::applyAnimation(pAnim);
 
 		// no chains except maybe
 		forwardKinematics(m_pRoot);
@@ -387,10 +329,6 @@ void IKController::applyAnimation(Animation* pAnim, bool UpdateUBO) {
 	} else {
 		transformSkeleton(m_pRoot, Matrix4f::Identity());
 	}
-	if (UpdateUBO) {
-		for (uint32_t i = 0; i < m_Joints.size(); ++i)
-			m_UBO.skinningMatrix(i, m_Joints[i]->SkinningMatrix);
-	}
 }//applyAnimation
 
 void IKController::forwardKinematics(SkeletalJoint* pJoint) {
@@ -423,7 +361,7 @@ void IKController::retrieveSkinningMatrices(std::vector<Matrix4f>* pSkinningMats
 		pSkinningMats->push_back(i->SkinningMatrix);
 }//retrieveSkinningMatrices
 
-SkeletalAnimationController::SkeletalJoint* IKController::getBone(uint32_t idx) {
+SkeletalPoseController::SkeletalJoint* IKController::getBone(uint32_t idx) {
 	return m_Joints[idx];
 }
 
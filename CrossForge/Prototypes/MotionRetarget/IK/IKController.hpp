@@ -1,9 +1,7 @@
 #pragma once
 
 #include <crossforge/AssetIO/T3DMesh.hpp>
-#include <crossforge/Graphics/Controller/SkeletalAnimationController.h>
-
-#include <Prototypes/MotionRetarget/Animation/JointPickable.hpp>
+#include <crossforge/Graphics/Controller/SkeletalPoseController.h>
 
 #include "IKTarget.hpp"
 #include "IKArmature.hpp"
@@ -12,9 +10,10 @@
 
 namespace CForge {
 using namespace Eigen;
-class RenderDevice;
-
-class IKController : public SkeletalAnimationController {
+/**
+ * @brief Pose and IK state of a skeleton. Holds no GL resources, rendering is done by IKSkeletalActor.
+*/
+class IKController : public SkeletalPoseController {
 public:
 	SkeletalJoint* getRoot() { return m_pRoot; }
 
@@ -28,12 +27,11 @@ public:
 	void update(float FPSScale);
 	void clear(void);
 
-	//void applyAnimation(bool UpdateUBO = true);
-	void applyAnimation(Animation* pAnim, bool UpdateUBO = true);
+	void applyAnimation(Animation* pAnim);
 
 	void retrieveSkinningMatrices(std::vector<Eigen::Matrix4f>* pSkinningMats);
 
-	SkeletalAnimationController::SkeletalJoint* getBone(uint32_t idx);
+	SkeletalPoseController::SkeletalJoint* getBone(uint32_t idx);
 	uint32_t boneCount();
 
 	IKChain* getIKChain(std::string name) {
@@ -64,17 +62,6 @@ public:
 		return ret;
 	};
 
-	std::vector<std::weak_ptr<JointPickable>> getJointPickables() {
-		std::vector<std::weak_ptr<JointPickable>> ret;
-		ret.reserve(m_jointPickables.size());
-		for (auto& [sj,jp] : m_jointPickables)
-			ret.push_back(jp);
-		return ret;
-	};
-	std::weak_ptr<JointPickable> getJointPickable(SkeletalJoint* joint) {
-		return m_jointPickables[joint];
-	}
-
 	//TODOff(skade) unify with chain editor func
 	/**
 	 * @brief Builds new IKChain from names and places them into getJointChains()
@@ -92,9 +79,6 @@ public:
 	IKArmature m_ikArmature;
 	std::vector<std::shared_ptr<IKTarget>> m_targets;
 private:
-	std::map<SkeletalJoint*,std::shared_ptr<JointPickable>> m_jointPickables;
-	JointPickableMesh m_jointPickableMesh;
-	
 	/**
 	 * @brief Initializes IKJoints
 	*/
@@ -1,27 +1,77 @@
 #include <crossforge/Graphics/RenderDevice.h>
 #include <crossforge/Graphics/OpenGLHeader.h>
+#include <crossforge/Graphics/Shader/SShaderManager.h>
 #include "IKSkeletalActor.hpp"
 
 
 namespace CForge {
 	IKSkeletalActor::IKSkeletalActor(void) : SkeletalActor() {
 		m_pAnimationController = nullptr;
+		m_pShadowPassShader = nullptr;
+		m_pShadowPassFSCode = nullptr;
+		m_pShadowPassVSCode = nullptr;
+
+#ifdef SHADER_GLES
+		m_GLSLVersionTag = "300 es";
+		m_GLSLPrecisionTag = "lowp";
+#else
+		m_GLSLVersionTag = "330 core";
+		m_GLSLPrecisionTag = "lowp";
+#endif
 	}//Constructor
 
 	IKSkeletalActor::~IKSkeletalActor(void) {
 		clear();
 	}//Destructor
 
-	void IKSkeletalActor::init(T3DMesh<float>* pMesh, IKController* pController) {
+	void IKSkeletalActor::init(T3DMesh<float>* pMesh, IKController* pController, uint16_t BoneDataProps) {
 		clear();
-		initBuffer(pMesh,true);
+		initBuffer(pMesh,true,BoneDataProps);
 
 		m_pAnimationController = pController;
 		m_BV.init(*pMesh, BoundingVolume::TYPE_AABB);
+
+		// initialize UBO
+		m_UBO.init(pController->boneCount());
+		for (uint32_t i = 0; i < pController->boneCount(); ++i)
+			m_UBO.skinningMatrix(i, pController->getBone(i)->OffsetMatrix);
+
+		initShadowPassShader();
 	}//initialize
 
+	void IKSkeletalActor::initShadowPassShader() {
+		SShaderManager* pSMan = SShaderManager::instance();
+
+		m_pShadowPassFSCode = pSMan->createShaderCode("Shader/ShadowPassShader.frag",
+		                      m_GLSLVersionTag, 0, m_GLSLPrecisionTag);
+		uint8_t configOptions = ShaderCode::CONF_SKELETALANIMATION | ShaderCode::CONF_LIGHTING;
+		if (m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEINFLUENCES8))
+			configOptions |= ShaderCode::CONF_BONEINFLUENCES8;
+		m_pShadowPassVSCode = pSMan->createShaderCode("Shader/ShadowPassShader.vert", m_GLSLVersionTag,
+		                      configOptions, m_GLSLPrecisionTag);
+
+		ShaderCode::SkeletalAnimationConfig SkelConfig;
+		SkelConfig.BoneCount = m_pAnimationController->boneCount();
+		m_pShadowPassVSCode->config(&SkelConfig);
+
+		std::vector<ShaderCode*> VSSources;
+		std::vector<ShaderCode*> FSSources;
+		VSSources.push_back(m_pShadowPassVSCode);
+		FSSources.push_back(m_pShadowPassFSCode);
+
+		m_pShadowPassShader = pSMan->buildShader(&VSSources, &FSSources, nullptr);
+
+		pSMan->release();
+	}//initShadowPassShader
+
 	void IKSkeletalActor::clear(void) {
 		m_pAnimationController = nullptr;
+		m_UBO.clear();
+
+		// instances get deleted by the Shader Manager
+		m_pShadowPassShader = nullptr;
+		m_pShadowPassFSCode = nullptr;
+		m_pShadowPassVSCode = nullptr;
 	}//clear
 
 	//TODOff(skade) does this make sense?
@@ -32,16 +82,18 @@ namespace CForge {
 	void IKSkeletalActor::render(RenderDevice* pRDev, Eigen::Quaternionf Rotation, Eigen::Vector3f Translation, Eigen::Vector3f Scale) {
 		if (!pRDev) throw NullpointerExcept("pRDev");
 		
-		m_pAnimationController->applyAnimation(m_pActiveAnimation,true);
+		m_pAnimationController->applyAnimation(m_pActiveAnimation);
+		for (uint32_t i = 0; i < m_pAnimationController->boneCount(); ++i)
+			m_UBO.skinningMatrix(i, m_pAnimationController->getBone(i)->SkinningMatrix);
 		
 		for (auto i : m_RenderGroupUtility.renderGroups()) {
 
 			switch (pRDev->activePass()) {
 			case RenderDevice::RENDERPASS_SHADOW: {
 				if (!(i->pShaderShadowPass)) continue;
-				pRDev->activeShader(m_pAnimationController->shadowPassShader());
+				pRDev->activeShader(m_pShadowPassShader);
 				uint32_t BindingPoint = pRDev->activeShader()->uboBindingPoint(GLShader::DEFAULTUBO_BONEDATA);
-				if (BindingPoint != GL_INVALID_INDEX) m_pAnimationController->ubo()->bind(BindingPoint);
+				if (BindingPoint != GL_INVALID_INDEX) m_UBO.bind(BindingPoint);
 			}
 				break;
 			case RenderDevice::RENDERPASS_GEOMETRY: {
@@ -49,7 +101,7 @@ namespace CForge {
 
 				pRDev->activeShader(i->pShaderGeometryPass);
 				uint32_t BindingPoint = pRDev->activeShader()->uboBindingPoint(GLShader::DEFAULTUBO_BONEDATA);
-				if (BindingPoint != GL_INVALID_INDEX) m_pAnimationController->ubo()->bind(BindingPoint);
+				if (BindingPoint != GL_INVALID_INDEX) m_UBO.bind(BindingPoint);
 
 				pRDev->activeMaterial(&i->Material);
 			}
@@ -59,7 +111,7 @@ namespace CForge {
 
 				pRDev->activeShader(i->pShaderForwardPass);
 				uint32_t BindingPoint = pRDev->activeShader()->uboBindingPoint(GLShader::DEFAULTUBO_BONEDATA);
-				if (BindingPoint != GL_INVALID_INDEX) m_pAnimationController->ubo()->bind(BindingPoint);
+				if (BindingPoint != GL_INVALID_INDEX) m_UBO.bind(BindingPoint);
 
 				pRDev->activeMaterial(&i->Material);
 			}
@@ -77,15 +129,26 @@ namespace CForge {
 		return m_pAnimationController;
 	}
 
+	UBOBoneData* IKSkeletalActor::ubo() {
+		return &m_UBO;
+	}
+
+	GLShader* IKSkeletalActor::shadowPassShader() {
+		return m_pShadowPassShader;
+	}
+
 	Eigen::Vector3f IKSkeletalActor::transformVertex(int32_t Index) {
 		if (0 == m_SkinVertexes.size()) throw CForgeExcept("Class not prepared for CPU skinning!");
 		if (0 > Index || Index >= m_SkinVertexes.size()) throw IndexOutOfBoundsExcept("Index");
 		
 		auto* pV = m_SkinVertexes[Index];
 
-		const Eigen::Vector4i I = Eigen::Vector4i(pV->BoneInfluences[0], pV->BoneInfluences[1], pV->BoneInfluences[2], pV->BoneInfluences[3]);
-		const Eigen::Vector4f W = Eigen::Vector4f(pV->BoneWeights[0], pV->BoneWeights[1], pV->BoneWeights[2], pV->BoneWeights[3]);
-
-		return m_pAnimationController->transformVertex(m_SkinVertexes[Index]->V, I, W);
+		Eigen::Vector3f ret = Eigen::Vector3f::Zero();
+		for (uint32_t k = 0; k + 3 < pV->BoneInfluences.size(); k += 4) {
+			const Eigen::Vector4i I = Eigen::Vector4i(pV->BoneInfluences[k], pV->BoneInfluences[k+1], pV->BoneInfluences[k+2], pV->BoneInfluences[k+3]);
+			const Eigen::Vector4f W = Eigen::Vector4f(pV->BoneWeights[k], pV->BoneWeights[k+1], pV->BoneWeights[k+2], pV->BoneWeights[k+3]);
+			ret += m_pAnimationController->transformVertex(pV->V, I, W);
+		}
+		return ret;
 	}//transformVertex
 }//CForge
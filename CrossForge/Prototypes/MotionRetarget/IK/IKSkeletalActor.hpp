@@ -5,12 +5,18 @@
 #include "IKController.hpp"
 
 namespace CForge {
+	/**
+	 * @brief GL layer of IKController, owns bone UBO and shadow pass shader.
+	*/
 	class IKSkeletalActor : public SkeletalActor {
 	public:
 		IKSkeletalActor(void);
 		~IKSkeletalActor(void);
 
-		void init(T3DMesh<float>* pMesh, IKController* pController);
+		/**
+		 * @param BoneDataProps VertexUtility::VPROP_BONEINFLUENCES8 and/or VertexUtility::VPROP_BONEDATA16
+		*/
+		void init(T3DMesh<float>* pMesh, IKController* pController, uint16_t BoneDataProps = 0);
 		void clear(void);
 		void release(void);
 
@@ -20,8 +26,21 @@ namespace CForge {
 
 		Eigen::Vector3f transformVertex(int32_t Index);
 
+		UBOBoneData* ubo();
+		GLShader* shadowPassShader();
+
 	protected:
+		void initShadowPassShader();
+
 		IKController* m_pAnimationController;
+
+		UBOBoneData m_UBO;
+		GLShader* m_pShadowPassShader;
+		ShaderCode* m_pShadowPassVSCode;
+		ShaderCode* m_pShadowPassFSCode;
+
+		std::string m_GLSLVersionTag;
+		std::string m_GLSLPrecisionTag;
 	};//SkeletalActor
 
 }//CForge
@@ -1,12 +1,15 @@
 #include "CCDSolver.hpp"
 #include <Prototypes/MotionRetarget/IK/IKController.hpp>
 
+#include <cfloat>
+
 namespace CForge {
 
 //template<IKSccd::Type type>
 void IKSccd::solve(std::string segmentName, IKController* pController) {
 	std::vector<IKController::SkeletalJoint*>& Chain = pController->getIKChain(segmentName)->joints;
 	IKTarget* target = pController->getIKChain(segmentName)->target.lock().get();
+	m_lastIterations = 0;
 	if (!target)
 		return;
 
@@ -78,6 +81,7 @@ void IKSccd::solve(std::string segmentName, IKController* pController) {
 			// update kinematic chain
 			pController->forwardKinematics(pCurrent);
 		}//for[each joint in chain]
+		m_lastIterations = i+1;
 
 		float PosChangeError = (eef.posGlobal - lastEFpos).norm();
 		if (PosChangeError < m_thresholdPosChange)
@@ -1,6 +1,8 @@
 #include "FABRIKSolver.hpp"
 #include <Prototypes/MotionRetarget/IK/IKController.hpp>
 
+#include <cfloat>
+
 namespace CForge {
 
 void IKSfabrik::solve(std::string segmentName, IKController* pController) {
@@ -8,6 +10,7 @@ void IKSfabrik::solve(std::string segmentName, IKController* pController) {
 	std::vector<IKController::SkeletalJoint*>& Chain = pController->getIKChain(segmentName)->joints;
 	//IKTarget* target = pController->m_jointChains.at(segmentName).target;
 	IKTarget* target = pController->getIKChain(segmentName)->target.lock().get();
+	m_lastIterations = 0;
 	if (!target)
 		return;
 
@@ -38,6 +41,7 @@ void IKSfabrik::solve(std::string segmentName, IKController* pController) {
 			Vector3f ofst = rootToTarget.normalized() * fbrkLen[i+1];
 			fbrkPoints[i] = ofst + fbrkPoints[i+1];
 		}
+		m_lastIterations = 1; // closed form, single pass
 	}
 	else {
 		// target reachable
@@ -70,6 +74,7 @@ void IKSfabrik::solve(std::string segmentName, IKController* pController) {
 				Vector3f newPos = fbrkPoints[i+1] + (line*fbrkLen[i+1]);
 				fbrkPoints[i] = newPos;
 			}
+			m_lastIterations = iter+1;
 		}
 	}
 
@@ -15,6 +15,8 @@ public:
 	int32_t m_MaxIterations = 100;
 	float m_thresholdDist = 1e-6f;
 	float m_thresholdPosChange = 1e-6f;
+
+	int32_t m_lastIterations = 0; // iterations performed by the last solve call
 protected:
 };//IIKSolver
 
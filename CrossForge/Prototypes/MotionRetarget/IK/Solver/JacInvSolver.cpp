@@ -11,6 +11,7 @@ using namespace Eigen;
 void IKSjacInv::solve(std::string segmentName, IKController* pController) {
 	std::vector<IKController::SkeletalJoint*>& Chain = pController->getIKChain(segmentName)->joints;
 	IKTarget* target = pController->getIKChain(segmentName)->target.lock().get();
+	m_lastIterations = 0;
 	if (!target)
 		return;
 
@@ -103,6 +104,7 @@ void IKSjacInv::solve(std::string segmentName, IKController* pController) {
 		}
 		
 		pController->forwardKinematics();
+		m_lastIterations = i+1;
 	
 		float PosChangeError = (eef.posGlobal - lastEFpos).norm();
 		if (PosChangeError < m_thresholdPosChange)
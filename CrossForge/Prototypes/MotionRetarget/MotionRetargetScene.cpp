@@ -73,6 +73,10 @@ void MotionRetargetScene::clear() {
 
 	m_config.baseStore();
 
+	m_rigTasks.clear(); // cancels and waits for running rigs
+	m_loadQueue.reset(); // cancels queued imports and waits for running ones
+	m_loadTasks.clear();
+
 	ExampleSceneBase::clear();
 	cleanUI();
 }
@@ -117,7 +121,7 @@ void MotionRetargetScene::mainLoop() {
 			animAutoplay |= c->m_animAutoplay;
 		}
 
-		frameAction = keyboardAnyKeyPressed() || IKCupdate || animAutoplay
+		frameAction = keyboardAnyKeyPressed() || IKCupdate || animAutoplay || !m_rigTasks.empty() || !m_loadTasks.empty()
 					  || ImGui::IsAnyItemHovered()
 					  || ImGuizmo::IsUsing() || m_guizmoViewManipChanged;
 		// need to render on window resize
@@ -286,7 +290,7 @@ void MotionRetargetScene::mainLoop() {
 						if (!c->controller)
 							continue;
 						if (m_settings.showJoints) {
-							std::vector<std::weak_ptr<JointPickable>> jp = c->controller->getJointPickables();
+							std::vector<std::weak_ptr<JointPickable>> jp = c->getJointPickables();
 							p.assign(jp.begin(),jp.end());
 							m_picker.pick(p);
 						}
@@ -346,11 +350,13 @@ void MotionRetargetScene::mainLoop() {
 		m_RenderWin.closeWindow();
 }//mainLoop
 
-void MotionRetargetScene::initCharacter(std::weak_ptr<CharEntity> charEntity) {
+void MotionRetargetScene::initCharacter(std::weak_ptr<CharEntity> charEntity, bool prepared) {
 	std::shared_ptr<CharEntity> c = charEntity.lock();
 	//setMeshShader(mesh, 0.7f, 0.04f); //TODOff(skade) check not modified export
 
-	c->init(&m_sgnRoot);
+	if (!prepared)
+		c->prepare();
+	c->upload(&m_sgnRoot);
 
 	//TODOff(skade) autoscale import option in preferences
 	// autoscale
@@ -450,63 +456,81 @@ void MotionRetargetScene::initIKTargetActor() {
 	m_TargetPosForeign.init(&M);
 }//initIKTargetActor
 
-void MotionRetargetScene::loadCharPrim(std::string path, IOmeth ioM) {
+bool MotionRetargetScene::charAccepted(const std::string& path, IOmeth ioM) {
 	switch (ioM)
 	{
 	case CForge::MotionRetargetScene::IOM_ASSIMP:
-		if (SAssetIO::accepted(path, I3DMeshIO::Operation::OP_LOAD)) {
-			std::shared_ptr<CharEntity> c = std::make_shared<CharEntity>();
-			std::string name = std::filesystem::path(path).filename().string();
-			c->name = name;
-			//TODOfff(skade) make m_charEntities std::map to avoid name confilcts?
-			// for now avoid name conflicts via checking
-			bool nameUnique = false;
-			int nameNum = 0;
-			while (!nameUnique) {
-				nameUnique = true;
-				for (auto oc : m_charEntities) {
-					if (oc->name == c->name) {
-						c->name = name + std::to_string(nameNum);
-						nameUnique = false; // need to check again
-					}
-				}
-				nameNum++;
-			}
-			SAssetIO::load(path,&c->mesh);
-			initCharacter(c);
-			m_charEntities.emplace_back(std::move(c));
-		}
-		break;
+		return SAssetIO::accepted(path, I3DMeshIO::Operation::OP_LOAD);
 	case CForge::MotionRetargetScene::IOM_GLTFIO:
-		if (GLTFIO::accepted(path, I3DMeshIO::Operation::OP_LOAD)) {
-			std::shared_ptr<CharEntity> c = std::make_shared<CharEntity>();
-			std::string name = std::filesystem::path(path).filename().string();
-			c->name = name;
-			//TODOfff(skade) make m_charEntities std::map to avoid name confilcts?
-			// for now avoid name conflicts via checking
-			bool nameUnique = false;
-			int nameNum = 0;
-			while (!nameUnique) {
-				nameUnique = true;
-				for (auto oc : m_charEntities) {
-					if (oc->name == c->name) {
-						c->name = name + std::to_string(nameNum);
-						nameUnique = false; // need to check again
-					}
-				}
-				nameNum++;
-			}
-			GLTFIO::load(path,&c->mesh);
-			initCharacter(c);
-			m_charEntities.emplace_back(std::move(c));
-		}
+		return GLTFIO::accepted(path, I3DMeshIO::Operation::OP_LOAD);
+	default:
+		return false;
+	}
+}
+
+void MotionRetargetScene::loadCharMesh(const std::string& path, IOmeth ioM, T3DMesh<float>* pMesh) {
+	switch (ioM)
+	{
+	case CForge::MotionRetargetScene::IOM_ASSIMP:
+		SAssetIO::load(path,pMesh);
 		break;
-	case CForge::MotionRetargetScene::IOM_OBJIMP:
+	case CForge::MotionRetargetScene::IOM_GLTFIO:
+		GLTFIO::load(path,pMesh);
 		break;
 	default:
-		break;
+		throw CForgeExcept("unsupported import method");
 	}
 }
+
+void MotionRetargetScene::loadCharPrim(std::string path, IOmeth ioM) {
+	if (!charAccepted(path,ioM))
+		return;
+	std::shared_ptr<CharEntity> c = std::make_shared<CharEntity>();
+	c->name = std::filesystem::path(path).filename().string();
+	loadCharMesh(path,ioM,&c->mesh);
+	c->prepare();
+	addCharEntity(c);
+}
+
+void MotionRetargetScene::queueCharPrim(std::string path, IOmeth ioM) {
+	if (!charAccepted(path,ioM))
+		return;
+	if (!m_loadQueue)
+		m_loadQueue = std::make_unique<JobQueue>();
+
+	std::shared_ptr<CharEntity> c = std::make_shared<CharEntity>();
+	c->name = std::filesystem::path(path).filename().string();
+	auto job = m_loadQueue->push([c,path,ioM](JobQueue::Job* pJob) {
+		pJob->report(0.f, "parse");
+		loadCharMesh(path,ioM,&c->mesh);
+		if (c->mesh.vertexCount() == 0)
+			throw CForgeExcept("no mesh data in " + path);
+		pJob->report(.8f, "prepare");
+		c->prepare();
+	});
+	m_loadTasks.push_back({ c, path, job });
+}
+
+void MotionRetargetScene::addCharEntity(std::shared_ptr<CharEntity> c) {
+	//TODOfff(skade) make m_charEntities std::map to avoid name confilcts?
+	// for now avoid name conflicts via checking
+	const std::string name = c->name;
+	bool nameUnique = false;
+	int nameNum = 0;
+	while (!nameUnique) {
+		nameUnique = true;
+		for (auto oc : m_charEntities) {
+			if (oc->name == c->name) {
+				c->name = name + std::to_string(nameNum);
+				nameUnique = false; // need to check again
+			}
+		}
+		nameNum++;
+	}
+	initCharacter(c,true);
+	m_charEntities.emplace_back(std::move(c));
+}
+
 void MotionRetargetScene::storeCharPrim(std::string path, IOmeth ioM) {
 	auto c = m_charEntityPrim.lock();
 	if (!c)
@@ -560,7 +584,7 @@ void MotionRetargetScene::renderVisualizers(CharEntity* c) {
 	Matrix4f t = CForgeMath::translationMatrix(pos) * CForgeMath::rotationMatrix(rot) * CForgeMath::scaleMatrix(scale);
 	glClear(GL_DEPTH_BUFFER_BIT);
 	if (c->controller && m_settings.showJoints) { //TODOff(skade) put in function
-		auto& joints = c->controller->getJointPickables();
+		auto& joints = c->getJointPickables();
 		if (joints.size() > 0 && joints[0].lock()->getOpacity() != 0.f) {
 			for (auto j : joints) {
 				if (auto jl = j.lock()) {
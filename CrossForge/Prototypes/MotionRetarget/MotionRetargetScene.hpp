@@ -18,6 +18,8 @@
 #include "UI/EditGrid.hpp"
 
 #include "AutoMoRe/MRlimb.hpp"
+#include "AutoRig/RigJob.hpp"
+#include "CMN/JobQueue.hpp"
 
 namespace CForge {
 
@@ -42,7 +44,10 @@ public:
 	void initCameraAndLights(bool CastShadows = true);
 
 private:
-	void initCharacter(std::weak_ptr<CharEntity> charEntity);
+	/**
+	 * @param prepared CharEntity::prepare already ran, e.g. on a load worker
+	*/
+	void initCharacter(std::weak_ptr<CharEntity> charEntity, bool prepared = false);
 	void initCesiumMan();
 
 	// target visualizer
@@ -68,6 +73,8 @@ private:
 	void renderUI_tools();
 	void renderUI_ik();
 	void renderUI_autorig();
+	void renderUI_rigJobs();
+	void renderUI_loadJobs();
 	void renderUI_autoMoRe();
 	void renderUI_ikChainEditor(int* item_current_idx);
 	void renderUI_ikTargetEditor();
@@ -82,7 +89,17 @@ private:
 		IOMCOUNT,
 	};
 	
+	static bool charAccepted(const std::string& path, IOmeth ioM);
+	static void loadCharMesh(const std::string& path, IOmeth ioM, T3DMesh<float>* pMesh);
+	/**
+	 * @brief loads synchronously, the new entity is m_charEntities.back()
+	*/
 	void loadCharPrim(std::string path, IOmeth ioM);
+	/**
+	 * @brief parses and prepares on a worker of m_loadQueue, the entity is added to the scene a few frames later
+	*/
+	void queueCharPrim(std::string path, IOmeth ioM);
+	void addCharEntity(std::shared_ptr<CharEntity> c);
 	void storeCharPrim(std::string path, IOmeth ioM);
 
 	bool keyboardAnyKeyPressed();
@@ -106,6 +123,23 @@ private:
 	std::vector<std::shared_ptr<CharEntity>> m_charEntities;
 	std::weak_ptr<CharEntity> m_charEntityPrim; // currently selected char entity
 	std::weak_ptr<CharEntity> m_charEntitySec; // secondary char entity for operations
+
+	// auto rigging running in the background, the result replaces the mesh of target once done
+	struct RigTask {
+		std::weak_ptr<CharEntity> target;
+		std::string name;
+		std::unique_ptr<RigJob> job;
+	};
+	std::vector<RigTask> m_rigTasks;
+
+	// asset imports running in the background, finished entities are uploaded and added on the render thread
+	struct LoadTask {
+		std::shared_ptr<CharEntity> entity; // not in m_charEntities until uploaded
+		std::string path;
+		std::shared_ptr<JobQueue::Job> job;
+	};
+	std::vector<LoadTask> m_loadTasks;
+	std::unique_ptr<JobQueue> m_loadQueue; // created on first import
 	bool m_isEditMode = false; // focuses on one charEntity
 	// sgn matrix of charEntity in edit mode for restoration
 	Vector3f m_editModeCachePos = Vector3f::Zero();
@@ -150,6 +184,7 @@ private:
 		POP_CHAINED,
 		POP_AR_PINOC,
 		POP_AR_RIGNET,
+		POP_AR_VOXEL,
 		POP_MR_LIMB,
 		POP_COUNT,
 	};
@@ -4,6 +4,10 @@
 #include "UI/ImGuiStyle.hpp"
 #include "Animation/IKSequencer.hpp"
 #include <crossforge/AssetIO/UserDialog.h>
+#include <crossforge/AssetIO/SkeletalClipLibrary.h>
+
+#include <chrono>
+
 //TODOff(skade) for ImGuiUtility::initImGui replace
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -13,10 +17,13 @@
 
 #include "AutoRig/ARpinocchio.hpp" //TODOff(skade) into Scene instead of here
 #include "AutoRig/ARrignet.hpp" //TODOff(skade) into Scene instead of here
+#include "AutoRig/ARproxy.hpp"
+#include "AutoRig/ARvoxelBind.hpp"
 
 #include "AutoMoRe/MRlimb.hpp" //TODOff(skade) into Scene instead of here
 
 #include "CMN/MergeVertices.hpp"
+#include "CMN/MRMutil.hpp"
 
 namespace ImGui {
 
@@ -95,6 +102,8 @@ void MotionRetargetScene::renderUI() {
 	renderUI_tools();
 	renderUI_ik();
 	renderUI_autorig();
+	renderUI_rigJobs();
+	renderUI_loadJobs();
 	renderUI_autoMoRe();
 
 	ImGuiUtility::render();
@@ -181,7 +190,7 @@ void MotionRetargetScene::renderUI_Outliner() {
 
 				if (c->controller) {
 					//ImGui::SameLine();
-					auto jps = c->controller->getJointPickables();
+					auto jps = c->getJointPickables();
 					float jpo = jps[0].lock()->getOpacity();
 					ImGui::SetNextItemWidth(ImGui::GetWindowWidth()*.5);
 					ImGui::DragFloat("Joint Opacity",&jpo,.005,0.,1.);
@@ -211,13 +220,13 @@ void MotionRetargetScene::renderUI_Outliner() {
 						}
 						else {
 							m_outlinerSelJoint = clickedNode;
-							m_picker.forcePick(c->controller->getJointPickable(clickedNode));
+							m_picker.forcePick(c->getJointPickable(clickedNode));
 							m_guizmoMat = m_picker.m_guizmoMat;
 						}
 					}
 					else {
 						m_outlinerSelJoint = clickedNode;
-						m_picker.forcePick(c->controller->getJointPickable(clickedNode));
+						m_picker.forcePick(c->getJointPickable(clickedNode));
 						m_guizmoMat = m_picker.m_guizmoMat;
 					}
 				}
@@ -255,7 +264,7 @@ void MotionRetargetScene::renderUI_animation() {
 	std::vector<std::string> items(c->controller->animationCount()+1);
 	items[0] = "none";
 	for (uint32_t i=0;i<c->controller->animationCount();++i)
-		items[i+1] = c->controller->animation(i)->Name;
+		items[i+1] = c->controller->animationName(i); // clips of libraries stay encoded until played
 	ImGui::ComboStr("select animation",&c->animIdx,items);
 
 	if (c->animIdx > 0) { // anim selected
@@ -381,12 +390,24 @@ void MotionRetargetScene::renderUI_menuBar() {
 		{
 			if (ImGui::BeginMenu("Import")) {
 				if (ImGui::MenuItem("GLTF", ".gltf, .glb")) {
-					std::string path = UserDialog::OpenFile("load primary char", "gltf", "*.gltf *.glb");
-					loadCharPrim(path,IOM_GLTFIO);
+					for (const std::string& path : UserDialog::OpenFiles("load chars", "gltf", "*.gltf *.glb"))
+						queueCharPrim(path,IOM_GLTFIO);
 				}
 				if (ImGui::MenuItem("Assimp")) {
-					std::string path = UserDialog::OpenFile("load primary char", "assimp");
-					loadCharPrim(path,IOM_ASSIMP);
+					for (const std::string& path : UserDialog::OpenFiles("load chars", "assimp"))
+						queueCharPrim(path,IOM_ASSIMP);
+				}
+				if (ImGui::MenuItem("Clip library", ".cfclips")) {
+					if (auto c = m_charEntityPrim.lock()) {
+						for (const std::string& path : UserDialog::OpenFiles("load clips for primary char", "cfclips", "*.cfclips")) {
+							try {
+								c->controller->addAnimationLibrary(path);
+							}
+							catch (const CrossForgeException& e) {
+								SLogger::logException(e);
+							}
+						}
+					}
 				}
 				ImGui::EndMenu();
 			}
@@ -403,6 +424,17 @@ void MotionRetargetScene::renderUI_menuBar() {
 					std::string path = UserDialog::SaveFile("store primary char", "objImport", "*.obj");
 					storeCharPrim(path,IOM_OBJIMP);
 				}
+				if (ImGui::MenuItem("Clip library", ".cfclips")) {
+					if (auto c = m_charEntityPrim.lock()) {
+						std::string path = UserDialog::SaveFile("store animations of primary char", "cfclips", "*.cfclips");
+						if (!path.empty()) {
+							std::vector<const T3DMesh<float>::SkeletalAnimation*> clips;
+							for (uint32_t i = 0; i < c->controller->animationCount(); ++i)
+								clips.push_back(c->controller->animation(i));
+							SkeletalClipLibrary::write(path,clips);
+						}
+					}
+				}
 				ImGui::EndMenu();
 			}
 
@@ -564,6 +596,8 @@ void MotionRetargetScene::renderUI_menuBar() {
 				m_showPop[POP_AR_RIGNET] = true;
 			if (ImGui::MenuItem("pinocchio"))
 				m_showPop[POP_AR_PINOC] = true;
+			if (ImGui::MenuItem("voxel binding"))
+				m_showPop[POP_AR_VOXEL] = true;
 			ImGui::EndMenu();
 		}
 
@@ -837,7 +871,7 @@ void MotionRetargetScene::renderUI_ik() {
 	if (m_selChainIdx != -1) {
 		auto js = chains[m_selChainIdx].joints;
 		for (uint32_t i = 0; i < js.size(); ++i) {
-			auto jp = c->controller->getJointPickable(js[i]).lock();
+			auto jp = c->getJointPickable(js[i]).lock();
 			jp->colorSelect = Vector4f(0.,1.,0.,1.);
 			jp->m_highlight = true;
 		}
@@ -845,7 +879,7 @@ void MotionRetargetScene::renderUI_ik() {
 	if (m_selChainIdxPrev != m_selChainIdx && m_selChainIdxPrev != -1) {
 		auto js = chains[m_selChainIdxPrev].joints;
 		for (uint32_t i = 0; i < js.size(); ++i) {
-			auto jp = c->controller->getJointPickable(js[i]).lock();
+			auto jp = c->getJointPickable(js[i]).lock();
 			jp->colorSelect = jp->colorSelect0;
 			jp->m_highlight = false;
 		}
@@ -879,7 +913,7 @@ void MotionRetargetScene::renderUI_ik() {
 
 				auto js = chains[m_selChainIdx].joints;
 				for (uint32_t i = 0; i < js.size(); ++i) {
-					auto jp = c->controller->getJointPickable(js[i]).lock();
+					auto jp = c->getJointPickable(js[i]).lock();
 					jp->colorSelect = jp->colorSelect0;
 					jp->m_highlight = false;
 				}
@@ -947,12 +981,12 @@ void MotionRetargetScene::renderUI_ikChainEditor(int* item_current_idx) {
 				// change color
 				if (clickedJoint) {
 					if (m_ikceRootJoint) {
-						auto jp = c->controller->getJointPickable(m_ikceRootJoint).lock();
+						auto jp = c->getJointPickable(m_ikceRootJoint).lock();
 						jp->restoreColor();
 						jp->m_highlight = false;
 					}
 					m_ikceRootJoint = clickedJoint;
-					auto jp = c->controller->getJointPickable(m_ikceRootJoint).lock();
+					auto jp = c->getJointPickable(m_ikceRootJoint).lock();
 					jp->colorSelect = Vector4f(1.,0.,0.,1.);
 					jp->m_highlight = true;
 				}
@@ -969,12 +1003,12 @@ void MotionRetargetScene::renderUI_ikChainEditor(int* item_current_idx) {
 				IKController::SkeletalJoint* clickedJoint = renderUI_OutlinerJoints(c,m_ikceEndEffJoint);
 				if (clickedJoint) {
 					if (m_ikceEndEffJoint) {
-						auto jp = c->controller->getJointPickable(m_ikceEndEffJoint).lock();
+						auto jp = c->getJointPickable(m_ikceEndEffJoint).lock();
 						jp->restoreColor();
 						jp->m_highlight = false;
 					}
 					m_ikceEndEffJoint = clickedJoint;
-					auto jp = c->controller->getJointPickable(m_ikceEndEffJoint).lock();
+					auto jp = c->getJointPickable(m_ikceEndEffJoint).lock();
 					jp->colorSelect = Vector4f(0.,0.,1.,1.);
 					jp->m_highlight = true;
 				}
@@ -1014,14 +1048,14 @@ void MotionRetargetScene::renderUI_ikChainEditor(int* item_current_idx) {
 		m_ikceName = "new"; m_ikceNameInit = false;
 		//TODO potential bug rootJoint still from other charEntity on swap
 		if (m_ikceRootJoint) {
-			auto jp = c->controller->getJointPickable(m_ikceRootJoint).lock();
+			auto jp = c->getJointPickable(m_ikceRootJoint).lock();
 			if (jp) {
 				jp->restoreColor();
 				jp->m_highlight = false;
 			}
 		}
 		if (m_ikceEndEffJoint) {
-			auto jp = c->controller->getJointPickable(m_ikceEndEffJoint).lock();
+			auto jp = c->getJointPickable(m_ikceEndEffJoint).lock();
 			if (jp) {
 				jp->restoreColor();
 				jp->m_highlight = false;
@@ -1065,17 +1099,17 @@ void MotionRetargetScene::renderUI_autorig() {
 				options = ARrignetOptions();
 			}
 			ImGui::Checkbox("parse last output only", &options.parseOutputOnly);
+			ImGui::Checkbox("use cache", &options.useCache);
 
 			if (ImGui::Button("Confirm")) {
 				
-				ARrignet arr;
-				arr.condaPath = m_settings.pathAnaconda;
-				arr.rignetPath = m_settings.pathRignet;
+				auto arr = std::make_shared<ARrignet>();
+				arr->condaPath = m_settings.pathAnaconda;
+				arr->rignetPath = m_settings.pathRignet;
 
 				if (auto e = m_charEntityPrim.lock()) {
-					arr.rig(&e->mesh,options);
+					m_rigTasks.push_back({ e, e->name + " rignet", std::make_unique<RigJob>(e->mesh, arr, options) });
 					options = ARrignetOptions(); // reset params
-					initCharacter(e);
 				}
 				
 				popState = false;
@@ -1092,12 +1126,32 @@ void MotionRetargetScene::renderUI_autorig() {
 		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
 
 		if (ImGui::Begin("autorig pinnocchio", &popState)) {
+			static ARpinocchioOptions opt;
+			ImGui::Checkbox("native weights",&opt.nativeWeights);
+			ImGui::InputFloat("heat weight",&opt.heatWeight);
+			ImGui::Checkbox("voxel weights",&opt.voxelWeights);
+			ImGui::InputInt("voxel resolution",&opt.voxelResolution);
+			ImGui::Checkbox("use cache",&opt.useCache);
+			static int proxyFaces = 0;
+			ImGui::InputInt("proxy faces (0 = full mesh)",&proxyFaces);
 			if (ImGui::Button("Confirm")) {
 				
-				ARpinocchio arp;
+				auto arp = std::make_shared<ARpinocchio>();
 				if (auto e = m_charEntityPrim.lock()) {
-					arp.rig(&e->mesh,ARpinocchioOptions());
-					initCharacter(e);
+					std::unique_ptr<RigJob> job;
+					if (proxyFaces > 0) {
+						auto arProxy = std::make_shared<ARproxy<ARpinocchioOptions>>(arp.get());
+						ARproxyOptions<ARpinocchioOptions> proxyOpt;
+						proxyOpt.rigger = opt;
+						proxyOpt.targetFaces = proxyFaces;
+						job = std::make_unique<RigJob>(e->mesh, [arp,arProxy,proxyOpt](T3DMesh<float>* pMesh, RigProgress* pProgress) {
+							arProxy->progress(pProgress);
+							arProxy->rig(pMesh,proxyOpt);
+						});
+					}
+					else
+						job = std::make_unique<RigJob>(e->mesh, arp, opt);
+					m_rigTasks.push_back({ e, e->name + " pinocchio", std::move(job) });
 				}
 				
 				popState = false;
@@ -1106,6 +1160,118 @@ void MotionRetargetScene::renderUI_autorig() {
 		}
 	}
 	m_showPop[POP_AR_PINOC] = popState;
+
+	popState = m_showPop[POP_AR_VOXEL];
+	if (popState) {
+		// Always center this window when appearing
+		ImVec2 center = ImGui::GetMainViewport()->GetCenter();
+		ImGui::SetNextWindowPos(center, ImGuiCond_Appearing, ImVec2(0.5f, 0.5f));
+
+		if (ImGui::Begin("voxel binding", &popState)) {
+			ImGui::Text("recomputes the skin weights of the current skeleton");
+			static ARvoxelBindOptions opt;
+			ImGui::InputInt("resolution",&opt.voxel.resolution);
+			ImGui::SliderFloat("falloff",&opt.voxel.falloff,0.f,1.f);
+			ImGui::InputInt("close holes (voxels)",&opt.voxel.closeRadius);
+			ImGui::InputInt("max influences",&opt.voxel.maxInfluences);
+			if (ImGui::Button("Confirm")) {
+				auto e = m_charEntityPrim.lock();
+				if (e && e->mesh.boneCount() > 0) {
+					auto arv = std::make_shared<ARvoxelBind>();
+					m_rigTasks.push_back({ e, e->name + " voxel binding", std::make_unique<RigJob>(e->mesh, arv, opt) });
+				}
+				popState = false;
+			}
+			ImGui::End();
+		}
+	}
+	m_showPop[POP_AR_VOXEL] = popState;
+}
+
+void MotionRetargetScene::renderUI_rigJobs() {
+	// apply finished rigs, the mesh is swapped in on the render thread
+	for (auto it = m_rigTasks.begin(); it != m_rigTasks.end();) {
+		RigJob::State state = it->job->state();
+		if (state == RigJob::STATE_RUNNING) {
+			++it;
+			continue;
+		}
+		if (state == RigJob::STATE_DONE) {
+			if (auto e = it->target.lock()) {
+				it->job->finish(&e->mesh);
+				initCharacter(e);
+			}
+		}
+		else if (state == RigJob::STATE_FAILED)
+			std::cerr << "autorig " << it->name << " failed: " << it->job->error() << std::endl;
+		it = m_rigTasks.erase(it);
+	}
+
+	if (m_rigTasks.empty())
+		return;
+
+	if (ImGui::Begin("autorig jobs")) {
+		for (uint32_t i = 0; i < m_rigTasks.size(); ++i) {
+			RigTask& t = m_rigTasks[i];
+			ImGui::PushID(i);
+			ImGui::Text("%s: %s", t.name.c_str(), t.job->stage());
+			ImGui::ProgressBar(t.job->progress(), ImVec2(200.f, 0.f));
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel"))
+				t.job->cancel();
+			ImGui::PopID();
+		}
+	}
+	ImGui::End();
+}
+
+void MotionRetargetScene::renderUI_loadJobs() {
+	// add finished imports, GL upload is the only part left for the render thread
+	// uploads are spread over frames so a large batch does not freeze the UI
+	const auto uploadStart = std::chrono::steady_clock::now();
+	const auto uploadBudget = std::chrono::milliseconds(12);
+	for (auto it = m_loadTasks.begin(); it != m_loadTasks.end();) {
+		JobQueue::State state = it->job->state();
+		if (state == JobQueue::STATE_QUEUED || state == JobQueue::STATE_RUNNING) {
+			++it;
+			continue;
+		}
+		if (state == JobQueue::STATE_DONE && !it->job->cancelled()) {
+			if (std::chrono::steady_clock::now() - uploadStart > uploadBudget) {
+				++it;
+				continue;
+			}
+			addCharEntity(it->entity);
+		}
+		else if (state == JobQueue::STATE_FAILED)
+			std::cerr << "import " << it->path << " failed: " << it->job->error() << std::endl;
+		it = m_loadTasks.erase(it);
+	}
+
+	if (m_loadTasks.empty())
+		return;
+
+	if (ImGui::Begin("import jobs")) {
+		uint32_t done = 0;
+		for (auto& t : m_loadTasks)
+			done += (t.job->state() == JobQueue::STATE_DONE);
+		ImGui::Text("%d files, %d ready", int(m_loadTasks.size()), int(done));
+		if (ImGui::Button("Cancel all")) {
+			for (auto& t : m_loadTasks)
+				t.job->cancel();
+		}
+		for (uint32_t i = 0; i < m_loadTasks.size(); ++i) {
+			LoadTask& t = m_loadTasks[i];
+			ImGui::PushID(i);
+			ImGui::Text("%s: %s", t.entity->name.c_str(), t.job->stage());
+			ImGui::ProgressBar(t.job->progress(), ImVec2(200.f, 0.f));
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel"))
+				t.job->cancel();
+			ImGui::PopID();
+		}
+	}
+	ImGui::End();
 }
 
 void MotionRetargetScene::renderUI_autoMoRe() {
@@ -1189,7 +1355,7 @@ void MotionRetargetScene::renderUI_autoMoRe() {
 					//	mrLimb.initialize(cs->controller.get(),ct->controller.get());
 					
 					//m_MRlimb.initialize();
-					m_MRlimb.initialize(cs,ct,corr);
+					m_MRlimb.initialize(cs->controller,ct->controller,corr,MRMutil::buildTransformation(ct->sgn));
 				}
 				corr.clear();
 				popState = false;
@@ -0,0 +1,16 @@
+// GL free subset of the sandbox pch.h, used by the MotionRetargetCore library
+// std
+#include <vector>
+#include <string>
+#include <memory>
+#include <map>
+
+// eigen
+#ifndef NDEBUG
+#define EIGEN_NO_DEBUG
+#define EIGEN_NO_STATIC_ASSERT
+#endif
+#include <Eigen/Eigen>
+
+#define JSON_DIAGNOSTICS 1
+#include <nlohmann/json.hpp>
@@ -65,6 +65,7 @@ namespace CForge {
 			SAssetIO::load("MyAssets/TexturedGround.fbx", &M);
 			setMeshShader(&M, 0.8f, 0.04f);
 			for (uint8_t i = 0; i < 4; ++i) M.textureCoordinate(i) *= 15.0f;
+			M.geometryChanged();
 			M.getMaterial(0)->TexAlbedo = "MyAssets/ground14.jpg";
 			M.getMaterial(0)->TexNormal = "MyAssets/ground14n.jpg";
 			M.computePerVertexNormals();
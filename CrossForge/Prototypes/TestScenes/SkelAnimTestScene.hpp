@@ -115,6 +115,7 @@ namespace CForge {
 
 				}//for[faces of submesh]
 			}//for[submeshes]
+			pMesh->topologyChanged();
 
 			// replace vertex weights
 			for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
@@ -0,0 +1,166 @@
+#include <crossforge/AssetIO/BVHIO.h>
+#include <crossforge/Math/CForgeMath.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+using namespace CForge;
+using namespace Eigen;
+
+static int failed = 0;
+
+#define CHECK(x) \
+	if (!(x)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #x); \
+		failed++; \
+	}
+
+static const std::string TestFile = "BVHIOTest.bvh";
+
+/**
+ * @brief root with 6 channels and two child joints with End Sites. Frame k moves the root to (k, 2k, 0),
+ *        rotates the root by 10k degrees about z, the spine by 5k degrees about x and the leg by k degrees about y.
+ *        Announces AnnouncedFrames but holds Frames lines, the last one without line break.
+*/
+static void writeFile(const std::string Path, int32_t Frames, int32_t AnnouncedFrames) {
+	std::ofstream F(Path, std::ios::binary);
+	F << "HIERARCHY\n"
+		"ROOT Hips\n{\n\tOFFSET 0 0 0\n\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n"
+		"\tJOINT Spine\n\t{\n\t\tOFFSET 0 10 0\n\t\tCHANNELS 3 Zrotation Xrotation Yrotation\n"
+		"\t\tEnd Site\n\t\t{\n\t\t\tOFFSET 0 5 0\n\t\t}\n\t}\n"
+		"\tJOINT Leg\n\t{\n\t\tOFFSET 3 -2 0\n\t\tCHANNELS 3 Zrotation Xrotation Yrotation\n"
+		"\t\tEnd Site\n\t\t{\n\t\t\tOFFSET 0 -8 0\n\t\t}\n\t}\n}\n"
+		"MOTION\nFrames: " << AnnouncedFrames << "\nFrame Time: 0.1\n";
+	for (int32_t k = 0; k < Frames; ++k) {
+		if (k > 0) F << "\r\n";
+		F << k << " " << 2 * k << " 0 " << 10 * k << " 0 0  0 " << 5 * k << " 0  0 0 " << k;
+	}
+}//writeFile
+
+static bool near(const Quaternionf& a, const Quaternionf& b) {
+	return std::abs(a.dot(b)) > 1.0f - 1e-5f;
+}//near
+
+static Quaternionf rotation(float Degrees, const Vector3f& Axis) {
+	return Quaternionf(AngleAxisf(CForgeMath::degToRad(Degrees), Axis));
+}//rotation
+
+static const T3DMesh<float>::BoneKeyframes* keyframes(const T3DMesh<float>& M, const std::string Name) {
+	for (auto* pK : M.getSkeletalAnimation(0)->Keyframes) {
+		if (pK->BoneName == Name) return pK;
+	}
+	return nullptr;
+}//keyframes
+
+static void skeletonAndFrames() {
+	writeFile(TestFile, 10, 10);
+	T3DMesh<float> M;
+	BVHIO::read(TestFile, &M, BVHIO::Selection());
+
+	CHECK(M.boneCount() == 3);
+	CHECK(M.getBone(0)->Name == "Hips" && M.getBone(0)->pParent == nullptr);
+	CHECK(M.getBone(1)->Name == "Spine" && M.getBone(1)->pParent == M.getBone(0));
+	CHECK(M.getBone(2)->Name == "Leg" && M.getBone(2)->pParent == M.getBone(0));
+	CHECK(M.getBone(1)->InvBindPoseMatrix.col(3).head<3>().isApprox(Vector3f(0, -10, 0)));
+	CHECK(M.getBone(2)->InvBindPoseMatrix.col(3).head<3>().isApprox(Vector3f(-3, 2, 0)));
+
+	CHECK(M.skeletalAnimationCount() == 1);
+	const T3DMesh<float>::SkeletalAnimation* pAnim = M.getSkeletalAnimation(0);
+	CHECK(pAnim->Keyframes.size() == 3);
+	CHECK(std::abs(pAnim->SamplesPerSecond - 10.0f) < 1e-4f);
+	CHECK(pAnim->Duration == 9.0f);
+
+	const T3DMesh<float>::BoneKeyframes* pHips = keyframes(M, "Hips");
+	const T3DMesh<float>::BoneKeyframes* pSpine = keyframes(M, "Spine");
+	const T3DMesh<float>::BoneKeyframes* pLeg = keyframes(M, "Leg");
+	CHECK(pHips && pSpine && pLeg);
+	if (!pHips || !pSpine || !pLeg) return;
+	CHECK(pHips->BoneID == 0 && pSpine->BoneID == 1 && pLeg->BoneID == 2);
+	CHECK(pHips->Positions.size() == 10 && pHips->Timestamps[9] == 9.0f);
+	CHECK(pHips->Positions[4].isApprox(Vector3f(4, 8, 0)));
+	CHECK(near(pHips->Rotations[3], rotation(30.0f, Vector3f::UnitZ())));
+	CHECK(pSpine->Positions[4].isApprox(Vector3f(0, 10, 0)));
+	CHECK(near(pSpine->Rotations[4], rotation(20.0f, Vector3f::UnitX())));
+	CHECK(pLeg->Positions[7].isApprox(Vector3f(3, -2, 0)));
+	CHECK(near(pLeg->Rotations[7], rotation(7.0f, Vector3f::UnitY())));
+}//skeletonAndFrames
+
+static void timeRange() {
+	writeFile(TestFile, 10, 10);
+	T3DMesh<float> M;
+	BVHIO::Selection Sel;
+	Sel.Begin = 0.25f; // first frame at or after 0.25 s is frame 3
+	Sel.End = 0.6f;    // last frame at or before 0.6 s is frame 6
+	BVHIO::read(TestFile, &M, Sel);
+
+	const T3DMesh<float>::BoneKeyframes* pHips = keyframes(M, "Hips");
+	CHECK(pHips && pHips->Positions.size() == 4);
+	if (!pHips) return;
+	CHECK(pHips->Positions[0].isApprox(Vector3f(3, 6, 0)));
+	CHECK(pHips->Positions[3].isApprox(Vector3f(6, 12, 0)));
+	CHECK(pHips->Timestamps[0] == 0.0f);
+	CHECK(M.getSkeletalAnimation(0)->Duration == 3.0f);
+
+	// range past the end holds no frames, files announcing more frames than they hold are cut
+	Sel.Begin = 5.0f;
+	Sel.End = -1.0f;
+	BVHIO::read(TestFile, &M, Sel);
+	CHECK(keyframes(M, "Hips")->Positions.empty());
+	writeFile(TestFile, 6, 10);
+	BVHIO::read(TestFile, &M, BVHIO::Selection());
+	CHECK(keyframes(M, "Hips")->Positions.size() == 6);
+	CHECK(keyframes(M, "Hips")->Positions[5].isApprox(Vector3f(5, 10, 0)));
+}//timeRange
+
+static void jointSubset() {
+	writeFile(TestFile, 10, 10);
+	T3DMesh<float> M;
+	BVHIO::Selection Sel;
+	Sel.Joints.push_back("Spine");
+	BVHIO::read(TestFile, &M, Sel);
+
+	CHECK(M.boneCount() == 3);
+	const T3DMesh<float>::SkeletalAnimation* pAnim = M.getSkeletalAnimation(0);
+	CHECK(pAnim->Keyframes.size() == 1);
+	const T3DMesh<float>::BoneKeyframes* pSpine = keyframes(M, "Spine");
+	CHECK(pSpine && pSpine->BoneID == 1 && pSpine->Rotations.size() == 10);
+	if (!pSpine) return;
+	CHECK(near(pSpine->Rotations[6], rotation(30.0f, Vector3f::UnitX())));
+}//jointSubset
+
+static void malformed() {
+	{
+		std::ofstream F(TestFile, std::ios::binary);
+		F << "HIERARCHY\nROOT Hips\n{\n\tOFFSET 0 0 0\n\tCHANNELS 1 Xposition\n}\nMOTION\nFrames: 2\nFrame Time: 0.1\n1\nx\n";
+	}
+	T3DMesh<float> M;
+	bool Thrown = false;
+	try {
+		BVHIO::read(TestFile, &M, BVHIO::Selection());
+	}
+	catch (const CrossForgeException&) {
+		Thrown = true;
+	}
+	CHECK(Thrown);
+}//malformed
+
+/**
+ * @brief Checks the BVH parser on a small generated file: skeleton, keyframe values, time range and joint
+ *        selection. Returns the number of failed checks.
+*/
+int main() {
+	try {
+		skeletonAndFrames();
+		timeRange();
+		jointSubset();
+		malformed();
+	}
+	catch (const CrossForgeException& e) {
+		printf("Exception occurred: %s\n", e.msg().c_str());
+		failed++;
+	}
+	std::remove(TestFile.c_str());
+	if (failed == 0) printf("All checks passed\n");
+	return failed;
+}//main
@@ -0,0 +1,190 @@
+#include <Prototypes/MotionRetarget/Animation/MotionDatabase.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+using namespace CForge;
+using namespace Eigen;
+
+static int failed = 0;
+
+#define CHECK(x) \
+	if (!(x)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #x); \
+		failed++; \
+	}
+
+/**
+ * @brief biped of 12 joints, root with spine, two arms and two legs, 5 leaf joints become the effectors
+*/
+static void buildSkeleton(T3DMesh<float>* pMesh) {
+	std::vector<T3DMesh<float>::Bone*> bones;
+	std::vector<Matrix4f> global;
+	auto addBone = [&](std::string name, int32_t parent, Vector3f offset) {
+		T3DMesh<float>::Bone* pB = new T3DMesh<float>::Bone();
+		pB->ID = bones.size();
+		pB->Name = name;
+		pB->pParent = (parent < 0) ? nullptr : bones[parent];
+		Matrix4f g = Matrix4f::Identity();
+		g.block<3,1>(0,3) = offset;
+		if (pB->pParent) {
+			g = global[parent] * g;
+			pB->pParent->Children.push_back(pB);
+		}
+		pB->InvBindPoseMatrix = g.inverse();
+		bones.push_back(pB);
+		global.push_back(g);
+		return pB->ID;
+	};
+
+	const int32_t root = addBone("hips", -1, Vector3f(0.f, 1.f, 0.f));
+	const int32_t spine = addBone("spine", root, Vector3f(0.f, 0.3f, 0.f));
+	addBone("head", addBone("neck", spine, Vector3f(0.f, 0.3f, 0.f)), Vector3f(0.f, 0.2f, 0.f));
+	for (float side : { -1.f, 1.f }) {
+		const std::string s = (side < 0.f) ? "l" : "r";
+		addBone(s + "Hand", addBone(s + "Arm", spine, Vector3f(side * 0.2f, 0.25f, 0.f)), Vector3f(side * 0.5f, 0.f, 0.f));
+		addBone(s + "Foot", addBone(s + "Leg", root, Vector3f(side * 0.1f, -0.05f, 0.f)), Vector3f(0.f, -0.9f, 0.f));
+	}
+
+	pMesh->bones(&bones, true);
+	for (auto* pB : bones)
+		delete pB;
+}//buildSkeleton
+
+/**
+ * @brief walk of Frames frames at 30 fps, joints swing with incommensurate frequencies so poses do not repeat
+*/
+static void addAnimation(T3DMesh<float>* pMesh, int32_t Frames, uint32_t Seed) {
+	std::mt19937 rng(Seed);
+	std::uniform_real_distribution<float> u(0.f, 1.f);
+
+	T3DMesh<float>::SkeletalAnimation* pAnim = new T3DMesh<float>::SkeletalAnimation();
+	pAnim->Name = "walk";
+	pAnim->SamplesPerSecond = 30.f;
+	pAnim->Duration = float(Frames - 1);
+
+	Vector3f rootPos = Vector3f(0.f, 1.f, 0.f);
+	float heading = 0.f;
+	for (uint32_t j = 0; j < pMesh->boneCount(); ++j) {
+		const T3DMesh<float>::Bone* pBone = pMesh->getBone(j);
+		T3DMesh<float>::BoneKeyframes* pK = new T3DMesh<float>::BoneKeyframes();
+		pK->ID = j;
+		pK->BoneID = j;
+		pK->BoneName = pBone->Name;
+		const Vector3f rest = (pBone->pParent) ? Vector3f((pBone->pParent->InvBindPoseMatrix * pBone->InvBindPoseMatrix.inverse()).block<3,1>(0,3)) : rootPos;
+		const Vector3f axis = Vector3f(u(rng) - 0.5f, u(rng) - 0.5f, u(rng) - 0.5f).normalized();
+		const float freq = 1.f + 3.f * u(rng);
+		const float phase = 6.283f * u(rng);
+		pK->Positions.resize(Frames, rest);
+		pK->Rotations.resize(Frames);
+		pK->Scalings.resize(Frames, Vector3f::Ones());
+		pK->Timestamps.resize(Frames);
+		for (int32_t k = 0; k < Frames; ++k) {
+			const float t = k / 30.f;
+			pK->Timestamps[k] = float(k);
+			pK->Rotations[k] = Quaternionf(AngleAxisf(0.6f * std::sin(freq * t + phase) * std::sin(0.07f * freq * t), axis));
+		}
+		if (pBone->pParent == nullptr) {
+			// root walks along a heading that drifts slowly
+			for (int32_t k = 0; k < Frames; ++k) {
+				const float t = k / 30.f;
+				heading += (0.5f * std::sin(0.13f * t) + 0.3f * std::sin(0.031f * t)) / 30.f;
+				rootPos += Vector3f(std::sin(heading), 0.f, std::cos(heading)) * (1.2f + 0.8f * std::sin(0.05f * t)) / 30.f;
+				pK->Positions[k] = rootPos;
+				pK->Rotations[k] = Quaternionf(AngleAxisf(heading, Vector3f::UnitY())) * pK->Rotations[k];
+			}
+		}
+		pAnim->Keyframes.push_back(pK);
+	}
+	pMesh->addSkeletalAnimation(pAnim, false);
+}//addAnimation
+
+static VectorXf perturbed(const VectorXf& v, std::mt19937& rng) {
+	std::normal_distribution<float> n(0.f, 0.05f);
+	VectorXf ret = v;
+	for (int32_t d = 0; d < ret.size(); ++d)
+		ret[d] += n(rng);
+	return ret;
+}//perturbed
+
+/**
+ * @brief KD-tree results have to equal a full ranking of all rows, which the tree yields for k = rowCount().
+*/
+static void queryMatchesFullRanking() {
+	T3DMesh<float> mesh;
+	buildSkeleton(&mesh);
+	addAnimation(&mesh, 2000, 1);
+	SkeletalPoseController ctrl;
+	ctrl.init(&mesh);
+
+	MotionDatabase db;
+	db.build(&ctrl, MotionDatabase::Config());
+	CHECK(db.rowCount() == 2000);
+	CHECK(db.dimension() == 5 * 6 + 3 * 4);
+
+	std::mt19937 rng(2);
+	for (int32_t i = 0; i < 20; ++i) {
+		const int32_t row = int32_t(rng() % db.rowCount());
+		const VectorXf q = perturbed(db.rawFeature(row), rng);
+		const std::vector<MotionDatabase::Match> all = db.query(q, db.rowCount());
+		const std::vector<MotionDatabase::Match> best = db.query(q, 5);
+		CHECK(int32_t(all.size()) == db.rowCount());
+		CHECK(best.size() == 5);
+		for (size_t m = 0; m < best.size(); ++m)
+			CHECK(best[m].distance == all[m].distance);
+
+		// exact row feature finds itself, excluded frames are skipped
+		const MotionDatabase::Match self = db.query(db.rawFeature(row), 1)[0];
+		CHECK(self.distance < 1e-6f);
+		const MotionDatabase::Match other = db.query(db.rawFeature(row), 1, 0, self.frame, 10)[0];
+		CHECK(std::abs(other.frame - self.frame) > 10);
+	}
+}//queryMatchesFullRanking
+
+/**
+ * @brief median query time over 100k frames, the target is below 1 ms in optimized builds
+*/
+static void queryTime() {
+	T3DMesh<float> mesh;
+	buildSkeleton(&mesh);
+	addAnimation(&mesh, 100000, 3);
+	SkeletalPoseController ctrl;
+	ctrl.init(&mesh);
+
+	MotionDatabase db;
+	db.build(&ctrl, MotionDatabase::Config());
+	CHECK(db.rowCount() == 100000);
+
+	std::mt19937 rng(4);
+	std::vector<double> ms;
+	for (int32_t i = 0; i < 1000; ++i) {
+		const int32_t row = int32_t(rng() % db.rowCount());
+		const VectorXf q = perturbed(db.rawFeature(row), rng);
+		const auto t0 = std::chrono::steady_clock::now();
+		const std::vector<MotionDatabase::Match> best = db.query(q, 1, 0, row, 10);
+		const auto t1 = std::chrono::steady_clock::now();
+		ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+		CHECK(best.size() == 1);
+	}
+	std::sort(ms.begin(), ms.end());
+	const double p50 = ms[ms.size() / 2];
+	const double p99 = ms[ms.size() * 99 / 100];
+	printf("query over %d frames: p50 %.3f ms p99 %.3f ms\n", db.rowCount(), p50, p99);
+#ifdef NDEBUG
+	CHECK(p50 < 1.0);
+#endif
+}//queryTime
+
+/**
+ * @brief Checks MotionDatabase nearest pose queries against a full ranking and times them on a synthetic
+ *        walk of 100k frames. Returns the number of failed checks.
+*/
+int main() {
+	queryMatchesFullRanking();
+	queryTime();
+	if (failed == 0) printf("All checks passed\n");
+	return failed;
+}//main
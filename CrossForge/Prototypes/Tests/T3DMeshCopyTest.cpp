@@ -0,0 +1,98 @@
+#include <crossforge/AssetIO/T3DMesh.hpp>
+
+#include <cstdio>
+
+using namespace CForge;
+
+static int failed = 0;
+
+#define CHECK(x) \
+	if (!(x)) { \
+		printf("FAILED line %d: %s\n", __LINE__, #x); \
+		failed++; \
+	}
+
+static void buildQuad(T3DMesh<float>* pMesh) {
+	std::vector<Eigen::Vector3f> positions = { {0,0,0},{1,0,0},{1,1,0},{0,1,0} };
+	pMesh->vertices(&positions);
+	T3DMesh<float>::Submesh sub;
+	T3DMesh<float>::Face f;
+	f.Vertices[0] = 0; f.Vertices[1] = 1; f.Vertices[2] = 2;
+	sub.Faces.push_back(f);
+	f.Vertices[0] = 0; f.Vertices[1] = 2; f.Vertices[2] = 3;
+	sub.Faces.push_back(f);
+	pMesh->addSubmesh(&sub, true);
+}
+
+static void vectorCopies() {
+	TSharedVector<int> a = std::vector<int>{ 1,2,3 };
+	TSharedVector<int> b = a;
+	CHECK(a.shared() && !a.unshareable());
+
+	// reference taken while shared clones a first
+	int& r = a[0];
+	CHECK(!a.shared() && b[0] == 1);
+
+	// copy taken while a reference is held does not share
+	TSharedVector<int> c = a;
+	CHECK(!a.shared() && !c.shared());
+	r = 7;
+	CHECK(a[0] == 7 && c[0] == 1);
+
+	// assigning new elements makes the buffer shareable again
+	a = std::vector<int>{ 4,5 };
+	CHECK(!a.unshareable());
+	TSharedVector<int> d = a;
+	CHECK(a.shared() && d.read().data() == a.read().data());
+
+	// moved handles keep the state of their buffer
+	int* p = c.data();
+	TSharedVector<int> e = std::move(c);
+	TSharedVector<int> g = e;
+	*p = 9;
+	CHECK(e[0] == 9 && g[0] == 1);
+}//vectorCopies
+
+static void meshCopies() {
+	T3DMesh<float> a;
+	buildQuad(&a);
+
+	// vertex reference held across a copy
+	Eigen::Vector3f& v = a.vertex(0);
+	T3DMesh<float> b(a);
+	v = Eigen::Vector3f(5, 5, 5);
+	a.geometryChanged();
+	CHECK(a.vertex(0) == Eigen::Vector3f(5, 5, 5));
+	CHECK(((const T3DMesh<float>&)b).vertex(0) == Eigen::Vector3f::Zero());
+
+	// submesh pointer and face reference held across a copy
+	T3DMesh<float>::Submesh* pSub = a.getSubmesh(0);
+	T3DMesh<float>::Face& face = pSub->Faces[1];
+	T3DMesh<float> c;
+	c.init(&a);
+	face.Vertices[2] = 1;
+	pSub->Faces[0].Vertices[0] = 3;
+	a.topologyChanged();
+	const T3DMesh<float>::Submesh* pCopy = ((const T3DMesh<float>&)c).getSubmesh(0);
+	CHECK(pCopy->Faces[1].Vertices[2] == 3 && pCopy->Faces[0].Vertices[0] == 0);
+	CHECK(pSub->Faces[1].Vertices[2] == 1 && pSub->Faces[0].Vertices[0] == 3);
+
+	// copies of data only read through const access still share
+	T3DMesh<float> d;
+	buildQuad(&d);
+	T3DMesh<float> e(d);
+	const T3DMesh<float>& cd = d;
+	CHECK(cd.getSubmesh(0)->Faces.read().data() == ((const T3DMesh<float>&)e).getSubmesh(0)->Faces.read().data());
+}//meshCopies
+
+/**
+ * @brief Checks that copies of a T3DMesh stay independent of references into the original,
+ *        which may be taken before or after the copy and are written after it.
+ *        Returns the number of failed checks.
+*/
+int main() {
+	vectorCopies();
+	meshCopies();
+	if (failed == 0) printf("All checks passed\n");
+	return failed;
+}//main
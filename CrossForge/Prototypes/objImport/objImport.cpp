@@ -1,60 +1,208 @@
 #include "objImport.h"
 #include <crossforge/AssetIO/SAssetIO.h>
+#include <crossforge/AssetIO/File.h>
+#include <crossforge/Core/Parallel.hpp>
+#include <charconv>
+#include <cstring>
 #include <iostream>
 
 
 namespace CForge{
 	
-	// this is just for reading a smplx file - it has just vertices and indices and comments
-	// texture are not completely supported
+	namespace {
+		using Face = T3DMesh<float>::Face;
 
-	void objImportExport::readObjFile(std::string fileName, std::vector<Eigen::Vector3f> &vertices, std::vector<T3DMesh<float>::Face> &indices, std::vector<Eigen::Matrix<float, 3, 1>>& uvs){
-		// read a file
-		std::ifstream file(fileName);
-		
-		std::string line;
-		
+		// parse chunks start at line boundaries, small files are parsed in one piece
+		const size_t ParseChunkSize = 1 << 20;
 
-		// https://github.com/nSkade/einherjarEngine/blob/develop/src/Mesh.cpp
-		// https://en.cppreference.com/w/cpp/io/basic_stringstream
-		
-		if(file.good()){
-			while(std::getline(file, line)){
-				std::stringstream ss(line);
-				std::string type;
-				ss >> type;
-				if (type == "#") continue; // comment
-				else if(type == "v"){
-					Eigen::Vector3f vertex;
-					ss >> vertex[0] >> vertex[1] >> vertex[2];
-					vertices.push_back(vertex);
-					
+		// export is formatted in blocks of lines, one block per thread and round
+		const size_t LinesPerBlock = 1 << 13;
+		const size_t MaxLineLength = 96;
+
+		struct ObjChunk {
+			std::vector<Eigen::Vector3f> Vertices;
+			std::vector<Eigen::Vector3f> UVs;
+			std::vector<Face> Faces;
+			std::vector<size_t> RelativeCorners; // face corners given as negative index, relative to the chunk's first vertex
+		};
+
+		bool isBlank(const char c) {
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		const char* skipBlanks(const char* p, const char* pEnd) {
+			while (p < pEnd && isBlank(*p)) p++;
+			return p;
+		}
+
+		const char* skipToken(const char* p, const char* pEnd) {
+			while (p < pEnd && !isBlank(*p)) p++;
+			return p;
+		}
+
+		const char* parseFloat(const char* p, const char* pEnd, float* pValue) {
+			p = skipBlanks(p, pEnd);
+			if (p < pEnd && *p == '+') p++;
+			auto Res = std::from_chars(p, pEnd, *pValue);
+			if (Res.ec != std::errc()) {
+				*pValue = 0.0f;
+				return skipToken(p, pEnd);
+			}
+			return Res.ptr;
+		}
+
+		void parseChunk(const char* p, const char* pEnd, ObjChunk* pChunk) {
+			std::vector<std::pair<int32_t, bool>> Corners; // vertex index, relative to chunk
+
+			while (p < pEnd) {
+				const char* pLineEnd = (const char*)std::memchr(p, '\n', pEnd - p);
+				if (nullptr == pLineEnd) pLineEnd = pEnd;
+				p = skipBlanks(p, pLineEnd);
+
+				if (pLineEnd - p > 1 && p[0] == 'v' && isBlank(p[1])) {
+					Eigen::Vector3f V;
+					p += 2;
+					for (int i = 0; i < 3; ++i) p = parseFloat(p, pLineEnd, &V[i]);
+					pChunk->Vertices.push_back(V);
 				}
-				else if(type == "vt"){
+				else if (pLineEnd - p > 2 && p[0] == 'v' && p[1] == 't' && isBlank(p[2])) {
 					// vertex textur, normally has x and y coordinate
-					float x, y; 
-					ss >> x , y; 
-					uvs.push_back(Eigen::Vector3f(x, y, 0.0f)); 
+					Eigen::Vector3f UV = Eigen::Vector3f::Zero();
+					p += 3;
+					for (int i = 0; i < 2; ++i) p = parseFloat(p, pLineEnd, &UV[i]);
+					pChunk->UVs.push_back(UV);
 				}
-				else if(type == "f"){
-					T3DMesh<float>::Face face;
-					ss >> face.Vertices[0] >> face.Vertices[1] >> face.Vertices[2];
-					// obj files are 1-indexed so we need to subtract 1
-					face.Vertices[0] -= 1;
-					face.Vertices[1] -= 1;
-					face.Vertices[2] -= 1;
-					indices.push_back(face);
+				else if (pLineEnd - p > 1 && p[0] == 'f' && isBlank(p[1])) {
+					Corners.clear();
+					p = skipBlanks(p + 2, pLineEnd);
+					while (p < pLineEnd) {
+						// only the vertex index of v/vt/vn is used
+						int32_t Index = 0;
+						auto Res = std::from_chars(p, pLineEnd, Index);
+						if (Res.ec != std::errc() || Index == 0) throw CForgeExcept("Invalid face index in obj file");
+						// obj files are 1-indexed, negative indexes count back from the last vertex
+						if (Index > 0) Corners.push_back(std::make_pair(Index - 1, false));
+						else Corners.push_back(std::make_pair(int32_t(pChunk->Vertices.size()) + Index, true));
+						p = skipBlanks(skipToken(Res.ptr, pLineEnd), pLineEnd);
+					}
+
+					// polygons are split into a triangle fan
+					for (size_t i = 2; i < Corners.size(); ++i) {
+						const std::pair<int32_t, bool> Tri[3] = { Corners[0], Corners[i - 1], Corners[i] };
+						Face F;
+						for (int k = 0; k < 3; ++k) {
+							F.Vertices[k] = Tri[k].first;
+							if (Tri[k].second) pChunk->RelativeCorners.push_back(pChunk->Faces.size() * 3 + k);
+						}
+						pChunk->Faces.push_back(F);
+					}
 				}
-				else{
-					// not recognized line
-					continue;
+				// comments and not recognized lines are skipped
+
+				p = pLineEnd + 1;
+			}
+		}//parseChunk
+
+		char* writeFloat(char* p, const float Value) {
+			// shortest representation that reads back to the same float
+			return std::to_chars(p, p + 32, Value).ptr;
+		}
+
+		char* writeIndex(char* p, const int32_t Value) {
+			return std::to_chars(p, p + 16, Value).ptr;
+		}
+
+		/**
+		* \brief Formats lines in parallel into fixed blocks and writes them in order. Blocks are allocated on first use and reused.
+		*/
+		class LineWriter {
+		public:
+			LineWriter(std::ostream* pOut) : m_pOut(pOut) {
+
+			}
+
+			// Line(i, p) writes line i to p and returns the end, at most MaxLineLength characters
+			template<typename Func>
+			void write(const size_t Count, Func Line) {
+				const size_t Blocks = parallelRangeCount(Count, LinesPerBlock);
+				while (m_Blocks.size() < Blocks) {
+					m_Blocks.emplace_back(LinesPerBlock * MaxLineLength);
+					m_Lengths.push_back(0);
+				}
+				for (size_t Begin = 0; Begin < Count; Begin += Blocks * LinesPerBlock) {
+					const size_t BlockCount = std::min(Blocks, (Count - Begin + LinesPerBlock - 1) / LinesPerBlock);
+					parallelForEach(BlockCount, [&](size_t b) {
+						const size_t First = Begin + b * LinesPerBlock;
+						const size_t Last = std::min(Count, First + LinesPerBlock);
+						char* p = m_Blocks[b].data();
+						for (size_t i = First; i < Last; ++i) p = Line(i, p);
+						m_Lengths[b] = p - m_Blocks[b].data();
+					});
+					for (size_t b = 0; b < BlockCount; ++b) m_pOut->write(m_Blocks[b].data(), m_Lengths[b]);
 				}
 			}
+
+		private:
+			std::ostream* m_pOut;
+			std::vector<std::vector<char>> m_Blocks;
+			std::vector<size_t> m_Lengths;
+		};//LineWriter
+
+	}//anonymous
+
+	// this is just for reading a smplx file - it has just vertices and indices and comments
+	// texture are not completely supported
+
+	void objImportExport::readObjFile(std::string fileName, std::vector<Eigen::Vector3f> &vertices, std::vector<T3DMesh<float>::Face> &indices, std::vector<Eigen::Matrix<float, 3, 1>>& uvs){
+		// the file is mapped and parsed in chunks of whole lines, chunks are stitched together in file order
+		MappedFile MF;
+		if (!MF.open(fileName)) {
+			if (!File::exists(fileName)) throw CForgeExcept("File not found");
+			return; // empty file
 		}
-		else{
-			throw CForgeExcept("File not found");
+
+		const char* pBegin = (const char*)MF.data();
+		const char* pEnd = pBegin + MF.size();
+
+		std::vector<const char*> Starts;
+		Starts.push_back(pBegin);
+		while (pEnd - Starts.back() > ParseChunkSize) {
+			const char* pSplit = Starts.back() + ParseChunkSize;
+			pSplit = (const char*)std::memchr(pSplit, '\n', pEnd - pSplit);
+			if (nullptr == pSplit) break;
+			Starts.push_back(pSplit + 1);
+		}
+		Starts.push_back(pEnd);
+
+		std::vector<ObjChunk> Chunks(Starts.size() - 1);
+		parallelForEach(Chunks.size(), [&](size_t i) {
+			parseChunk(Starts[i], Starts[i + 1], &Chunks[i]);
+		});
+
+		size_t VertexCount = vertices.size();
+		size_t UVCount = uvs.size();
+		size_t FaceCount = indices.size();
+		std::vector<size_t> FirstVertex(Chunks.size()), FirstUV(Chunks.size()), FirstFace(Chunks.size());
+		for (size_t i = 0; i < Chunks.size(); ++i) {
+			FirstVertex[i] = VertexCount;
+			FirstUV[i] = UVCount;
+			FirstFace[i] = FaceCount;
+			VertexCount += Chunks[i].Vertices.size();
+			UVCount += Chunks[i].UVs.size();
+			FaceCount += Chunks[i].Faces.size();
 		}
+		vertices.resize(VertexCount);
+		uvs.resize(UVCount);
+		indices.resize(FaceCount);
 
+		parallelForEach(Chunks.size(), [&](size_t i) {
+			ObjChunk& C = Chunks[i];
+			for (size_t k : C.RelativeCorners) C.Faces[k / 3].Vertices[k % 3] += int32_t(FirstVertex[i]);
+			std::copy(C.Vertices.begin(), C.Vertices.end(), vertices.begin() + FirstVertex[i]);
+			std::copy(C.UVs.begin(), C.UVs.end(), uvs.begin() + FirstUV[i]);
+			std::copy(C.Faces.begin(), C.Faces.end(), indices.begin() + FirstFace[i]);
+			C = ObjChunk();
+		});
 	}// readObjFile
 
 
@@ -65,15 +213,15 @@ namespace CForge{
 		objImportExport::readObjFile(fileName, vertices, indices, uvs);
 		mesh->init(); 
 
-		mesh->vertices(&vertices);
-		mesh->textureCoordinates(&uvs);  
+		mesh->vertices(std::move(vertices));
+		mesh->textureCoordinates(std::move(uvs));  
 		int materialID = 0; 
 		
-		// create submesh
-		T3DMesh<float>::Submesh submesh;
-		submesh.Material = materialID;
-		submesh.Faces = indices;
-		mesh->addSubmesh(&submesh, true);
+		// create submesh, the mesh takes ownership
+		T3DMesh<float>::Submesh* submesh = new T3DMesh<float>::Submesh();
+		submesh->Material = materialID;
+		submesh->Faces = std::move(indices);
+		mesh->addSubmesh(submesh, false);
 
 		// create material
 		T3DMesh<float>::Material material; 
@@ -86,20 +234,20 @@ namespace CForge{
 		// export the mesh to an obj file
 
 		// first check whether the mesh has vertices
-		if(mesh->vertexCount() == 0 || mesh == nullptr) return; 
+		if(mesh == nullptr || mesh->vertexCount() == 0) return; 
 
 		// second check whether the filename ends with .obj
 		std::string extension = ".obj";
-		if(fileName.rfind(extension) != fileName.size() - extension.size()){
-			std::cout<<"File name does not end with \".ob\"!"<<std::endl;
+		if(fileName.size() < extension.size() || fileName.compare(fileName.size() - extension.size(), extension.size(), extension) != 0){
+			std::cout<<"File name does not end with \".obj\"!"<<std::endl;
 			return; 
 		}
 
-		std::ofstream file(fileName, std::ostream::out | std::ostream::trunc);
-		std::string ret; 
+		std::ofstream file(fileName, std::ostream::out | std::ostream::binary | std::ostream::trunc);
+		if(!file) throw CForgeExcept("Failed to open " + fileName + " for writing");
 
 		// write - with a comment
-		ret.append("# Exported from CForge");
+		std::string header = "# Exported from CForge\n";
 		
 		std::vector<std::string> materialNames;
 		for(int i = 0; i < mesh->submeshCount(); i++){
@@ -114,61 +262,80 @@ namespace CForge{
 				size_t dotPos = m->TexAlbedo.find_last_of(".");
 				std::string path = m->TexAlbedo.substr(lastSlashPos + 1, dotPos - lastSlashPos - 1);
 				materialNames.push_back(path);
-				ret.append("\nmtllib " + path + ".mtl");
+				header.append("mtllib " + path + ".mtl\n");
 			}
 		}
+		file << header;
+
+		// lines are formatted in parallel straight from the mesh arrays
+		LineWriter writer(&file);
 
 		// write vertices
-		for(int i = 0; i < mesh->vertexCount(); i++){
-			Eigen::Vector3f v = mesh->vertex(i);
-			ret.append("\nv "   + std::to_string(v.x()) + " " 
-								+ std::to_string(v.y()) + " " 
-								+ std::to_string(v.z()));
-		}	
+		writer.write(mesh->vertexCount(), [mesh](size_t i, char* p) {
+			const Eigen::Vector3f& v = mesh->vertex(i);
+			*p++ = 'v';
+			for (int c = 0; c < 3; c++) {
+				*p++ = ' ';
+				p = writeFloat(p, v[c]);
+			}
+			*p++ = '\n';
+			return p;
+		});
 
 		// export the vertex normals
-		for(int i = 0; i < mesh->normalCount(); i++){
-			Eigen::Vector3f vn = mesh->normal(i);
-			ret.append("\nvn "	  + std::to_string(vn.x()) + " " 
-									+ std::to_string(vn.y()) + " " 
-									+ std::to_string(vn.z()));
-		}
+		writer.write(mesh->normalCount(), [mesh](size_t i, char* p) {
+			const Eigen::Vector3f& vn = mesh->normal(i);
+			*p++ = 'v';
+			*p++ = 'n';
+			for (int c = 0; c < 3; c++) {
+				*p++ = ' ';
+				p = writeFloat(p, vn[c]);
+			}
+			*p++ = '\n';
+			return p;
+		});
 
 		// write the textur coordinates
-		for(int i = 0; i < mesh->textureCoordinatesCount(); i++){
-			Eigen::Vector3f vt = mesh->textureCoordinate(i); 
-			ret.append("\nvt " + std::to_string(vt.x()) + " " + std::to_string(vt.y()));
-		}
+		writer.write(mesh->textureCoordinatesCount(), [mesh](size_t i, char* p) {
+			const Eigen::Vector3f& vt = mesh->textureCoordinate(i);
+			*p++ = 'v';
+			*p++ = 't';
+			for (int c = 0; c < 2; c++) {
+				*p++ = ' ';
+				p = writeFloat(p, vt[c]);
+			}
+			*p++ = '\n';
+			return p;
+		});
 
 		// expor the faces - define material beforehand 
+		const bool hasUVs = (mesh->textureCoordinatesCount() != 0);
 		for(int i = 0; i < mesh->submeshCount(); i++){
-			T3DMesh<float>::Submesh *submesh = mesh->getSubmesh(i); 
+			const T3DMesh<float>::Submesh *submesh = mesh->getSubmesh(i); 
 
 			//if(materialNames[i] == ""){
 			//	continue;
 			//}
 			//ret.append("\nusemtl " + materialNames[i]);
 			
-			for(int j = 0; j < submesh->Faces.size(); j++){
-				T3DMesh<float>::Face face = submesh->Faces[j]; 
-				
-				if(mesh->textureCoordinatesCount() == 0){
-					ret.append("\nf "	+ std::to_string(face.Vertices[0] + 1) + " " 
-										+ std::to_string(face.Vertices[1] + 1) + " " 
-										+ std::to_string(face.Vertices[2] + 1));
-				} // if no texture coordinates
-				else {
-					ret.append("\nf "	+ std::to_string(face.Vertices[0] + 1)+"/"+std::to_string(face.Vertices[0] + 1) + " " 
-										+ std::to_string(face.Vertices[1] + 1)+"/"+std::to_string(face.Vertices[1] + 1) + " " 
-										+ std::to_string(face.Vertices[2] + 1)+"/"+std::to_string(face.Vertices[2] + 1));
-
-				} // if texture coordinates
-			} // for each face
+			writer.write(submesh->Faces.size(), [submesh, hasUVs](size_t j, char* p) {
+				const T3DMesh<float>::Face& face = submesh->Faces[j];
+				*p++ = 'f';
+				for (int k = 0; k < 3; k++) {
+					*p++ = ' ';
+					p = writeIndex(p, face.Vertices[k] + 1);
+					// texture coordinates share the vertex index
+					if (hasUVs) {
+						*p++ = '/';
+						p = writeIndex(p, face.Vertices[k] + 1);
+					}
+				}
+				*p++ = '\n';
+				return p;
+			});
 		}// for each submesh
 		
-		ret.append("\n");
-		file << ret;
-		
+		if(!file) throw CForgeExcept("Failed to write " + fileName);
 	}// exportAsObjFile
 
 	void objImportExport::exportSubmeshesAsObjFiles(std::vector<std::string> filenames, T3DMesh<float>* pMesh){
@@ -17,13 +17,13 @@ namespace CForge {
 
 	}//Destructor
 
-	void AdaptiveSkeletalActor::init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning) {
+	void AdaptiveSkeletalActor::init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning, uint16_t BoneDataProps) {
 
 		m_FeetAlignmentToggle = true;
 		m_LastAdaptationAngle = 0.0f;
 		m_MaxAdaptationDelta = 0.2f;
 
-		SkeletalActor::init(pMesh, pController, true);
+		SkeletalActor::init(pMesh, pController, true, BoneDataProps);
 
 		//m_SkeletalSkinning.init(pMesh, pController);
 		m_Joints = pController->retrieveSkeleton();
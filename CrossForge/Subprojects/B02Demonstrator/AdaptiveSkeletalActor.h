@@ -53,7 +53,7 @@ namespace CForge {
 		AdaptiveSkeletalActor(void);
 		~AdaptiveSkeletalActor(void);
 
-		void init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning = true) override;
+		void init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning = true, uint16_t BoneDataProps = 0) override;
 		void render(RenderDevice* pRDev, Eigen::Quaternionf Rotation, Eigen::Vector3f Translation, Eigen::Vector3f Scale) override;
 
 		//Eigen::Vector3f getTransformedVertex(int32_t ID);
@@ -103,6 +103,7 @@ namespace CForge {
 			
 			SAssetIO::load("MyAssets/TexturedGround.fbx", &M);
 			for (uint8_t i = 0; i < 4; ++i) M.textureCoordinate(i) *= 15.0f;
+			M.geometryChanged();
 			setMeshShader(&M, 0.0f, 0.04f);
 			M.getMaterial(0)->Color = 1.0f * Vector4f(0.75f, 0.85f, 0.75f, 1.0f);
 
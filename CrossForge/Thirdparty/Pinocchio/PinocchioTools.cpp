@@ -4,6 +4,8 @@
 
 #include <cmath>
 #include <iostream>
+#include <list>
+#include <mutex>
 
 namespace nsPinocchioTools {
 
@@ -154,6 +156,19 @@ namespace nsPinocchioTools {
 	                  nsPiR::PinocchioOutput& piO, uint32_t vertexCount) {
 		if (!piO.attachment)
 			throw CForgeExcept("PinocchioTools::applyWeights error: attatchment not valid");
+		std::vector<std::vector<std::pair<int32_t,float>>> weights(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++) {
+			Vector<double,-1> w = piO.attachment->getWeights(i);
+			for (uint32_t j = 0; j < w.size(); j++) {
+				if (w[j] > 0.0)
+					weights[i].push_back(std::make_pair(int32_t(j), float(w[j])));
+			}
+		}
+		applyWeights(in, inMesh, out, CVSInfo, piO, weights);
+	}
+
+	void applyWeights(nsPiR::Skeleton* in, nsPiR::Mesh* inMesh, CForge::T3DMesh<float>* out, const CVScalingInfo& CVSInfo,
+	                  nsPiR::PinocchioOutput& piO, const std::vector<std::vector<std::pair<int32_t,float>>>& weights) {
 		std::vector<CForge::T3DMesh<float>::Bone*> outList = gatherBones(out->rootBone());
 		
 		// center embedding and mesh at boneRoot = 0
@@ -187,35 +202,104 @@ namespace nsPinocchioTools {
 		// set position of bones
 		adaptSkeleton(&piO,in,out->rootBone());
 		//apply weights
-		for (uint32_t i = 0; i < vertexCount; i++) {
-			Vector<double,-1> weights = piO.attachment->getWeights(i);
-			// TODO assumption that attatchment and outList index is the same
-			for (uint32_t k = 0; k < outList.size(); k++) {
-				uint32_t jointIndex = in->getJointForName(outList[k]->Name);
-				for (uint32_t j = 0; j < weights.size(); j++) {
-					if (weights[j] > 0.0 && j==jointIndex) {
-						outList[k]->VertexInfluences.push_back(i);
-						outList[k]->VertexWeights.push_back(weights[j]);
-					}
+		// TODO assumption that attatchment and outList index is the same
+		std::vector<std::vector<CForge::T3DMesh<float>::Bone*>> jointBones; // outList bones per joint index
+		for (uint32_t k = 0; k < outList.size(); k++) {
+			int jointIndex = in->getJointForName(outList[k]->Name);
+			if (jointIndex < 0)
+				continue;
+			if (jointIndex >= (int)jointBones.size())
+				jointBones.resize(jointIndex + 1);
+			jointBones[jointIndex].push_back(outList[k]);
+		}
+		for (uint32_t i = 0; i < weights.size(); i++) {
+			for (const auto& [j, w] : weights[i]) {
+				if (w <= 0.0f || j >= (int32_t)jointBones.size())
+					continue;
+				for (auto* b : jointBones[j]) {
+					b->VertexInfluences.push_back(i);
+					b->VertexWeights.push_back(w);
+				}
+			}
+		}
+	}
+
+	namespace {
+		struct DistanceFieldEntry {
+			uint64_t hash;
+			size_t vertices, edges;
+			std::shared_ptr<TreeType> field;
+		};
+		std::mutex distanceFieldMutex;
+		std::list<DistanceFieldEntry> distanceFieldCache; // most recently used first
+		const size_t distanceFieldCacheSize = 2;
+
+		uint64_t hashMesh(const nsPiR::Mesh& m) {
+			uint64_t h = 14695981039346656037ull; // FNV-1a
+			auto add = [&](const void* data, size_t size) {
+				const unsigned char* p = (const unsigned char*)data;
+				for (size_t i = 0; i < size; i++) {
+					h ^= p[i];
+					h *= 1099511628211ull;
+				}
+			};
+			for (const auto& v : m.vertices)
+				add(&v.pos[0], 3 * sizeof(double));
+			for (const auto& e : m.edges)
+				add(&e.vertex, sizeof(int));
+			return h;
+		}
+	}
+
+	std::shared_ptr<TreeType> cachedDistanceField(const nsPiR::Mesh& m) {
+		const uint64_t hash = hashMesh(m);
+		{
+			std::lock_guard<std::mutex> lock(distanceFieldMutex);
+			for (auto it = distanceFieldCache.begin(); it != distanceFieldCache.end(); ++it) {
+				if (it->hash == hash && it->vertices == m.vertices.size() && it->edges == m.edges.size()) {
+					distanceFieldCache.splice(distanceFieldCache.begin(), distanceFieldCache, it);
+					return it->field;
 				}
 			}
 		}
+
+		// built outside the lock, concurrent requests for the same mesh may build it twice
+		std::shared_ptr<TreeType> field(constructDistanceField(m));
+
+		std::lock_guard<std::mutex> lock(distanceFieldMutex);
+		distanceFieldCache.push_front(DistanceFieldEntry{ hash, m.vertices.size(), m.edges.size(), field });
+		if (distanceFieldCache.size() > distanceFieldCacheSize)
+			distanceFieldCache.pop_back();
+		return field;
+	}
+
+	void clearDistanceFieldCache() {
+		std::lock_guard<std::mutex> lock(distanceFieldMutex);
+		distanceFieldCache.clear();
 	}
 
-	nsPinocchio::PinocchioOutput autorig(const nsPiR::Skeleton &given, nsPiR::Mesh* m)
+	nsPinocchio::PinocchioOutput autorig(const nsPiR::Skeleton &given, nsPiR::Mesh* m, const AttachmentFunc& attach,
+	                                     const ProgressFunc& progress)
 	{
 		using namespace nsPinocchio;
 		int i;
 		PinocchioOutput out;
+		auto report = [&](float p, const char* stage) {
+			if (progress)
+				progress(p, stage);
+		};
 
 		Mesh newMesh = prepareMesh(*m);
 		*m = newMesh;
 		if(newMesh.vertices.size() == 0)
 			return out;
 
-		TreeType *distanceField = constructDistanceField(newMesh);
+		report(0.f, "distance field");
+		std::shared_ptr<TreeType> field = cachedDistanceField(newMesh);
+		TreeType *distanceField = field.get();
 
 		//discretization
+		report(0.3f, "medial surface");
 		vector<Sphere> medialSurface = sampleMedialSurface(distanceField);
 
 		vector<Sphere> spheres = packSpheres(medialSurface);
@@ -223,6 +307,7 @@ namespace nsPinocchioTools {
 		PtGraph graph = connectSamples(distanceField, spheres);
 
 		//discrete embedding
+		report(0.45f, "embedding");
 		vector<vector<int> > possibilities = computePossibilities(graph, spheres, given);
 
 		//constraints can be set by respecifying possibilities for skeleton joints:
@@ -230,10 +315,8 @@ namespace nsPinocchioTools {
 
 		vector<int> embeddingIndices = discreteEmbed(graph, spheres, given, possibilities);
 
-		if(embeddingIndices.size() == 0) { //failure
-			delete distanceField;
+		if(embeddingIndices.size() == 0) //failure
 			return out;
-		}
 
 		vector<Vector3> discreteEmbedding = splitPaths(embeddingIndices, graph, given);
 
@@ -242,15 +325,16 @@ namespace nsPinocchioTools {
 		for(i = 0; i < (int)medialSurface.size(); ++i)
 			medialCenters[i] = medialSurface[i].center;
 
+		report(0.6f, "refine embedding");
 		out.embedding = refineEmbedding(distanceField, medialCenters, discreteEmbedding, given);
 
-		//attachment
-		VisTester<TreeType> *tester = new VisTester<TreeType>(distanceField);
-		out.attachment = new Attachment(newMesh, given, out.embedding, tester);
-
-		//cleanup
-		delete tester;
-		delete distanceField;
+		//attachment, the distance field stays cached
+		report(0.7f, "attachment");
+		std::unique_ptr<VisTester<TreeType>> tester(new VisTester<TreeType>(distanceField));
+		if (attach)
+			attach(newMesh, out.embedding, tester.get());
+		else
+			out.attachment = new Attachment(newMesh, given, out.embedding, tester.get());
 
 		return out;
 	}
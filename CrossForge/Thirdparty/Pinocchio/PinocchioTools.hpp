@@ -13,6 +13,9 @@
 #include "indexer.h"
 
 #include "../../crossforge/AssetIO/T3DMesh.hpp"
+
+#include <functional>
+#include <memory>
 /*
 * \brief tools for converting engine format to pinocchio and vice versa
 */
@@ -23,7 +26,32 @@ using namespace nsPinocchio;
 
 namespace nsPiR = nsPinocchio;
 
-nsPinocchio::PinocchioOutput PINOCCHIOTOOLS_API autorig(const nsPiR::Skeleton &given, nsPiR::Mesh* m);
+/*
+* \brief distance field of a prepared mesh, cached by a hash of the mesh content.
+*        Rigging the same mesh again, e.g. with another skeleton, reuses the field instead of rebuilding it.
+*/
+std::shared_ptr<nsPiR::TreeType> PINOCCHIOTOOLS_API cachedDistanceField(const nsPiR::Mesh& m);
+void PINOCCHIOTOOLS_API clearDistanceFieldCache();
+
+/*
+* \brief called by autorig with the prepared mesh, the embedding and the distance field visibility test,
+*        replaces the Pinocchio Attachment. The tester is deleted after the call.
+*/
+using AttachmentFunc = std::function<void(const nsPiR::Mesh& mesh, const std::vector<nsPiR::Vector3>& embedding,
+                                          const nsPiR::VisibilityTester* tester)>;
+
+/*
+* \brief called by autorig before each step with the fraction done and the step name.
+*        May throw to abort, the exception is passed on to the caller of autorig.
+*/
+using ProgressFunc = std::function<void(float progress, const char* stage)>;
+
+/*
+* \param attach computes the weights instead of Pinocchio, piO.attachment stays null if set
+*/
+nsPinocchio::PinocchioOutput PINOCCHIOTOOLS_API autorig(const nsPiR::Skeleton &given, nsPiR::Mesh* m,
+                                                        const AttachmentFunc& attach = nullptr,
+                                                        const ProgressFunc& progress = nullptr);
 
 //TODO necessary?
 // wrapper class for converting
@@ -83,6 +111,13 @@ void PINOCCHIOTOOLS_API adaptSkeleton( nsPiR::PinocchioOutput* in, nsPiR::Skelet
 void PINOCCHIOTOOLS_API applyWeights(nsPiR::Skeleton* in, nsPiR::Mesh* inMesh, CForge::T3DMesh<float>* out, const CVScalingInfo& CVSInfo,
 	nsPiR::PinocchioOutput& piO, uint32_t vertexCount);
 
+/*
+* \brief same as above with weights computed outside of Pinocchio
+* \param weights per vertex (bone index, weight), bone indices as in Attachment::getWeights
+*/
+void PINOCCHIOTOOLS_API applyWeights(nsPiR::Skeleton* in, nsPiR::Mesh* inMesh, CForge::T3DMesh<float>* out, const CVScalingInfo& CVSInfo,
+	nsPiR::PinocchioOutput& piO, const std::vector<std::vector<std::pair<int32_t,float>>>& weights);
+
 /*
 * \morphs and scales mesh to targetSkl
 * \param in T3DMesh
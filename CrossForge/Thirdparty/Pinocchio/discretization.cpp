@@ -18,6 +18,7 @@
 
 #include "pinocchioApi.h"
 #include "deriv.h"
+#include "../../crossforge/Core/Parallel.hpp"
 //#include "debugging.h"
 
 namespace nsPinocchio {
@@ -102,6 +103,7 @@ vector<Sphere> sampleMedialSurface(TreeType *distanceField, double tol)
     vector<Sphere> out;
 
     vector<OctTreeNode *> todo;
+    vector<OctTreeNode *> leaves;
     todo.push_back(distanceField);
     int inTodo = 0;
     while(inTodo < (int)todo.size()) {
@@ -113,14 +115,20 @@ vector<Sphere> sampleMedialSurface(TreeType *distanceField, double tol)
             }
             continue;
         }
-        
-        //we are at octree leaf
+        leaves.push_back(cur);
+    }
+
+    //leaves are independent and only read the field, samples are merged in leaf order afterwards
+    //so the result does not depend on the number of threads
+    vector<vector<Sphere> > leafSamples(leaves.size());
+    CForge::parallelForEach(leaves.size(), [&](size_t l) {
+        OctTreeNode *cur = leaves[l];
         Rect3 r = cur->getRect();
         double rad = r.getSize().length() / 2.;
         Vector3 c = r.getCenter();
         double dot = getMinDot(distanceField, c, rad);
         if(dot > 0.)
-            continue;
+            return;
     
         //we are likely near medial surface
         double step = tol;
@@ -136,17 +144,20 @@ vector<Sphere> sampleMedialSurface(TreeType *distanceField, double tol)
         }
         
         //pts now contains a grid on 3 of the octree cell faces (that's enough)
-        for(i = 0; i < (int)pts.size(); ++i) {
-            Vector3 &p = pts[i];
+        for(int k = 0; k < (int)pts.size(); ++k) {
+            Vector3 &p = pts[k];
             double dist = -distanceField->locate(p)->evaluate(p);
             if(dist <= 2. * step)
                 continue; //we want to be well inside
             double dot = getMinDot(distanceField, p, step * 0.001);
             if(dot > 0.0)
                 continue;
-            out.push_back(Sphere(p, dist));
+            leafSamples[l].push_back(Sphere(p, dist));
         }
-    }
+    }, 64);
+
+    for(i = 0; i < (int)leafSamples.size(); ++i)
+        out.insert(out.end(), leafSamples[i].begin(), leafSamples[i].end());
     
     std::cout << "Medial axis points = " << out.size() << endl;
     
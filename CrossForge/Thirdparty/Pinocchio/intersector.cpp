@@ -30,7 +30,7 @@ void Intersector::getIndex(const Vector2 &pt, int &x, int &y) const
 {
     Vector2 c = (pt - bounds.getLo()).apply(divides<double>(), bounds.getSize());
     x = int(c[0] * double(cells));
-    y = int(c[0] * double(cells));
+    y = int(c[1] * double(cells));
     x = max(0, min(cells - 1, x));
     y = max(0, min(cells - 1, y));
 }
@@ -70,16 +70,25 @@ public:
         }
     
         rnodes.reserve((int)objs.size() * 2 - 1);
+        inLeft.resize(objs.size(), 0);
         initHelper(orders);
+        inLeft.clear();
     }
 
-    Vec project(const Vec &from) const
+    Vec project(const Vec &from) const { return project(from, NULL); }
+
+    //hint is a point on the objects (e.g. the result of a nearby query), its distance bounds the search
+    Vec project(const Vec &from, const Vec *hint) const
     {
         double minDistSq = 1e37;
         Vec closestSoFar;
+        if(hint) {
+            minDistSq = (from - *hint).lengthsq();
+            closestSoFar = *hint;
+        }
 
         int sz = 1;
-        static pair<double, int> todo[10000];
+        thread_local pair<double, int> todo[10000]; //per thread, projection is called concurrently
         todo[0] = make_pair(rnodes[0].rect.distSqTo(from), 0);
 
         while(sz > 0) {
@@ -148,20 +157,23 @@ private:
         else {
             int i, d;
             vector<int> orders1[Dim], orders2[Dim];
-            set<int> left;
             for(i = 0; i < num / 2; ++i)
-                left.insert(orders[curDim][i]);
+                inLeft[orders[curDim][i]] = 1;
         
             for(d = 0; d < Dim; ++d) {
                 orders1[d].reserve((num + 1) / 2);
                 orders2[d].reserve((num + 1) / 2);
                 for(i = 0; i < num; ++i) {
-                    if(left.count(orders[d][i]))
+                    if(inLeft[orders[d][i]])
                         orders1[d].push_back(orders[d][i]);
                     else
                         orders2[d].push_back(orders[d][i]);
                 }
             }
+            for(i = 0; i < num / 2; ++i)
+                inLeft[orders[curDim][i]] = 0;
+            for(d = 0; d < Dim; ++d)
+                vector<int>().swap(orders[d]); //not needed below this node anymore
         
             rnodes[out].child1 = initHelper(orders1, (curDim + 1) % Dim);
             rnodes[out].child2 = initHelper(orders2, (curDim + 1) % Dim);
@@ -182,6 +194,7 @@ private:
 
     vector<RNode> rnodes;
     vector<Obj> objs;
+    vector<char> inLeft; //scratch for initHelper, marks objects of the left half
 };
 }
 #endif
@@ -24,8 +24,11 @@
 #include "multilinear.h"
 #include "intersector.h"
 #include "pointprojector.h"
+#include "../../crossforge/Core/Parallel.hpp"
+#include <array>
 #include <numeric>
 #include <map>
+#include <memory>
 
 namespace nsPinocchio {
 template<int Dim>
@@ -45,6 +48,16 @@ public:
 private:
 };
 
+//subtree of the octree that is split independently of the rest
+template<class Node, class Eval>
+struct SplitTask
+{
+    Node *node;
+    Eval eval; //copy of the evaluator with the state it had when reaching node
+    int level;
+    bool cropOutside;
+};
+
 template<int Dim>
 class DistData : public DistFunction<Dim>
 {
@@ -56,8 +69,10 @@ public:
 
     void init() { }
 
+    //if tasks is given, nodes at taskLevel are not split but collected for the caller
     template<class Eval, template<typename Node, int IDim> class Indexer>
-    void fullSplit(const Eval &eval, double tol, DRootNode<DistData<Dim>, Dim, Indexer> *rootNode, int level = 0, bool cropOutside = false)
+    void fullSplit(const Eval &eval, double tol, DRootNode<DistData<Dim>, Dim, Indexer> *rootNode, int level = 0, bool cropOutside = false,
+                   vector<SplitTask<NodeType, Eval> > *tasks = NULL, int taskLevel = 0)
     {
         int i;
         const Rect<double, Dim> &rect = node->getRect();
@@ -112,7 +127,12 @@ public:
         rootNode->split(node);
         for(i = 0; i < NodeType::numChildren; ++i) {
             eval.setRect(Rect<double, Dim>(rect.getCorner(i)) | Rect<double, Dim>(rect.getCenter()));
-            node->getChild(i)->fullSplit(eval, tol, rootNode, level + 1, nextCropOutside);
+            if(tasks && level + 1 >= taskLevel) {
+                SplitTask<NodeType, Eval> task = { node->getChild(i), eval, level + 1, nextCropOutside };
+                tasks->push_back(task);
+            }
+            else
+                node->getChild(i)->fullSplit(eval, tol, rootNode, level + 1, nextCropOutside, tasks, taskLevel);
         }
     }
 
@@ -162,7 +182,14 @@ public:
         DistObjEval eval(proj, m);
         RootNode *out = new RootNode();
 
-        out->fullSplit(eval, tol, out, 0, true);
+        //top levels serially, the remaining subtrees in parallel with their own evaluator copy
+        typedef SplitTask<typename RootNode::Node, DistObjEval> Task;
+        vector<Task> tasks;
+        out->fullSplit(eval, tol, out, 0, true, &tasks, parallelLevel);
+        CForge::parallelForEach(tasks.size(), [&](size_t i) {
+            Task &t = tasks[i];
+            t.node->fullSplit(t.eval, tol, out, t.level, t.cropOutside);
+        });
         out->preprocessIndex();
 
         return out;
@@ -180,10 +207,13 @@ public:
     }
 
 private:
+    static const int parallelLevel = 3; //up to 512 subtrees
+
     class DistObjEval
     {
     public:
-        DistObjEval(const ObjectProjector<3, Tri3Object> &inProj, const Mesh &m) : proj(inProj), mint(m, Vector3(1, 0, 0))
+        DistObjEval(const ObjectProjector<3, Tri3Object> &inProj, const Mesh &m)
+            : proj(inProj), mint(new Intersector(m, Vector3(1, 0, 0))), hasLast(false)
         {
             level = 0;
             rects[0] = Rect3(Vector3(), Vector3(1.));
@@ -192,7 +222,9 @@ private:
 
         double operator()(const Vector3 &vec) const
         {
-            unsigned int cur = ROUND(vec[0] * 1023.) + 1024 * (ROUND(vec[1] * 1023.) + 1024 * ROUND(vec[2] * 1023.));
+            //keyed by exact position, cell corners are shared by neighbouring cells. A quantized key would
+            //return values of nearby points on deep levels and make the result depend on evaluation order.
+            std::array<double, 3> cur = {{ vec[0], vec[1], vec[2] }};
             unsigned int sz = cache.size();
             double &d = cache[cur];
             if(sz == cache.size())
@@ -225,19 +257,24 @@ private:
             int i, ins = inside[level];
             if(!ins) {
                 ins = 1;
-                vector<Vector3> isecs = mint.intersect(vec);
+                vector<Vector3> isecs = mint->intersect(vec);
                 for(i = 0; i < (int)isecs.size(); ++i) {
                     if(isecs[i][0] > vec[0])
                         ins = -ins;
                 }
             }
             
-            return (vec - proj.project(vec)).length() * ins;
+            //consecutive queries are close to each other, the last closest point bounds the search
+            lastProj = proj.project(vec, hasLast ? &lastProj : NULL);
+            hasLast = true;
+            return (vec - lastProj).length() * ins;
         }
         
-        mutable map<unsigned int, double> cache;
+        mutable map<std::array<double, 3>, double> cache;
         const ObjectProjector<3, Tri3Object> &proj;
-        Intersector mint;
+        std::shared_ptr<const Intersector> mint; //shared by the copies of parallel subtrees
+        mutable Vector3 lastProj;
+        mutable bool hasLast;
         mutable Rect3 rects[11];
         mutable int inside[11];
         mutable int level; //essentially index of last rect
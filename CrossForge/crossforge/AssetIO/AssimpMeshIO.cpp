@@ -3,9 +3,11 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 #include <assimp/Exporter.hpp>
+#include <assimp/version.h>
 #include "../Core/SLogger.h"
 #include "../Utility/CForgeUtility.h"
 #include "../AssetIO/File.h"
+#include "../Core/Parallel.hpp"
 
 
 
@@ -14,6 +16,8 @@ using namespace Assimp;
 namespace CForge {
 	AssimpMeshIO::AssimpMeshIO(void): I3DMeshIO("AssimpMeshIO") {
 		m_PluginName = "AssImp Mesh IO";
+		// loaded meshes also depend on the Assimp release
+		m_PluginVersion = 1 * 10000 + aiGetVersionMajor() * 100 + aiGetVersionMinor();
 	}//Constructor
 
 	AssimpMeshIO::~AssimpMeshIO(void) {
@@ -33,10 +37,12 @@ namespace CForge {
 	}
 
 	void AssimpMeshIO::load(const std::string Filepath, T3DMesh<float> *pMesh){
-		const aiScene *pScene = m_Importer.ReadFile(Filepath, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_LimitBoneWeights | aiProcess_OptimizeGraph | aiProcess_ValidateDataStructure);
+		// importer per call, so loads can run concurrently and no parser state survives between files
+		Assimp::Importer Importer;
+		const aiScene *pScene = Importer.ReadFile(Filepath, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_LimitBoneWeights | aiProcess_OptimizeGraph | aiProcess_ValidateDataStructure);
 
 		if (nullptr == pScene) {
-			std::string ErrorMsg = m_Importer.GetErrorString();
+			std::string ErrorMsg = Importer.GetErrorString();
 			throw CForgeExcept("Failed to load model from resource " + Filepath + "\n\t" + ErrorMsg);
 		}
 
@@ -47,7 +53,7 @@ namespace CForge {
 			SLogger::logException(e);
 		}
 		
-		m_Importer.FreeScene();
+		Importer.FreeScene();
 	}//load
 
 	void AssimpMeshIO::store(const std::string Filepath, const T3DMesh<float>* pMesh) {
@@ -102,98 +108,115 @@ namespace CForge {
 
 		pMesh->clear();
 
-		std::vector<Eigen::Vector3f> Positions;
-		std::vector<Eigen::Vector3f> Normals;
-		std::vector<Eigen::Vector3f> Tangents;
-		std::vector<Eigen::Vector3f> UVWs;
+		const uint32_t MeshCount = pScene->mNumMeshes;
+
+		// offsets of every aiMesh in the joined vertex arrays, known upfront so meshes can be extracted in parallel
+		std::vector<uint32_t> VertexOffsets(MeshCount + 1, 0);
+		bool HasNormals = false;
+		bool HasTangents = false;
+		bool HasUVWs = false;
+		for (uint32_t i = 0; i < MeshCount; ++i) {
+			const aiMesh* pM = pScene->mMeshes[i];
+			VertexOffsets[i + 1] = VertexOffsets[i] + pM->mNumVertices;
+			if (nullptr != pM->mNormals) HasNormals = true;
+			if (nullptr != pM->mTangents) HasTangents = true;
+			if (nullptr != pM->mTextureCoords[0]) HasUVWs = true;
+		}//for[all meshes]
+		const uint32_t VertexCount = VertexOffsets[MeshCount];
 
-		std::vector<T3DMesh<float>::Bone*> Bones;
-		std::vector<T3DMesh<float>::SkeletalAnimation*> SekeltonAnimations;
+		// meshes without an attribute other meshes have get zeros, so all arrays stay aligned with the positions
+		std::vector<Eigen::Vector3f> Positions(VertexCount);
+		std::vector<Eigen::Vector3f> Normals(HasNormals ? VertexCount : 0, Eigen::Vector3f::Zero());
+		std::vector<Eigen::Vector3f> Tangents(HasTangents ? VertexCount : 0, Eigen::Vector3f::Zero());
+		std::vector<Eigen::Vector3f> UVWs(HasUVWs ? VertexCount : 0, Eigen::Vector3f::Zero());
+		std::vector<T3DMesh<float>::Submesh*> Submeshes(MeshCount, nullptr);
 
-		uint32_t PositionsOffset = 0;
-		uint32_t NormalsOffset = 0;
-		uint32_t TangentsOffset = 0;
-		uint32_t UVWsOffset = 0;
+		// global transformation is applied while extracting
+		const Eigen::Matrix4f GlobalTransform = toEigenMat(pScene->mRootNode->mTransformation);
+		const Eigen::Matrix3f GlobalLinear = GlobalTransform.block<3, 3>(0, 0);
+		const Eigen::Vector3f GlobalTranslation = GlobalTransform.block<3, 1>(0, 3);
 
-		uint32_t IndexOffset = 0;
+		for (auto& i : Submeshes) i = new T3DMesh<float>::Submesh();
 
-		for (uint32_t i = 0; i < pScene->mNumMeshes; ++i) {
-			aiMesh* pM = pScene->mMeshes[i];
+		parallelForEach(MeshCount, [&](uint32_t i) {
+			const aiMesh* pM = pScene->mMeshes[i];
+			const uint32_t Offset = VertexOffsets[i];
 
 			for (uint32_t k = 0; k < pM->mNumVertices; ++k) {
 				// collect vertices
-				Positions.push_back(toEigenVec(pM->mVertices[k]));
+				Positions[Offset + k] = GlobalLinear * toEigenVec(pM->mVertices[k]) + GlobalTranslation;
 				// collect normals
-				if (pM->mNormals != nullptr) Normals.push_back(toEigenVec(pM->mNormals[k]));
+				if (pM->mNormals != nullptr) Normals[Offset + k] = GlobalLinear * toEigenVec(pM->mNormals[k]);
 				// collect tangents
-				if (pM->mTangents != nullptr) Tangents.push_back(toEigenVec(pM->mTangents[k]));
+				if (pM->mTangents != nullptr) Tangents[Offset + k] = GlobalLinear * toEigenVec(pM->mTangents[k]);
 				// collect texture coordinates
-				if (pM->mTextureCoords[0] != nullptr && pM->GetNumUVChannels() > 0) UVWs.push_back(toEigenVec(pM->mTextureCoords[0][k]));
+				if (pM->mTextureCoords[0] != nullptr) UVWs[Offset + k] = toEigenVec(pM->mTextureCoords[0][k]);
 			}
 
 			// now we retrieve the faces (create submesh)
-			T3DMesh<float>::Submesh* pSubmesh = new T3DMesh<float>::Submesh();
+			T3DMesh<float>::Submesh* pSubmesh = Submeshes[i];
 			pSubmesh->Material = (int32_t)pM->mMaterialIndex;
+			pSubmesh->Faces.reserve(pM->mNumFaces);
 			for (uint32_t k = 0; k < pM->mNumFaces; ++k) {
-				aiFace F = pM->mFaces[k];
+				const aiFace& F = pM->mFaces[k];
+				// points and lines are skipped
+				if (F.mNumIndices < 3) continue;
 				T3DMesh<float>::Face Face;
-				for (uint32_t j = 0; j < F.mNumIndices && j < 4; j++) {
-					Face.Vertices[j] = PositionsOffset + F.mIndices[j];
+				for (uint32_t j = 0; j < 3; j++) {
+					Face.Vertices[j] = Offset + F.mIndices[j];
 				}//for[face indices]
-
-				if(Face.Vertices[0] != -1 && Face.Vertices[1] != -1 && Face.Vertices[2] != -1) 
-					pSubmesh->Faces.push_back(Face);
+				pSubmesh->Faces.push_back(Face);
 			}//for[number of faces]
-			// add submesh to model
-			pMesh->addSubmesh(pSubmesh, false);
+		});
 
-			// add bones
-			for (uint32_t k = 0; k < pM->mNumBones; k++) {
+		// add submeshes to model
+		for (auto i : Submeshes) pMesh->addSubmesh(i, false);
 
-				T3DMesh<float>::Bone* pBone = new T3DMesh<float>::Bone();
-				pBone->ID = Bones.size();
-				pBone->InvBindPoseMatrix = toEigenMat(pM->mBones[k]->mOffsetMatrix);
-				pBone->Name = pM->mBones[k]->mName.C_Str();
+		// bones of the same name in several meshes are joined, one pass over the bones collects the sources of every joined bone
+		std::vector<T3DMesh<float>::Bone*> Bones;
+		std::unordered_map<std::string, T3DMesh<float>::Bone*> BoneIndex;
+		std::vector<std::vector<std::pair<uint32_t, const aiBone*>>> BoneSources;
 
-				for (uint32_t j = 0; j < pM->mBones[k]->mNumWeights; ++j) {
-					pBone->VertexInfluences.push_back(PositionsOffset + pM->mBones[k]->mWeights[j].mVertexId);
-					pBone->VertexWeights.push_back(pM->mBones[k]->mWeights[j].mWeight);
+		for (uint32_t i = 0; i < MeshCount; ++i) {
+			const aiMesh* pM = pScene->mMeshes[i];
+			for (uint32_t k = 0; k < pM->mNumBones; k++) {
+				const aiBone* pAiBone = pM->mBones[k];
+				auto Entry = BoneIndex.emplace(pAiBone->mName.C_Str(), nullptr);
+				if (Entry.second) {
+					T3DMesh<float>::Bone* pBone = new T3DMesh<float>::Bone();
+					pBone->ID = Bones.size();
+					pBone->InvBindPoseMatrix = toEigenMat(pAiBone->mOffsetMatrix);
+					pBone->Name = pAiBone->mName.C_Str();
+					Entry.first->second = pBone;
+					Bones.push_back(pBone);
+					BoneSources.emplace_back();
 				}
-				
-				Bones.push_back(pBone);
+				BoneSources[Entry.first->second->ID].push_back(std::make_pair(i, pAiBone));
 			}//for[bones]
-
-			PositionsOffset += pM->mNumVertices;
-			if (nullptr != pM->mNormals) NormalsOffset += pM->mNumVertices;
-			if (nullptr != pM->mTangents) TangentsOffset += pM->mNumVertices;
-			if (nullptr != pM->mTextureCoords[0]) UVWsOffset += pM->mNumVertices;
 		}//for[all meshes]
 
-
-		// apply global transformation
-		Eigen::Matrix4f GlobalTransform = toEigenMat(pScene->mRootNode->mTransformation);
-		for (auto& i : Positions) {
-			Eigen::Vector4f p = GlobalTransform * Eigen::Vector4f(i.x(), i.y(), i.z(), 1.0f);
-			i = Eigen::Vector3f(p.x(), p.y(), p.z());
-		}
-		if (Normals.size() > 0) {
-			for (auto& i : Normals) {
-				Eigen::Vector4f p = GlobalTransform * Eigen::Vector4f(i.x(), i.y(), i.z(), 0.0f);
-				i = Eigen::Vector3f(p.x(), p.y(), p.y());
-			}
-		}
-		if (Tangents.size() > 0) {
-			for (auto& i : Tangents) {
-				Eigen::Vector4f p = GlobalTransform * Eigen::Vector4f(i.x(), i.y(), i.z(), 0.0f);
-				i = Eigen::Vector3f(p.x(), p.y(), p.z());
+		// gather vertex influences, every bone owns its arrays
+		parallelForEach(Bones.size(), [&](uint32_t i) {
+			T3DMesh<float>::Bone* pBone = Bones[i];
+			size_t InfluenceCount = 0;
+			for (const auto& k : BoneSources[i]) InfluenceCount += k.second->mNumWeights;
+			pBone->VertexInfluences.reserve(InfluenceCount);
+			pBone->VertexWeights.reserve(InfluenceCount);
+
+			for (const auto& k : BoneSources[i]) {
+				const uint32_t Offset = VertexOffsets[k.first];
+				for (uint32_t j = 0; j < k.second->mNumWeights; ++j) {
+					pBone->VertexInfluences.push_back(Offset + k.second->mWeights[j].mVertexId);
+					pBone->VertexWeights.push_back(k.second->mWeights[j].mWeight);
+				}
 			}
-		}
+		});
 
 		// set positions, normals, tangents
-		pMesh->vertices(&Positions);
-		if (Normals.size() > 0) pMesh->normals(&Normals);
-		if (Tangents.size() > 0) pMesh->tangents(&Tangents);
-		if (UVWs.size() > 0) pMesh->textureCoordinates(&UVWs);
+		pMesh->vertices(std::move(Positions));
+		if (Normals.size() > 0) pMesh->normals(std::move(Normals));
+		if (Tangents.size() > 0) pMesh->tangents(std::move(Tangents));
+		if (UVWs.size() > 0) pMesh->textureCoordinates(std::move(UVWs));
 
 		//add materials
 		for (uint32_t i = 0; i < pScene->mNumMaterials; ++i) {
@@ -233,32 +256,9 @@ namespace CForge {
 			pMesh->addMaterial(&Mat, true);
 		}//for[all materials]
 
-		// join identical bones (if names are identical)
-		for (auto i : Bones) {
-			if (nullptr == i) continue;
-			for (uint32_t k = i->ID + 1; k < Bones.size(); ++k) {
-				if (Bones[k] == nullptr) continue;
-				if (i->Name.compare(Bones[k]->Name) == 0) {
-					// copy vertx influces
-					for (auto l : Bones[k]->VertexInfluences) i->VertexInfluences.push_back(l);
-					for (auto l : Bones[k]->VertexWeights) i->VertexWeights.push_back(l);
-					delete Bones[k];
-					Bones[k] = nullptr;
-				}
-			}//for[following bones]
-		}//for[all bones]
-
-		std::vector<T3DMesh<float>::Bone*> Bones2;
-		for (auto i : Bones) {
-			if (i != nullptr) Bones2.push_back(i);
-		}
-		Bones = Bones2;
-
-		for (uint32_t i = 0; i < Bones.size(); ++i) Bones[i]->ID = i;
-
 		// skeleton
 		aiNode* pRoot = pScene->mRootNode;
-		retrieveBoneHierarchy(pRoot, &Bones);
+		retrieveBoneHierarchy(pRoot, &BoneIndex);
 
 		//TODO(skade) this code is actually useless, remove
 		// find root bone (the one without parent)
@@ -289,7 +289,7 @@ namespace CForge {
 			for (uint32_t k = 0; k < pAnim->mNumChannels; ++k) {
 				aiNodeAnim *pNodeAnim = pAnim->mChannels[k];
 
-				T3DMesh<float>::Bone* pB = getBoneFromName(pNodeAnim->mNodeName.C_Str(), &Bones);
+				T3DMesh<float>::Bone* pB = getBoneFromName(pNodeAnim->mNodeName.C_Str(), &BoneIndex);
 
 
 				int32_t KeyID = (nullptr == pB) ? k : pB->ID;
@@ -298,6 +298,10 @@ namespace CForge {
 				pSkelAnim->Keyframes[KeyID]->BoneName = pNodeAnim->mNodeName.C_Str();
 
 				T3DMesh<float>::BoneKeyframes* pKeys = (pB == nullptr) ? pSkelAnim->Keyframes[k] : pSkelAnim->Keyframes[pB->ID];
+				pKeys->Positions.reserve(pKeys->Positions.size() + pNodeAnim->mNumPositionKeys);
+				pKeys->Rotations.reserve(pKeys->Rotations.size() + pNodeAnim->mNumRotationKeys);
+				pKeys->Timestamps.reserve(pKeys->Timestamps.size() + pNodeAnim->mNumRotationKeys);
+				pKeys->Scalings.reserve(pKeys->Scalings.size() + pNodeAnim->mNumScalingKeys);
 
 				for (uint32_t l = 0; l < pNodeAnim->mNumPositionKeys; l++) {
 					pKeys->Positions.push_back( toEigenVec(pNodeAnim->mPositionKeys[l].mValue) );
@@ -639,40 +643,32 @@ namespace CForge {
 
 
 
-	void AssimpMeshIO::retrieveBoneHierarchy(aiNode* pNode, std::vector<T3DMesh<float>::Bone*>* pBones) {
+	void AssimpMeshIO::retrieveBoneHierarchy(aiNode* pNode, const std::unordered_map<std::string, T3DMesh<float>::Bone*>* pBoneIndex) {
 		if (nullptr == pNode) return; // end of recursion
-		if (nullptr == pBones) throw NullpointerExcept("pBones");
+		if (nullptr == pBoneIndex) throw NullpointerExcept("pBoneIndex");
 
-		T3DMesh<float>::Bone* pCurrentBone = getBoneFromName(pNode->mName.C_Str(), pBones);
+		T3DMesh<float>::Bone* pCurrentBone = getBoneFromName(pNode->mName.C_Str(), pBoneIndex);
 		if (nullptr != pCurrentBone) {
 			// retrieve parent
-			if(nullptr != pNode->mParent) pCurrentBone->pParent = getBoneFromName(pNode->mParent->mName.C_Str(), pBones);
+			if(nullptr != pNode->mParent) pCurrentBone->pParent = getBoneFromName(pNode->mParent->mName.C_Str(), pBoneIndex);
 			// add children
 			for (uint32_t i = 0; i < pNode->mNumChildren; ++i) {
-				T3DMesh<float>::Bone* pChild = getBoneFromName(pNode->mChildren[i]->mName.C_Str(), pBones);
+				T3DMesh<float>::Bone* pChild = getBoneFromName(pNode->mChildren[i]->mName.C_Str(), pBoneIndex);
 				if(nullptr != pChild) pCurrentBone->Children.push_back(pChild);
 			}//for[all child nodes]	
 		}//if[current bone was found]
 
 		// recursion
 		for (uint32_t i = 0; i < pNode->mNumChildren; ++i) {
-			retrieveBoneHierarchy(pNode->mChildren[i], pBones);
+			retrieveBoneHierarchy(pNode->mChildren[i], pBoneIndex);
 		}
 
 	}//retriveBoneHierarchy
 
-	T3DMesh<float>::Bone* AssimpMeshIO::getBoneFromName(std::string Name, std::vector<T3DMesh<float>::Bone*>* pBones) {
-		T3DMesh<float>::Bone* pRval = nullptr;
-
-		for (auto i : (*pBones)) {
-			if (0 == i->Name.compare(Name)) {
-				pRval = i;
-				break;
-			}
-		}//for[all bones]
-
-		return pRval;
-	}//
+	T3DMesh<float>::Bone* AssimpMeshIO::getBoneFromName(const std::string Name, const std::unordered_map<std::string, T3DMesh<float>::Bone*>* pBoneIndex) {
+		auto It = pBoneIndex->find(Name);
+		return (It == pBoneIndex->end()) ? nullptr : It->second;
+	}//getBoneFromName
 
 	Eigen::Vector3f AssimpMeshIO::toEigenVec(const aiVector3D Vec)const {
 		return Eigen::Vector3f(Vec.x, Vec.y, Vec.z);
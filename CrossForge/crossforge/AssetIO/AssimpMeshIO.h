@@ -21,6 +21,7 @@
 #include "I3DMeshIO.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
+#include <unordered_map>
 
 namespace CForge {
 	/***
@@ -151,21 +152,21 @@ namespace CForge {
 		inline aiQuaternion toAiQuat(const Eigen::Quaternionf Q)const;
 
 		/**
-		* \brief Searches for a specific bone name in a list of bones.
+		* \brief Looks up a bone by name.
 		* 
 		* \param[in] Name Bone name to search for.
-		* \param[in] pBones List of bones to search in.
+		* \param[in] pBoneIndex Bones by name.
 		* \return Bone instance or nullptr if not found.
 		*/
-		T3DMesh<float>::Bone* getBoneFromName(std::string Name, std::vector<T3DMesh<float>::Bone*>* pBones);
+		T3DMesh<float>::Bone* getBoneFromName(const std::string Name, const std::unordered_map<std::string, T3DMesh<float>::Bone*>* pBoneIndex);
 
 		/**
 		* \brief Collects the bone hierarchy from the AssImp scene.
 		* 
 		* \param[in] pNode Root node to start extracting from.
-		* \param[out] pBones Will store the found bones.
+		* \param[in] pBoneIndex Bones by name, parents and children of the found bones are set.
 		*/
-		void retrieveBoneHierarchy(aiNode* pNode, std::vector<T3DMesh<float>::Bone*>* pBones);
+		void retrieveBoneHierarchy(aiNode* pNode, const std::unordered_map<std::string, T3DMesh<float>::Bone*>* pBoneIndex);
 
 		/**
 		* \brief Writes a bone to an AssImp scene node.
@@ -176,8 +177,6 @@ namespace CForge {
 		void writeBone(aiNode* pNode, const T3DMesh<float>::Bone* pBone);
 		void rotateBones(aiNode* pNode, Eigen::Matrix3f accu);
 
-		Assimp::Importer m_Importer;	///< Instance of AssImp's importer structure.
-
 	};//AssimpMeshIO
 }//name space
 
@@ -0,0 +1,324 @@
+#include "BVHIO.h"
+#include "File.h"
+#include "../Math/CForgeMath.h"
+#include "../Utility/CForgeUtility.h"
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace CForge {
+
+	const std::string BVHIO::Extension = ".bvh";
+
+	namespace {
+
+		enum Channel : uint8_t {
+			CH_XPOSITION = 0,
+			CH_YPOSITION,
+			CH_ZPOSITION,
+			CH_XROTATION,
+			CH_YROTATION,
+			CH_ZROTATION,
+		};
+
+		struct Joint {
+			std::string Name;
+			int32_t Parent;
+			Eigen::Vector3f Offset;
+			std::vector<Channel> Channels;
+		};
+
+		bool isBlank(const char c) {
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		}
+
+		const char* skipBlanks(const char* p, const char* pEnd) {
+			while (p < pEnd && isBlank(*p)) p++;
+			return p;
+		}
+
+		bool parseChannel(const std::string Name, Channel* pChannel) {
+			const std::string Str = CForgeUtility::toLowerCase(Name);
+			if (Str == "xposition") *pChannel = CH_XPOSITION;
+			else if (Str == "yposition") *pChannel = CH_YPOSITION;
+			else if (Str == "zposition") *pChannel = CH_ZPOSITION;
+			else if (Str == "xrotation") *pChannel = CH_XROTATION;
+			else if (Str == "yrotation") *pChannel = CH_YROTATION;
+			else if (Str == "zrotation") *pChannel = CH_ZROTATION;
+			else return false;
+			return true;
+		}//parseChannel
+
+		/**
+		* \brief Reads HIERARCHY and the MOTION header. The stream stands behind the frame time afterwards.
+		*/
+		void readHeader(std::istream& In, std::vector<Joint>* pJoints, int64_t* pFrameCount, float* pFrameTime) {
+			std::string Tok;
+			if (!(In >> Tok) || Tok != "HIERARCHY") throw CForgeExcept("Missing HIERARCHY");
+
+			std::vector<int32_t> Stack; // open joints, -1 for End Sites
+			int32_t Pending = -1;
+
+			while (In >> Tok) {
+				if (Tok == "ROOT" || Tok == "JOINT") {
+					Joint J;
+					if (!(In >> J.Name)) throw CForgeExcept("Missing joint name");
+					J.Parent = Stack.empty() ? -1 : Stack.back();
+					J.Offset = Eigen::Vector3f::Zero();
+					if (Tok == "JOINT" && J.Parent < 0) throw CForgeExcept("Joint " + J.Name + " has no parent");
+					Pending = int32_t(pJoints->size());
+					pJoints->push_back(J);
+				}
+				else if (Tok == "End") {
+					In >> Tok; // Site
+					Pending = -1;
+				}
+				else if (Tok == "{") {
+					Stack.push_back(Pending);
+					Pending = -1;
+				}
+				else if (Tok == "}") {
+					if (Stack.empty()) throw CForgeExcept("Unbalanced braces");
+					Stack.pop_back();
+				}
+				else if (Tok == "OFFSET") {
+					Eigen::Vector3f Offset;
+					if (!(In >> Offset.x() >> Offset.y() >> Offset.z())) throw CForgeExcept("Malformed OFFSET");
+					if (!Stack.empty() && Stack.back() >= 0) (*pJoints)[Stack.back()].Offset = Offset;
+				}
+				else if (Tok == "CHANNELS") {
+					uint32_t Count = 0;
+					if (!(In >> Count) || Stack.empty() || Stack.back() < 0) throw CForgeExcept("Malformed CHANNELS");
+					Joint& J = (*pJoints)[Stack.back()];
+					for (uint32_t i = 0; i < Count; ++i) {
+						Channel C;
+						if (!(In >> Tok) || !parseChannel(Tok, &C)) throw CForgeExcept("Unknown channel " + Tok);
+						J.Channels.push_back(C);
+					}
+				}
+				else if (Tok == "MOTION") {
+					break;
+				}
+				else {
+					throw CForgeExcept("Unexpected token " + Tok);
+				}
+			}//while[hierarchy]
+
+			if (Tok != "MOTION" || !Stack.empty() || pJoints->empty()) throw CForgeExcept("Incomplete HIERARCHY");
+
+			if (!(In >> Tok) || Tok != "Frames:" || !(In >> (*pFrameCount))) throw CForgeExcept("Missing frame count");
+			if (!(In >> Tok) || Tok != "Frame" || !(In >> Tok) || Tok != "Time:" || !(In >> (*pFrameTime))) throw CForgeExcept("Missing frame time");
+			if (*pFrameCount < 0 || !(*pFrameTime > 0.0f)) throw CForgeExcept("Invalid frame count or frame time");
+		}//readHeader
+
+		/**
+		* \brief Parses one frame line into the keyframes of the selected joints.
+		* \return False if the line has too few or malformed values.
+		*/
+		bool parseFrame(const char* p, const char* pEnd, const std::vector<Joint>& Joints, const std::vector<T3DMesh<float>::BoneKeyframes*>& JointKeys, size_t Key) {
+			for (size_t j = 0; j < Joints.size(); ++j) {
+				const Joint& J = Joints[j];
+				T3DMesh<float>::BoneKeyframes* pKeys = JointKeys[j];
+
+				Eigen::Vector3f Position = J.Offset;
+				Eigen::Quaternionf Rotation = Eigen::Quaternionf::Identity();
+
+				for (Channel C : J.Channels) {
+					p = skipBlanks(p, pEnd);
+					if (p == pEnd) return false;
+
+					// values of joints that are not loaded are only skipped
+					if (nullptr == pKeys) {
+						while (p < pEnd && !isBlank(*p)) p++;
+						continue;
+					}
+
+					float Value = 0.0f;
+					auto Res = std::from_chars(p, pEnd, Value);
+					if (Res.ec != std::errc()) return false;
+					p = Res.ptr;
+
+					switch (C) {
+					case CH_XPOSITION: Position.x() = Value; break;
+					case CH_YPOSITION: Position.y() = Value; break;
+					case CH_ZPOSITION: Position.z() = Value; break;
+					case CH_XROTATION: Rotation = Rotation * Eigen::AngleAxisf(CForgeMath::degToRad(Value), Eigen::Vector3f::UnitX()); break;
+					case CH_YROTATION: Rotation = Rotation * Eigen::AngleAxisf(CForgeMath::degToRad(Value), Eigen::Vector3f::UnitY()); break;
+					case CH_ZROTATION: Rotation = Rotation * Eigen::AngleAxisf(CForgeMath::degToRad(Value), Eigen::Vector3f::UnitZ()); break;
+					}
+				}//for[channels]
+
+				if (nullptr != pKeys) {
+					pKeys->Positions[Key] = Position;
+					pKeys->Rotations[Key] = Rotation.normalized();
+				}
+			}//for[joints]
+			return true;
+		}//parseFrame
+
+	}//anonymous
+
+	BVHIO::BVHIO(void) : I3DMeshIO("BVHIO") {
+		m_PluginName = "BVH Motion IO";
+	}//Constructor
+
+	BVHIO::~BVHIO(void) {
+		clear();
+	}//Destructor
+
+	void BVHIO::init(void) {
+
+	}//initialize
+
+	void BVHIO::clear(void) {
+
+	}//clear
+
+	void BVHIO::release(void) {
+		delete this;
+	}//release
+
+	bool BVHIO::accepted(const std::string Filepath, Operation Op) {
+		if (Op != OP_LOAD) return false;
+		const std::string Str = CForgeUtility::toLowerCase(Filepath);
+		return Str.size() >= Extension.size() && Str.compare(Str.size() - Extension.size(), Extension.size(), Extension) == 0;
+	}//accepted
+
+	void BVHIO::load(const std::string Filepath, T3DMesh<float>* pMesh) {
+		read(Filepath, pMesh, Selection());
+	}//load
+
+	void BVHIO::store(const std::string Filepath, const T3DMesh<float>* pMesh) {
+		throw CForgeExcept("Storing BVH files is not supported");
+	}//store
+
+	void BVHIO::read(const std::string Filepath, T3DMesh<float>* pMesh, const Selection& Sel) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+
+		std::ifstream In(Filepath, std::ios::in | std::ios::binary);
+		if (!In) throw CForgeExcept("Failed to open " + Filepath);
+
+		std::vector<Joint> Joints;
+		int64_t FrameCount = 0;
+		float FrameTime = 0.0f;
+		try {
+			readHeader(In, &Joints, &FrameCount, &FrameTime);
+		}
+		catch (const CrossForgeException& e) {
+			throw CForgeExcept("Invalid BVH file " + Filepath + ": " + e.msg());
+		}
+
+		// requested frames [FirstFrame, LastFrame)
+		const int64_t FirstFrame = std::min(FrameCount, std::max(int64_t(0), int64_t(std::ceil(Sel.Begin / FrameTime - 1e-3f))));
+		const int64_t LastFrame = (Sel.End < 0.0f) ? FrameCount : std::max(FirstFrame, std::min(FrameCount, int64_t(std::floor(Sel.End / FrameTime + 1e-3f)) + 1));
+		const size_t KeyCount = size_t(LastFrame - FirstFrame);
+
+		// skeleton with bind pose given by the offsets
+		T3DMesh<float> M;
+		std::vector<T3DMesh<float>::Bone*> Bones;
+		std::vector<Eigen::Vector3f> GlobalOffsets(Joints.size());
+		for (size_t i = 0; i < Joints.size(); ++i) {
+			T3DMesh<float>::Bone* pBone = new T3DMesh<float>::Bone();
+			pBone->ID = int32_t(i);
+			pBone->Name = Joints[i].Name;
+			GlobalOffsets[i] = Joints[i].Offset;
+			if (Joints[i].Parent >= 0) {
+				pBone->pParent = Bones[Joints[i].Parent];
+				pBone->pParent->Children.push_back(pBone);
+				GlobalOffsets[i] += GlobalOffsets[Joints[i].Parent];
+			}
+			pBone->InvBindPoseMatrix = Eigen::Matrix4f::Identity();
+			pBone->InvBindPoseMatrix.block<3, 1>(0, 3) = -GlobalOffsets[i];
+			Bones.push_back(pBone);
+		}//for[joints]
+		M.bones(&Bones, false);
+
+		// keyframe arrays are sized upfront and written by the frame parsers
+		T3DMesh<float>::SkeletalAnimation* pAnim = new T3DMesh<float>::SkeletalAnimation();
+		pAnim->Name = File::retrieveFilename(Filepath);
+		pAnim->SamplesPerSecond = 1.0f / FrameTime;
+		std::vector<T3DMesh<float>::BoneKeyframes*> JointKeys(Joints.size(), nullptr);
+		for (size_t i = 0; i < Joints.size(); ++i) {
+			if (!Sel.Joints.empty() && Sel.Joints.end() == std::find(Sel.Joints.begin(), Sel.Joints.end(), Joints[i].Name)) continue;
+			T3DMesh<float>::BoneKeyframes* pKeys = new T3DMesh<float>::BoneKeyframes();
+			pKeys->ID = int32_t(pAnim->Keyframes.size());
+			pKeys->BoneID = int32_t(i);
+			pKeys->BoneName = Joints[i].Name;
+			pKeys->Positions.resize(KeyCount);
+			pKeys->Rotations.resize(KeyCount);
+			pKeys->Scalings.assign(KeyCount, Eigen::Vector3f::Ones());
+			pKeys->Timestamps.resize(KeyCount);
+			for (size_t k = 0; k < KeyCount; ++k) pKeys->Timestamps[k] = float(k);
+			JointKeys[i] = pKeys;
+			pAnim->Keyframes.push_back(pKeys);
+		}//for[joints]
+		M.addSkeletalAnimation(pAnim, false);
+
+		// stream the frames, one line per frame
+		std::vector<char> Buffer(m_ChunkSize);
+		std::vector<std::pair<const char*, const char*>> Lines;
+		size_t Filled = 0;
+		int64_t Frame = 0;
+		bool Eof = false;
+
+		while (Frame < LastFrame && !Eof) {
+			In.read(Buffer.data() + Filled, Buffer.size() - Filled);
+			Filled += size_t(In.gcount());
+			Eof = !In;
+
+			// collect the complete lines, the last line of the file may miss its line break
+			Lines.clear();
+			const char* p = Buffer.data();
+			const char* pEnd = Buffer.data() + Filled;
+			while (p < pEnd && Frame < LastFrame) {
+				const char* pLineEnd = (const char*)std::memchr(p, '\n', pEnd - p);
+				if (nullptr == pLineEnd) {
+					if (!Eof) break;
+					pLineEnd = pEnd;
+				}
+				if (skipBlanks(p, pLineEnd) != pLineEnd) {
+					if (Frame >= FirstFrame) Lines.push_back(std::make_pair(p, pLineEnd));
+					Frame++;
+				}
+				p = (pLineEnd == pEnd) ? pEnd : pLineEnd + 1;
+			}//while[lines]
+
+			// frames are independent, every worker parses a contiguous range of lines
+			const int64_t FirstKey = Frame - int64_t(Lines.size()) - FirstFrame;
+			std::atomic<bool> Malformed(false);
+			parallelFor(0, Lines.size(), [&](size_t Begin, size_t End) {
+				for (size_t i = Begin; i < End && !Malformed; ++i) {
+					if (!parseFrame(Lines[i].first, Lines[i].second, Joints, JointKeys, size_t(FirstKey) + i)) Malformed = true;
+				}
+			}, 1024);
+			if (Malformed) throw CForgeExcept("Malformed frame in " + Filepath);
+
+			// keep the incomplete last line for the next chunk
+			const size_t Remainder = size_t(pEnd - p);
+			if (Remainder == Buffer.size()) Buffer.resize(Buffer.size() * 2); // line longer than a chunk
+			else std::memmove(Buffer.data(), p, Remainder);
+			Filled = Remainder;
+		}//while[chunks]
+
+		// files may announce more frames than they contain
+		const size_t Loaded = size_t(std::max(int64_t(0), std::min(Frame, LastFrame) - FirstFrame));
+		if (Loaded < KeyCount) {
+			for (auto i : pAnim->Keyframes) {
+				i->Positions.resize(Loaded);
+				i->Rotations.resize(Loaded);
+				i->Scalings.resize(Loaded);
+				i->Timestamps.resize(Loaded);
+			}
+		}
+		pAnim->Duration = (Loaded > 0) ? float(Loaded - 1) : 0.0f;
+
+		pMesh->clear();
+		pMesh->swap(M);
+	}//read
+
+}//name space
@@ -0,0 +1,122 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): BVHIO.h and BVHIO.cpp                                            *
+*                                                                           *
+* Content: Import plugin for BVH motion capture files.                      *
+*                                                                           *
+*                                                                           *
+*                                                                           *
+* Author(s): Simon Kretzschmar                                              *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_BVHIO_H__
+#define __CFORGE_BVHIO_H__
+
+#include "I3DMeshIO.h"
+
+namespace CForge {
+	/**
+	* \brief Import plugin for BVH motion capture files (.bvh).
+	* \ingroup AssetIO
+	*
+	* Joints of the hierarchy become bones, End Sites are skipped. The MOTION section is streamed in chunks of whole
+	* frames, the frames of a chunk are parsed in parallel straight into the keyframe arrays, so the text of the file
+	* is never held in memory. Reading stops after the last requested frame.
+	* Keyframes follow the convention of the Assimp BVH importer: one BoneKeyframes per joint, positions are the
+	* joint offset with the position channels replacing their component, rotations are the rotation channels
+	* combined in file order, timestamps and duration are in frames and SamplesPerSecond is 1 / Frame Time.
+	* Unlike the Assimp importer it also creates the bones with bind pose and sets BoneID of the keyframes.
+	* The plugin is not registered with SAssetIO, which keeps loading .bvh files through Assimp. Use read to load
+	* a file, or a part of it.
+	*/
+	class CFORGE_API BVHIO : public I3DMeshIO {
+	public:
+		/**
+		* \brief Part of a file to load.
+		*/
+		struct Selection {
+			float Begin;						///< Time of the first frame to load in seconds.
+			float End;							///< Time of the last frame to load in seconds, negative loads to the end.
+			std::vector<std::string> Joints;	///< Joints that get keyframes, empty for all. The skeleton is always complete.
+
+			Selection(void) {
+				Begin = 0.0f;
+				End = -1.0f;
+			}
+		};
+
+		/**
+		* \brief Constructor.
+		*/
+		BVHIO(void);
+
+		/**
+		* \brief Destructor
+		*/
+		~BVHIO(void);
+
+		/**
+		* \brief Initialization method.
+		*/
+		void init(void);
+
+		/**
+		* \brief Clear method.
+		*/
+		void clear(void);
+
+		/**
+		* \brief Release method.
+		*/
+		void release(void) override;
+
+		/**
+		* \brief Returns whether the plugin accepts a file for a certain operation. Only loading is supported.
+		*
+		* \param[in] Filepath URI to the resource.
+		* \param[in] Op Operation to check.
+		* \return Whether the plugin can process the specified file.
+		*/
+		bool accepted(const std::string Filepath, Operation Op) override;
+
+		/**
+		* \brief Loads the skeleton and all frames of the file.
+		*
+		* \param[in] Filepath URI to the resource.
+		* \param[out] pMesh Data structure where the data will be stored to.
+		* \throws CrossForgeException if the file can not be read or is malformed.
+		*/
+		void load(const std::string Filepath, T3DMesh<float>* pMesh) override;
+
+		/**
+		* \brief Not supported.
+		*
+		* \throws CrossForgeException always.
+		*/
+		void store(const std::string Filepath, const T3DMesh<float>* pMesh) override;
+
+		/**
+		* \brief Loads the skeleton and a selected part of the motion.
+		*
+		* \param[in] Filepath Path to the .bvh file.
+		* \param[out] pMesh Receives bones and one skeletal animation.
+		* \param[in] Sel Time range and joints to load.
+		* \throws CrossForgeException if the file can not be read or is malformed.
+		*/
+		static void read(const std::string Filepath, T3DMesh<float>* pMesh, const Selection& Sel);
+
+		static const std::string Extension;	///< File extension including the dot.
+
+	protected:
+		static const size_t m_ChunkSize = 16 << 20;	///< Bytes of the MOTION section read at once.
+	};//BVHIO
+
+}//name space
+
+#endif
@@ -0,0 +1,643 @@
+#include "CFMeshIO.h"
+#include "File.h"
+#include "../Utility/CForgeUtility.h"
+
+#include <cstring>
+#include <map>
+#include <thread>
+
+namespace CForge {
+
+	const std::string CFMeshIO::Extension = ".cfmesh";
+
+	namespace {
+
+		enum SectionType : uint32_t {
+			SEC_POSITIONS = 0,
+			SEC_NORMALS,
+			SEC_TANGENTS,
+			SEC_UVWS,
+			SEC_COLORS,
+			SEC_STRINGS,			///< Characters of all names and paths.
+			SEC_STRING_LIST,		///< Ranges into SEC_STRINGS, for lists of strings.
+			SEC_SUBMESHES,
+			SEC_FACES,
+			SEC_FACE_NORMALS,
+			SEC_FACE_TANGENTS,
+			SEC_MATERIALS,
+			SEC_BONES,
+			SEC_BONE_CHILDREN,
+			SEC_BONE_INFLUENCES,
+			SEC_BONE_WEIGHTS,
+			SEC_ANIMATIONS,
+			SEC_KEYFRAMES,
+			SEC_KEY_POSITIONS,
+			SEC_KEY_ROTATIONS,
+			SEC_KEY_SCALINGS,
+			SEC_KEY_TIMESTAMPS,
+			SEC_MORPHTARGETS,
+			SEC_MORPH_VERTEX_IDS,
+			SEC_MORPH_VERTEX_OFFSETS,
+			SEC_MORPH_NORMAL_OFFSETS,
+			SEC_COUNT,
+		};
+
+		const uint64_t Alignment = 64;
+
+		struct Header {
+			uint32_t Magic;
+			uint32_t Version;
+			uint64_t FileSize;
+			uint64_t SourceKey;
+			uint32_t SectionCount;
+			uint32_t Reserved;
+			float AABBMin[3];
+			float AABBMax[3];
+			uint8_t Padding[8];
+		};
+
+		struct SectionEntry {
+			uint32_t Type;
+			uint32_t ElementSize;
+			uint64_t Offset;
+			uint64_t Count;
+		};
+
+		struct Range {
+			uint64_t Begin;
+			uint64_t Count;
+		};
+
+		struct SubmeshRecord {
+			int32_t Material;
+			uint32_t Reserved;
+			Range Faces;
+			Range FaceNormals;
+			Range FaceTangents;
+		};
+
+		struct MaterialRecord {
+			int32_t ID;
+			float Color[4];
+			float Metallic;
+			float Roughness;
+			uint32_t Reserved;
+			Range Textures[6];	///< Albedo, normal, depth, metallic-roughness, emissive, occlusion.
+			Range Shaders[6];	///< Ranges into SEC_STRING_LIST. Geometry, shadow and forward pass, vertex and fragment each.
+		};
+
+		struct BoneRecord {
+			int32_t ID;
+			int32_t Parent;		///< Index in the bone array, -1 for none.
+			float InvBindPoseMatrix[16];
+			Range Name;
+			Range Children;
+			Range Influences;	///< Into SEC_BONE_INFLUENCES and SEC_BONE_WEIGHTS.
+		};
+
+		struct AnimationRecord {
+			float Duration;
+			float SamplesPerSecond;
+			Range Name;
+			Range Keyframes;
+		};
+
+		struct KeyframeRecord {
+			int32_t ID;
+			int32_t BoneID;
+			Range BoneName;
+			Range Positions;
+			Range Rotations;
+			Range Scalings;
+			Range Timestamps;
+		};
+
+		struct MorphTargetRecord {
+			int32_t ID;
+			uint32_t Reserved;
+			Range Name;
+			Range Vertices;		///< Into SEC_MORPH_VERTEX_IDS and SEC_MORPH_VERTEX_OFFSETS.
+			Range NormalOffsets;
+		};
+
+		static_assert(sizeof(Header) == 64, "Header has to fill one alignment block");
+		static_assert(sizeof(Eigen::Vector3f) == 12 && sizeof(Eigen::Quaternionf) == 16, "Unexpected Eigen layout");
+		static_assert(sizeof(T3DMesh<float>::Face) == 12, "Unexpected face layout");
+
+		/**
+		* \brief Collects the sections of a file in memory.
+		*/
+		class Writer {
+		public:
+			Writer(void) {
+				m_Sections.resize(SEC_COUNT);
+				m_ElementSizes.assign(SEC_COUNT, 1);
+			}
+
+			template<typename T>
+			Range add(SectionType Type, const T* pData, uint64_t Count) {
+				std::vector<uint8_t>& S = m_Sections[Type];
+				m_ElementSizes[Type] = sizeof(T);
+				Range R = { S.size() / sizeof(T), Count };
+				if (Count > 0) S.insert(S.end(), (const uint8_t*)pData, (const uint8_t*)pData + Count * sizeof(T));
+				return R;
+			}//add
+
+			template<typename T>
+			Range add(SectionType Type, const std::vector<T>& Data) {
+				return add(Type, Data.data(), Data.size());
+			}//add
+
+			Range add(const std::string& Str) {
+				return add(SEC_STRINGS, Str.data(), Str.size());
+			}//add
+
+			Range add(const std::vector<std::string>& List) {
+				std::vector<Range> Refs;
+				for (const auto& i : List) Refs.push_back(add(i));
+				return add(SEC_STRING_LIST, Refs);
+			}//add
+
+			void write(const std::string Filepath, Header H) {
+				std::vector<SectionEntry> Table;
+				uint64_t Offset = pad(sizeof(Header) + SEC_COUNT * sizeof(SectionEntry));
+				for (uint32_t i = 0; i < SEC_COUNT; ++i) {
+					SectionEntry E;
+					E.Type = i;
+					E.ElementSize = m_ElementSizes[i];
+					E.Offset = Offset;
+					E.Count = m_Sections[i].size() / m_ElementSizes[i];
+					Table.push_back(E);
+					Offset = pad(Offset + m_Sections[i].size());
+				}
+				H.SectionCount = SEC_COUNT;
+				H.FileSize = Offset;
+
+				File F;
+				F.begin(Filepath, "wb");
+				uint64_t Written = 0;
+				auto Put = [&](const void* pData, uint64_t Size) {
+					// File::write takes 32 bit counts
+					const uint8_t* p = (const uint8_t*)pData;
+					while (Size > 0) {
+						const uint64_t Chunk = std::min<uint64_t>(Size, 1 << 30);
+						F.write(p, Chunk);
+						p += Chunk;
+						Size -= Chunk;
+						Written += Chunk;
+					}
+				};
+				const uint8_t Zeros[Alignment] = { 0 };
+				auto Pad = [&]() {
+					if (pad(Written) != Written) Put(Zeros, pad(Written) - Written);
+				};
+
+				Put(&H, sizeof(Header));
+				Put(Table.data(), Table.size() * sizeof(SectionEntry));
+				Pad();
+				for (auto& i : m_Sections) {
+					Put(i.data(), i.size());
+					Pad();
+				}
+				F.end();
+			}//write
+
+		private:
+			static uint64_t pad(uint64_t Offset) {
+				return (Offset + Alignment - 1) / Alignment * Alignment;
+			}
+
+			std::vector<std::vector<uint8_t>> m_Sections;
+			std::vector<uint32_t> m_ElementSizes;
+		};//Writer
+
+		/**
+		* \brief Bounds checked access to the sections of a mapped file.
+		*/
+		class Reader {
+		public:
+			bool init(const uint8_t* pData, uint64_t Size, uint32_t Magic, uint32_t Version) {
+				if (Size < sizeof(Header)) return false;
+				memcpy(&m_Header, pData, sizeof(Header));
+				if (m_Header.Magic != Magic || m_Header.Version != Version || m_Header.FileSize != Size) return false;
+				if (m_Header.SectionCount > (Size - sizeof(Header)) / sizeof(SectionEntry)) return false;
+
+				m_Sections.assign(SEC_COUNT, SectionEntry{ 0, 0, 0, 0 });
+				for (uint32_t i = 0; i < m_Header.SectionCount; ++i) {
+					SectionEntry E;
+					memcpy(&E, pData + sizeof(Header) + i * sizeof(SectionEntry), sizeof(SectionEntry));
+					if (E.ElementSize == 0 || E.Offset % Alignment != 0 || E.Offset > Size) return false;
+					if (E.Count > (Size - E.Offset) / E.ElementSize) return false;
+					if (E.Type < SEC_COUNT) m_Sections[E.Type] = E; // unknown sections of newer writers are skipped
+				}
+				m_pData = pData;
+				return true;
+			}//init
+
+			const Header& header(void)const {
+				return m_Header;
+			}
+
+			template<typename T>
+			const T* get(SectionType Type, Range R)const {
+				const SectionEntry& E = m_Sections[Type];
+				if (R.Count == 0) return nullptr;
+				if (E.ElementSize != sizeof(T) || R.Begin > E.Count || R.Count > E.Count - R.Begin) throw CForgeExcept("Invalid section range");
+				return (const T*)(m_pData + E.Offset) + R.Begin;
+			}//get
+
+			template<typename T>
+			Range all(SectionType Type)const {
+				const SectionEntry& E = m_Sections[Type];
+				if (E.Count > 0 && E.ElementSize != sizeof(T)) throw CForgeExcept("Invalid section element size");
+				return Range{ 0, E.Count };
+			}//all
+
+			template<typename T>
+			void copy(SectionType Type, Range R, std::vector<T>* pTarget)const {
+				const T* pSource = get<T>(Type, R);
+				// element wise, Eigen types and Face are not trivially copyable
+				if (R.Count > 0) pTarget->assign(pSource, pSource + R.Count);
+				else pTarget->clear();
+			}//copy
+
+			std::string string(Range R)const {
+				const char* p = get<char>(SEC_STRINGS, R);
+				return (nullptr == p) ? std::string() : std::string(p, R.Count);
+			}//string
+
+			std::vector<std::string> stringList(Range R)const {
+				std::vector<std::string> Rval;
+				const Range* p = get<Range>(SEC_STRING_LIST, R);
+				for (uint64_t i = 0; i < R.Count; ++i) Rval.push_back(string(p[i]));
+				return Rval;
+			}//stringList
+
+		private:
+			const uint8_t* m_pData = nullptr;
+			Header m_Header;
+			std::vector<SectionEntry> m_Sections;
+		};//Reader
+
+		/**
+		* \brief Fills pMesh from the mapped file. Throws on malformed content.
+		*/
+		void readMesh(const Reader& R, T3DMesh<float>* pMesh) {
+			std::vector<Eigen::Vector3f> Buffer;
+
+			R.copy(SEC_POSITIONS, R.all<Eigen::Vector3f>(SEC_POSITIONS), &Buffer);
+			const int64_t VertexCount = Buffer.size();
+			pMesh->vertices(&Buffer);
+			R.copy(SEC_NORMALS, R.all<Eigen::Vector3f>(SEC_NORMALS), &Buffer);
+			pMesh->normals(&Buffer);
+			R.copy(SEC_TANGENTS, R.all<Eigen::Vector3f>(SEC_TANGENTS), &Buffer);
+			pMesh->tangents(&Buffer);
+			R.copy(SEC_UVWS, R.all<Eigen::Vector3f>(SEC_UVWS), &Buffer);
+			pMesh->textureCoordinates(&Buffer);
+			R.copy(SEC_COLORS, R.all<Eigen::Vector3f>(SEC_COLORS), &Buffer);
+			pMesh->colors(&Buffer);
+
+			const Range MatRange = R.all<MaterialRecord>(SEC_MATERIALS);
+			const MaterialRecord* pMats = R.get<MaterialRecord>(SEC_MATERIALS, MatRange);
+			for (uint64_t i = 0; i < MatRange.Count; ++i) {
+				const MaterialRecord& Rec = pMats[i];
+				T3DMesh<float>::Material* pMat = new T3DMesh<float>::Material();
+				pMesh->addMaterial(pMat, false);
+				pMat->ID = Rec.ID;
+				pMat->Color = Eigen::Vector4f(Rec.Color[0], Rec.Color[1], Rec.Color[2], Rec.Color[3]);
+				pMat->Metallic = Rec.Metallic;
+				pMat->Roughness = Rec.Roughness;
+				pMat->TexAlbedo = R.string(Rec.Textures[0]);
+				pMat->TexNormal = R.string(Rec.Textures[1]);
+				pMat->TexDepth = R.string(Rec.Textures[2]);
+				pMat->TexMetallicRoughness = R.string(Rec.Textures[3]);
+				pMat->TexEmissive = R.string(Rec.Textures[4]);
+				pMat->TexOcclusion = R.string(Rec.Textures[5]);
+				pMat->VertexShaderGeometryPass = R.stringList(Rec.Shaders[0]);
+				pMat->FragmentShaderGeometryPass = R.stringList(Rec.Shaders[1]);
+				pMat->VertexShaderShadowPass = R.stringList(Rec.Shaders[2]);
+				pMat->FragmentShaderShadowPass = R.stringList(Rec.Shaders[3]);
+				pMat->VertexShaderForwardPass = R.stringList(Rec.Shaders[4]);
+				pMat->FragmentShaderForwardPass = R.stringList(Rec.Shaders[5]);
+			}//for[materials]
+
+			const Range SubRange = R.all<SubmeshRecord>(SEC_SUBMESHES);
+			const SubmeshRecord* pSubs = R.get<SubmeshRecord>(SEC_SUBMESHES, SubRange);
+			for (uint64_t i = 0; i < SubRange.Count; ++i) {
+				T3DMesh<float>::Submesh* pSub = new T3DMesh<float>::Submesh();
+				pMesh->addSubmesh(pSub, false);
+				pSub->Material = pSubs[i].Material;
+				R.copy(SEC_FACES, pSubs[i].Faces, &pSub->Faces.write());
+				R.copy(SEC_FACE_NORMALS, pSubs[i].FaceNormals, &pSub->FaceNormals.write());
+				R.copy(SEC_FACE_TANGENTS, pSubs[i].FaceTangents, &pSub->FaceTangents.write());
+				for (const auto& F : pSub->Faces) {
+					for (uint8_t k = 0; k < 3; ++k) {
+						if (F.Vertices[k] < 0 || F.Vertices[k] >= VertexCount) throw CForgeExcept("Face references invalid vertex");
+					}
+				}
+			}//for[submeshes]
+
+			const Range BoneRange = R.all<BoneRecord>(SEC_BONES);
+			const BoneRecord* pBoneRecs = R.get<BoneRecord>(SEC_BONES, BoneRange);
+			if (BoneRange.Count > 0) {
+				std::vector<T3DMesh<float>::Bone*> Bones;
+				for (uint64_t i = 0; i < BoneRange.Count; ++i) Bones.push_back(new T3DMesh<float>::Bone());
+				// possession goes to the mesh right away so the bones are released if anything below throws
+				pMesh->bones(&Bones, false);
+
+				for (uint64_t i = 0; i < BoneRange.Count; ++i) {
+					const BoneRecord& Rec = pBoneRecs[i];
+					T3DMesh<float>::Bone* pBone = Bones[i];
+					pBone->ID = Rec.ID;
+					pBone->Name = R.string(Rec.Name);
+					memcpy(pBone->InvBindPoseMatrix.data(), Rec.InvBindPoseMatrix, sizeof(Rec.InvBindPoseMatrix));
+					if (Rec.Parent >= int32_t(BoneRange.Count)) throw CForgeExcept("Invalid parent bone");
+					pBone->pParent = (Rec.Parent < 0) ? nullptr : Bones[Rec.Parent];
+					const int32_t* pChildren = R.get<int32_t>(SEC_BONE_CHILDREN, Rec.Children);
+					for (uint64_t k = 0; k < Rec.Children.Count; ++k) {
+						if (pChildren[k] < 0 || pChildren[k] >= int32_t(BoneRange.Count)) throw CForgeExcept("Invalid child bone");
+						pBone->Children.push_back(Bones[pChildren[k]]);
+					}
+					R.copy(SEC_BONE_INFLUENCES, Rec.Influences, &pBone->VertexInfluences);
+					R.copy(SEC_BONE_WEIGHTS, Rec.Influences, &pBone->VertexWeights);
+					for (auto v : pBone->VertexInfluences) {
+						if (v < 0 || v >= VertexCount) throw CForgeExcept("Bone influences invalid vertex");
+					}
+				}//for[bones]
+				pMesh->findRootBone();
+			}
+
+			const Range AnimRange = R.all<AnimationRecord>(SEC_ANIMATIONS);
+			const AnimationRecord* pAnims = R.get<AnimationRecord>(SEC_ANIMATIONS, AnimRange);
+			for (uint64_t i = 0; i < AnimRange.Count; ++i) {
+				T3DMesh<float>::SkeletalAnimation* pAnim = new T3DMesh<float>::SkeletalAnimation();
+				pMesh->addSkeletalAnimation(pAnim, false);
+				pAnim->Name = R.string(pAnims[i].Name);
+				pAnim->Duration = pAnims[i].Duration;
+				pAnim->SamplesPerSecond = pAnims[i].SamplesPerSecond;
+
+				const KeyframeRecord* pKeys = R.get<KeyframeRecord>(SEC_KEYFRAMES, pAnims[i].Keyframes);
+				for (uint64_t k = 0; k < pAnims[i].Keyframes.Count; ++k) {
+					T3DMesh<float>::BoneKeyframes* pKey = new T3DMesh<float>::BoneKeyframes();
+					pAnim->Keyframes.push_back(pKey);
+					pKey->ID = pKeys[k].ID;
+					pKey->BoneID = pKeys[k].BoneID;
+					pKey->BoneName = R.string(pKeys[k].BoneName);
+					R.copy(SEC_KEY_POSITIONS, pKeys[k].Positions, &pKey->Positions);
+					R.copy(SEC_KEY_ROTATIONS, pKeys[k].Rotations, &pKey->Rotations);
+					R.copy(SEC_KEY_SCALINGS, pKeys[k].Scalings, &pKey->Scalings);
+					R.copy(SEC_KEY_TIMESTAMPS, pKeys[k].Timestamps, &pKey->Timestamps);
+				}
+			}//for[animations]
+
+			const Range MorphRange = R.all<MorphTargetRecord>(SEC_MORPHTARGETS);
+			const MorphTargetRecord* pMorphs = R.get<MorphTargetRecord>(SEC_MORPHTARGETS, MorphRange);
+			for (uint64_t i = 0; i < MorphRange.Count; ++i) {
+				T3DMesh<float>::MorphTarget* pMT = new T3DMesh<float>::MorphTarget();
+				pMesh->addMorphTarget(pMT, false);
+				pMT->Name = R.string(pMorphs[i].Name);
+				R.copy(SEC_MORPH_VERTEX_IDS, pMorphs[i].Vertices, &pMT->VertexIDs);
+				R.copy(SEC_MORPH_VERTEX_OFFSETS, pMorphs[i].Vertices, &pMT->VertexOffsets);
+				R.copy(SEC_MORPH_NORMAL_OFFSETS, pMorphs[i].NormalOffsets, &pMT->NormalOffsets);
+				for (auto v : pMT->VertexIDs) {
+					if (v < 0 || v >= VertexCount) throw CForgeExcept("Morph target references invalid vertex");
+				}
+			}//for[morph targets]
+
+			const Header& H = R.header();
+			pMesh->aabb().init(Eigen::Vector3f(H.AABBMin[0], H.AABBMin[1], H.AABBMin[2]), Eigen::Vector3f(H.AABBMax[0], H.AABBMax[1], H.AABBMax[2]));
+		}//readMesh
+
+		uint64_t fnv1a(const void* pData, uint64_t Size, uint64_t Hash) {
+			const uint8_t* p = (const uint8_t*)pData;
+			for (uint64_t i = 0; i < Size; ++i) {
+				Hash ^= p[i];
+				Hash *= 1099511628211ull;
+			}
+			return Hash;
+		}//fnv1a
+
+	}//anonymous name space
+
+	CFMeshIO::CFMeshIO(void) : I3DMeshIO("CFMeshIO") {
+		m_PluginName = "CrossForge Mesh IO";
+	}//Constructor
+
+	CFMeshIO::~CFMeshIO(void) {
+		clear();
+	}//Destructor
+
+	void CFMeshIO::init(void) {
+
+	}//initialize
+
+	void CFMeshIO::clear(void) {
+
+	}//clear
+
+	void CFMeshIO::release(void) {
+		delete this;
+	}//release
+
+	bool CFMeshIO::accepted(const std::string Filepath, Operation Op) {
+		const std::string Str = CForgeUtility::toLowerCase(Filepath);
+		return Str.size() >= Extension.size() && Str.compare(Str.size() - Extension.size(), Extension.size(), Extension) == 0;
+	}//accepted
+
+	void CFMeshIO::load(const std::string Filepath, T3DMesh<float>* pMesh) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+
+		MappedFile MF;
+		if (!MF.open(Filepath)) throw CForgeExcept("Failed to map file " + Filepath);
+		Reader R;
+		if (!R.init(MF.data(), MF.size(), m_Magic, m_Version)) throw CForgeExcept("File " + Filepath + " is not a valid version " + std::to_string(m_Version) + " .cfmesh file");
+
+		T3DMesh<float> M;
+		readMesh(R, &M);
+		pMesh->clear();
+		pMesh->swap(M);
+	}//load
+
+	void CFMeshIO::store(const std::string Filepath, const T3DMesh<float>* pMesh) {
+		write(Filepath, pMesh, 0);
+	}//store
+
+	bool CFMeshIO::read(const std::string Filepath, T3DMesh<float>* pMesh, uint64_t SourceKey) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+		if (!File::exists(Filepath)) return false;
+
+		MappedFile MF;
+		if (!MF.open(Filepath)) return false;
+		Reader R;
+		if (!R.init(MF.data(), MF.size(), m_Magic, m_Version) || R.header().SourceKey != SourceKey) return false;
+
+		T3DMesh<float> M;
+		try {
+			readMesh(R, &M);
+		}
+		catch (const CrossForgeException&) {
+			return false;
+		}
+		pMesh->clear();
+		pMesh->swap(M);
+		return true;
+	}//read
+
+	void CFMeshIO::write(const std::string Filepath, const T3DMesh<float>* pMesh, uint64_t SourceKey) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+		if (Filepath.empty()) throw CForgeExcept("Empty filepath specified");
+
+		Writer W;
+		std::vector<Eigen::Vector3f> Buffer;
+		Buffer.resize(pMesh->vertexCount());
+		for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) Buffer[i] = pMesh->vertex(i);
+		W.add(SEC_POSITIONS, Buffer);
+		Buffer.resize(pMesh->normalCount());
+		for (uint32_t i = 0; i < pMesh->normalCount(); ++i) Buffer[i] = pMesh->normal(i);
+		W.add(SEC_NORMALS, Buffer);
+		Buffer.resize(pMesh->tangentCount());
+		for (uint32_t i = 0; i < pMesh->tangentCount(); ++i) Buffer[i] = pMesh->tangent(i);
+		W.add(SEC_TANGENTS, Buffer);
+		Buffer.resize(pMesh->textureCoordinatesCount());
+		for (uint32_t i = 0; i < pMesh->textureCoordinatesCount(); ++i) Buffer[i] = pMesh->textureCoordinate(i);
+		W.add(SEC_UVWS, Buffer);
+		Buffer.resize(pMesh->colorCount());
+		for (uint32_t i = 0; i < pMesh->colorCount(); ++i) Buffer[i] = pMesh->color(i);
+		W.add(SEC_COLORS, Buffer);
+
+		std::vector<MaterialRecord> Materials;
+		for (uint32_t i = 0; i < pMesh->materialCount(); ++i) {
+			const T3DMesh<float>::Material* pMat = pMesh->getMaterial(i);
+			MaterialRecord Rec = {};
+			Rec.ID = pMat->ID;
+			for (uint8_t k = 0; k < 4; ++k) Rec.Color[k] = pMat->Color[k];
+			Rec.Metallic = pMat->Metallic;
+			Rec.Roughness = pMat->Roughness;
+			Rec.Textures[0] = W.add(pMat->TexAlbedo);
+			Rec.Textures[1] = W.add(pMat->TexNormal);
+			Rec.Textures[2] = W.add(pMat->TexDepth);
+			Rec.Textures[3] = W.add(pMat->TexMetallicRoughness);
+			Rec.Textures[4] = W.add(pMat->TexEmissive);
+			Rec.Textures[5] = W.add(pMat->TexOcclusion);
+			Rec.Shaders[0] = W.add(pMat->VertexShaderGeometryPass);
+			Rec.Shaders[1] = W.add(pMat->FragmentShaderGeometryPass);
+			Rec.Shaders[2] = W.add(pMat->VertexShaderShadowPass);
+			Rec.Shaders[3] = W.add(pMat->FragmentShaderShadowPass);
+			Rec.Shaders[4] = W.add(pMat->VertexShaderForwardPass);
+			Rec.Shaders[5] = W.add(pMat->FragmentShaderForwardPass);
+			Materials.push_back(Rec);
+		}//for[materials]
+		W.add(SEC_MATERIALS, Materials);
+
+		std::vector<SubmeshRecord> Submeshes;
+		for (uint32_t i = 0; i < pMesh->submeshCount(); ++i) {
+			const T3DMesh<float>::Submesh* pSub = pMesh->getSubmesh(i);
+			SubmeshRecord Rec = {};
+			Rec.Material = pSub->Material;
+			Rec.Faces = W.add(SEC_FACES, pSub->Faces.read());
+			Rec.FaceNormals = W.add(SEC_FACE_NORMALS, pSub->FaceNormals.read());
+			Rec.FaceTangents = W.add(SEC_FACE_TANGENTS, pSub->FaceTangents.read());
+			Submeshes.push_back(Rec);
+		}//for[submeshes]
+		W.add(SEC_SUBMESHES, Submeshes);
+
+		std::map<const T3DMesh<float>::Bone*, int32_t> BoneIndex;
+		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) BoneIndex[pMesh->getBone(i)] = i;
+		std::vector<BoneRecord> Bones;
+		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
+			const T3DMesh<float>::Bone* pBone = pMesh->getBone(i);
+			if (pBone->VertexInfluences.size() != pBone->VertexWeights.size()) throw CForgeExcept("Bone " + pBone->Name + " has different numbers of influences and weights");
+			BoneRecord Rec = {};
+			Rec.ID = pBone->ID;
+			Rec.Parent = (nullptr == pBone->pParent) ? -1 : BoneIndex.at(pBone->pParent);
+			memcpy(Rec.InvBindPoseMatrix, pBone->InvBindPoseMatrix.data(), sizeof(Rec.InvBindPoseMatrix));
+			Rec.Name = W.add(pBone->Name);
+			std::vector<int32_t> Children;
+			for (auto c : pBone->Children) Children.push_back(BoneIndex.at(c));
+			Rec.Children = W.add(SEC_BONE_CHILDREN, Children);
+			Rec.Influences = W.add(SEC_BONE_INFLUENCES, pBone->VertexInfluences);
+			W.add(SEC_BONE_WEIGHTS, pBone->VertexWeights);
+			Bones.push_back(Rec);
+		}//for[bones]
+		W.add(SEC_BONES, Bones);
+
+		std::vector<AnimationRecord> Animations;
+		std::vector<KeyframeRecord> Keyframes;
+		for (uint32_t i = 0; i < pMesh->skeletalAnimationCount(); ++i) {
+			const T3DMesh<float>::SkeletalAnimation* pAnim = pMesh->getSkeletalAnimation(i);
+			AnimationRecord Rec = {};
+			Rec.Duration = pAnim->Duration;
+			Rec.SamplesPerSecond = pAnim->SamplesPerSecond;
+			Rec.Name = W.add(pAnim->Name);
+			Rec.Keyframes = Range{ Keyframes.size(), pAnim->Keyframes.size() };
+			for (auto pKey : pAnim->Keyframes) {
+				KeyframeRecord K = {};
+				K.ID = pKey->ID;
+				K.BoneID = pKey->BoneID;
+				K.BoneName = W.add(pKey->BoneName);
+				K.Positions = W.add(SEC_KEY_POSITIONS, pKey->Positions);
+				K.Rotations = W.add(SEC_KEY_ROTATIONS, pKey->Rotations);
+				K.Scalings = W.add(SEC_KEY_SCALINGS, pKey->Scalings);
+				K.Timestamps = W.add(SEC_KEY_TIMESTAMPS, pKey->Timestamps);
+				Keyframes.push_back(K);
+			}
+			Animations.push_back(Rec);
+		}//for[animations]
+		W.add(SEC_ANIMATIONS, Animations);
+		W.add(SEC_KEYFRAMES, Keyframes);
+
+		std::vector<MorphTargetRecord> MorphTargets;
+		for (uint32_t i = 0; i < pMesh->morphTargetCount(); ++i) {
+			const T3DMesh<float>::MorphTarget* pMT = pMesh->getMorphTarget(i);
+			if (pMT->VertexIDs.size() != pMT->VertexOffsets.size()) throw CForgeExcept("Morph target " + pMT->Name + " has different numbers of vertices and offsets");
+			MorphTargetRecord Rec = {};
+			Rec.ID = pMT->ID;
+			Rec.Name = W.add(pMT->Name);
+			Rec.Vertices = W.add(SEC_MORPH_VERTEX_IDS, pMT->VertexIDs);
+			W.add(SEC_MORPH_VERTEX_OFFSETS, pMT->VertexOffsets);
+			Rec.NormalOffsets = W.add(SEC_MORPH_NORMAL_OFFSETS, pMT->NormalOffsets);
+			MorphTargets.push_back(Rec);
+		}//for[morph targets]
+		W.add(SEC_MORPHTARGETS, MorphTargets);
+
+		Header H = {};
+		H.Magic = m_Magic;
+		H.Version = m_Version;
+		H.SourceKey = SourceKey;
+		const Box AABB = pMesh->aabb();
+		for (uint8_t k = 0; k < 3; ++k) {
+			H.AABBMin[k] = AABB.min()[k];
+			H.AABBMax[k] = AABB.max()[k];
+		}
+
+		// unique temporary per thread, concurrent writers of the same file write the same content
+		const std::string Tmp = Filepath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		W.write(Tmp, H);
+		if (!File::rename(Tmp, Filepath)) {
+			File::remove(Tmp);
+			throw CForgeExcept("Failed to move " + Tmp + " to " + Filepath);
+		}
+	}//write
+
+	uint64_t CFMeshIO::sourceKey(const std::string Filepath, const std::string Loader, uint32_t LoaderVersion) {
+		if (!File::exists(Filepath)) throw CForgeExcept("File " + Filepath + " does not exist!");
+
+		uint64_t Hash = 14695981039346656037ull;
+		const int64_t Size = File::size(Filepath);
+		Hash = fnv1a(Loader.data(), Loader.size(), Hash);
+		Hash = fnv1a(&LoaderVersion, sizeof(LoaderVersion), Hash);
+		Hash = fnv1a(&Size, sizeof(Size), Hash);
+
+		const int64_t Block = 1 << 20;
+		std::vector<uint8_t> Buffer(std::min(Size, Block));
+		File F;
+		F.begin(Filepath, "rb");
+		if (!Buffer.empty()) {
+			uint64_t Read = 0;
+			while ((Read = F.read(Buffer.data(), Buffer.size())) > 0) Hash = fnv1a(Buffer.data(), Read, Hash);
+		}
+		F.end();
+		return Hash;
+	}//sourceKey
+
+}//name space
@@ -0,0 +1,131 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): CFMeshIO.h and CFMeshIO.cpp                                      *
+*                                                                           *
+* Content: Import/export plugin for the native binary mesh format.          *
+*                                                                           *
+*                                                                           *
+*                                                                           *
+* Author(s): Simon Kretzschmar                                              *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_CFMESHIO_H__
+#define __CFORGE_CFMESHIO_H__
+
+#include "I3DMeshIO.h"
+
+namespace CForge {
+	/**
+	* \brief 3D mesh import/export plugin for the native binary format (.cfmesh).
+	* \ingroup AssetIO
+	*
+	* A file is a header, a section table and the sections. Every section is a plain array of one element type,
+	* starts at a 64 byte aligned offset and is addressed by offset and size from the table, so the loader maps the
+	* file and fills the mesh with one bulk copy per array. Variable sized data (names, texture paths, keyframes of
+	* a bone, influences of a bone, ...) are records holding begin/count ranges into shared arrays.
+	* Stores everything T3DMesh holds: vertex attributes, submeshes with face normals and tangents, materials,
+	* bones with influences, skeletal animations, morph targets and the bounding box.
+	*
+	* The header also carries a source key (see sourceKey) so SAssetIO can use the format as sidecar cache of
+	* slow to parse source files.
+	*/
+	class CFORGE_API CFMeshIO : public I3DMeshIO {
+	public:
+		/**
+		* \brief Constructor.
+		*/
+		CFMeshIO(void);
+
+		/**
+		* \brief Destructor
+		*/
+		~CFMeshIO(void);
+
+		/**
+		* \brief Initialization method.
+		*/
+		void init(void);
+
+		/**
+		* \brief Clear method.
+		*/
+		void clear(void);
+
+		/**
+		* \brief Release method.
+		*/
+		void release(void) override;
+
+		/**
+		* \brief Returns whether the plugin accepts a file for a certain operation.
+		*
+		* \param[in] Filepath URI to the resource.
+		* \param[in] Op Operation to check.
+		* \return Whether the plugin can process the specified file.
+		*/
+		bool accepted(const std::string Filepath, Operation Op) override;
+
+		/**
+		* \brief Maps the file and copies its content into the T3DMesh structure.
+		*
+		* \param[in] Filepath URI to the resource.
+		* \param[out] pMesh Data structure where the data will be stored to.
+		* \throws CrossForgeException if the file is not a valid .cfmesh file.
+		*/
+		void load(const std::string Filepath, T3DMesh<float>* pMesh) override;
+
+		/**
+		* \brief Stores the specified data structure at the specified URI.
+		*
+		* \param[in] Filepath URI where the data will be located.
+		* \param[in] pMesh 3D mesh data that will be stored.
+		*/
+		void store(const std::string Filepath, const T3DMesh<float>* pMesh) override;
+
+		/**
+		* \brief Loads a file only if it was written for the expected source key.
+		*
+		* \param[in] Filepath Path to the .cfmesh file.
+		* \param[out] pMesh Receives the data, untouched if false is returned.
+		* \param[in] SourceKey Expected key, see sourceKey.
+		* \return False if the file does not exist, is not valid, has a different version or source key.
+		*/
+		static bool read(const std::string Filepath, T3DMesh<float>* pMesh, uint64_t SourceKey);
+
+		/**
+		* \brief Writes a mesh. The file is written to a temporary first and renamed, readers never see partial files.
+		*
+		* \param[in] Filepath Path to the .cfmesh file.
+		* \param[in] pMesh The mesh.
+		* \param[in] SourceKey Key stored in the header, 0 for files that are not a cache.
+		*/
+		static void write(const std::string Filepath, const T3DMesh<float>* pMesh, uint64_t SourceKey);
+
+		/**
+		* \brief Computes a key identifying the current state of a source file and the loader reading it.
+		*
+		* Hashes the loader name and version and the whole content of the file, so edits anywhere in the file as well
+		* as changes of the loader invalidate the cache.
+		* \param[in] Filepath Path to the source file.
+		* \param[in] Loader Name of the plug-in that loads the source file.
+		* \param[in] LoaderVersion Version of that plug-in, see I3DMeshIO::pluginVersion.
+		* \return The key.
+		*/
+		static uint64_t sourceKey(const std::string Filepath, const std::string Loader, uint32_t LoaderVersion);
+
+		static const std::string Extension;	///< File extension including the dot.
+
+	protected:
+		static const uint32_t m_Magic = 0x48534D43;	///< "CMSH" in a little endian file.
+		static const uint32_t m_Version = 1;		///< Files of other versions are rejected.
+	};//CFMeshIO
+
+}//name space
+
+#endif
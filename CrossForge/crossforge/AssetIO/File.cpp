@@ -10,6 +10,18 @@
 
 #include "File.h"
 
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace CForge {
 
 	bool File::exists(const std::string Path) {
@@ -63,6 +75,21 @@ namespace CForge {
 		return STD_FS::is_directory(Path);
 	}//isDirectory
 
+	int64_t File::lastWriteTime(const std::string Path) {
+		return int64_t(STD_FS::last_write_time(Path).time_since_epoch().count());
+	}//lastWriteTime
+
+	bool File::rename(const std::string From, const std::string To) {
+		std::error_code Err;
+		STD_FS::rename(From, To, Err);
+		return !Err;
+	}//rename
+
+	bool File::remove(const std::string Path) {
+		std::error_code Err;
+		return STD_FS::remove(Path, Err);
+	}//remove
+
 
 
 	File::File(void): CForgeObject("File") {
@@ -143,4 +170,80 @@ namespace CForge {
 		return (nullptr != m_pFile);
 	}//valid
 
+	MappedFile::MappedFile(void) {
+		m_pData = nullptr;
+		m_Size = 0;
+#if defined(_WIN32)
+		m_File = INVALID_HANDLE_VALUE;
+#else
+		m_File = nullptr;
+#endif
+		m_Mapping = nullptr;
+		m_FD = -1;
+	}//Constructor
+
+	MappedFile::~MappedFile(void) {
+		close();
+	}//Destructor
+
+	bool MappedFile::open(const std::string Filepath) {
+		close();
+#if defined(_WIN32)
+		m_File = CreateFileA(Filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_File == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER Size;
+		if (!GetFileSizeEx(m_File, &Size) || Size.QuadPart == 0) {
+			close();
+			return false;
+		}
+		m_Size = uint64_t(Size.QuadPart);
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (nullptr == m_Mapping) {
+			close();
+			return false;
+		}
+		m_pData = (const uint8_t*)MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		m_FD = ::open(Filepath.c_str(), O_RDONLY);
+		if (m_FD < 0) return false;
+		struct stat St;
+		if (fstat(m_FD, &St) != 0 || St.st_size == 0) {
+			close();
+			return false;
+		}
+		m_Size = uint64_t(St.st_size);
+		void* p = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_FD, 0);
+		m_pData = (p == MAP_FAILED) ? nullptr : (const uint8_t*)p;
+#endif
+		if (nullptr == m_pData) {
+			close();
+			return false;
+		}
+		return true;
+	}//open
+
+	void MappedFile::close(void) {
+#if defined(_WIN32)
+		if (nullptr != m_pData) UnmapViewOfFile(m_pData);
+		if (nullptr != m_Mapping) CloseHandle(m_Mapping);
+		if (m_File != INVALID_HANDLE_VALUE) CloseHandle(m_File);
+		m_Mapping = nullptr;
+		m_File = INVALID_HANDLE_VALUE;
+#else
+		if (nullptr != m_pData) munmap((void*)m_pData, m_Size);
+		if (m_FD >= 0) ::close(m_FD);
+		m_FD = -1;
+#endif
+		m_pData = nullptr;
+		m_Size = 0;
+	}//close
+
+	const uint8_t* MappedFile::data(void)const {
+		return m_pData;
+	}//data
+
+	uint64_t MappedFile::size(void)const {
+		return m_Size;
+	}//size
+
 }//name-space
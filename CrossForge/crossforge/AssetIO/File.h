@@ -109,6 +109,32 @@ namespace CForge {
 		*/
 		static std::string removeFilename(const std::string Path);
 
+		/**
+		* \brief Returns the last modification time of a file.
+		* 
+		* \param[in] Path Path to the file.
+		* \return Modification time in ticks of the file system clock. Only useful for comparisons.
+		* \throws std::fileystem::filesystem_error if an error occurs. 
+		*/
+		static int64_t lastWriteTime(const std::string Path);
+
+		/**
+		* \brief Renames or moves a file, replacing an existing target.
+		* 
+		* \param[in] From Current path.
+		* \param[in] To New path.
+		* \return True on success.
+		*/
+		static bool rename(const std::string From, const std::string To);
+
+		/**
+		* \brief Deletes a file.
+		* 
+		* \param[in] Path Path to the file.
+		* \return True if the file existed and was deleted.
+		*/
+		static bool remove(const std::string Path);
+
 		
 		/**
 		* \brief Constructor
@@ -181,4 +207,58 @@ namespace CForge {
 		std::string m_Path;	///< Path of the file.
 	};//CFile
 
+	/**
+	* \brief Read only memory mapping of a whole file.
+	* \ingroup AssetIO
+	*/
+	class CFORGE_API MappedFile {
+	public:
+		/**
+		* \brief Constructor
+		*/
+		MappedFile(void);
+
+		/**
+		* \brief Destructor
+		*/
+		~MappedFile(void);
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		* \brief Maps the file. Empty files can not be mapped.
+		*
+		* \param[in] Filepath Path to the file.
+		* \return True on success, false otherwise.
+		*/
+		bool open(const std::string Filepath);
+
+		/**
+		* \brief Unmaps the file.
+		*/
+		void close(void);
+
+		/**
+		* \brief Returns the mapped bytes.
+		*
+		* \return Pointer to the first byte or nullptr if no file is mapped.
+		*/
+		const uint8_t* data(void)const;
+
+		/**
+		* \brief Returns size of the mapped file.
+		*
+		* \return Size in bytes.
+		*/
+		uint64_t size(void)const;
+
+	protected:
+		const uint8_t* m_pData;	///< Mapped bytes.
+		uint64_t m_Size;		///< Size of the mapping in bytes.
+		void* m_File;			///< File handle (Windows).
+		void* m_Mapping;		///< Mapping handle (Windows).
+		int m_FD;				///< File descriptor (POSIX).
+	};//MappedFile
+
 }//name-space
\ No newline at end of file
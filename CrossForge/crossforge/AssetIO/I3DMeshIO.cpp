@@ -6,9 +6,13 @@ namespace CForge {
 		return m_PluginName;
 	}//pluginName
 
+	uint32_t I3DMeshIO::pluginVersion(void)const {
+		return m_PluginVersion;
+	}//pluginVersion
 
 	I3DMeshIO::I3DMeshIO(const std::string ClassName): CForgeObject("I3DMeshIO::" + ClassName) {
 		m_PluginName = "3DMeshIO base class";
+		m_PluginVersion = 1;
 	}//Constructor
 
 	I3DMeshIO::~I3DMeshIO(void) {
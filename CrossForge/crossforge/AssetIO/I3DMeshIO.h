@@ -74,6 +74,11 @@ namespace CForge {
 		*/
 		virtual std::string pluginName(void)const;
 
+		/**
+		* \brief Returns the version of the plug-in's loader. Part of the key of the mesh cache of SAssetIO, so it has
+		* to be increased whenever a change of the plug-in changes loaded meshes.
+		*/
+		virtual uint32_t pluginVersion(void)const;
 
 	protected:
 		/**
@@ -89,6 +94,7 @@ namespace CForge {
 		virtual ~I3DMeshIO(void);
 
 		std::string m_PluginName;		///< Name of the plug-in.
+		uint32_t m_PluginVersion;		///< Version of the plug-in's loader, see pluginVersion.
 	};//I3DMeshIO
 
 }//name space
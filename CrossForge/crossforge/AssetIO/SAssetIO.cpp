@@ -1,16 +1,21 @@
 #include "SAssetIO.h"
 #include "AssimpMeshIO.h"
+#include "CFMeshIO.h"
 #include "StbImageIO.h"
 #include "WebPImageIO.h"
 #include "JPEGTurboIO.h"
 #include "../Core/SLogger.h"
 #include "../AssetIO/File.h"
+#include "../Utility/CForgeUtility.h"
 
 namespace CForge {
 	SAssetIO* SAssetIO::m_pInstance = nullptr;
 	uint32_t SAssetIO::m_InstanceCount = 0;
+	bool SAssetIO::m_MeshCache = true;
+	std::mutex SAssetIO::m_InstanceMutex;
 	
 	SAssetIO* SAssetIO::instance(void) {
+		std::lock_guard<std::mutex> Lock(m_InstanceMutex);
 		if (nullptr == m_pInstance) {
 			m_pInstance = new SAssetIO();
 			m_pInstance->init();
@@ -39,6 +44,14 @@ namespace CForge {
 		return Rval;
 	}//readTextFile
 
+	void SAssetIO::meshCache(bool Enable) {
+		m_MeshCache = Enable;
+	}//meshCache
+
+	bool SAssetIO::meshCache(void) {
+		return m_MeshCache;
+	}//meshCache
+
 
 	void SAssetIO::store(const std::string Filepath, const T3DMesh<float>* pMesh) {
 		SAssetIO* pInstance = SAssetIO::instance();
@@ -71,6 +84,7 @@ namespace CForge {
 	}//load
 
 	void SAssetIO::release(void) {
+		std::lock_guard<std::mutex> Lock(m_InstanceMutex);
 		if (m_InstanceCount == 0) throw CForgeExcept("Not enough instances for a release call!");
 		m_InstanceCount--;
 		if (0 == m_InstanceCount) {
@@ -93,6 +107,13 @@ namespace CForge {
 		// ModelIO Plugins
 		ModelIOPlugin Plug;
 
+		// native format, checked first
+		CFMeshIO* pCFMeshIO = new CFMeshIO();
+		pCFMeshIO->init();
+		Plug.pInstance = pCFMeshIO;
+		Plug.Name = pCFMeshIO->pluginName();
+		m_ModelIOPlugins.push_back(Plug);
+
 		// Assimp mesh IO
 		AssimpMeshIO *pAssimMeshIO = new AssimpMeshIO();
 		pAssimMeshIO->init();
@@ -167,16 +188,37 @@ namespace CForge {
 		if (Filepath.empty()) throw CForgeExcept("Empty filepath specified");
 		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
 
+		// try the sidecar cache first
+		std::string CachePath;
+		uint64_t SourceKey = 0;
+		const std::string Lower = CForgeUtility::toLowerCase(Filepath);
+		const bool Native = Lower.size() >= CFMeshIO::Extension.size() && Lower.compare(Lower.size() - CFMeshIO::Extension.size(), CFMeshIO::Extension.size(), CFMeshIO::Extension) == 0;
+		if (m_MeshCache && !Native && File::exists(Filepath) && !File::isDirectory(Filepath)) {
+			try {
+				// keyed to the plug-in that would load the source
+				for (auto& i : m_ModelIOPlugins) {
+					if (!i.pInstance->accepted(Filepath, I3DMeshIO::OP_LOAD)) continue;
+					SourceKey = CFMeshIO::sourceKey(Filepath, i.Name, i.pInstance->pluginVersion());
+					CachePath = Filepath + CFMeshIO::Extension;
+					break;
+				}
+				if (!CachePath.empty() && CFMeshIO::read(CachePath, pMesh, SourceKey)) return;
+			}
+			catch (CrossForgeException& e) {
+				SLogger::logException(e);
+				CachePath.clear();
+			}
+			catch (...) {
+				CachePath.clear();
+			}
+		}
+
+		bool Loaded = false;
 		for (auto &i : m_ModelIOPlugins) {
 			if (i.pInstance->accepted(Filepath, I3DMeshIO::OP_LOAD)) {
 				try {
 					i.pInstance->load(Filepath, pMesh);
-
-					// Assimp requires restart of the plugin if .bvh is loaded or next loading operation of a bvh will terminate with an unexpected end of file error :-(
-					if (Filepath.find(".bvh") != std::string::npos && i.Name.compare("AssImp Mesh IO") == 0) {
-						i.pInstance->release();
-						i.pInstance = new AssimpMeshIO();
-					}
+					Loaded = true;
 				}
 				catch (CrossForgeException& e) {
 					SLogger::logException(e);
@@ -188,6 +230,18 @@ namespace CForge {
 				break; // loaded successfully
 			}//if[matcing plugin found]
 		}//for[all plugins]
+
+		if (Loaded && !CachePath.empty()) {
+			try {
+				CFMeshIO::write(CachePath, pMesh, SourceKey);
+			}
+			catch (CrossForgeException& e) {
+				SLogger::logException(e);
+			}
+			catch (...) {
+				SLogger::log("Unable to write mesh cache " + CachePath);
+			}
+		}
 	}//load
 
 
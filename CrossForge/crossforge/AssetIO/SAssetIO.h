@@ -20,13 +20,16 @@
 
 #include "I3DMeshIO.h"
 #include "I2DImageIO.h"
+#include <mutex>
 
 namespace CForge {
 
 	/**
 	* \brief This singleton class handles import and export of resources such as images and 3d models.
 	*
-	* \todo Design and implement mesh file format for crossforge
+	* Meshes loaded from other formats are cached in a .cfmesh file next to the source (see CFMeshIO). The cache is
+	* used as long as the source key (whole content of the source file, name and version of the loading plug-in) matches.
+	*
 	* \todo Implement TImagePyramid (handles image pyramid with different resolutions)
 	* \todo implement DDS import/export
 	* \todo Add json support.
@@ -109,6 +112,20 @@ namespace CForge {
 		*/
 		static std::string readTextFile(const std::string Filepath);
 
+		/**
+		* \brief Enables or disables the .cfmesh sidecar cache for mesh loading. Enabled by default.
+		*
+		* \param[in] Enable Whether loadModel reads and writes cache files.
+		*/
+		static void meshCache(bool Enable);
+
+		/**
+		* \brief Returns whether the .cfmesh sidecar cache is used.
+		*
+		* \return True if the cache is enabled.
+		*/
+		static bool meshCache(void);
+
 		//TODO(skade) brief + move in cpp
 		static bool accepted(const std::string Filepath, I3DMeshIO::Operation op) {
 			for (auto p : instance()->m_ModelIOPlugins)
@@ -242,6 +259,8 @@ namespace CForge {
 
 		static SAssetIO* m_pInstance;		///< Singleton's unique instance.
 		static uint32_t m_InstanceCount;	///< Singleton's instance count.
+		static bool m_MeshCache;			///< Whether loaded meshes are cached as .cfmesh sidecar files.
+		static std::mutex m_InstanceMutex;	///< Guards creation and release of the instance, loading may happen on several threads.
 	};//SAssetIO
 
 	typedef SAssetIO AssetIO;
@@ -0,0 +1,340 @@
+#include "SkeletalClipLibrary.h"
+
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+namespace CForge {
+
+	const std::string SkeletalClipLibrary::Extension = ".cfclips";
+
+	namespace {
+
+		const uint64_t Alignment = 64;
+		const uint32_t NoJoint = 0xFFFFFFFF;
+
+		enum TrackFlags : uint32_t {
+			TRACK_UNIT_SCALINGS = 1,	///< All scalings are one and not stored.
+		};
+
+		struct Header {
+			uint32_t Magic;
+			uint32_t Version;
+			uint64_t FileSize;
+			uint32_t ClipCount;
+			uint32_t JointCount;
+			uint64_t JointTable;	///< Offset of JointCount ranges into the strings.
+			uint64_t ClipTable;		///< Offset of ClipCount ClipRecords.
+			uint64_t Strings;		///< Offset of the characters of all names.
+			uint64_t StringsSize;
+			uint8_t Padding[8];
+		};
+
+		struct Range {
+			uint64_t Begin;
+			uint64_t Count;
+		};
+
+		struct ClipRecord {
+			Range Name;
+			float Duration;
+			float SamplesPerSecond;
+			uint32_t TrackCount;
+			uint32_t Reserved;
+			uint64_t Offset;	///< Offset of the keyframe block in the file.
+			uint64_t Size;		///< Size of the keyframe block in bytes.
+		};
+
+		/**
+		* \brief Head of a track in a keyframe block. The arrays follow at Offset, relative to the block, in the order
+		* timestamps, positions, rotations, scalings.
+		*/
+		struct TrackRecord {
+			uint32_t Joint;		///< Index in the joint table, NoJoint for keyframes without bone name.
+			int32_t ID;
+			int32_t BoneID;
+			uint32_t Flags;
+			uint32_t Timestamps;
+			uint32_t Positions;
+			uint32_t Rotations;
+			uint32_t Scalings;
+			uint64_t Offset;
+		};
+
+		static_assert(sizeof(Header) == 64, "Header has to fill one alignment block");
+		static_assert(sizeof(Eigen::Vector3f) == 12 && sizeof(Eigen::Quaternionf) == 16, "Unexpected Eigen layout");
+
+		uint64_t pad(uint64_t Offset) {
+			return (Offset + Alignment - 1) / Alignment * Alignment;
+		}//pad
+
+		bool unitScalings(const T3DMesh<float>::BoneKeyframes* pKeys) {
+			for (const auto& i : pKeys->Scalings) {
+				if (i != Eigen::Vector3f::Ones()) return false;
+			}
+			return true;
+		}//unitScalings
+
+		uint64_t trackSize(const TrackRecord& T) {
+			uint64_t Rval = T.Timestamps * sizeof(float) + T.Positions * sizeof(Eigen::Vector3f) + T.Rotations * sizeof(Eigen::Quaternionf);
+			if (!(T.Flags & TRACK_UNIT_SCALINGS)) Rval += T.Scalings * sizeof(Eigen::Vector3f);
+			return Rval;
+		}//trackSize
+
+		// scalar storage of the keyframe element types, tracks are only 4 byte aligned
+		float* scalars(float& Value) { return &Value; }
+		float* scalars(Eigen::Vector3f& Value) { return Value.data(); }
+		float* scalars(Eigen::Quaternionf& Value) { return Value.coeffs().data(); }
+
+		template<typename T>
+		void copyArray(const uint8_t** ppData, uint32_t Count, std::vector<T>* pTarget) {
+			static_assert(sizeof(T) % sizeof(float) == 0, "Keyframe elements have to consist of floats");
+			pTarget->resize(Count);
+			for (uint32_t i = 0; i < Count; ++i) memcpy(scalars((*pTarget)[i]), (*ppData) + i * sizeof(T), sizeof(T));
+			(*ppData) += Count * sizeof(T);
+		}//copyArray
+
+	}//anonymous name space
+
+	SkeletalClipLibrary::SkeletalClipLibrary(void) : CForgeObject("SkeletalClipLibrary") {
+
+	}//Constructor
+
+	SkeletalClipLibrary::~SkeletalClipLibrary(void) {
+		clear();
+	}//Destructor
+
+	void SkeletalClipLibrary::open(const std::string Filepath) {
+		clear();
+		if (!m_File.open(Filepath)) throw CForgeExcept("Failed to map file " + Filepath);
+		m_Filepath = Filepath;
+
+		const uint8_t* pData = m_File.data();
+		const uint64_t Size = m_File.size();
+		Header H;
+		bool Valid = (Size >= sizeof(Header));
+		if (Valid) {
+			memcpy(&H, pData, sizeof(Header));
+			Valid = H.Magic == m_Magic && H.Version == m_Version && H.FileSize == Size;
+		}
+		Valid = Valid && H.JointTable <= Size && H.JointCount <= (Size - H.JointTable) / sizeof(Range);
+		Valid = Valid && H.ClipTable <= Size && H.ClipCount <= (Size - H.ClipTable) / sizeof(ClipRecord);
+		Valid = Valid && H.Strings <= Size && H.StringsSize <= Size - H.Strings;
+		if (!Valid) {
+			clear();
+			throw CForgeExcept("File " + Filepath + " is not a valid version " + std::to_string(m_Version) + " .cfclips file");
+		}
+
+		const char* pStrings = (const char*)(pData + H.Strings);
+		auto String = [&](const Range& R) {
+			if (R.Begin > H.StringsSize || R.Count > H.StringsSize - R.Begin) throw CForgeExcept("Invalid name in " + Filepath);
+			return std::string(pStrings + R.Begin, R.Count);
+		};
+
+		try {
+			m_JointNames.reserve(H.JointCount);
+			for (uint32_t i = 0; i < H.JointCount; ++i) {
+				Range R;
+				memcpy(&R, pData + H.JointTable + i * sizeof(Range), sizeof(Range));
+				m_JointNames.push_back(String(R));
+			}
+
+			m_Clips.reserve(H.ClipCount);
+			m_Blocks.reserve(H.ClipCount);
+			for (uint32_t i = 0; i < H.ClipCount; ++i) {
+				ClipRecord Rec;
+				memcpy(&Rec, pData + H.ClipTable + i * sizeof(ClipRecord), sizeof(ClipRecord));
+				if (Rec.Offset > Size || Rec.Size > Size - Rec.Offset) throw CForgeExcept("Invalid clip block in " + Filepath);
+				ClipInfo Info;
+				Info.Name = String(Rec.Name);
+				Info.Duration = Rec.Duration;
+				Info.SamplesPerSecond = Rec.SamplesPerSecond;
+				Info.TrackCount = Rec.TrackCount;
+				m_Clips.push_back(Info);
+				m_Blocks.push_back(ClipBlock{ Rec.Offset, Rec.Size });
+			}
+		}
+		catch (...) {
+			clear();
+			throw;
+		}
+	}//open
+
+	void SkeletalClipLibrary::clear(void) {
+		m_File.close();
+		m_Filepath.clear();
+		m_JointNames.clear();
+		m_Clips.clear();
+		m_Blocks.clear();
+	}//clear
+
+	uint32_t SkeletalClipLibrary::clipCount(void)const {
+		return uint32_t(m_Clips.size());
+	}//clipCount
+
+	const SkeletalClipLibrary::ClipInfo& SkeletalClipLibrary::clipInfo(uint32_t Index)const {
+		if (Index >= m_Clips.size()) throw IndexOutOfBoundsExcept("Index");
+		return m_Clips[Index];
+	}//clipInfo
+
+	const std::vector<std::string>& SkeletalClipLibrary::jointNames(void)const {
+		return m_JointNames;
+	}//jointNames
+
+	T3DMesh<float>::SkeletalAnimation* SkeletalClipLibrary::decode(uint32_t Index)const {
+		if (Index >= m_Clips.size()) throw IndexOutOfBoundsExcept("Index");
+
+		const ClipInfo& Info = m_Clips[Index];
+		const ClipBlock& Block = m_Blocks[Index];
+		const uint8_t* pBlock = m_File.data() + Block.Offset;
+		if (Info.TrackCount > Block.Size / sizeof(TrackRecord)) throw CForgeExcept("Invalid clip " + Info.Name + " in " + m_Filepath);
+
+		std::unique_ptr<T3DMesh<float>::SkeletalAnimation> pAnim(new T3DMesh<float>::SkeletalAnimation());
+		pAnim->Name = Info.Name;
+		pAnim->Duration = Info.Duration;
+		pAnim->SamplesPerSecond = Info.SamplesPerSecond;
+		pAnim->Keyframes.reserve(Info.TrackCount);
+
+		for (uint32_t i = 0; i < Info.TrackCount; ++i) {
+			TrackRecord T;
+			memcpy(&T, pBlock + i * sizeof(TrackRecord), sizeof(TrackRecord));
+			if (T.Joint != NoJoint && T.Joint >= m_JointNames.size()) throw CForgeExcept("Invalid joint in clip " + Info.Name + " of " + m_Filepath);
+			if (T.Offset > Block.Size || trackSize(T) > Block.Size - T.Offset) throw CForgeExcept("Invalid track in clip " + Info.Name + " of " + m_Filepath);
+
+			T3DMesh<float>::BoneKeyframes* pKeys = new T3DMesh<float>::BoneKeyframes();
+			pAnim->Keyframes.push_back(pKeys);
+			pKeys->ID = T.ID;
+			pKeys->BoneID = T.BoneID;
+			if (T.Joint != NoJoint) pKeys->BoneName = m_JointNames[T.Joint];
+
+			const uint8_t* p = pBlock + T.Offset;
+			copyArray(&p, T.Timestamps, &pKeys->Timestamps);
+			copyArray(&p, T.Positions, &pKeys->Positions);
+			copyArray(&p, T.Rotations, &pKeys->Rotations);
+			if (T.Flags & TRACK_UNIT_SCALINGS) pKeys->Scalings.assign(T.Scalings, Eigen::Vector3f::Ones());
+			else copyArray(&p, T.Scalings, &pKeys->Scalings);
+		}//for[tracks]
+
+		return pAnim.release();
+	}//decode
+
+	void SkeletalClipLibrary::write(const std::string Filepath, const std::vector<const T3DMesh<float>::SkeletalAnimation*>& Clips) {
+		for (auto i : Clips) {
+			if (nullptr == i) throw NullpointerExcept("Clips");
+		}
+
+		// names and joint table
+		std::string Strings;
+		std::vector<Range> JointTable;
+		std::unordered_map<std::string, uint32_t> JointIndices;
+		auto AddString = [&](const std::string& Str) {
+			Range R = { Strings.size(), Str.size() };
+			Strings += Str;
+			return R;
+		};
+
+		// table of contents and track heads, blocks are laid out back to back
+		std::vector<ClipRecord> ClipTable;
+		std::vector<std::vector<TrackRecord>> Tracks(Clips.size());
+		const uint64_t TableSize = sizeof(Header) + Clips.size() * sizeof(ClipRecord);
+		for (size_t c = 0; c < Clips.size(); ++c) {
+			const T3DMesh<float>::SkeletalAnimation* pAnim = Clips[c];
+			ClipRecord Rec;
+			memset(&Rec, 0, sizeof(ClipRecord));
+			Rec.Name = AddString(pAnim->Name);
+			Rec.Duration = pAnim->Duration;
+			Rec.SamplesPerSecond = pAnim->SamplesPerSecond;
+			Rec.TrackCount = uint32_t(pAnim->Keyframes.size());
+
+			uint64_t Offset = pAnim->Keyframes.size() * sizeof(TrackRecord);
+			for (auto pKeys : pAnim->Keyframes) {
+				TrackRecord T;
+				memset(&T, 0, sizeof(TrackRecord));
+				T.Joint = NoJoint;
+				if (!pKeys->BoneName.empty()) {
+					auto It = JointIndices.find(pKeys->BoneName);
+					if (It == JointIndices.end()) {
+						It = JointIndices.emplace(pKeys->BoneName, uint32_t(JointTable.size())).first;
+						JointTable.push_back(AddString(pKeys->BoneName));
+					}
+					T.Joint = It->second;
+				}
+				T.ID = pKeys->ID;
+				T.BoneID = pKeys->BoneID;
+				T.Flags = unitScalings(pKeys) ? uint32_t(TRACK_UNIT_SCALINGS) : 0;
+				T.Timestamps = uint32_t(pKeys->Timestamps.size());
+				T.Positions = uint32_t(pKeys->Positions.size());
+				T.Rotations = uint32_t(pKeys->Rotations.size());
+				T.Scalings = uint32_t(pKeys->Scalings.size());
+				T.Offset = Offset;
+				Offset += trackSize(T);
+				Tracks[c].push_back(T);
+			}
+			Rec.Size = Offset;
+			ClipTable.push_back(Rec);
+		}//for[clips]
+
+		Header H;
+		memset(&H, 0, sizeof(Header));
+		H.Magic = m_Magic;
+		H.Version = m_Version;
+		H.ClipCount = uint32_t(Clips.size());
+		H.JointCount = uint32_t(JointTable.size());
+		H.ClipTable = sizeof(Header);
+		H.JointTable = TableSize;
+		H.Strings = H.JointTable + JointTable.size() * sizeof(Range);
+		H.StringsSize = Strings.size();
+		uint64_t Offset = pad(H.Strings + H.StringsSize);
+		for (auto& i : ClipTable) {
+			i.Offset = Offset;
+			Offset = pad(Offset + i.Size);
+		}
+		H.FileSize = Offset;
+
+		// unique temporary per thread, a library can be rewritten while others still map the old file
+		const std::string Tmp = Filepath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+		File F;
+		F.begin(Tmp, "wb");
+		uint64_t Written = 0;
+		auto Put = [&](const void* pData, uint64_t Size) {
+			// File::write takes 32 bit counts
+			const uint8_t* p = (const uint8_t*)pData;
+			while (Size > 0) {
+				const uint64_t Chunk = std::min<uint64_t>(Size, 1 << 30);
+				F.write(p, Chunk);
+				p += Chunk;
+				Size -= Chunk;
+				Written += Chunk;
+			}
+		};
+		const uint8_t Zeros[Alignment] = { 0 };
+		auto Pad = [&]() {
+			if (pad(Written) != Written) Put(Zeros, pad(Written) - Written);
+		};
+
+		Put(&H, sizeof(Header));
+		Put(ClipTable.data(), ClipTable.size() * sizeof(ClipRecord));
+		Put(JointTable.data(), JointTable.size() * sizeof(Range));
+		Put(Strings.data(), Strings.size());
+		Pad();
+		for (size_t c = 0; c < Clips.size(); ++c) {
+			Put(Tracks[c].data(), Tracks[c].size() * sizeof(TrackRecord));
+			for (size_t k = 0; k < Tracks[c].size(); ++k) {
+				const T3DMesh<float>::BoneKeyframes* pKeys = Clips[c]->Keyframes[k];
+				Put(pKeys->Timestamps.data(), pKeys->Timestamps.size() * sizeof(float));
+				Put(pKeys->Positions.data(), pKeys->Positions.size() * sizeof(Eigen::Vector3f));
+				Put(pKeys->Rotations.data(), pKeys->Rotations.size() * sizeof(Eigen::Quaternionf));
+				if (!(Tracks[c][k].Flags & TRACK_UNIT_SCALINGS)) Put(pKeys->Scalings.data(), pKeys->Scalings.size() * sizeof(Eigen::Vector3f));
+			}
+			Pad();
+		}//for[clips]
+		F.end();
+
+		if (!File::rename(Tmp, Filepath)) {
+			File::remove(Tmp);
+			throw CForgeExcept("Failed to move " + Tmp + " to " + Filepath);
+		}
+	}//write
+
+}//name space
@@ -0,0 +1,128 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): SkeletalClipLibrary.h and SkeletalClipLibrary.cpp                *
+*                                                                           *
+* Content: Binary container of skeletal animations that are decoded on      *
+*          first use.                                                       *
+*                                                                           *
+*                                                                           *
+* Author(s): Simon Kretzschmar                                              *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_SKELETALCLIPLIBRARY_H__
+#define __CFORGE_SKELETALCLIPLIBRARY_H__
+
+#include "T3DMesh.hpp"
+#include "File.h"
+
+namespace CForge {
+	/**
+	* \brief Memory mapped library of skeletal animations (.cfclips).
+	* \ingroup AssetIO
+	*
+	* A file is a header, a table of contents and one keyframe block per clip. The table holds the joint names
+	* shared by all clips and for every clip its name, duration, sample rate and the byte range of its block, so
+	* opening a library only reads the table. Blocks start at 64 byte aligned offsets and are decoded by decode,
+	* the operating system pages in only the blocks that are touched.
+	*/
+	class CFORGE_API SkeletalClipLibrary : public CForgeObject {
+	public:
+		/**
+		* \brief Table of contents entry of a clip.
+		*/
+		struct ClipInfo {
+			std::string Name;		///< Name of the animation.
+			float Duration;			///< Duration as stored in the animation.
+			float SamplesPerSecond;	///< Sample rate as stored in the animation.
+			uint32_t TrackCount;	///< Number of bone keyframes.
+		};
+
+		/**
+		* \brief Constructor.
+		*/
+		SkeletalClipLibrary(void);
+
+		/**
+		* \brief Destructor.
+		*/
+		~SkeletalClipLibrary(void);
+
+		/**
+		* \brief Maps a library and reads its table of contents.
+		*
+		* \param[in] Filepath Path to the .cfclips file.
+		* \throws CrossForgeException if the file can not be mapped or is not a valid library.
+		*/
+		void open(const std::string Filepath);
+
+		/**
+		* \brief Unmaps the library.
+		*/
+		void clear(void);
+
+		/**
+		* \brief Returns the number of clips.
+		*
+		* \return Number of clips.
+		*/
+		uint32_t clipCount(void)const;
+
+		/**
+		* \brief Returns the table of contents entry of a clip.
+		*
+		* \param[in] Index Index of the clip.
+		* \return Name, duration, sample rate and track count.
+		*/
+		const ClipInfo& clipInfo(uint32_t Index)const;
+
+		/**
+		* \brief Returns the joint names referenced by the clips.
+		*
+		* \return Joint names.
+		*/
+		const std::vector<std::string>& jointNames(void)const;
+
+		/**
+		* \brief Decodes the keyframes of a clip.
+		*
+		* \param[in] Index Index of the clip.
+		* \return New animation, possession goes to the caller.
+		* \throws CrossForgeException if the block of the clip is malformed.
+		*/
+		T3DMesh<float>::SkeletalAnimation* decode(uint32_t Index)const;
+
+		/**
+		* \brief Writes a library. The file is written to a temporary first and renamed, readers never see partial files.
+		*
+		* \param[in] Filepath Path to the .cfclips file.
+		* \param[in] Clips The animations to store.
+		*/
+		static void write(const std::string Filepath, const std::vector<const T3DMesh<float>::SkeletalAnimation*>& Clips);
+
+		static const std::string Extension;	///< File extension including the dot.
+
+	protected:
+		static const uint32_t m_Magic = 0x50494C43;	///< "CLIP" in a little endian file.
+		static const uint32_t m_Version = 1;		///< Files of other versions are rejected.
+
+		struct ClipBlock {
+			uint64_t Offset;
+			uint64_t Size;
+		};
+
+		MappedFile m_File;						///< The mapped library.
+		std::string m_Filepath;					///< Path of the mapped library, used in error messages.
+		std::vector<std::string> m_JointNames;	///< Joint names referenced by the tracks.
+		std::vector<ClipInfo> m_Clips;			///< Table of contents.
+		std::vector<ClipBlock> m_Blocks;		///< Byte range of the keyframe block of every clip.
+	};//SkeletalClipLibrary
+
+}//name space
+
+#endif
@@ -19,13 +19,20 @@
 #define __CFORGE_T3DMESH_H__
 
 #include "../Core/CForgeObject.h"
+#include "../Core/Parallel.hpp"
+#include "../Core/TSharedVector.hpp"
 #include "../Math/Box.hpp"
 
+#include <algorithm>
+
 namespace CForge {
 
 	/**
 	* \brief Template class that stores a triangle mesh.
 	* 
+	* Per vertex data and faces are shared between copies until one of them is written, see TSharedVector.
+	* References returned by the non-const accessors only ever write this mesh, copies taken afterwards clone the data they refer to.
+	* 
 	* \todo Change internal data handling to container.
 	* \todo Change pass by pointer to pass by reference, where applicable.
 	* \todo Implement copy operator for class and all nested structures.
@@ -74,9 +81,9 @@ namespace CForge {
 		* \brief A submesh is a set collection of faces. It is usually characterized by all faces sharing the same material.
 		*/
 		struct Submesh {
-			std::vector<Face> Faces;					///< Set of faces belonging to this submesh.
-			std::vector<Eigen::Vector3f> FaceNormals;	///< Stores face normals (if required)
-			std::vector<Eigen::Vector3f> FaceTangents;	///< Stores face tangents (if required)
+			TSharedVector<Face> Faces;					///< Set of faces belonging to this submesh. Shared with copies until written.
+			TSharedVector<Eigen::Vector3f> FaceNormals;	///< Stores face normals (if required)
+			TSharedVector<Eigen::Vector3f> FaceTangents;	///< Stores face tangents (if required)
 			int32_t Material;
 
 			/**
@@ -419,16 +426,28 @@ namespace CForge {
 		*/
 		static Box computeAxisAlignedBoundingBox(const T3DMesh<T> &Mesh) {
 			if (Mesh.vertexCount() == 0) throw CForgeExcept("Mesh contains no vertex data. Can not compute axis aligned bounding box");
-			Eigen::Vector3f Min = Mesh.m_Positions[0];
-			Eigen::Vector3f Max = Mesh.m_Positions[0];
-			for (auto i : Mesh.m_Positions) {
-				if (i.x() < Min.x()) Min.x() = i.x();
-				if (i.y() < Min.y()) Min.y() = i.y();
-				if (i.z() < Min.z()) Min.z() = i.z();
-				if (i.x() > Max.x()) Max.x() = i.x();
-				if (i.y() > Max.y()) Max.y() = i.y();
-				if (i.z() > Max.z()) Max.z() = i.z();
-			}//for[all position values]
+
+			// every worker reduces a range, the partial boxes are merged afterwards
+			const std::vector<Eigen::Matrix<T, 3, 1>>& Positions = Mesh.m_Positions;
+			const size_t Ranges = parallelRangeCount(Positions.size(), ParallelMinRange);
+			std::vector<Eigen::Vector3f> Mins(Ranges, Positions[0]);
+			std::vector<Eigen::Vector3f> Maxs(Ranges, Positions[0]);
+			parallelRanges(Positions.size(), Ranges, [&](size_t Range, size_t Begin, size_t End) {
+				Eigen::Vector3f Min = Positions[Begin];
+				Eigen::Vector3f Max = Positions[Begin];
+				for (size_t i = Begin; i < End; ++i) {
+					Min = Min.cwiseMin(Positions[i]);
+					Max = Max.cwiseMax(Positions[i]);
+				}
+				Mins[Range] = Min;
+				Maxs[Range] = Max;
+			});
+			Eigen::Vector3f Min = Mins[0];
+			Eigen::Vector3f Max = Maxs[0];
+			for (size_t i = 1; i < Ranges; ++i) {
+				Min = Min.cwiseMin(Mins[i]);
+				Max = Max.cwiseMax(Maxs[i]);
+			}
 
 			Box Rval;
 			Rval.init(Min, Max);
@@ -440,6 +459,7 @@ namespace CForge {
 		*/
 		T3DMesh(void): CForgeObject("T3DMesh") {
 			m_pRootBone = nullptr;
+			resetVersions();
 		}//Constructor
 
 		/**
@@ -457,6 +477,7 @@ namespace CForge {
 		T3DMesh(const T3DMesh<T>& Other): CForgeObject("T3DMesh") {
 			if (this == &Other) return;
 			m_pRootBone = nullptr;
+			resetVersions();
 			this->init(&Other);
 		}
 
@@ -472,6 +493,38 @@ namespace CForge {
 			return (*this);
 		}
 
+		/**
+		* \brief Exchanges all data with another mesh without copying.
+		*
+		* \param[in,out] Other The other mesh.
+		*/
+		void swap(T3DMesh<T>& Other) {
+			std::swap(m_Positions, Other.m_Positions);
+			std::swap(m_Normals, Other.m_Normals);
+			std::swap(m_Tangents, Other.m_Tangents);
+			std::swap(m_UVWs, Other.m_UVWs);
+			std::swap(m_Colors, Other.m_Colors);
+			std::swap(m_Submeshes, Other.m_Submeshes);
+			std::swap(m_Materials, Other.m_Materials);
+			std::swap(m_pRootBone, Other.m_pRootBone);
+			std::swap(m_Bones, Other.m_Bones);
+			std::swap(m_SkeletalAnimations, Other.m_SkeletalAnimations);
+			std::swap(m_MorphTargets, Other.m_MorphTargets);
+			std::swap(m_AABB, Other.m_AABB);
+
+			// versions and stamps move with the data they describe
+			std::swap(m_GeometryVersion, Other.m_GeometryVersion);
+			std::swap(m_TopologyVersion, Other.m_TopologyVersion);
+			std::swap(m_FaceNormalsVersion, Other.m_FaceNormalsVersion);
+			std::swap(m_NormalsVersion, Other.m_NormalsVersion);
+			std::swap(m_FaceTangentsVersion, Other.m_FaceTangentsVersion);
+			std::swap(m_TangentsVersion, Other.m_TangentsVersion);
+			std::swap(m_AABBVersion, Other.m_AABBVersion);
+			std::swap(m_AdjacencyVersion, Other.m_AdjacencyVersion);
+			std::swap(m_VertexFaceOffsets, Other.m_VertexFaceOffsets);
+			std::swap(m_VertexFaces, Other.m_VertexFaces);
+		}//swap
+
 		/**
 		* \brief Initialization method. 
 		* 
@@ -518,9 +571,15 @@ namespace CForge {
 					m_SkeletalAnimations.push_back(pAnim);
 				}
 
-				//// morph target related
-				//std::vector<MorphTarget*> m_MorphTargets;
+				// copy morph targets
+				for (auto i : pRef->m_MorphTargets) m_MorphTargets.push_back(new MorphTarget(*i));
 
+				// derived data that was up to date in the reference is up to date in the copy
+				if (pRef->m_FaceNormalsVersion == pRef->m_GeometryVersion) m_FaceNormalsVersion = m_GeometryVersion;
+				if (pRef->m_NormalsVersion == pRef->m_GeometryVersion) m_NormalsVersion = m_GeometryVersion;
+				if (pRef->m_FaceTangentsVersion == pRef->m_GeometryVersion) m_FaceTangentsVersion = m_GeometryVersion;
+				if (pRef->m_TangentsVersion == pRef->m_GeometryVersion) m_TangentsVersion = m_GeometryVersion;
+				if (pRef->m_AABBVersion == pRef->m_GeometryVersion) m_AABBVersion = m_GeometryVersion;
 			}
 		}//initialize
 
@@ -547,6 +606,9 @@ namespace CForge {
 			for (auto& i : m_MorphTargets) delete i;
 			m_MorphTargets.clear();
 
+			m_VertexFaceOffsets.clear();
+			m_VertexFaces.clear();
+			topologyChanged();
 		}//clear
 
 		/**
@@ -580,6 +642,7 @@ namespace CForge {
 		*/
 		void vertices(std::vector<Eigen::Matrix<T, 3, 1>> *pCoords) {
 			if (nullptr != pCoords) m_Positions = (*pCoords);
+			topologyChanged();
 		}//positions
 
 		/**
@@ -589,6 +652,7 @@ namespace CForge {
 		*/
 		void normals(std::vector<Eigen::Matrix<T, 3, 1>>* pNormals) {
 			if (nullptr != pNormals) m_Normals = (*pNormals);
+			m_NormalsVersion = 0;
 		}//normals
 
 		/**
@@ -598,6 +662,7 @@ namespace CForge {
 		*/
 		void tangents(std::vector<Eigen::Matrix<T, 3, 1>>* pTangents) {
 			if (nullptr != pTangents) m_Tangents = (*pTangents);
+			m_TangentsVersion = 0;
 		}//tangents
 
 		/**
@@ -607,6 +672,7 @@ namespace CForge {
 		*/
 		void textureCoordinates(std::vector<Eigen::Matrix<T, 3, 1>>* pUVWs) {
 			if (nullptr != pUVWs) m_UVWs = (*pUVWs);
+			geometryChanged();
 		}//textureCoordinates
 
 		/**
@@ -618,6 +684,35 @@ namespace CForge {
 			if (nullptr != pColors) m_Colors = (*pColors);
 		}//colors
 
+		/**
+		* \brief Setters taking over the arrays without copying. Used by importers that decode into their own arrays.
+		*
+		* \param[in] Coords Vertex data, left empty.
+		*/
+		void vertices(std::vector<Eigen::Matrix<T, 3, 1>>&& Coords) {
+			m_Positions = std::move(Coords);
+			topologyChanged();
+		}//positions
+
+		void normals(std::vector<Eigen::Matrix<T, 3, 1>>&& Normals) {
+			m_Normals = std::move(Normals);
+			m_NormalsVersion = 0;
+		}//normals
+
+		void tangents(std::vector<Eigen::Matrix<T, 3, 1>>&& Tangents) {
+			m_Tangents = std::move(Tangents);
+			m_TangentsVersion = 0;
+		}//tangents
+
+		void textureCoordinates(std::vector<Eigen::Matrix<T, 3, 1>>&& UVWs) {
+			m_UVWs = std::move(UVWs);
+			geometryChanged();
+		}//textureCoordinates
+
+		void colors(std::vector<Eigen::Matrix<T, 3, 1>>&& Colors) {
+			m_Colors = std::move(Colors);
+		}//colors
+
 		/**
 		* \brief Setter for the bones.
 		* 
@@ -717,6 +812,7 @@ namespace CForge {
 				pSM->init(pSubmesh);
 			}
 			m_Submeshes.push_back(pSM);
+			topologyChanged();
 		}//addSubmesh
 
 		/**
@@ -850,7 +946,8 @@ namespace CForge {
 		* \brief Vertex access operator.
 		* 
 		* \param[in] Index The index of the vertex.
-		* \return Read/write access of the requested vertex.
+		* \return Read/write access of the requested vertex. Call geometryChanged after writing through it.
+		* \remark The reference stays bound to this mesh. Copies of the mesh made while it is held get their own positions, so writes through it never reach them.
 		*/
 		Eigen::Matrix<T, 3, 1>& vertex(int32_t Index) {
 			if (Index < 0 || Index >= vertexCount()) throw IndexOutOfBoundsExcept("Index");
@@ -872,7 +969,7 @@ namespace CForge {
 		* \brief Normal access operator.
 		* 
 		* \param[in] Index The index of the normal.
-		* \return Read/write access of the requested normal.
+		* \return Read/write access of the requested normal. Written normals are kept by updatePerVertexNormals until the geometry changes.
 		*/
 		Eigen::Matrix<T, 3, 1>& normal(int32_t Index) {
 			if (Index < 0 || Index >= normalCount()) throw IndexOutOfBoundsExcept("Index");
@@ -894,7 +991,7 @@ namespace CForge {
 		* \brief Tangent access operator.
 		* 
 		* \param[in] Index The index of the tangent.
-		* \return Read/write access of the requested tangent.
+		* \return Read/write access of the requested tangent. Written tangents are kept by updatePerVertexTangents until the geometry changes.
 		*/
 		Eigen::Matrix<T, 3, 1>& tangent(int32_t Index) {
 			if (Index < 0 || Index >= tangentCount()) throw IndexOutOfBoundsExcept("Index");
@@ -918,7 +1015,7 @@ namespace CForge {
 		* \brief Texture coordinate access operator.
 		* 
 		* \param[in] Index The index of the texture coordinate.
-		* \return Read/write access of the requested texture coordinate.
+		* \return Read/write access of the requested texture coordinate. Call geometryChanged after writing through it.
 		*/
 		Eigen::Matrix<T, 3, 1>& textureCoordinate(int32_t Index) {
 			if (Index < 0 || Index >= textureCoordinatesCount()) throw IndexOutOfBoundsExcept("Index");
@@ -962,7 +1059,8 @@ namespace CForge {
 		* \brief Submesh access operator.
 		* 
 		* \param[in] Index The index of the submesh.
-		* \return Read/write access of the requested submesh.
+		* \return Read/write access of the requested submesh. Call topologyChanged after changing its faces.
+		* \remark Like the reference of vertex, face references obtained through the submesh only ever write this mesh.
 		*/
 		Submesh* getSubmesh(int32_t Index){
 			if (Index < 0 || Index >= m_Submeshes.size()) throw IndexOutOfBoundsExcept("Index");
@@ -1092,15 +1190,24 @@ namespace CForge {
 		* \todo Move computation of normals to the submsesh data structure.
 		*/
 		void computePerFaceNormals(void) {
+			updateAdjacency(); // validates the vertex indexes
+
+			// workers only read shared data, results are assigned afterwards
+			const std::vector<Eigen::Matrix<T, 3, 1>>& Positions = m_Positions;
 			for (auto i : m_Submeshes) {
-				i->FaceNormals.clear();
-				for (auto k : i->Faces) {
-					const Eigen::Vector3f a = m_Positions[k.Vertices[0]] - m_Positions[k.Vertices[2]];
-					const Eigen::Vector3f b = m_Positions[k.Vertices[1]] - m_Positions[k.Vertices[2]];
-					const Eigen::Vector3f n = a.cross(b);
-					i->FaceNormals.push_back(n.normalized());
-				}//for[faces]
+				const std::vector<Face>& Faces = i->Faces;
+				std::vector<Eigen::Vector3f> FaceNormals(Faces.size());
+				parallelRanges(Faces.size(), parallelRangeCount(Faces.size(), ParallelMinRange), [&](size_t, size_t Begin, size_t End) {
+					for (size_t k = Begin; k < End; ++k) {
+						const Face& F = Faces[k];
+						const Eigen::Vector3f a = Positions[F.Vertices[0]] - Positions[F.Vertices[2]];
+						const Eigen::Vector3f b = Positions[F.Vertices[1]] - Positions[F.Vertices[2]];
+						FaceNormals[k] = a.cross(b).normalized();
+					}//for[faces]
+				});
+				i->FaceNormals = std::move(FaceNormals);
 			}//for[submeshes]
+			m_FaceNormalsVersion = m_GeometryVersion;
 		}//computePerFaceNormals
 
 		/**
@@ -1111,25 +1218,34 @@ namespace CForge {
 		void computePerFaceTangents(void) {
 
 			if (m_UVWs.size() == 0) throw CForgeExcept("No UVW coordinates. Can not compute tangents.");
+			updateAdjacency(); // validates the vertex indexes
 
+			const std::vector<Eigen::Matrix<T, 3, 1>>& Positions = m_Positions;
+			const std::vector<Eigen::Matrix<T, 3, 1>>& UVWs = m_UVWs;
 			for (auto i : m_Submeshes) {
-				i->FaceTangents.clear();
-				for (auto F : i->Faces) {
-					const Eigen::Vector3f Edge1 = m_Positions[F.Vertices[1]] - m_Positions[F.Vertices[0]];
-					const Eigen::Vector3f Edge2 = m_Positions[F.Vertices[2]] - m_Positions[F.Vertices[0]];
-					const Eigen::Vector3f DeltaUV1 = m_UVWs[F.Vertices[1]] - m_UVWs[F.Vertices[0]];
-					const Eigen::Vector3f DeltaUV2 = m_UVWs[F.Vertices[2]] - m_UVWs[F.Vertices[0]];
-
-					float f = DeltaUV1.x() * DeltaUV2.y() - DeltaUV2.x() + DeltaUV1.y();
-					f = (std::abs(f) > 0.0f) ? 1.0f / f : 1.0f;
-
-					Eigen::Vector3f Tangent;
-					Tangent.x() = f * (DeltaUV2.y() * Edge1.x() - DeltaUV1.y() * Edge2.x());
-					Tangent.y() = f * (DeltaUV2.y() * Edge1.y() - DeltaUV1.y() * Edge2.y());
-					Tangent.z() = f * (DeltaUV2.y() * Edge1.z() - DeltaUV1.y() * Edge2.z());
-					i->FaceTangents.push_back(Tangent);
-				}//for[all faces]
+				const std::vector<Face>& Faces = i->Faces;
+				std::vector<Eigen::Vector3f> FaceTangents(Faces.size());
+				parallelRanges(Faces.size(), parallelRangeCount(Faces.size(), ParallelMinRange), [&](size_t, size_t Begin, size_t End) {
+					for (size_t k = Begin; k < End; ++k) {
+						const Face& F = Faces[k];
+						const Eigen::Vector3f Edge1 = Positions[F.Vertices[1]] - Positions[F.Vertices[0]];
+						const Eigen::Vector3f Edge2 = Positions[F.Vertices[2]] - Positions[F.Vertices[0]];
+						const Eigen::Vector3f DeltaUV1 = UVWs[F.Vertices[1]] - UVWs[F.Vertices[0]];
+						const Eigen::Vector3f DeltaUV2 = UVWs[F.Vertices[2]] - UVWs[F.Vertices[0]];
+
+						float f = DeltaUV1.x() * DeltaUV2.y() - DeltaUV2.x() * DeltaUV1.y();
+						f = (std::abs(f) > 0.0f) ? 1.0f / f : 1.0f;
+
+						Eigen::Vector3f Tangent;
+						Tangent.x() = f * (DeltaUV2.y() * Edge1.x() - DeltaUV1.y() * Edge2.x());
+						Tangent.y() = f * (DeltaUV2.y() * Edge1.y() - DeltaUV1.y() * Edge2.y());
+						Tangent.z() = f * (DeltaUV2.y() * Edge1.z() - DeltaUV1.y() * Edge2.z());
+						FaceTangents[k] = Tangent;
+					}//for[all faces]
+				});
+				i->FaceTangents = std::move(FaceTangents);
 			}//for[all submeshes]
+			m_FaceTangentsVersion = m_GeometryVersion;
 
 		}//computeTangents
 
@@ -1143,22 +1259,14 @@ namespace CForge {
 		void computePerVertexNormals(bool ComputePerFaceNormals = true) {
 			if(ComputePerFaceNormals) computePerFaceNormals();
 
-			m_Normals.clear();
-			// create normals
-			for (uint32_t i = 0; i < m_Positions.size(); ++i) m_Normals.push_back(Eigen::Vector3f::Zero());
-
-			// sum normals
-			for (auto i : m_Submeshes) {
-				for (uint32_t k = 0; k < i->Faces.size(); ++k) {
-					Face* pF = &(i->Faces[k]);
-					m_Normals[pF->Vertices[0]] = m_Normals[pF->Vertices[0]] + i->FaceNormals[k];
-					m_Normals[pF->Vertices[1]] = m_Normals[pF->Vertices[1]] + i->FaceNormals[k];
-					m_Normals[pF->Vertices[2]] = m_Normals[pF->Vertices[2]] + i->FaceNormals[k];
-				}//for[faces]
-			}//for[sub meshes
-
-			// normalize normals
-			for (auto& i : m_Normals) i.normalize();
+			// sum normals of the adjacent faces and normalize
+			std::vector<const std::vector<Eigen::Vector3f>*> FaceNormals;
+			for (const Submesh* i : m_Submeshes) {
+				if (i->FaceNormals.size() != i->Faces.size()) throw CForgeExcept("Per face normals missing. Can not compute per vertex normals.");
+				FaceNormals.push_back(&i->FaceNormals.read());
+			}
+			m_Normals = accumulatePerVertex(FaceNormals);
+			m_NormalsVersion = m_GeometryVersion;
 
 		}//computeperVertexNormals
 
@@ -1172,30 +1280,68 @@ namespace CForge {
 		void computePerVertexTangents(bool ComputePerFaceTangents = true) {
 			if (ComputePerFaceTangents) computePerFaceTangents();
 
-			m_Tangents.clear();
+			// sum tangents of the adjacent faces and normalize
+			std::vector<const std::vector<Eigen::Vector3f>*> FaceTangents;
+			for (const Submesh* i : m_Submeshes) {
+				if (i->FaceTangents.size() != i->Faces.size()) throw CForgeExcept("Per face tangents missing. Can not compute per vertex tangents.");
+				FaceTangents.push_back(&i->FaceTangents.read());
+			}
+			m_Tangents = accumulatePerVertex(FaceTangents);
+			m_TangentsVersion = m_GeometryVersion;
 
-			// create tangents
-			for (uint32_t i = 0; i < m_Positions.size(); ++i) m_Tangents.push_back(Eigen::Vector3f::Zero());
+		}//computePerVertexTangents
 
-			// sum tangents
-			for (auto i : m_Submeshes) {
-				for (uint32_t k = 0; k < i->Faces.size(); ++k) {
-					Face* pF = &(i->Faces[k]);
-					m_Tangents[pF->Vertices[0]] += i->FaceTangents[k];
-					m_Tangents[pF->Vertices[1]] += i->FaceTangents[k];
-					m_Tangents[pF->Vertices[2]] += i->FaceTangents[k];
-				}//for[all faces]
-			}//for[submeshes]
+		/**
+		* \brief Computes the per vertex normals unless they were computed for the current geometry version already.
+		*
+		* Meant for code that only needs valid normals, e.g. when preparing a mesh for rendering. Writes through references
+		* of the non-const accessors are only noticed after geometryChanged or topologyChanged was called.
+		*/
+		void updatePerVertexNormals(void) {
+			if (m_NormalsVersion == m_GeometryVersion && m_Normals.size() == m_Positions.size()) return;
+			computePerVertexNormals(m_FaceNormalsVersion != m_GeometryVersion);
+		}//updatePerVertexNormals
+
+		/**
+		* \brief Computes the per vertex tangents unless they were computed for the current geometry version already, see updatePerVertexNormals.
+		*/
+		void updatePerVertexTangents(void) {
+			if (m_TangentsVersion == m_GeometryVersion && m_Tangents.size() == m_Positions.size()) return;
+			computePerVertexTangents(m_FaceTangentsVersion != m_GeometryVersion);
+		}//updatePerVertexTangents
 
-			// normalize tangents
-			for (auto& i : m_Tangents) i.normalize();
+		/**
+		* \brief Returns the geometry version. It changes with every setter of positions, faces or texture coordinates and with
+		* every call of geometryChanged or topologyChanged. The update methods only recompute derived data (normals, tangents,
+		* bounding box) that was computed for an older version, the compute methods always recompute. Writes through references
+		* of the non-const accessors are not tracked.
+		* Like all non-const members, the version counters must not be changed while other threads use the mesh.
+		*
+		* \return Current geometry version.
+		*/
+		uint64_t geometryVersion(void)const {
+			return m_GeometryVersion;
+		}//geometryVersion
 
-		}//computePerVertexTangents
+		/**
+		* \brief Marks positions or texture coordinates as changed. Has to be called after writing through vertex or textureCoordinate.
+		*/
+		void geometryChanged(void) {
+			m_GeometryVersion++;
+		}//geometryChanged
+
+		/**
+		* \brief Marks faces or the number of vertexes as changed. Has to be called after changing faces of a submesh returned by getSubmesh.
+		*/
+		void topologyChanged(void) {
+			m_GeometryVersion++;
+			m_TopologyVersion++;
+		}//topologyChanged
 
 		/**
 		* \brief Axis aligned bounding box access operator.
 		* 
-		* \return Read/write access to the axis aligned bounding box.
+		* \return Read/write access to the axis aligned bounding box. A written box is kept by updateAxisAlignedBoundingBox until the geometry changes.
 		*/
 		Box& aabb() {
 			return m_AABB;
@@ -1216,14 +1362,25 @@ namespace CForge {
 		void computeAxisAlignedBoundingBox(void) {
 			if (m_Positions.size() == 0) throw CForgeExcept("Mesh contains no vertex data. Can not compute axis aligned bounding box");
 			m_AABB = computeAxisAlignedBoundingBox((*this));
+			m_AABBVersion = m_GeometryVersion;
 		}//computeAxisAlignedBoundingBox
 
+		/**
+		* \brief Computes the axis aligned bounding box unless it was computed for the current geometry version already, see updatePerVertexNormals.
+		*/
+		void updateAxisAlignedBoundingBox(void) {
+			if (m_AABBVersion == m_GeometryVersion) return;
+			computeAxisAlignedBoundingBox();
+		}//updateAxisAlignedBoundingBox
+
 		/**
 		* \brief Applies a 4x4 matrix to the geometry data of the mesh.
 		* 
 		* \param[in] Mat Transformation matrix.
 		*/
 		void applyTransformation(const Eigen::Matrix4f Mat) {
+			geometryChanged();
+
 			// transform vertices
 			for (auto &i : m_Positions) {
 				const Eigen::Vector4f v = Mat * Eigen::Vector4f(i.x(), i.y(), i.z(), (T)1.0);
@@ -1249,15 +1406,96 @@ namespace CForge {
 		*/
 		void changeUVTiling(const Eigen::Vector3f Factor) {
 			for (auto& i : m_UVWs) i = i.cwiseProduct(Factor);
+			geometryChanged();
 			if (tangentCount() > 0) computePerVertexTangents(true);
 		}//changeUVTiling
 			
 	protected:
-		std::vector<Eigen::Matrix<T, 3, 1>> m_Positions;	///< Vertex positions.
-		std::vector<Eigen::Matrix<T, 3, 1>> m_Normals;		///< Per vertex normals.
-		std::vector<Eigen::Matrix<T, 3, 1>> m_Tangents;		///< Per vertex tangents.
-		std::vector<Eigen::Matrix<T, 3, 1>> m_UVWs;			///< Texture coordinates.
-		std::vector<Eigen::Matrix<T, 3, 1>> m_Colors;		///< Vertex colors.
+		static const size_t ParallelMinRange = 1 << 14; ///< Minimum elements per range of the parallel loops over vertices and faces.
+
+		/**
+		* \brief Builds the vertex to face adjacency once per topology. Faces are numbered over all submeshes in order.
+		*/
+		void updateAdjacency(void) {
+			if (m_AdjacencyVersion == m_TopologyVersion && m_VertexFaceOffsets.size() == m_Positions.size() + 1) return;
+
+			const int32_t VertexCount = int32_t(m_Positions.size());
+			m_VertexFaceOffsets.assign(m_Positions.size() + 1, 0);
+			for (const Submesh* i : m_Submeshes) {
+				for (const auto& F : i->Faces) {
+					for (uint8_t k = 0; k < 3; ++k) {
+						if (F.Vertices[k] < 0 || F.Vertices[k] >= VertexCount) throw CForgeExcept("Face references invalid vertex");
+						m_VertexFaceOffsets[F.Vertices[k] + 1]++;
+					}
+				}
+			}//for[submeshes]
+			for (size_t i = 1; i < m_VertexFaceOffsets.size(); ++i) m_VertexFaceOffsets[i] += m_VertexFaceOffsets[i - 1];
+
+			// faces are inserted in ascending order, sums over the adjacency add up in the same order as a loop over the faces
+			m_VertexFaces.resize(m_VertexFaceOffsets.back());
+			std::vector<uint32_t> Cursor(m_VertexFaceOffsets.begin(), m_VertexFaceOffsets.end() - 1);
+			uint32_t FaceID = 0;
+			for (const Submesh* i : m_Submeshes) {
+				for (const auto& F : i->Faces) {
+					for (uint8_t k = 0; k < 3; ++k) m_VertexFaces[Cursor[F.Vertices[k]]++] = FaceID;
+					FaceID++;
+				}
+			}//for[submeshes]
+			m_AdjacencyVersion = m_TopologyVersion;
+		}//updateAdjacency
+
+		/**
+		* \brief Sums per face vectors over the adjacent faces of every vertex and normalizes the sums.
+		* Every vertex is written by exactly one worker, no synchronization is needed.
+		*
+		* \param[in] PerFace Per face vectors of every submesh.
+		* \return One vector per vertex.
+		*/
+		std::vector<Eigen::Matrix<T, 3, 1>> accumulatePerVertex(const std::vector<const std::vector<Eigen::Vector3f>*>& PerFace) {
+			updateAdjacency();
+
+			// one array over all submeshes, most meshes only have one submesh
+			std::vector<Eigen::Vector3f> Gathered;
+			const Eigen::Vector3f* pFaceData = nullptr;
+			if (PerFace.size() == 1) {
+				pFaceData = PerFace[0]->data();
+			}
+			else {
+				for (auto i : PerFace) Gathered.insert(Gathered.end(), i->begin(), i->end());
+				pFaceData = Gathered.data();
+			}
+
+			std::vector<Eigen::Matrix<T, 3, 1>> Rval(m_Positions.size());
+			parallelRanges(Rval.size(), parallelRangeCount(Rval.size(), ParallelMinRange), [&](size_t, size_t Begin, size_t End) {
+				for (size_t v = Begin; v < End; ++v) {
+					Eigen::Vector3f Sum = Eigen::Vector3f::Zero();
+					for (uint32_t k = m_VertexFaceOffsets[v]; k < m_VertexFaceOffsets[v + 1]; ++k) Sum += pFaceData[m_VertexFaces[k]];
+					Rval[v] = Sum.normalized();
+				}
+			});
+			return Rval;
+		}//accumulatePerVertex
+
+		/**
+		* \brief Initializes the versions of a new mesh.
+		*/
+		void resetVersions(void) {
+			m_GeometryVersion = 1;
+			m_TopologyVersion = 1;
+			m_FaceNormalsVersion = 0;
+			m_NormalsVersion = 0;
+			m_FaceTangentsVersion = 0;
+			m_TangentsVersion = 0;
+			m_AABBVersion = 0;
+			m_AdjacencyVersion = 0;
+		}//resetVersions
+
+		// vertex data is shared with copies of the mesh, non-const access clones only the array it touches
+		TSharedVector<Eigen::Matrix<T, 3, 1>> m_Positions;	///< Vertex positions.
+		TSharedVector<Eigen::Matrix<T, 3, 1>> m_Normals;		///< Per vertex normals.
+		TSharedVector<Eigen::Matrix<T, 3, 1>> m_Tangents;		///< Per vertex tangents.
+		TSharedVector<Eigen::Matrix<T, 3, 1>> m_UVWs;			///< Texture coordinates.
+		TSharedVector<Eigen::Matrix<T, 3, 1>> m_Colors;		///< Vertex colors.
 		std::vector<Submesh*> m_Submeshes;					///< Submeshes.
 		std::vector<Material*> m_Materials;					///< Materials.
 		
@@ -1270,6 +1508,18 @@ namespace CForge {
 		std::vector<MorphTarget*> m_MorphTargets;	///< List of morph target animations.
 
 		Box m_AABB;		///< Axis aligned bounding box.
+
+		// caching of derived data, see geometryVersion
+		uint64_t m_GeometryVersion;		///< Changes whenever positions, faces or texture coordinates may have changed.
+		uint64_t m_TopologyVersion;		///< Changes whenever faces or the number of vertexes may have changed.
+		uint64_t m_FaceNormalsVersion;	///< Geometry version the face normals were computed for, 0 if none.
+		uint64_t m_NormalsVersion;		///< Geometry version the vertex normals were computed for, 0 if none.
+		uint64_t m_FaceTangentsVersion;	///< Geometry version the face tangents were computed for, 0 if none.
+		uint64_t m_TangentsVersion;		///< Geometry version the vertex tangents were computed for, 0 if none.
+		uint64_t m_AABBVersion;			///< Geometry version the bounding box was computed for, 0 if none.
+		uint64_t m_AdjacencyVersion;	///< Topology version the adjacency was built for, 0 if none.
+		std::vector<uint32_t> m_VertexFaceOffsets;	///< Faces of vertex v are m_VertexFaces[m_VertexFaceOffsets[v]] up to m_VertexFaces[m_VertexFaceOffsets[v+1]].
+		std::vector<uint32_t> m_VertexFaces;		///< Face IDs, numbered over all submeshes in order.
 	};//T3DMesh
 
 }//name space
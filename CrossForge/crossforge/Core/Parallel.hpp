@@ -0,0 +1,218 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): Parallel.hpp                                                     *
+*                                                                           *
+* Content: Data parallel loops sharing one thread budget.                  *
+*                                                                           *
+*                                                                           *
+*                                                                           *
+* Author(s): Simon Kretzschmar                                              *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_PARALLEL_HPP__
+#define __CFORGE_PARALLEL_HPP__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CForge {
+
+	/**
+	* \brief Thread budget of the parallel loops.
+	* \ingroup Core
+	*
+	* A loop only starts as many helper threads as the hardware has idle cores. Threads that are already busy,
+	* helpers of other loops and threads of pools registered with a ParallelScope, are subtracted. Loops started
+	* from a helper thread run serially, so nested loops never spawn threads.
+	*/
+	class ParallelBudget {
+	public:
+		/**
+		* \brief Reserves up to Wanted helper threads for a loop started on the calling thread.
+		* \return Number of reserved threads, has to be given back with release.
+		*/
+		static uint32_t acquire(uint32_t Wanted) {
+			if (Wanted == 0 || helper()) return 0;
+			const int32_t Hardware = int32_t(std::max(1u, std::thread::hardware_concurrency()));
+			// a registered caller is part of the busy count already
+			const int32_t Own = registered() ? 0 : 1;
+			std::atomic<int32_t>& B = busy();
+			int32_t Busy = B.load();
+			int32_t Take = 0;
+			do {
+				Take = std::min<int32_t>(int32_t(Wanted), Hardware - Own - Busy);
+				if (Take <= 0) return 0;
+			} while (!B.compare_exchange_weak(Busy, Busy + Take));
+			return uint32_t(Take);
+		}//acquire
+
+		static void release(uint32_t Count) {
+			busy() -= int32_t(Count);
+		}//release
+
+		/**
+		* \brief Returns whether the calling thread is a helper of a parallel loop.
+		*/
+		static bool& helper(void) {
+			static thread_local bool Helper = false;
+			return Helper;
+		}//helper
+
+		/**
+		* \brief Returns whether the calling thread is registered by a ParallelScope.
+		*/
+		static bool& registered(void) {
+			static thread_local bool Registered = false;
+			return Registered;
+		}//registered
+
+		static std::atomic<int32_t>& busy(void) {
+			static std::atomic<int32_t> Busy(0);
+			return Busy;
+		}//busy
+	};//ParallelBudget
+
+	/**
+	* \brief Counts the calling thread as busy while in scope, e.g. a worker of a job pool executing a job.
+	*
+	* Parallel loops started by other threads then leave its core alone.
+	*/
+	class ParallelScope {
+	public:
+		ParallelScope(void) {
+			m_Outer = ParallelBudget::registered();
+			if (!m_Outer) {
+				ParallelBudget::registered() = true;
+				ParallelBudget::busy()++;
+			}
+		}//Constructor
+
+		~ParallelScope(void) {
+			if (!m_Outer) {
+				ParallelBudget::busy()--;
+				ParallelBudget::registered() = false;
+			}
+		}//Destructor
+
+		ParallelScope(const ParallelScope&) = delete;
+		ParallelScope& operator=(const ParallelScope&) = delete;
+
+	private:
+		bool m_Outer;
+	};//ParallelScope
+
+	/**
+	* \brief Returns into how many ranges parallelRanges may split Count elements if every range should hold at least MinPerRange elements.
+	*
+	* The result is an upper bound that does not depend on the current load, so it can be used to size per range buffers.
+	*/
+	inline size_t parallelRangeCount(size_t Count, size_t MinPerRange) {
+		const size_t Threads = std::max(1u, std::thread::hardware_concurrency());
+		MinPerRange = std::max<size_t>(1, MinPerRange);
+		return std::max<size_t>(1, std::min(Threads, (Count + MinPerRange - 1) / MinPerRange));
+	}//parallelRangeCount
+
+	/**
+	* \brief Calls F(Task) for every Task in [0, Tasks) on the calling thread and up to Threads - 1 helper threads.
+	*
+	* Tasks are handed out one at a time in ascending order, helpers are only started as far as the budget grants them.
+	* The first exception thrown by F is rethrown on the calling thread after all running tasks finished, remaining
+	* tasks are skipped.
+	*/
+	template<typename Func>
+	void parallelTasks(size_t Tasks, size_t Threads, Func F) {
+		if (Tasks == 0) return;
+		const size_t Wanted = std::min(Tasks, Threads) - ((Threads > 0) ? 1 : 0);
+		const uint32_t Helpers = ParallelBudget::acquire(uint32_t(std::min<size_t>(Wanted, UINT32_MAX)));
+		if (Helpers == 0) {
+			for (size_t i = 0; i < Tasks; ++i) F(i);
+			return;
+		}
+
+		std::atomic<size_t> Next(0);
+		std::exception_ptr Error;
+		std::mutex ErrorMutex;
+		auto Work = [&]() {
+			for (size_t i = Next++; i < Tasks; i = Next++) {
+				try {
+					F(i);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> Lock(ErrorMutex);
+					if (!Error) Error = std::current_exception();
+					Next = Tasks;
+				}
+			}
+		};
+
+		std::vector<std::thread> Workers;
+		Workers.reserve(Helpers);
+		for (uint32_t i = 0; i < Helpers; ++i) {
+			Workers.emplace_back([&Work]() {
+				ParallelBudget::helper() = true;
+				Work();
+			});
+		}
+		// loops nested in tasks of the calling thread run serially as well
+		const bool WasHelper = ParallelBudget::helper();
+		ParallelBudget::helper() = true;
+		Work();
+		ParallelBudget::helper() = WasHelper;
+		for (auto& i : Workers) i.join();
+		ParallelBudget::release(Helpers);
+
+		if (Error) std::rethrow_exception(Error);
+	}//parallelTasks
+
+	/**
+	* \brief Calls F(Range, Begin, End) for Ranges contiguous ranges of [0, Count). Exceptions are rethrown on the calling thread.
+	*/
+	template<typename Func>
+	void parallelRanges(size_t Count, size_t Ranges, Func F) {
+		if (Count == 0) return;
+		Ranges = std::max<size_t>(1, std::min(Ranges, Count));
+		const size_t Step = (Count + Ranges - 1) / Ranges;
+		Ranges = (Count + Step - 1) / Step;
+		parallelTasks(Ranges, Ranges, [&](size_t r) {
+			F(r, r * Step, std::min(Count, (r + 1) * Step));
+		});
+	}//parallelRanges
+
+	/**
+	* \brief Calls F(RangeBegin, RangeEnd) for contiguous ranges of [Begin, End) of at least MinPerThread elements.
+	*
+	* F must only write data owned by its range. Exceptions are rethrown on the calling thread.
+	*/
+	template<typename Func>
+	void parallelFor(size_t Begin, size_t End, Func F, size_t MinPerThread = 4096) {
+		if (End <= Begin) return;
+		const size_t Count = End - Begin;
+		parallelRanges(Count, parallelRangeCount(Count, MinPerThread), [&](size_t, size_t RangeBegin, size_t RangeEnd) {
+			F(Begin + RangeBegin, Begin + RangeEnd);
+		});
+	}//parallelFor
+
+	/**
+	* \brief Calls F(i) for every i in [0, Count), for work items of uneven size.
+	*
+	* Items are handed out one at a time to at most Count / MinPerThread threads. Exceptions are rethrown on the calling thread.
+	*/
+	template<typename Func>
+	void parallelForEach(size_t Count, Func F, size_t MinPerThread = 1) {
+		parallelTasks(Count, parallelRangeCount(Count, MinPerThread), F);
+	}//parallelForEach
+
+}//name space
+
+#endif
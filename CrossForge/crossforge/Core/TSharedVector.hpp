@@ -0,0 +1,228 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): TSharedVector.hpp                                                *
+*                                                                           *
+* Content: Reference counted std::vector with copy-on-write semantics.     *
+*                                                                           *
+*                                                                           *
+*                                                                           *
+* Author(s): Simon Kretzschmar                                              *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_TSHAREDVECTOR_HPP__
+#define __CFORGE_TSHAREDVECTOR_HPP__
+
+#include <memory>
+#include <vector>
+
+namespace CForge {
+
+	/**
+	* \brief Vector whose copies share one buffer until one of them is written.
+	* \ingroup Core
+	*
+	* Copying is O(1). Every non-const access (non-const operator[], begin, data, push_back, ...) first
+	* clones the buffer if other copies still reference it, const access never does. Code that only reads
+	* should therefore use a const reference, e.g. the implicit conversion to const std::vector&.
+	* Concurrent const access is safe. Writing concurrently to the same object is not, call write() once
+	* before handing the elements to worker threads.
+	*
+	* References, pointers and iterators returned by non-const access stay valid after the vector was copied.
+	* To keep writes through them out of the copies, handing them out marks the buffer unshareable: copies
+	* made afterwards clone it right away instead of sharing it. Assigning new elements, clear() and being
+	* the target of a copy make the buffer shareable again and invalidate such references, like the
+	* corresponding std::vector operations.
+	*/
+	template<typename E>
+	class TSharedVector {
+	public:
+		typedef std::vector<E> Vector;
+		typedef typename Vector::value_type value_type;
+		typedef typename Vector::size_type size_type;
+		typedef typename Vector::iterator iterator;
+		typedef typename Vector::const_iterator const_iterator;
+		typedef typename Vector::reference reference;
+		typedef typename Vector::const_reference const_reference;
+
+		TSharedVector(void) {
+
+		}//Constructor
+
+		TSharedVector(const Vector& Other) {
+			if (!Other.empty()) m_pData = std::make_shared<Vector>(Other);
+		}//Constructor
+
+		TSharedVector(Vector&& Other) {
+			if (!Other.empty()) m_pData = std::make_shared<Vector>(std::move(Other));
+		}//Constructor
+
+		TSharedVector(const TSharedVector& Other) {
+			m_pData = Other.share();
+		}//Constructor
+
+		TSharedVector(TSharedVector&& Other) {
+			m_pData = std::move(Other.m_pData);
+			m_Unshareable = Other.m_Unshareable;
+			Other.m_Unshareable = false;
+		}//Constructor
+
+		TSharedVector& operator=(const TSharedVector& Other) {
+			if (this == &Other) return *this;
+			m_pData = Other.share();
+			m_Unshareable = false;
+			return *this;
+		}//operator=
+
+		TSharedVector& operator=(TSharedVector&& Other) {
+			if (this == &Other) return *this;
+			m_pData = std::move(Other.m_pData);
+			m_Unshareable = Other.m_Unshareable;
+			Other.m_Unshareable = false;
+			return *this;
+		}//operator=
+
+		TSharedVector& operator=(const Vector& Other) {
+			m_pData = (Other.empty()) ? nullptr : std::make_shared<Vector>(Other);
+			m_Unshareable = false;
+			return *this;
+		}//operator=
+
+		TSharedVector& operator=(Vector&& Other) {
+			m_pData = (Other.empty()) ? nullptr : std::make_shared<Vector>(std::move(Other));
+			m_Unshareable = false;
+			return *this;
+		}//operator=
+
+		/**
+		* \brief Read access to the elements. Never copies.
+		*/
+		const Vector& read(void)const {
+			static const Vector Empty;
+			return (nullptr != m_pData) ? (*m_pData) : Empty;
+		}//read
+
+		/**
+		* \brief Write access to the elements. Clones the buffer if it is shared and marks it unshareable.
+		*/
+		Vector& write(void) {
+			m_Unshareable = true;
+			return detach();
+		}//write
+
+		/**
+		* \brief Returns whether other copies reference the same buffer.
+		*/
+		bool shared(void)const {
+			return (nullptr != m_pData && m_pData.use_count() > 1);
+		}//shared
+
+		/**
+		* \brief Returns whether references into the buffer were handed out, i.e. whether copies clone it.
+		*/
+		bool unshareable(void)const {
+			return m_Unshareable;
+		}//unshareable
+
+		operator const Vector& (void)const {
+			return read();
+		}
+
+		size_type size(void)const { return read().size(); }
+		bool empty(void)const { return read().empty(); }
+		size_type capacity(void)const { return read().capacity(); }
+
+		const_reference operator[](size_type Index)const { return read()[Index]; }
+		reference operator[](size_type Index) { return write()[Index]; }
+		const_reference at(size_type Index)const { return read().at(Index); }
+		reference at(size_type Index) { return write().at(Index); }
+		const_reference front(void)const { return read().front(); }
+		reference front(void) { return write().front(); }
+		const_reference back(void)const { return read().back(); }
+		reference back(void) { return write().back(); }
+		const E* data(void)const { return read().data(); }
+		E* data(void) { return write().data(); }
+
+		const_iterator begin(void)const { return read().begin(); }
+		const_iterator end(void)const { return read().end(); }
+		const_iterator cbegin(void)const { return read().cbegin(); }
+		const_iterator cend(void)const { return read().cend(); }
+		iterator begin(void) { return write().begin(); }
+		iterator end(void) { return write().end(); }
+
+		void push_back(const E& Value) { detach().push_back(Value); }
+		void push_back(E&& Value) { detach().push_back(std::move(Value)); }
+		template<typename... Args>
+		reference emplace_back(Args&&... Arguments) { return write().emplace_back(std::forward<Args>(Arguments)...); }
+		void pop_back(void) { detach().pop_back(); }
+		void reserve(size_type Count) { detach().reserve(Count); }
+		void resize(size_type Count) { detach().resize(Count); }
+		void resize(size_type Count, const E& Value) { detach().resize(Count, Value); }
+
+		/**
+		* \brief Drops the reference, other copies keep their elements.
+		*/
+		void clear(void) {
+			m_pData = nullptr;
+			m_Unshareable = false;
+		}//clear
+
+		// iterators may point into a shared buffer, positions are translated to the written one
+		template<typename... Args>
+		iterator insert(const_iterator Pos, Args&&... Arguments) {
+			const auto Offset = Pos - read().begin();
+			Vector& V = write();
+			return V.insert(V.begin() + Offset, std::forward<Args>(Arguments)...);
+		}//insert
+
+		iterator erase(const_iterator Pos) {
+			const auto Offset = Pos - read().begin();
+			Vector& V = write();
+			return V.erase(V.begin() + Offset);
+		}//erase
+
+		iterator erase(const_iterator First, const_iterator Last) {
+			const auto Begin = First - read().begin();
+			const auto End = Last - read().begin();
+			Vector& V = write();
+			return V.erase(V.begin() + Begin, V.begin() + End);
+		}//erase
+
+		bool operator==(const TSharedVector& Other)const {
+			return (m_pData == Other.m_pData) || read() == Other.read();
+		}
+
+		bool operator!=(const TSharedVector& Other)const {
+			return !(*this == Other);
+		}
+
+	protected:
+		/**
+		* \brief Clones the buffer if it is shared, without marking it unshareable.
+		*/
+		Vector& detach(void) {
+			if (nullptr == m_pData) m_pData = std::make_shared<Vector>();
+			else if (m_pData.use_count() > 1) m_pData = std::make_shared<Vector>(*m_pData);
+			return *m_pData;
+		}//detach
+
+		/**
+		* \brief Returns the buffer a new copy should reference, a clone if references into this one were handed out.
+		*/
+		std::shared_ptr<Vector> share(void)const {
+			if (m_Unshareable && nullptr != m_pData) return std::make_shared<Vector>(*m_pData);
+			return m_pData;
+		}//share
+
+		std::shared_ptr<Vector> m_pData;	///< Shared elements, nullptr if empty.
+		bool m_Unshareable = false;			///< Whether references into m_pData were handed out.
+	};//TSharedVector
+
+}//name space
+
+#endif
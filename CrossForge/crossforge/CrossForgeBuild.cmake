@@ -125,6 +125,9 @@ add_library(crossforge SHARED
 	# Asset import/exporter stuff
 	crossforge/AssetIO/File.cpp
 	crossforge/AssetIO/AssimpMeshIO.cpp
+	crossforge/AssetIO/BVHIO.cpp
+	crossforge/AssetIO/SkeletalClipLibrary.cpp
+	crossforge/AssetIO/CFMeshIO.cpp
 	crossforge/AssetIO/I2DImageIO.cpp
 	crossforge/AssetIO/I3DMeshIO.cpp
 	crossforge/AssetIO/JPEGTurboIO.cpp
@@ -165,6 +168,7 @@ add_library(crossforge SHARED
 	crossforge/Graphics/Actors/StickFigureActor.cpp
 
 	# Animation Controller 
+	crossforge/Graphics/Controller/SkeletalPoseController.cpp
 	crossforge/Graphics/Controller/SkeletalAnimationController.cpp 
 	crossforge/Graphics/Controller/MorphTargetAnimationController.cpp
 
@@ -303,3 +307,23 @@ target_precompile_headers(crossforge PRIVATE
 	pch.h
 )
 
+# GL free subset of crossforge (objects, math, file access and skeletal pose sampling) for headless tools
+# a binary links either crossforge or crossforgeCore, never both
+add_library(crossforgeCore STATIC
+	crossforge/Core/CForgeObject.cpp
+	crossforge/Core/CrossForgeException.cpp
+	crossforge/AssetIO/File.cpp
+	crossforge/AssetIO/SkeletalClipLibrary.cpp
+	crossforge/Math/BoundingVolume.cpp
+	crossforge/Math/CForgeMath.cpp
+	crossforge/Graphics/Controller/SkeletalPoseController.cpp
+)
+if(NOT EMSCRIPTEN)
+	target_link_libraries(crossforgeCore PUBLIC Eigen3::Eigen)
+endif()
+if(UNIX AND NOT EMSCRIPTEN)
+	target_link_libraries(crossforgeCore PRIVATE stdc++fs)
+endif()
+target_precompile_headers(crossforgeCore PRIVATE
+	crossforge/pch.h
+)
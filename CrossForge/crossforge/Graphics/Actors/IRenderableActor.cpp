@@ -53,14 +53,32 @@ namespace CForge {
 			glVertexAttribPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_COLOR), 3, GL_FLOAT, GL_FALSE, m_VertexUtility.vertexSize(), (const void*)(uint64_t(m_VertexUtility.offset(VertexUtility::VPROP_COLOR))));
 		}
 
+		// bone data is either int32/float or uint16/normalized uint16, 8 influences use a second pair of attributes
+		const bool BoneData16 = m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEDATA16);
+		const bool BoneInfluences8 = m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEINFLUENCES8);
+		const uint64_t BoneDataSize = BoneData16 ? sizeof(uint16_t) : sizeof(int32_t);
+
 		if (m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEINDICES)) {
+			const uint64_t Offset = m_VertexUtility.offset(VertexUtility::VPROP_BONEINDICES);
+			const GLenum Type = BoneData16 ? GL_UNSIGNED_SHORT : GL_INT;
 			glEnableVertexAttribArray(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_INDICES));
-			glVertexAttribIPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_INDICES), 4, GL_INT, m_VertexUtility.vertexSize(), (const void*)(uint64_t(m_VertexUtility.offset(VertexUtility::VPROP_BONEINDICES))));
+			glVertexAttribIPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_INDICES), 4, Type, m_VertexUtility.vertexSize(), (const void*)(Offset));
+			if (BoneInfluences8) {
+				glEnableVertexAttribArray(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_INDICES2));
+				glVertexAttribIPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_INDICES2), 4, Type, m_VertexUtility.vertexSize(), (const void*)(Offset + 4 * BoneDataSize));
+			}
 		}
 
 		if (m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEWEIGHTS)) {
+			const uint64_t Offset = m_VertexUtility.offset(VertexUtility::VPROP_BONEWEIGHTS);
+			const GLenum Type = BoneData16 ? GL_UNSIGNED_SHORT : GL_FLOAT;
+			const GLboolean Normalized = BoneData16 ? GL_TRUE : GL_FALSE;
 			glEnableVertexAttribArray(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_WEIGHTS));
-			glVertexAttribPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_WEIGHTS), 4, GL_FLOAT, GL_FALSE, m_VertexUtility.vertexSize(), (const void*)(uint64_t(m_VertexUtility.offset(VertexUtility::VPROP_BONEWEIGHTS))));
+			glVertexAttribPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_WEIGHTS), 4, Type, Normalized, m_VertexUtility.vertexSize(), (const void*)(Offset));
+			if (BoneInfluences8) {
+				glEnableVertexAttribArray(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_WEIGHTS2));
+				glVertexAttribPointer(GLShader::attribArrayIndex(GLShader::ATTRIB_BONE_WEIGHTS2), 4, Type, Normalized, m_VertexUtility.vertexSize(), (const void*)(Offset + 4 * BoneDataSize));
+			}
 		}
 	}//setBufferData
 
@@ -6,6 +6,7 @@ namespace CForge {
 
 	RenderGroupUtility::RenderGroupUtility(void): CForgeObject("RenderGroupUtiliy") {
 		m_RenderGroups.clear();
+		m_VSConfigOptions = 0;
 
 #ifdef SHADER_GLES
 		m_GLSLVersionTag = "300 es";
@@ -21,11 +22,12 @@ namespace CForge {
 		clear();
 	}//Destructor
 
-	void RenderGroupUtility::init(const T3DMesh<float>* pMesh, void **ppBuffer, uint32_t *pBufferSize) {
+	void RenderGroupUtility::init(const T3DMesh<float>* pMesh, void **ppBuffer, uint32_t *pBufferSize, uint8_t VSConfigOptions) {
 		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
 		if (pMesh->submeshCount() == 0) throw CForgeExcept("Mesh does not contain any submeshes");
 
 		clear();
+		m_VSConfigOptions = VSConfigOptions;
 
 		for (uint32_t i = 0; i < pMesh->submeshCount(); ++i) {
 			m_RenderGroups.push_back(new RenderGroup());
@@ -142,7 +144,7 @@ namespace CForge {
 		try {
 
 			for (auto k : VSSources) {
-				uint8_t ConfigOptions = 0;
+				uint8_t ConfigOptions = m_VSConfigOptions;
 
 				// requires skeletal animation?
 				if (pMesh->boneCount() > 0) {
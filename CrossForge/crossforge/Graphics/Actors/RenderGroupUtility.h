@@ -58,7 +58,10 @@ namespace CForge {
 		RenderGroupUtility(void);
 		~RenderGroupUtility(void);
 
-		void init(const T3DMesh<float>* pMesh, void** ppBuffer = nullptr, uint32_t* pBufferSize = nullptr);
+		/**
+		* \param[in] VSConfigOptions ShaderCode::ConfigOptions added to all vertex shaders, e.g. ShaderCode::CONF_BONEINFLUENCES8 to match the vertex layout.
+		*/
+		void init(const T3DMesh<float>* pMesh, void** ppBuffer = nullptr, uint32_t* pBufferSize = nullptr, uint8_t VSConfigOptions = 0);
 		void clear(void);
 		void buildIndexArray(const T3DMesh<float>* pMesh, void** ppBuffer, uint32_t* pBufferSize);
 
@@ -73,6 +76,7 @@ namespace CForge {
 		std::vector<RenderGroup*> m_RenderGroups;
 		std::string m_GLSLVersionTag;
 		std::string m_GLSLPrecisionTag;
+		uint8_t m_VSConfigOptions;
 	};//RenderGroupUtility
 
 }//name space
@@ -14,14 +14,14 @@ namespace CForge {
 		clear();
 	}//Destructor
 
-	void SkeletalActor::init(T3DMesh<float>* pMesh, SkeletalAnimationController *pController, bool PrepareCPUSkinning) {
+	void SkeletalActor::init(T3DMesh<float>* pMesh, SkeletalAnimationController *pController, bool PrepareCPUSkinning, uint16_t BoneDataProps) {
 		clear();
-		initBuffer(pMesh, PrepareCPUSkinning);
+		initBuffer(pMesh, PrepareCPUSkinning, BoneDataProps);
 		m_pAnimationController = pController;
 		m_BV.init(*pMesh, BoundingVolume::TYPE_AABB); //TODO bounding volume does not move with animation
 	}//initialize
 
-	void SkeletalActor::initBuffer(T3DMesh<float>* pMesh, bool PrepareCPUSkinning) {
+	void SkeletalActor::initBuffer(T3DMesh<float>* pMesh, bool PrepareCPUSkinning, uint16_t BoneDataProps) {
 		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
 		if (pMesh->vertexCount() == 0) throw CForgeExcept("Mesh contains no vertex data!");
 		if (pMesh->boneCount() == 0) throw CForgeExcept("Mesh contains no bones!");
@@ -30,10 +30,11 @@ namespace CForge {
 		if (pMesh->normalCount() > 0) VProps |= VertexUtility::VPROP_NORMAL;
 		if (pMesh->tangentCount() > 0) VProps |= VertexUtility::VPROP_TANGENT;
 		if (pMesh->textureCoordinatesCount() > 0) VProps |= VertexUtility::VPROP_UVW;
+		VProps |= BoneDataProps & (VertexUtility::VPROP_BONEINFLUENCES8 | VertexUtility::VPROP_BONEDATA16);
 
+		m_VertexUtility.init(VProps);
 		if (PrepareCPUSkinning) prepareCPUSkinning(pMesh);
 
-		m_VertexUtility.init(VProps);
 		uint8_t* pBuffer = nullptr;
 		uint32_t BufferSize = 0;
 		m_VertexUtility.buildBuffer(pMesh->vertexCount(), (void**)&pBuffer, &BufferSize, pMesh);
@@ -44,7 +45,8 @@ namespace CForge {
 		pBuffer = nullptr;
 		BufferSize = 0;
 
-		m_RenderGroupUtility.init(pMesh, (void**)&pBuffer, &BufferSize);
+		const uint8_t VSConfigOptions = m_VertexUtility.hasProperties(VertexUtility::VPROP_BONEINFLUENCES8) ? ShaderCode::CONF_BONEINFLUENCES8 : 0;
+		m_RenderGroupUtility.init(pMesh, (void**)&pBuffer, &BufferSize, VSConfigOptions);
 		// build index buffer
 		m_ElementBuffer.init(GLBuffer::BTYPE_INDEX, GLBuffer::BUSAGE_STATIC_DRAW, pBuffer, BufferSize);
 
@@ -65,31 +67,20 @@ namespace CForge {
 		}
 		m_SkinVertexes.clear();
 
+		// same influences as the vertex buffer: largest weights of each vertex, renormalized
+		const uint8_t Influences = m_VertexUtility.boneInfluenceCount();
+		std::vector<int32_t> BoneIndices;
+		std::vector<float> BoneWeights;
+		VertexUtility::buildInfluenceTable(pMesh, Influences, &BoneIndices, &BoneWeights);
+
 		// create vertexes
 		for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) {
 			SkinVertex* pSV = new SkinVertex();
 			pSV->V = pMesh->vertex(i);
+			pSV->BoneInfluences.assign(BoneIndices.begin() + i * Influences, BoneIndices.begin() + (i + 1) * Influences);
+			pSV->BoneWeights.assign(BoneWeights.begin() + i * Influences, BoneWeights.begin() + (i + 1) * Influences);
 			m_SkinVertexes.push_back(pSV);
 		}//for[vertices]
-
-		// go through bones and store influences/weights
-		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
-			auto* pBone = pMesh->getBone(i);
-
-			for (uint32_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
-				auto* pAffectedSF = m_SkinVertexes[pBone->VertexInfluences[k]];
-				pAffectedSF->BoneInfluences.push_back(i);
-				pAffectedSF->BoneWeights.push_back(pBone->VertexWeights[k]);
-			}//for[vertex influences]
-		}//for[all bones]
-
-		// make sure we have at least 4 influences per vertex
-		for (auto i : m_SkinVertexes) {
-			while (i->BoneInfluences.size() < 4) {
-				i->BoneInfluences.push_back(0);
-				i->BoneWeights.push_back(0.0f);
-			}
-		}//for[skin vertexes]
 	}//prepareCPUSkinning
 
 	void SkeletalActor::clear(void) {
@@ -169,10 +160,14 @@ namespace CForge {
 		
 		auto* pV = m_SkinVertexes[Index];
 
-		const Eigen::Vector4i I = Eigen::Vector4i(pV->BoneInfluences[0], pV->BoneInfluences[1], pV->BoneInfluences[2], pV->BoneInfluences[3]);
-		const Eigen::Vector4f W = Eigen::Vector4f(pV->BoneWeights[0], pV->BoneWeights[1], pV->BoneWeights[2], pV->BoneWeights[3]);
-
-		return m_pAnimationController->transformVertex(m_SkinVertexes[Index]->V, I, W);
+		// skinning is linear in the weights, influences are applied in groups of 4
+		Eigen::Vector3f Rval = Eigen::Vector3f::Zero();
+		for (uint32_t k = 0; k + 3 < pV->BoneInfluences.size(); k += 4) {
+			const Eigen::Vector4i I = Eigen::Vector4i(pV->BoneInfluences[k], pV->BoneInfluences[k + 1], pV->BoneInfluences[k + 2], pV->BoneInfluences[k + 3]);
+			const Eigen::Vector4f W = Eigen::Vector4f(pV->BoneWeights[k], pV->BoneWeights[k + 1], pV->BoneWeights[k + 2], pV->BoneWeights[k + 3]);
+			Rval += m_pAnimationController->transformVertex(pV->V, I, W);
+		}
+		return Rval;
 	}//transformVertex
 
 }//name-space
\ No newline at end of file
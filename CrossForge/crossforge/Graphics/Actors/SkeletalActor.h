@@ -27,7 +27,10 @@ namespace CForge {
 		SkeletalActor(void);
 		~SkeletalActor(void);
 
-		virtual void init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning = false);
+		/**
+		* \param[in] BoneDataProps Optional vertex layout of the skinning data, VertexUtility::VPROP_BONEINFLUENCES8 and/or VertexUtility::VPROP_BONEDATA16. With 8 influences the controller has to be initialized with 8 bone influences as well.
+		*/
+		virtual void init(T3DMesh<float>* pMesh, SkeletalAnimationController* pController, bool PrepareCPUSkinning = false, uint16_t BoneDataProps = 0);
 		virtual void activeAnimation(SkeletalAnimationController::Animation* pAnim);
 		virtual SkeletalAnimationController::Animation* activeAnimation(void)const;
 		virtual void clear(void);
@@ -38,7 +41,7 @@ namespace CForge {
 
 	protected:
 		virtual void prepareCPUSkinning(const T3DMesh<float>* pMesh);
-		virtual void initBuffer(T3DMesh<float>* pMesh, bool PrepareCPUSkinning);
+		virtual void initBuffer(T3DMesh<float>* pMesh, bool PrepareCPUSkinning, uint16_t BoneDataProps = 0);
 
 		/**
 		* \brief Structure that holds data for CPU skinning.
@@ -47,13 +47,14 @@ namespace CForge {
 			m_ColorOffset = m_VertexSize;
 			m_VertexSize += sizeof(float) * 3;
 		}
+		const uint16_t BoneDataSize = hasProperties(VPROP_BONEDATA16) ? sizeof(uint16_t) : sizeof(int32_t);
 		if (hasProperties(VPROP_BONEINDICES)) {
 			m_BoneIndicesOffset = m_VertexSize;
-			m_VertexSize += sizeof(int32_t) * 4;
+			m_VertexSize += BoneDataSize * boneInfluenceCount();
 		}
 		if (hasProperties(VPROP_BONEWEIGHTS)) {
 			m_BoneWeightsOffset = m_VertexSize;
-			m_VertexSize += sizeof(float) * 4;
+			m_VertexSize += BoneDataSize * boneInfluenceCount();
 		}
 
 
@@ -97,47 +98,73 @@ namespace CForge {
 		return m_VertexSize;
 	}//vertexSize
 
-	void buildSkeletonAssignment(const T3DMesh<float>* pMesh, vector<Vector4i>* pBoneIndices, vector<Vector4f>* pSkinningWeights) {
-		if (pMesh->boneCount() == 0) return; // nothing to do here
-		if (nullptr == pBoneIndices) throw NullpointerExcept("pBoneIndices");
-		if (nullptr == pSkinningWeights) throw NullpointerExcept("pSkinningWeights");
+	uint8_t VertexUtility::boneInfluenceCount(void)const {
+		return (m_Properties & VPROP_BONEINFLUENCES8) ? 8 : 4;
+	}//boneInfluenceCount
 
-		// initialize the arrays
-		pBoneIndices->clear();
-		pSkinningWeights->clear();
+	void VertexUtility::buildInfluenceTable(const T3DMesh<float>* pMesh, uint8_t MaxInfluences, vector<int32_t>* pBoneIndices, vector<float>* pBoneWeights) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+		if (nullptr == pBoneIndices) throw NullpointerExcept("pBoneIndices");
+		if (nullptr == pBoneWeights) throw NullpointerExcept("pBoneWeights");
+		if (0 == MaxInfluences) throw CForgeExcept("Invalid number of bone influences specified!");
 
-		for (uint32_t i = 0; i < pMesh->vertexCount(); ++i) {
-			pBoneIndices->push_back(Vector4i(-1, -1, -1, -1));
-			pSkinningWeights->push_back(Vector4f::Zero());
-		}//for[all vertices]
+		const uint32_t VertexCount = pMesh->vertexCount();
 
+		// gather influences of all bones per vertex (compressed rows, no allocation per vertex)
+		vector<uint32_t> Offsets(VertexCount + 1, 0);
+		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
+			for (auto k : pMesh->getBone(i)->VertexInfluences) {
+				if (k < 0 || uint32_t(k) >= VertexCount) throw IndexOutOfBoundsExcept("VertexInfluences");
+				Offsets[k + 1]++;
+			}
+		}//for[all bones]
+		for (uint32_t i = 0; i < VertexCount; ++i) Offsets[i + 1] += Offsets[i];
 
+		vector<pair<float, int32_t>> Influences(Offsets[VertexCount]);
+		vector<uint32_t> Fill(Offsets.begin(), Offsets.end() - 1);
 		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
 			const T3DMesh<float>::Bone* pBone = pMesh->getBone(i);
+			for (uint32_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
+				Influences[Fill[pBone->VertexInfluences[k]]++] = pair<float, int32_t>(pBone->VertexWeights[k], pBone->ID);
+			}
+		}//for[all bones]
 
-			uint32_t BoneID = pBone->ID;
+		pBoneIndices->assign(size_t(VertexCount) * MaxInfluences, 0);
+		pBoneWeights->assign(size_t(VertexCount) * MaxInfluences, 0.0f);
 
-			for(uint32_t k=0; k < pBone->VertexInfluences.size(); ++k){
-				const uint32_t VertexID = pBone->VertexInfluences[k];
-				const float VertexWeight = pBone->VertexWeights[k];
-				for (uint8_t l = 0; l < 4; ++l) {
-					if (pBoneIndices->at(VertexID)[l] < 0) {
-						pBoneIndices->at(VertexID)[l] = BoneID;
-						pSkinningWeights->at(VertexID)[l] = VertexWeight;
-						break;
-					}
-				}//for[4 values]
-			}//for[all vertex influences]	
-		}//for[all bones]
+		// keep largest weights and renormalize, dropped weights are distributed to the remaining ones
+		auto ByWeight = [](const pair<float, int32_t>& a, const pair<float, int32_t>& b) { return (a.first != b.first) ? a.first > b.first : a.second < b.second; };
+		for (uint32_t i = 0; i < VertexCount; ++i) {
+			auto Begin = Influences.begin() + Offsets[i];
+			auto End = Influences.begin() + Offsets[i + 1];
+			const uint32_t Count = std::min(uint32_t(End - Begin), uint32_t(MaxInfluences));
+			std::partial_sort(Begin, Begin + Count, End, ByWeight);
 
-		// set all invalid indices to zero (or there may be errors in the shader later)
-		for(auto &i: (*pBoneIndices)) {
-			for (uint8_t k = 0; k < 4; ++k) {
-				if (i[k] < 0) i[k] = 0;
-			}//for[4 values of the vector]
-		}//For[all bone indices]
+			float Sum = 0.0f;
+			for (uint32_t k = 0; k < Count; ++k) Sum += Begin[k].first;
+			if (Sum <= 0.0f) continue;
 
-	}//buildSkeletonAssignment
+			for (uint32_t k = 0; k < Count; ++k) {
+				(*pBoneIndices)[i * MaxInfluences + k] = Begin[k].second;
+				(*pBoneWeights)[i * MaxInfluences + k] = Begin[k].first / Sum;
+			}
+		}//for[all vertices]
+
+	}//buildInfluenceTable
+
+	uint32_t VertexUtility::maxBoneInfluences(const T3DMesh<float>* pMesh) {
+		if (nullptr == pMesh) throw NullpointerExcept("pMesh");
+
+		vector<uint32_t> Counts(pMesh->vertexCount(), 0);
+		uint32_t Rval = 0;
+		for (uint32_t i = 0; i < pMesh->boneCount(); ++i) {
+			const T3DMesh<float>::Bone* pBone = pMesh->getBone(i);
+			for (uint32_t k = 0; k < pBone->VertexInfluences.size(); ++k) {
+				if (pBone->VertexWeights[k] > 0.0f) Rval = std::max(Rval, ++Counts[pBone->VertexInfluences[k]]);
+			}
+		}//for[all bones]
+		return Rval;
+	}//maxBoneInfluences
 
 	void VertexUtility::buildBuffer(uint32_t VertexCount, void** ppBuffer, uint32_t* pBufferSize, const T3DMesh<float>* pMesh) {
 		if (nullptr == ppBuffer) throw NullpointerExcept("ppBuffer");
@@ -159,10 +186,15 @@ namespace CForge {
 
 		if (nullptr == pMesh || 0 == pMesh->vertexCount()) return; // thats it
 
-		std::vector<Vector4i> BoneIndices;
-		std::vector<Vector4f> SkinningWeights;
+		std::vector<int32_t> BoneIndices;
+		std::vector<float> SkinningWeights;
+		const uint8_t Influences = boneInfluenceCount();
+		const bool BoneData16 = hasProperties(VPROP_BONEDATA16);
 
-		buildSkeletonAssignment(pMesh, &BoneIndices, &SkinningWeights);
+		if (pMesh->boneCount() > 0 && (hasProperties(VPROP_BONEINDICES) || hasProperties(VPROP_BONEWEIGHTS))) {
+			if (BoneData16 && pMesh->boneCount() > 0xFFFF) throw CForgeExcept("Too many bones for 16 bit bone indices!");
+			buildInfluenceTable(pMesh, Influences, &BoneIndices, &SkinningWeights);
+		}
 
 		// initialize buffer with mesh values (if available)	
 		for (uint32_t i = 0; i < std::min(pMesh->vertexCount(), VertexCount); ++i) {
@@ -207,22 +239,34 @@ namespace CForge {
 				pV[2] = pMesh->color(i).z();
 			}
 
-			if (BoneIndices.size() == pMesh->vertexCount()) {
+			if (!BoneIndices.empty() && hasProperties(VPROP_BONEINDICES)) {
 				BufferOffset = i * m_VertexSize + m_BoneIndicesOffset;
-				int32_t *pVi = (int32_t*)&pBuf[BufferOffset];
-				pVi[0] = BoneIndices[i].x();
-				pVi[1] = BoneIndices[i].y();
-				pVi[2] = BoneIndices[i].z();
-				pVi[3] = BoneIndices[i].w();
+				if (BoneData16) {
+					uint16_t* pVi = (uint16_t*)&pBuf[BufferOffset];
+					for (uint8_t k = 0; k < Influences; ++k) pVi[k] = uint16_t(BoneIndices[i * Influences + k]);
+				}
+				else {
+					int32_t* pVi = (int32_t*)&pBuf[BufferOffset];
+					for (uint8_t k = 0; k < Influences; ++k) pVi[k] = BoneIndices[i * Influences + k];
+				}
 			}
 
-			if (SkinningWeights.size() == pMesh->vertexCount()) {
+			if (!SkinningWeights.empty() && hasProperties(VPROP_BONEWEIGHTS)) {
 				BufferOffset = i * m_VertexSize + m_BoneWeightsOffset;
-				pV = (float*)&pBuf[BufferOffset];
-				pV[0] = SkinningWeights[i].x();
-				pV[1] = SkinningWeights[i].y();
-				pV[2] = SkinningWeights[i].z();
-				pV[3] = SkinningWeights[i].w();
+				if (BoneData16) {
+					// quantize and put the rounding error on the largest weight, so the weights still sum up to 1
+					uint16_t* pVw = (uint16_t*)&pBuf[BufferOffset];
+					int32_t Sum = 0;
+					for (uint8_t k = 0; k < Influences; ++k) {
+						pVw[k] = uint16_t(std::lround(SkinningWeights[i * Influences + k] * 65535.0f));
+						Sum += pVw[k];
+					}
+					if (Sum > 0) pVw[0] = uint16_t(int32_t(pVw[0]) + 65535 - Sum);
+				}
+				else {
+					pV = (float*)&pBuf[BufferOffset];
+					for (uint8_t k = 0; k < Influences; ++k) pV[k] = SkinningWeights[i * Influences + k];
+				}
 			}
 
 		}//for[number of vertices]	
@@ -38,6 +38,8 @@ namespace CForge {
 			VPROP_COLOR				= 0x0010, ///< vertex colors
 			VPROP_BONEINDICES		= 0x0020, ///< bone indices
 			VPROP_BONEWEIGHTS		= 0x0040, ///< bone weights
+			VPROP_BONEINFLUENCES8	= 0x0080, ///< 8 instead of 4 bone indices and weights per vertex (shader define BONE_INFLUENCES_8)
+			VPROP_BONEDATA16		= 0x0100, ///< bone indices as uint16 and bone weights as normalized uint16
 		};
 
 		VertexUtility(void);
@@ -50,9 +52,25 @@ namespace CForge {
 
 		uint16_t offset(VertexProperty Prop);
 		uint16_t vertexSize(void)const;
+		uint8_t boneInfluenceCount(void)const;
 
 		void buildBuffer(uint32_t VertexCount, void** ppBuffer, uint32_t* pBufferSize, const T3DMesh<float>* pMesh = nullptr );
 
+		/**
+		* \brief Builds the per vertex skinning data from the per bone influences of the mesh. Keeps the MaxInfluences largest weights of every vertex, sorted by weight, and renormalizes them to sum up to 1.
+		*
+		* \param[in] pMesh Mesh with bones.
+		* \param[in] MaxInfluences Number of influences stored per vertex.
+		* \param[out] pBoneIndices MaxInfluences bone IDs per vertex, unused slots are 0.
+		* \param[out] pBoneWeights MaxInfluences weights per vertex, unused slots are 0.
+		*/
+		static void buildInfluenceTable(const T3DMesh<float>* pMesh, uint8_t MaxInfluences, std::vector<int32_t>* pBoneIndices, std::vector<float>* pBoneWeights);
+
+		/**
+		* \brief Largest number of bones influencing a single vertex of the mesh.
+		*/
+		static uint32_t maxBoneInfluences(const T3DMesh<float>* pMesh);
+
 	protected:
 
 	private:
@@ -0,0 +1,138 @@
+/*****************************************************************************\
+*                                                                           *
+* File(s): SkeletalPoseController.h and SkeletalPoseController.cpp          *
+*                                                                           *
+* Content: Skeleton and keyframe sampling without any OpenGL resources.     *
+*          Base of SkeletalAnimationController.                             *
+*                                                                           *
+*                                                                           *
+* Author(s): Tom Uhlmann                                                    *
+*                                                                           *
+*                                                                           *
+* The file(s) mentioned above are provided as is under the terms of the     *
+* MIT License without any warranty or guaranty to work properly.            *
+* For additional license, copyright and contact/support issues see the      *
+* supplied documentation.                                                   *
+*                                                                           *
+\****************************************************************************/
+#ifndef __CFORGE_SKELETALPOSECONTROLLER_H__
+#define __CFORGE_SKELETALPOSECONTROLLER_H__
+
+#include "../../AssetIO/T3DMesh.hpp"
+#include "../../AssetIO/SkeletalClipLibrary.h"
+
+namespace CForge {
+	/**
+	* \brief Holds a skeleton and its animations and computes poses from keyframes.
+	*
+	* Does not create any GL resources and can be used without a render context.
+	* Uploading the skinning matrices is done by SkeletalAnimationController.
+	*/
+	class CFORGE_API SkeletalPoseController: public CForgeObject {
+	public:
+		struct Animation {
+			int32_t AnimationID;   // m_SkeletalAnimations index
+			float Speed;           // playback speed
+			float Duration;
+			float t;               // current timestep
+			float SamplesPerSecond;
+			int64_t LastTimestamp;
+			bool Finished;
+		};
+
+		struct SkeletalJoint : public CForgeObject {
+			int32_t ID;
+			std::string Name;
+			Eigen::Matrix4f OffsetMatrix;
+			Eigen::Vector3f LocalPosition;
+			Eigen::Quaternionf LocalRotation;
+			Eigen::Vector3f LocalScale;
+			Eigen::Matrix4f SkinningMatrix;
+
+			int32_t Parent;
+			std::vector<int32_t> Children;
+
+			SkeletalJoint(void) : CForgeObject("SkeletalPoseController::SkeletalJoint") {
+				ID = -1;
+				Parent = -1;
+			}
+		};
+
+		SkeletalPoseController(void);
+		~SkeletalPoseController(void);
+
+		// pMesh has to hold skeletal definition
+		void init(T3DMesh<float>* pMesh, bool CopyAnimationData = true);
+		void update(float FPSScale);
+		void clear(void);
+
+		void addAnimationData(T3DMesh<float>::SkeletalAnimation* pAnimation);
+
+		/**
+		* \brief Appends the clips of a .cfclips library to the animations.
+		*
+		* Only the table of contents is read, a clip is decoded the first time it is requested by animation or createAnimation.
+		* \param[in] Filepath Path to the library.
+		* \throws CrossForgeException if the library can not be opened.
+		*/
+		void addAnimationLibrary(const std::string Filepath);
+
+		Animation* createAnimation(int32_t AnimationID, float Speed, float Offset);
+		void destroyAnimation(Animation* pAnim);
+
+		/**
+		* \brief Samples the animation at its current time and computes the skinning matrices.
+		* \param[in] pAnim Animation to sample. Resets all skinning matrices to identity if nullptr.
+		*/
+		void applyAnimation(Animation* pAnim);
+
+		T3DMesh<float>::SkeletalAnimation* animation(uint32_t ID);
+		uint32_t animationCount(void)const;
+
+		/**
+		* \brief Returns the name of an animation without decoding clips of a library.
+		*/
+		std::string animationName(uint32_t ID)const;
+
+		/**
+		* \brief Returns the rate of the keyframe timestamps of an animation as imported.
+		*
+		* Timestamps are stored in the unit of the source (ticks for Assimp, frames for BVH, seconds for glTF), divide by this rate to get seconds.
+		* Sources that do not specify a rate return 1, their timestamps are taken as seconds.
+		*/
+		float ticksPerSecond(uint32_t ID)const;
+
+		void retrieveSkinningMatrices(std::vector<Eigen::Matrix4f>* pSkinningMats);
+
+		std::vector<SkeletalJoint*> retrieveSkeleton(void)const;
+		void retrieveSkeleton(std::vector<SkeletalJoint*>* pSkeleton);
+		void setSkeletonValues(std::vector<SkeletalJoint*>* pSkeleton);
+
+		Eigen::Vector3f transformVertex(Eigen::Vector3f V, Eigen::Vector4i BoneInfluences, Eigen::Vector4f BoneWeights);
+
+	protected:
+		SkeletalPoseController(const std::string ClassName);
+
+		void transformSkeleton(SkeletalJoint* pJoint, Eigen::Matrix4f ParentTransform);
+		int32_t jointIDFromName(std::string JointName);
+		T3DMesh<float>::SkeletalAnimation* bindAnimation(const T3DMesh<float>::SkeletalAnimation* pAnimation);
+
+		struct ClipSource {
+			SkeletalClipLibrary* pLibrary; // nullptr for animations added as data
+			uint32_t Clip;
+			float TicksPerSecond; // SamplesPerSecond of the source, bindAnimation overwrites it
+		};
+
+		SkeletalJoint* m_pRoot;
+		std::vector<SkeletalJoint*> m_Joints;
+
+		std::vector<T3DMesh<float>::SkeletalAnimation*> m_SkeletalAnimations; // available animations for this skeleton, nullptr until a library clip is decoded
+		std::vector<ClipSource> m_ClipSources; // origin of every entry of m_SkeletalAnimations
+		std::vector<SkeletalClipLibrary*> m_ClipLibraries;
+		std::vector<Animation*> m_ActiveAnimations;
+
+	};//SkeletalPoseController
+
+}//name space
+
+#endif
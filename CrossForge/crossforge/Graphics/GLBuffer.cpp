@@ -60,8 +60,9 @@ namespace CForge {
 	}//initialize
 
 	void GLBuffer::clear(void) {
-		if (glIsBuffer(m_GLID)) glDeleteBuffers(1, &m_GLID);
-		if (glIsTexture(m_TextureHandle)) glDeleteTextures(1, &m_TextureHandle);
+		// never initialized buffers must not touch GL, there may be no context at all
+		if (GL_INVALID_INDEX != m_GLID && glIsBuffer(m_GLID)) glDeleteBuffers(1, &m_GLID);
+		if (GL_INVALID_INDEX != m_TextureHandle && glIsTexture(m_TextureHandle)) glDeleteTextures(1, &m_TextureHandle);
 		m_GLID = GL_INVALID_INDEX;
 		m_TextureHandle = GL_INVALID_INDEX;
 		m_BufferType = BTYPE_UNKNOWN;
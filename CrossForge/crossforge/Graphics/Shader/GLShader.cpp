@@ -16,6 +16,8 @@ namespace CForge {
 		case ATTRIB_BONE_WEIGHTS:	Rval = 5; break;
 		case ATTRIB_COLOR:			Rval = 6; break;
 		case ATTRIB_SPARE:			Rval = 7; break;
+		case ATTRIB_BONE_INDICES2:	Rval = 8; break;
+		case ATTRIB_BONE_WEIGHTS2:	Rval = 9; break;
 		default: {
 			throw CForgeExcept("Invalid vertex attribute specified!");
 		}break;
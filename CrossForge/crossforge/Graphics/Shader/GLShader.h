@@ -40,6 +40,8 @@ namespace CForge {
 			ATTRIB_BONE_WEIGHTS,
 			ATTRIB_COLOR,
 			ATTRIB_SPARE,
+			ATTRIB_BONE_INDICES2,	///< bone indices 5 to 8 (VertexUtility::VPROP_BONEINFLUENCES8)
+			ATTRIB_BONE_WEIGHTS2,	///< bone weights 5 to 8
 		};
 
 		enum ShaderType : int8_t {
@@ -215,6 +215,7 @@ namespace CForge {
 			if (i->requiresConfig(ShaderCode::CONF_LIGHTING)) i->config(&m_LightConfig);
 			if (i->requiresConfig(ShaderCode::CONF_POSTPROCESSING)) i->config(&m_PostProcessingConfig);
 			if (i->requiresConfig(ShaderCode::CONF_SKELETALANIMATION)) i->config(ShaderCode::CONF_SKELETALANIMATION);
+			if (i->requiresConfig(ShaderCode::CONF_BONEINFLUENCES8)) i->config(ShaderCode::CONF_BONEINFLUENCES8);
 			if (i->requiresConfig(ShaderCode::CONF_VERTEXCOLORS)) i->config(ShaderCode::CONF_VERTEXCOLORS);
 			if (i->requiresConfig(ShaderCode::CONF_NORMALMAPPING)) i->config(ShaderCode::CONF_NORMALMAPPING);
 			pShader->pShader->addVertexShader(i->code());
@@ -151,6 +151,7 @@ namespace CForge {
 		if (ConfigOptions & CONF_MORPHTARGETANIMATION) config(&m_MorphTargetAnimationConfig);
 		if (ConfigOptions & CONF_VERTEXCOLORS) addDefine("VERTEX_COLORS");
 		if (ConfigOptions & CONF_NORMALMAPPING) addDefine("NORMAL_MAPPING");
+		if (ConfigOptions & CONF_BONEINFLUENCES8) addDefine("BONE_INFLUENCES_8");
 	}//config
 
 	std::string ShaderCode::code(void)const {
@@ -81,6 +81,7 @@ namespace CForge {
 			CONF_MORPHTARGETANIMATION	= 0x08,
 			CONF_VERTEXCOLORS			= 0x10,
 			CONF_NORMALMAPPING			= 0x20,
+			CONF_BONEINFLUENCES8		= 0x40, ///< 8 bone influences per vertex, requires CONF_SKELETALANIMATION
 		};
 
 		ShaderCode(void);
@@ -12,6 +12,10 @@ layout (location = 0) in vec3 Position;
 #ifdef SKELETAL_ANIMATION
 layout (location = 4) in ivec4 BoneIndices;
 layout (location = 5) in vec4 BoneWeights;
+#ifdef BONE_INFLUENCES_8
+layout (location = 8) in ivec4 BoneIndices2;
+layout (location = 9) in vec4 BoneWeights2;
+#endif
 #endif
 
 uniform uint ActiveLightID;
@@ -38,6 +42,11 @@ void main(){
 	for(uint i = 0U; i < 4U; ++i){
 		T += BoneWeights[i] * Bones.SkinningMatrix[BoneIndices[i]];	
 	}//for[4 weights]
+#ifdef BONE_INFLUENCES_8
+	for(uint i = 0U; i < 4U; ++i){
+		T += BoneWeights2[i] * Bones.SkinningMatrix[BoneIndices2[i]];
+	}//for[4 more weights]
+#endif
 
 	Po = T * Po;
 #endif 